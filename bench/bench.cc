@@ -0,0 +1,91 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "bench/bench.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<wasp::u64> s_allocation_count{0};
+
+}  // namespace
+
+// Count every allocation, so benchmarks can report allocations as well as
+// time. The array and sized forms call these.
+void* operator new(size_t size) {
+  s_allocation_count.fetch_add(1, std::memory_order_relaxed);
+  if (void* ptr = std::malloc(size ? size : 1)) {
+    return ptr;
+  }
+  throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+  std::free(ptr);
+}
+
+namespace wasp::bench {
+
+u64 AllocationCount() {
+  return s_allocation_count.load(std::memory_order_relaxed);
+}
+
+std::vector<Benchmark>& Benchmarks() {
+  static std::vector<Benchmark> benchmarks;
+  return benchmarks;
+}
+
+Registrar::Registrar(string_view name, BenchmarkFunction function) {
+  Benchmarks().push_back(Benchmark{std::string{name}, function});
+}
+
+Result Run(const Benchmark& benchmark, double min_seconds) {
+  u64 iterations = 1;
+  while (true) {
+    State state{iterations};
+    auto start = std::chrono::steady_clock::now();
+    u64 start_allocations = AllocationCount();
+    benchmark.function(state);
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    double seconds = elapsed.count() - state.paused_seconds();
+    u64 allocations =
+        AllocationCount() - start_allocations - state.paused_allocations();
+
+    if (seconds >= min_seconds || iterations >= (u64{1} << 40)) {
+      return Result{benchmark.name, iterations, seconds,
+                    state.bytes_processed(), state.items_processed(),
+                    allocations};
+    }
+
+    // Aim a little past `min_seconds`, but don't grow too quickly if the
+    // first runs were too short to measure.
+    double scale = seconds > 0 ? 1.4 * min_seconds / seconds : 10;
+    iterations = std::max(iterations + 1,
+                          static_cast<u64>(iterations * std::min(scale, 10.)));
+  }
+}
+
+}  // namespace wasp::bench
@@ -0,0 +1,126 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BENCH_BENCH_H_
+#define WASP_BENCH_BENCH_H_
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "wasp/base/string_view.h"
+#include "wasp/base/types.h"
+
+namespace wasp::bench {
+
+// The number of calls to operator new so far, counted by wasp_bench's
+// replacement of it.
+u64 AllocationCount();
+
+// Passed to each benchmark function, which runs its workload `iterations()`
+// times and reports how much work that was.
+class State {
+ public:
+  explicit State(u64 iterations) : iterations_{iterations} {}
+
+  u64 iterations() const { return iterations_; }
+
+  // The totals over all iterations, used to report throughput.
+  void SetBytesProcessed(u64 bytes) { bytes_processed_ = bytes; }
+  void SetItemsProcessed(u64 items) { items_processed_ = items; }
+
+  u64 bytes_processed() const { return bytes_processed_; }
+  u64 items_processed() const { return items_processed_; }
+
+  // Excludes the time between these calls from the result, e.g. to build the
+  // inputs of a benchmark the first time it runs.
+  void PauseTiming() {
+    pause_start_ = Clock::now();
+    pause_allocations_start_ = AllocationCount();
+  }
+  void ResumeTiming() {
+    paused_ += Clock::now() - pause_start_;
+    paused_allocations_ += AllocationCount() - pause_allocations_start_;
+  }
+
+  double paused_seconds() const {
+    return std::chrono::duration<double>(paused_).count();
+  }
+  u64 paused_allocations() const { return paused_allocations_; }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  u64 iterations_;
+  u64 bytes_processed_ = 0;
+  u64 items_processed_ = 0;
+  Clock::time_point pause_start_;
+  Clock::duration paused_{};
+  u64 pause_allocations_start_ = 0;
+  u64 paused_allocations_ = 0;
+};
+
+using BenchmarkFunction = void (*)(State&);
+
+struct Benchmark {
+  std::string name;
+  BenchmarkFunction function;
+};
+
+struct Result {
+  std::string name;
+  u64 iterations;
+  double seconds;
+  u64 bytes_processed;
+  u64 items_processed;
+  u64 allocations;
+};
+
+// All benchmarks registered with WASP_BENCHMARK, in registration order.
+std::vector<Benchmark>& Benchmarks();
+
+struct Registrar {
+  explicit Registrar(string_view name, BenchmarkFunction);
+};
+
+#define WASP_BENCHMARK_CONCAT2(x, y) x##y
+#define WASP_BENCHMARK_CONCAT(x, y) WASP_BENCHMARK_CONCAT2(x, y)
+
+// The benchmark function is variadic so it can be a lambda with commas in it.
+#define WASP_BENCHMARK(name, ...)                        \
+  static ::wasp::bench::Registrar WASP_BENCHMARK_CONCAT( \
+      wasp_benchmark_, __LINE__) {                       \
+    name, __VA_ARGS__                                    \
+  }
+
+// Runs the benchmark with increasing iteration counts until it takes at least
+// `min_seconds`.
+Result Run(const Benchmark&, double min_seconds);
+
+// Prevents the compiler from optimizing away the computation of `value`.
+template <typename T>
+void DoNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static volatile const void* sink;
+  sink = &value;
+#endif
+}
+
+}  // namespace wasp::bench
+
+#endif  // WASP_BENCH_BENCH_H_
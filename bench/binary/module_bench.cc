@@ -0,0 +1,193 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <iterator>
+#include <vector>
+
+#include "bench/bench.h"
+#include "bench/corpus.h"
+#include "wasp/base/errors_nop.h"
+#include "wasp/base/output_sink.h"
+#include "wasp/binary/lazy_expression.h"
+#include "wasp/binary/lazy_module.h"
+#include "wasp/binary/module_index.h"
+#include "wasp/binary/read.h"
+#include "wasp/binary/read/read_ctx.h"
+#include "wasp/binary/visitor.h"
+#include "wasp/binary/write.h"
+
+namespace wasp::bench {
+namespace {
+
+using namespace ::wasp::binary;
+
+// Visits everything in the module, including every instruction.
+struct CountingVisitor : visit::Visitor {
+  visit::Result OnInstruction(const At<Instruction>&) {
+    count++;
+    return visit::Result::Ok;
+  }
+
+  u64 count = 0;
+};
+
+// Collects the function bodies, without reading their instructions.
+struct CodeVisitor : visit::Visitor {
+  visit::Result BeginCode(const At<Code>& code) {
+    bodies.push_back(code->body);
+    return visit::Result::Skip;
+  }
+
+  std::vector<Expression> bodies;
+};
+
+WASP_BENCHMARK("binary/ReadLazyModule+Visit", [](State& state) {
+  const auto& corpus = GetCorpus(state);
+  ErrorsNop errors;
+  ForEachInput(state, Format::Binary, [&](size_t index) {
+    auto module =
+        ReadLazyModule(corpus.inputs[index].binary, corpus.features, errors);
+    CountingVisitor visitor;
+    visit::Visit(module, visitor);
+    DoNotOptimize(visitor.count);
+  });
+});
+
+WASP_BENCHMARK("binary/ReadExpression", [](State& state) {
+  state.PauseTiming();
+  const auto& corpus = GetCorpus();
+  ErrorsNop errors;
+  static const auto bodies = [&] {
+    std::vector<std::vector<Expression>> result;
+    for (const auto& input : corpus.inputs) {
+      auto module = ReadLazyModule(input.binary, corpus.features, errors);
+      CodeVisitor visitor;
+      visit::Visit(module, visitor);
+      result.push_back(std::move(visitor.bodies));
+    }
+    return result;
+  }();
+  state.ResumeTiming();
+
+  ReadCtx ctx{corpus.features, errors};
+  ForEachInput(state, Format::Binary, [&](size_t index) {
+    for (const auto& body : bodies[index]) {
+      for (const auto& instr : ReadExpression(body, ctx)) {
+        DoNotOptimize(instr);
+      }
+    }
+  });
+  // Only the function bodies are read.
+  u64 size = 0;
+  for (const auto& module_bodies : bodies) {
+    for (const auto& body : module_bodies) {
+      size += body.data.size();
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * size);
+});
+
+// Returns every module in the corpus, read with ReadModule.
+const std::vector<Module>& ReadModules(State& state) {
+  state.PauseTiming();
+  const auto& corpus = GetCorpus();
+  static const auto modules = [&] {
+    ErrorsNop errors;
+    std::vector<Module> result;
+    for (const auto& input : corpus.inputs) {
+      ReadCtx ctx{corpus.features, errors};
+      result.push_back(*ReadModule(input.binary, ctx));
+    }
+    return result;
+  }();
+  state.ResumeTiming();
+  return modules;
+}
+
+WASP_BENCHMARK("binary/Write", [](State& state) {
+  const auto& modules = ReadModules(state);
+
+  Buffer buffer;
+  ForEachInput(state, Format::Binary, [&](size_t index) {
+    buffer.clear();
+    Write(modules[index], std::back_inserter(buffer));
+    DoNotOptimize(buffer.data());
+  });
+});
+
+// As above, but patches the lengths in place, instead of writing each section
+// and function body to a temporary buffer.
+WASP_BENCHMARK("binary/WriteModule", [](State& state) {
+  const auto& modules = ReadModules(state);
+
+  Buffer buffer;
+  ForEachInput(state, Format::Binary, [&](size_t index) {
+    buffer.clear();
+    WriteModule(modules[index], buffer);
+    DoNotOptimize(buffer.data());
+  });
+});
+
+// As binary/WriteModule, but starts with an empty buffer each time, so
+// includes the cost of growing it.
+WASP_BENCHMARK("binary/WriteModule/NewBuffer", [](State& state) {
+  const auto& modules = ReadModules(state);
+
+  ForEachInput(state, Format::Binary, [&](size_t index) {
+    Buffer buffer;
+    WriteModule(modules[index], buffer);
+    DoNotOptimize(buffer.data());
+  });
+});
+
+// As binary/Write, but writes to an OutputSink, which stores the bytes in
+// fixed-size chunks instead of growing a single buffer.
+WASP_BENCHMARK("binary/Write/OutputSink", [](State& state) {
+  const auto& modules = ReadModules(state);
+
+  ForEachInput(state, Format::Binary, [&](size_t index) {
+    OutputSink sink;
+    Write(modules[index], sink.out());
+    DoNotOptimize(sink.size());
+  });
+});
+
+// Reads an index written by WriteModuleIndex, which includes checking that it
+// matches the module.
+WASP_BENCHMARK("binary/ReadModuleIndex", [](State& state) {
+  state.PauseTiming();
+  const auto& corpus = GetCorpus();
+  static const auto indexes = [&] {
+    ErrorsNop errors;
+    std::vector<Buffer> result;
+    for (const auto& input : corpus.inputs) {
+      auto module = ReadLazyModule(input.binary, corpus.features, errors);
+      result.emplace_back();
+      WriteModuleIndex(BuildModuleIndex(module), result.back());
+    }
+    return result;
+  }();
+  state.ResumeTiming();
+
+  ForEachInput(state, Format::Binary, [&](size_t index) {
+    auto module_index =
+        ReadModuleIndex(indexes[index], corpus.inputs[index].binary);
+    DoNotOptimize(module_index);
+  });
+});
+
+}  // namespace
+}  // namespace wasp::bench
@@ -0,0 +1,127 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include "bench/bench.h"
+#include "wasp/base/errors_nop.h"
+#include "wasp/binary/read/read_ctx.h"
+#include "wasp/binary/read/read_var_int.h"
+#include "wasp/binary/write.h"
+
+namespace wasp::bench {
+namespace {
+
+using namespace ::wasp::binary;
+
+constexpr size_t kValueCount = 64 * 1024;
+
+// A range of values, and how often values are chosen from it.
+template <typename T>
+struct Bucket {
+  int weight;
+  T min;
+  T max;
+};
+
+// Encodes kValueCount values chosen from `buckets`, using a fixed seed so
+// every run decodes the same bytes.
+template <typename T>
+std::vector<u8> Encode(std::vector<Bucket<T>> buckets) {
+  std::mt19937_64 rng{0};
+  std::vector<int> weights;
+  for (auto& bucket : buckets) {
+    weights.push_back(bucket.weight);
+  }
+  std::discrete_distribution<size_t> choose_bucket{weights.begin(),
+                                                   weights.end()};
+  std::vector<u8> result;
+  for (size_t i = 0; i < kValueCount; ++i) {
+    auto& bucket = buckets[choose_bucket(rng)];
+    std::uniform_int_distribution<T> choose_value{bucket.min, bucket.max};
+    WriteVarInt(choose_value(rng), std::back_inserter(result));
+  }
+  return result;
+}
+
+// Indexes and lengths are almost always small.
+const std::vector<u8>& Indexes() {
+  static const auto data =
+      Encode<u32>({{85, 0, 127}, {13, 128, 16383}, {2, 16384, 1 << 21}});
+  return data;
+}
+
+// Constants are more spread out, though small values are still common.
+const std::vector<u8>& S32Constants() {
+  static const auto data = Encode<s32>({{50, -64, 63},
+                                        {30, -8192, 8191},
+                                        {15, -(1 << 20), 1 << 20},
+                                        {5, INT32_MIN, INT32_MAX}});
+  return data;
+}
+
+const std::vector<u8>& S64Constants() {
+  static const auto data = Encode<s64>({{40, -64, 63},
+                                        {30, -8192, 8191},
+                                        {20, INT32_MIN, INT32_MAX},
+                                        {10, INT64_MIN, INT64_MAX}});
+  return data;
+}
+
+template <typename T, OptAt<T> (*Read)(SpanU8*, ReadCtx&, string_view)>
+void DecodeAll(State& state, const std::vector<u8>& (*input)()) {
+  state.PauseTiming();
+  const auto& bytes = input();
+  state.ResumeTiming();
+  ErrorsNop errors;
+  ReadCtx ctx{errors};
+  for (u64 i = 0; i < state.iterations(); ++i) {
+    SpanU8 data{bytes};
+    while (!data.empty()) {
+      auto value = Read(&data, ctx, "value");
+      // Only keep the decoded value; forcing the whole OptAt<T> into memory
+      // costs more than decoding a small value.
+      DoNotOptimize(value->value());
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * bytes.size());
+  state.SetItemsProcessed(state.iterations() * kValueCount);
+}
+
+WASP_BENCHMARK("ReadVarInt/u32_index", [](State& state) {
+  DecodeAll<u32, ReadVarInt<u32>>(state, Indexes);
+});
+WASP_BENCHMARK("ReadVarIntSlow/u32_index", [](State& state) {
+  DecodeAll<u32, ReadVarIntSlow<u32>>(state, Indexes);
+});
+WASP_BENCHMARK("ReadVarInt/s32_const", [](State& state) {
+  DecodeAll<s32, ReadVarInt<s32>>(state, S32Constants);
+});
+WASP_BENCHMARK("ReadVarIntSlow/s32_const", [](State& state) {
+  DecodeAll<s32, ReadVarIntSlow<s32>>(state, S32Constants);
+});
+WASP_BENCHMARK("ReadVarInt/s64_const", [](State& state) {
+  DecodeAll<s64, ReadVarInt<s64>>(state, S64Constants);
+});
+WASP_BENCHMARK("ReadVarIntSlow/s64_const", [](State& state) {
+  DecodeAll<s64, ReadVarIntSlow<s64>>(state, S64Constants);
+});
+
+}  // namespace
+}  // namespace wasp::bench
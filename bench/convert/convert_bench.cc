@@ -0,0 +1,150 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_format.h"
+
+#include "bench/bench.h"
+#include "bench/corpus.h"
+#include "wasp/base/errors_nop.h"
+#include "wasp/binary/read.h"
+#include "wasp/binary/read/read_ctx.h"
+#include "wasp/convert/to_binary.h"
+#include "wasp/convert/to_text.h"
+#include "wasp/text/desugar.h"
+#include "wasp/text/read.h"
+#include "wasp/text/read/read_ctx.h"
+#include "wasp/text/read/tokenizer.h"
+#include "wasp/text/resolve.h"
+
+namespace wasp::bench {
+namespace {
+
+using namespace ::wasp::convert;
+
+WASP_BENCHMARK("convert/ToBinary", [](State& state) {
+  state.PauseTiming();
+  const auto& corpus = GetCorpus();
+  static const auto modules = [&] {
+    ErrorsNop errors;
+    std::vector<text::Module> result;
+    for (const auto& input : corpus.inputs) {
+      text::Tokenizer tokenizer{input.text};
+      text::ReadCtx ctx{corpus.features, errors};
+      auto module = text::ReadSingleModule(tokenizer, ctx);
+      text::Resolve(*module, errors);
+      text::Desugar(*module);
+      result.push_back(std::move(*module));
+    }
+    return result;
+  }();
+  state.ResumeTiming();
+
+  ForEachInput(state, Format::Text, [&](size_t index) {
+    BinCtx ctx{corpus.features};
+    DoNotOptimize(ToBinary(ctx, modules[index]));
+  });
+});
+
+WASP_BENCHMARK("convert/ToText", [](State& state) {
+  state.PauseTiming();
+  const auto& corpus = GetCorpus();
+  static const auto modules = [&] {
+    ErrorsNop errors;
+    std::vector<binary::Module> result;
+    for (const auto& input : corpus.inputs) {
+      binary::ReadCtx ctx{corpus.features, errors};
+      result.push_back(*binary::ReadModule(input.binary, ctx));
+    }
+    return result;
+  }();
+  state.ResumeTiming();
+
+  ForEachInput(state, Format::Binary, [&](size_t index) {
+    TextCtx ctx;
+    DoNotOptimize(ToText(ctx, modules[index]));
+  });
+});
+
+// A module with `count` exported functions and `count` passive data segments,
+// so converting it is mostly storing names and data in the context.
+struct StringsModule {
+  explicit StringsModule(Index count);
+
+  std::vector<std::string> names;
+  std::vector<std::string> data;
+  binary::Module module;
+};
+
+StringsModule::StringsModule(Index count) {
+  using namespace ::wasp::binary;
+
+  for (Index i = 0; i < count; ++i) {
+    names.push_back(absl::StrFormat("function_%u", i));
+    data.push_back(absl::StrFormat("data\t%u\n", i));
+  }
+
+  module.types.push_back(DefinedType{FunctionType{}});
+  for (Index i = 0; i < count; ++i) {
+    module.functions.push_back(Function{0});
+    module.exports.push_back(Export{ExternalKind::Function, names[i], i});
+    module.codes.push_back(UnpackedCode{{}, {}});
+    module.codes.back()->body.instructions.push_back(Instruction{Opcode::End});
+    module.data_segments.push_back(DataSegment{SpanU8{
+        reinterpret_cast<const u8*>(data[i].data()), data[i].size()}});
+  }
+}
+
+// The items processed are the names and data segments.
+template <Index count>
+void ToTextStrings(State& state) {
+  state.PauseTiming();
+  static const StringsModule input{count};
+  state.ResumeTiming();
+
+  for (u64 i = 0; i < state.iterations(); ++i) {
+    TextCtx ctx;
+    DoNotOptimize(ToText(ctx, input.module));
+  }
+  state.SetItemsProcessed(state.iterations() * count * 2);
+}
+
+template <Index count>
+void ToBinaryStrings(State& state) {
+  state.PauseTiming();
+  static const StringsModule input{count};
+  static TextCtx text_ctx;
+  static const text::Module module = ToText(text_ctx, input.module);
+  Features features;
+  features.EnableAll();
+  state.ResumeTiming();
+
+  for (u64 i = 0; i < state.iterations(); ++i) {
+    BinCtx ctx{features};
+    DoNotOptimize(ToBinary(ctx, module));
+  }
+  state.SetItemsProcessed(state.iterations() * count * 2);
+}
+
+WASP_BENCHMARK("convert/ToText/Strings/10000", ToTextStrings<10000>);
+WASP_BENCHMARK("convert/ToText/Strings/100000", ToTextStrings<100000>);
+WASP_BENCHMARK("convert/ToBinary/Strings/10000", ToBinaryStrings<10000>);
+WASP_BENCHMARK("convert/ToBinary/Strings/100000", ToBinaryStrings<100000>);
+
+}  // namespace
+}  // namespace wasp::bench
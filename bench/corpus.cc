@@ -0,0 +1,231 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "bench/corpus.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <iterator>
+#include <utility>
+
+#include "absl/strings/str_format.h"
+
+#include "src/tools/generator.h"
+#include "wasp/base/errors_buffer.h"
+#include "wasp/base/file.h"
+#include "wasp/binary/read.h"
+#include "wasp/binary/read/read_ctx.h"
+#include "wasp/binary/write.h"
+#include "wasp/convert/to_binary.h"
+#include "wasp/convert/to_text.h"
+#include "wasp/text/desugar.h"
+#include "wasp/text/read.h"
+#include "wasp/text/read/read_ctx.h"
+#include "wasp/text/read/tokenizer.h"
+#include "wasp/text/resolve.h"
+#include "wasp/text/formatters.h"
+#include "wasp/text/write.h"
+#include "wasp/valid/valid_ctx.h"
+#include "wasp/valid/validate.h"
+
+namespace wasp::bench {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+CorpusOptions s_options;
+bool s_has_corpus = false;
+
+// Returns the binary form of a text module that has already been resolved.
+optional<Buffer> TextToBinary(text::Module& module, const Features& features) {
+  text::Desugar(module);
+  convert::BinCtx ctx{features};
+  auto binary_module = convert::ToBinary(ctx, module);
+  Buffer buffer;
+  binary::WriteModule(*binary_module, buffer);
+  return buffer;
+}
+
+optional<text::Module> ReadTextModule(SpanU8 data,
+                                      const Features& features,
+                                      Errors& errors) {
+  text::Tokenizer tokenizer{data};
+  text::ReadCtx ctx{features, errors};
+  auto module = text::ReadSingleModule(tokenizer, ctx);
+  if (!module || errors.HasError()) {
+    return nullopt;
+  }
+  text::Expect(tokenizer, ctx, text::TokenType::Eof);
+  text::Resolve(*module, errors);
+  if (errors.HasError()) {
+    return nullopt;
+  }
+  return module;
+}
+
+// Adds the binary module `data` to the corpus, if it is valid and survives a
+// round trip through the text format.
+void AddModule(Corpus& corpus, std::string name, Buffer data) {
+  ErrorsBuffer errors;
+  Input input{std::move(name), std::move(data), {}, 0};
+
+  binary::ReadCtx read_ctx{corpus.features, errors};
+  auto module = binary::ReadModule(input.binary, read_ctx);
+  valid::ValidCtx valid_ctx{corpus.features, errors};
+  if (!module || errors.HasError() || !valid::Validate(valid_ctx, *module)) {
+    corpus.skipped++;
+    return;
+  }
+
+  for (const auto& code : module->codes) {
+    input.instruction_count += code->body.instructions.size();
+  }
+
+  convert::TextCtx text_ctx;
+  auto text_module = convert::ToText(text_ctx, *module);
+  text::WriteCtx write_ctx;
+  text::Write(write_ctx, *text_module, std::back_inserter(input.text));
+
+  auto reread = ReadTextModule(input.text, corpus.features, errors);
+  if (!reread || !TextToBinary(*reread, corpus.features) || errors.HasError()) {
+    corpus.skipped++;
+    return;
+  }
+
+  corpus.binary_size += input.binary.size();
+  corpus.text_size += input.text.size();
+  corpus.instruction_count += input.instruction_count;
+  corpus.inputs.push_back(std::move(input));
+}
+
+void AddTextModule(Corpus& corpus, std::string name, SpanU8 data) {
+  ErrorsBuffer errors;
+  auto module = ReadTextModule(data, corpus.features, errors);
+  if (!module) {
+    corpus.skipped++;
+    return;
+  }
+  AddModule(corpus, std::move(name), *TextToBinary(*module, corpus.features));
+}
+
+// Adds the top-level modules of a .wast script. Modules in assertions are
+// usually invalid, so they are ignored.
+void AddScript(Corpus& corpus, const std::string& name, SpanU8 data) {
+  ErrorsBuffer errors;
+  text::Tokenizer tokenizer{data};
+  text::ReadCtx ctx{corpus.features, errors};
+  auto script = text::ReadScript(tokenizer, ctx);
+  if (!script || errors.HasError()) {
+    corpus.skipped++;
+    return;
+  }
+  text::Resolve(*script, errors);
+  if (errors.HasError()) {
+    corpus.skipped++;
+    return;
+  }
+
+  int count = 0;
+  for (auto& command : *script) {
+    if (!command->is_script_module()) {
+      continue;
+    }
+    auto& script_module = command->script_module();
+    std::string module_name = absl::StrFormat("%s:%d", name, count++);
+    if (script_module.has_module()) {
+      AddModule(corpus, module_name,
+                *TextToBinary(script_module.module(), corpus.features));
+    } else if (script_module.kind == text::ScriptModuleKind::Binary) {
+      Buffer buffer;
+      text::AppendToBuffer(script_module.text_list(), buffer);
+      AddModule(corpus, module_name, std::move(buffer));
+    }
+  }
+}
+
+void AddFile(Corpus& corpus, const fs::path& path) {
+  auto ext = path.extension();
+  if (ext != ".wasm" && ext != ".wat" && ext != ".wast") {
+    return;
+  }
+  auto data = ReadFile(path.string());
+  if (!data) {
+    absl::FPrintF(stderr, "Unable to read %s\n", path.string());
+    return;
+  }
+  if (ext == ".wasm") {
+    AddModule(corpus, path.string(), std::move(*data));
+    return;
+  } else if (ext == ".wat") {
+    AddTextModule(corpus, path.string(), *data);
+  } else {
+    AddScript(corpus, path.string(), *data);
+  }
+  corpus.source_size += data->size();
+  corpus.sources.push_back(Source{path.string(), std::move(*data)});
+}
+
+void AddPath(Corpus& corpus, const std::string& path) {
+  if (!fs::is_directory(path)) {
+    AddFile(corpus, path);
+    return;
+  }
+
+  // Sort the files, so the corpus is the same on every run.
+  std::vector<fs::path> files;
+  for (auto& entry : fs::recursive_directory_iterator(path)) {
+    if (entry.is_regular_file()) {
+      files.push_back(entry.path());
+    }
+  }
+  std::sort(files.begin(), files.end());
+  for (auto& file : files) {
+    AddFile(corpus, file);
+  }
+}
+
+}  // namespace
+
+void SetCorpusOptions(CorpusOptions options) {
+  s_options = std::move(options);
+}
+
+const Corpus& GetCorpus() {
+  static const Corpus corpus = [] {
+    Corpus corpus;
+    corpus.features.EnableAll();
+    for (const auto& path : s_options.paths) {
+      AddPath(corpus, path);
+    }
+    if (s_options.synthetic_functions > 0) {
+      tools::GeneratorOptions options;
+      options.functions = s_options.synthetic_functions;
+      AddModule(corpus,
+                absl::StrFormat("synthetic:%u", s_options.synthetic_functions),
+                tools::GenerateModule(options));
+    }
+    s_has_corpus = true;
+    return corpus;
+  }();
+  return corpus;
+}
+
+bool HasCorpus() {
+  return s_has_corpus;
+}
+
+}  // namespace wasp::bench
@@ -0,0 +1,107 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BENCH_CORPUS_H_
+#define WASP_BENCH_CORPUS_H_
+
+#include <string>
+#include <vector>
+
+#include "bench/bench.h"
+#include "wasp/base/buffer.h"
+#include "wasp/base/features.h"
+#include "wasp/base/string_view.h"
+#include "wasp/base/types.h"
+
+namespace wasp::bench {
+
+// A module in both of its formats. The text is written by wasp from the
+// binary module, so both describe exactly the same module.
+struct Input {
+  std::string name;
+  Buffer binary;
+  Buffer text;
+  u64 instruction_count;
+};
+
+// A .wat or .wast file as it was read, including its comments, formatting
+// and any modules that weren't added to the corpus.
+struct Source {
+  std::string name;
+  Buffer text;
+};
+
+struct Corpus {
+  Features features;
+  std::vector<Input> inputs;
+  std::vector<Source> sources;
+  u64 binary_size = 0;
+  u64 text_size = 0;
+  u64 source_size = 0;
+  u64 instruction_count = 0;
+  u64 skipped = 0;  // Modules that failed to read, validate or round-trip.
+};
+
+struct CorpusOptions {
+  // Directories are searched recursively for .wasm, .wat and .wast files.
+  // Only the top-level modules of a .wast file are used.
+  std::vector<std::string> paths;
+
+  // The number of functions in the module generated with
+  // tools::GenerateModule, or 0 for none.
+  Index synthetic_functions = 1000;
+};
+
+// Sets the options used to build the corpus, which must be called before the
+// first call to GetCorpus.
+void SetCorpusOptions(CorpusOptions);
+
+// Returns the corpus, building it on the first call. Every input has been
+// read, validated and round-tripped through the text format without errors,
+// so the benchmarks don't need to handle failures.
+const Corpus& GetCorpus();
+
+// As above, but excludes the time taken to build the corpus from `state`.
+inline const Corpus& GetCorpus(State& state) {
+  state.PauseTiming();
+  const Corpus& corpus = GetCorpus();
+  state.ResumeTiming();
+  return corpus;
+}
+
+// Returns true if the corpus has been built.
+bool HasCorpus();
+
+enum class Format { Binary, Text };
+
+// Calls `f` with the index of each input, `state.iterations()` times, and
+// reports the throughput in bytes of `format` and in instructions.
+template <typename F>
+void ForEachInput(State& state, Format format, F&& f) {
+  const Corpus& corpus = GetCorpus(state);
+  for (u64 i = 0; i < state.iterations(); ++i) {
+    for (size_t index = 0; index < corpus.inputs.size(); ++index) {
+      f(index);
+    }
+  }
+  u64 size = format == Format::Binary ? corpus.binary_size : corpus.text_size;
+  state.SetBytesProcessed(state.iterations() * size);
+  state.SetItemsProcessed(state.iterations() * corpus.instruction_count);
+}
+
+}  // namespace wasp::bench
+
+#endif  // WASP_BENCH_CORPUS_H_
@@ -0,0 +1,182 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_format.h"
+
+#include "bench/bench.h"
+#include "bench/corpus.h"
+#include "src/tools/argparser.h"
+#include "wasp/base/span.h"
+#include "wasp/base/str_to_u32.h"
+#include "wasp/base/string_view.h"
+
+using namespace ::wasp;
+using namespace ::wasp::bench;
+
+namespace {
+
+// Whether decoded values store their locations; see the WASP_LOCATIONS CMake
+// option. Included in the JSON results, since it's the main thing to compare
+// between builds.
+#if WASP_NO_LOCATIONS
+constexpr bool kLocations = false;
+#else
+constexpr bool kLocations = true;
+#endif
+
+// Benchmark names are plain ASCII, but quote them properly anyway.
+std::string JsonString(string_view str) {
+  std::string result = "\"";
+  for (char c : str) {
+    if (c == '"' || c == '\\') {
+      result += '\\';
+      result += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      result += absl::StrFormat("\\u%04x", c);
+    } else {
+      result += c;
+    }
+  }
+  return result + "\"";
+}
+
+void PrintTableHeader() {
+  absl::PrintF("%-40s %12s %12s %14s %14s %14s\n", "benchmark", "iterations",
+               "ns/iter", "MiB/s", "items/s", "allocs/iter");
+}
+
+void PrintTableRow(const Result& result) {
+  double ns = result.seconds * 1e9 / result.iterations;
+  absl::PrintF("%-40s %12u %12.1f", result.name, result.iterations, ns);
+  if (result.bytes_processed) {
+    absl::PrintF(" %14.2f",
+                 result.bytes_processed / result.seconds / (1024 * 1024));
+  } else {
+    absl::PrintF(" %14s", "-");
+  }
+  if (result.items_processed) {
+    absl::PrintF(" %14.4g", result.items_processed / result.seconds);
+  } else {
+    absl::PrintF(" %14s", "-");
+  }
+  absl::PrintF(" %14.1f\n",
+               static_cast<double>(result.allocations) / result.iterations);
+}
+
+// Writes a single JSON object, so results can be compared between runs.
+void PrintJson(const std::vector<Result>& results) {
+  absl::PrintF("{\n");
+  absl::PrintF("  \"locations\": %s,\n", kLocations ? "true" : "false");
+  if (HasCorpus()) {
+    const auto& corpus = GetCorpus();
+    absl::PrintF(
+        "  \"corpus\": {\"inputs\": %u, \"skipped\": %u, \"binary_bytes\": %u, "
+        "\"text_bytes\": %u, \"source_bytes\": %u, \"instructions\": %u},\n",
+        corpus.inputs.size(), corpus.skipped, corpus.binary_size,
+        corpus.text_size, corpus.source_size, corpus.instruction_count);
+  }
+  absl::PrintF("  \"benchmarks\": [");
+  const char* separator = "\n";
+  for (const auto& result : results) {
+    absl::PrintF(
+        "%s    {\"name\": %s, \"iterations\": %u, \"seconds\": %.9g, "
+        "\"ns_per_iteration\": %.9g, \"bytes_per_second\": %.9g, "
+        "\"items_per_second\": %.9g, \"allocations_per_iteration\": %.9g}",
+        separator, JsonString(result.name), result.iterations, result.seconds,
+        result.seconds * 1e9 / result.iterations,
+        result.bytes_processed / result.seconds,
+        result.items_processed / result.seconds,
+        static_cast<double>(result.allocations) / result.iterations);
+    separator = ",\n";
+  }
+  absl::PrintF("\n  ]\n}\n");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::vector<string_view> args(argv + 1, argv + argc);
+
+  std::vector<std::string> filters;
+  double min_seconds = 0.5;
+  bool json = false;
+  CorpusOptions corpus_options;
+
+  tools::ArgParser parser{"wasp_bench"};
+  parser
+      .Add('h', "--help", "print help and exit",
+           [&]() { parser.PrintHelpAndExit(0); })
+      .Add("--min-time", "<seconds>",
+           "run each benchmark for at least <seconds>",
+           [&](string_view arg) {
+             min_seconds = std::strtod(std::string{arg}.c_str(), nullptr);
+           })
+      .Add("--corpus", "<path>",
+           "add the modules in <path>, a .wasm, .wat or .wast file or a "
+           "directory of them",
+           [&](string_view arg) { corpus_options.paths.emplace_back(arg); })
+      .Add("--synthetic", "<count>",
+           "add a synthetic module with <count> functions (default: 1000)",
+           [&](string_view arg) {
+             auto count = StrToU32(arg);
+             if (!count) {
+               absl::FPrintF(stderr, "Invalid function count: %s\n", arg);
+               std::exit(1);
+             }
+             corpus_options.synthetic_functions = *count;
+           })
+      .Add("--json", "print the results as JSON", [&]() { json = true; })
+      .Add("<filters...>",
+           "only run benchmarks whose name contains one of <filters>",
+           [&](string_view arg) { filters.emplace_back(arg); });
+  parser.Parse(args);
+
+#ifdef WASP_BENCH_TESTSUITE_DIR
+  if (corpus_options.paths.empty() &&
+      std::filesystem::is_directory(WASP_BENCH_TESTSUITE_DIR)) {
+    corpus_options.paths.push_back(WASP_BENCH_TESTSUITE_DIR);
+  }
+#endif
+  SetCorpusOptions(corpus_options);
+
+  if (!json) {
+    PrintTableHeader();
+  }
+  std::vector<Result> results;
+  for (const auto& benchmark : Benchmarks()) {
+    if (!filters.empty() &&
+        std::none_of(filters.begin(), filters.end(), [&](const auto& filter) {
+          return benchmark.name.find(filter) != std::string::npos;
+        })) {
+      continue;
+    }
+
+    results.push_back(Run(benchmark, min_seconds));
+    if (!json) {
+      PrintTableRow(results.back());
+    }
+  }
+  if (json) {
+    PrintJson(results);
+  }
+  return 0;
+}
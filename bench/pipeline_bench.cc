@@ -0,0 +1,82 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <iterator>
+
+#include "bench/bench.h"
+#include "bench/corpus.h"
+#include "wasp/base/errors_nop.h"
+#include "wasp/binary/read.h"
+#include "wasp/binary/read/read_ctx.h"
+#include "wasp/binary/write.h"
+#include "wasp/convert/to_binary.h"
+#include "wasp/convert/to_text.h"
+#include "wasp/text/desugar.h"
+#include "wasp/text/read.h"
+#include "wasp/text/read/read_ctx.h"
+#include "wasp/text/read/tokenizer.h"
+#include "wasp/text/resolve.h"
+#include "wasp/text/formatters.h"
+#include "wasp/text/write.h"
+#include "wasp/valid/valid_ctx.h"
+#include "wasp/valid/validate.h"
+
+namespace wasp::bench {
+namespace {
+
+// The same steps as `wasp wat2wasm`, without the file I/O.
+WASP_BENCHMARK("pipeline/wat2wasm", [](State& state) {
+  const auto& corpus = GetCorpus(state);
+  ErrorsNop errors;
+  Buffer buffer;
+  ForEachInput(state, Format::Text, [&](size_t index) {
+    text::Tokenizer tokenizer{corpus.inputs[index].text};
+    text::ReadCtx read_ctx{corpus.features, errors};
+    auto text_module = text::ReadSingleModule(tokenizer, read_ctx);
+    text::Resolve(*text_module, errors);
+    text::Desugar(*text_module);
+    convert::BinCtx convert_ctx{corpus.features};
+    auto binary_module = convert::ToBinary(convert_ctx, *text_module);
+    valid::ValidCtx valid_ctx{corpus.features, errors};
+    valid::Validate(valid_ctx, *binary_module);
+    buffer.clear();
+    binary::WriteModule(*binary_module, buffer);
+    DoNotOptimize(buffer.data());
+  });
+});
+
+// The same steps as `wasp wasm2wat`, without the file I/O.
+WASP_BENCHMARK("pipeline/wasm2wat", [](State& state) {
+  const auto& corpus = GetCorpus(state);
+  ErrorsNop errors;
+  Buffer buffer;
+  ForEachInput(state, Format::Binary, [&](size_t index) {
+    binary::ReadCtx read_ctx{corpus.features, errors};
+    auto binary_module =
+        binary::ReadModule(corpus.inputs[index].binary, read_ctx);
+    valid::ValidCtx valid_ctx{corpus.features, errors};
+    valid::Validate(valid_ctx, *binary_module);
+    convert::TextCtx convert_ctx;
+    auto text_module = convert::ToText(convert_ctx, *binary_module);
+    text::WriteCtx write_ctx;
+    buffer.clear();
+    text::Write(write_ctx, text_module, std::back_inserter(buffer));
+    DoNotOptimize(buffer.data());
+  });
+});
+
+}  // namespace
+}  // namespace wasp::bench
@@ -0,0 +1,135 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <iterator>
+#include <vector>
+
+#include "bench/bench.h"
+#include "bench/corpus.h"
+#include "wasp/base/errors_nop.h"
+#include "wasp/base/output_sink.h"
+#include "wasp/text/desugar.h"
+#include "wasp/text/formatters.h"
+#include "wasp/text/read.h"
+#include "wasp/text/read/lex.h"
+#include "wasp/text/read/read_ctx.h"
+#include "wasp/text/read/tokenizer.h"
+#include "wasp/text/resolve.h"
+#include "wasp/text/write.h"
+
+namespace wasp::bench {
+namespace {
+
+using namespace ::wasp::text;
+
+WASP_BENCHMARK("text/Tokenizer", [](State& state) {
+  const auto& corpus = GetCorpus(state);
+  ForEachInput(state, Format::Text, [&](size_t index) {
+    Tokenizer tokenizer{corpus.inputs[index].text};
+    while (tokenizer.Read().type != TokenType::Eof) {
+    }
+  });
+});
+
+// Lexes the .wat and .wast files of the corpus as they were read, with the
+// comments, indentation and long data strings that the text written by wasp
+// doesn't have. The items are tokens, not instructions.
+WASP_BENCHMARK("text/Lex/Sources", [](State& state) {
+  const auto& corpus = GetCorpus(state);
+  u64 token_count = 0;
+  for (u64 i = 0; i < state.iterations(); ++i) {
+    for (const auto& source : corpus.sources) {
+      SpanU8 data = source.text;
+      while (Lex(&data).type != TokenType::Eof) {
+        ++token_count;
+      }
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * corpus.source_size);
+  state.SetItemsProcessed(token_count);
+});
+
+WASP_BENCHMARK("text/ReadModule", [](State& state) {
+  const auto& corpus = GetCorpus(state);
+  ErrorsNop errors;
+  ForEachInput(state, Format::Text, [&](size_t index) {
+    Tokenizer tokenizer{corpus.inputs[index].text};
+    ReadCtx ctx{corpus.features, errors};
+    DoNotOptimize(ReadSingleModule(tokenizer, ctx));
+  });
+});
+
+// Returns the text modules of the corpus, read once and shared by every
+// benchmark.
+const std::vector<Module>& ReadModules(State& state) {
+  state.PauseTiming();
+  const auto& corpus = GetCorpus();
+  static const auto modules = [&] {
+    ErrorsNop errors;
+    std::vector<Module> result;
+    for (const auto& input : corpus.inputs) {
+      Tokenizer tokenizer{input.text};
+      ReadCtx ctx{corpus.features, errors};
+      result.push_back(*ReadSingleModule(tokenizer, ctx));
+    }
+    return result;
+  }();
+  state.ResumeTiming();
+  return modules;
+}
+
+WASP_BENCHMARK("text/Resolve+Desugar", [](State& state) {
+  const auto& modules = ReadModules(state);
+  ErrorsNop errors;
+
+  ForEachInput(state, Format::Text, [&](size_t index) {
+    // Both passes modify the module, so each run needs a fresh copy.
+    state.PauseTiming();
+    Module module = modules[index];
+    state.ResumeTiming();
+    Resolve(module, errors);
+    Desugar(module);
+    DoNotOptimize(module);
+  });
+});
+
+WASP_BENCHMARK("text/Write", [](State& state) {
+  const auto& modules = ReadModules(state);
+
+  Buffer buffer;
+  ForEachInput(state, Format::Text, [&](size_t index) {
+    buffer.clear();
+    WriteCtx ctx;
+    Write(ctx, modules[index], std::back_inserter(buffer));
+    DoNotOptimize(buffer.data());
+  });
+});
+
+// As above, but writes to an OutputSink, which copies each token's text in
+// bulk instead of one byte at a time.
+WASP_BENCHMARK("text/Write/OutputSink", [](State& state) {
+  const auto& modules = ReadModules(state);
+
+  ForEachInput(state, Format::Text, [&](size_t index) {
+    OutputSink sink;
+    WriteCtx ctx;
+    Write(ctx, modules[index], sink.out());
+    DoNotOptimize(sink.size());
+  });
+});
+
+}  // namespace
+}  // namespace wasp::bench
@@ -0,0 +1,163 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_format.h"
+
+#include "bench/bench.h"
+#include "wasp/base/errors_nop.h"
+#include "wasp/base/span.h"
+#include "wasp/text/read.h"
+#include "wasp/text/read/name_map.h"
+#include "wasp/text/read/read_ctx.h"
+#include "wasp/text/read/tokenizer.h"
+#include "wasp/text/resolve.h"
+
+namespace wasp::bench {
+namespace {
+
+using namespace ::wasp::text;
+
+constexpr Index kNameCount = 100000;
+
+const std::vector<std::string>& Names() {
+  static const auto names = [] {
+    std::vector<std::string> result;
+    for (Index i = 0; i < kNameCount; ++i) {
+      result.push_back(absl::StrFormat("$name%u", i));
+    }
+    return result;
+  }();
+  return names;
+}
+
+// Binds every name, then looks each one up, as for the functions of a module.
+WASP_BENCHMARK("text/NameMap/Bind+Get", [](State& state) {
+  const auto& names = Names();
+  NameMap map;
+  for (u64 i = 0; i < state.iterations(); ++i) {
+    map.Reset();
+    for (const auto& name : names) {
+      map.NewBound(name);
+    }
+    for (const auto& name : names) {
+      DoNotOptimize(map.Get(name));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * names.size() * 2);
+});
+
+// Binds and looks up nested labels, as in a function body with many blocks.
+WASP_BENCHMARK("text/NameMap/Labels", [](State& state) {
+  const auto& names = Names();
+  constexpr Index kDepth = 8;
+  NameMap map;
+  for (u64 i = 0; i < state.iterations(); ++i) {
+    map.Reset();
+    for (Index block = 0; block + kDepth <= names.size(); block += kDepth) {
+      for (Index depth = 0; depth < kDepth; ++depth) {
+        map.Push();
+        map.NewBound(names[block + depth]);
+      }
+      for (Index depth = 0; depth < kDepth; ++depth) {
+        DoNotOptimize(map.Get(names[block + depth]));
+        map.Pop();
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * names.size() * 2);
+});
+
+// Resolves a module with many named functions, each calling another by name.
+WASP_BENCHMARK("text/Resolve/named_functions", [](State& state) {
+  constexpr Index kFunctionCount = 20000;
+  state.PauseTiming();
+  static const std::string text = [] {
+    std::string result;
+    for (Index i = 0; i < kFunctionCount; ++i) {
+      result += absl::StrFormat("(func $f%u (call $f%u))\n", i,
+                                (i * 7919) % kFunctionCount);
+    }
+    return result;
+  }();
+  static const Module module = [] {
+    ErrorsNop errors;
+    Tokenizer tokenizer{SpanU8{reinterpret_cast<const u8*>(text.data()),
+                               text.size()}};
+    ReadCtx ctx{errors};
+    return *ReadModule(tokenizer, ctx);
+  }();
+  state.ResumeTiming();
+
+  ErrorsNop errors;
+  for (u64 i = 0; i < state.iterations(); ++i) {
+    state.PauseTiming();
+    Module copy = module;
+    state.ResumeTiming();
+    Resolve(copy, errors);
+    DoNotOptimize(copy);
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+  state.SetItemsProcessed(state.iterations() * kFunctionCount);
+});
+
+// Resolves a module with many functions, each with a different implicit
+// function type, and each calling indirectly with another function's type.
+WASP_BENCHMARK("text/Resolve/function_types", [](State& state) {
+  constexpr Index kParamCount = 12;
+  constexpr Index kFunctionCount = 1 << kParamCount;
+  state.PauseTiming();
+  static const std::string text = [] {
+    auto params = [](Index bits) {
+      std::string result = "(param";
+      for (Index i = 0; i < kParamCount; ++i) {
+        result += (bits & (1 << i)) ? " i64" : " i32";
+      }
+      return result + ")";
+    };
+    std::string result = "(table 1 funcref)\n";
+    for (Index i = 0; i < kFunctionCount; ++i) {
+      result += absl::StrFormat(
+          "(func %s (call_indirect %s (i32.const 0)))\n", params(i),
+          params((i * 7919) % kFunctionCount));
+    }
+    return result;
+  }();
+  static const Module module = [] {
+    ErrorsNop errors;
+    Tokenizer tokenizer{SpanU8{reinterpret_cast<const u8*>(text.data()),
+                               text.size()}};
+    ReadCtx ctx{errors};
+    return *ReadModule(tokenizer, ctx);
+  }();
+  state.ResumeTiming();
+
+  ErrorsNop errors;
+  for (u64 i = 0; i < state.iterations(); ++i) {
+    state.PauseTiming();
+    Module copy = module;
+    state.ResumeTiming();
+    Resolve(copy, errors);
+    DoNotOptimize(copy);
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+  state.SetItemsProcessed(state.iterations() * kFunctionCount);
+});
+
+}  // namespace
+}  // namespace wasp::bench
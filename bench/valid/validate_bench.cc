@@ -0,0 +1,110 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_format.h"
+
+#include "bench/bench.h"
+#include "bench/corpus.h"
+#include "wasp/base/buffer.h"
+#include "wasp/base/errors_nop.h"
+#include "wasp/base/features.h"
+#include "wasp/binary/lazy_module.h"
+#include "wasp/binary/types.h"
+#include "wasp/binary/visitor.h"
+#include "wasp/binary/write.h"
+#include "wasp/valid/validate_visitor.h"
+
+namespace wasp::bench {
+namespace {
+
+WASP_BENCHMARK("valid/ValidateVisitor", [](State& state) {
+  const auto& corpus = GetCorpus(state);
+  ErrorsNop errors;
+  ForEachInput(state, Format::Binary, [&](size_t index) {
+    auto module = binary::ReadLazyModule(corpus.inputs[index].binary,
+                                         corpus.features, errors);
+    valid::ValidateVisitor visitor{corpus.features, errors};
+    DoNotOptimize(binary::visit::Visit(module, visitor));
+  });
+});
+
+// Returns a module with `count` functions, each of which is exported. If
+// `ref_funcs` is true, the first function also uses ref.func on every
+// function.
+Buffer MakeExportsModule(Index count, bool ref_funcs) {
+  using namespace ::wasp::binary;
+
+  std::vector<std::string> names;
+  names.reserve(count);
+  for (Index i = 0; i < count; ++i) {
+    names.push_back(absl::StrFormat("f%u", i));
+  }
+
+  Module module;
+  module.types.push_back(DefinedType{FunctionType{}});
+  for (Index i = 0; i < count; ++i) {
+    module.functions.push_back(Function{0});
+    module.exports.push_back(Export{ExternalKind::Function, names[i], i});
+    module.codes.push_back(UnpackedCode{{}, {}});
+  }
+  auto& instructions = module.codes[0]->body.instructions;
+  if (ref_funcs) {
+    for (Index i = 0; i < count; ++i) {
+      instructions.push_back(Instruction{Opcode::RefFunc, Index{i}});
+      instructions.push_back(Instruction{Opcode::Drop});
+    }
+  }
+  instructions.push_back(Instruction{Opcode::End});
+
+  Buffer buffer;
+  Write(module, std::back_inserter(buffer));
+  return buffer;
+}
+
+// Validates a module made by MakeExportsModule. The items processed are the
+// exported functions, so the items per second should stay the same as
+// `count` grows.
+template <Index count, bool ref_funcs>
+void ValidateExports(State& state) {
+  state.PauseTiming();
+  static const Buffer buffer = MakeExportsModule(count, ref_funcs);
+  Features features;
+  features.EnableAll();
+  state.ResumeTiming();
+
+  ErrorsNop errors;
+  for (u64 i = 0; i < state.iterations(); ++i) {
+    auto module = binary::ReadLazyModule(buffer, features, errors);
+    valid::ValidateVisitor visitor{features, errors};
+    DoNotOptimize(binary::visit::Visit(module, visitor));
+  }
+  state.SetBytesProcessed(state.iterations() * buffer.size());
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+WASP_BENCHMARK("valid/Exports/10000", ValidateExports<10000, false>);
+WASP_BENCHMARK("valid/Exports/100000", ValidateExports<100000, false>);
+WASP_BENCHMARK("valid/Exports/1000000", ValidateExports<1000000, false>);
+WASP_BENCHMARK("valid/RefFunc/10000", ValidateExports<10000, true>);
+WASP_BENCHMARK("valid/RefFunc/100000", ValidateExports<100000, true>);
+WASP_BENCHMARK("valid/RefFunc/1000000", ValidateExports<1000000, true>);
+
+}  // namespace
+}  // namespace wasp::bench
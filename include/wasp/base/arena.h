@@ -0,0 +1,61 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BASE_ARENA_H_
+#define WASP_BASE_ARENA_H_
+
+#include <memory>
+#include <vector>
+
+#include "wasp/base/span.h"
+#include "wasp/base/string_view.h"
+#include "wasp/base/types.h"
+
+namespace wasp {
+
+// Stores strings and byte buffers in large blocks, instead of making a
+// separate allocation for each one. The contents never move, so the returned
+// string_views and spans are valid until the Arena is destroyed.
+class Arena {
+ public:
+  static constexpr size_t kDefaultBlockSize = 64 * 1024;
+
+  explicit Arena(size_t block_size = kDefaultBlockSize);
+  Arena(const Arena&) = delete;
+  Arena(Arena&&);
+  Arena& operator=(const Arena&) = delete;
+  Arena& operator=(Arena&&);
+
+  // Returns `size` bytes of uninitialized storage.
+  u8* Allocate(size_t size);
+
+  string_view Add(string_view);
+  SpanU8 Add(SpanU8);
+
+  size_t allocated_bytes() const { return allocated_bytes_; }
+  size_t block_count() const { return blocks_.size(); }
+
+ private:
+  std::vector<std::unique_ptr<u8[]>> blocks_;
+  size_t block_size_;
+  u8* next_ = nullptr;
+  size_t remaining_ = 0;
+  size_t allocated_bytes_ = 0;
+};
+
+}  // namespace wasp
+
+#endif  // WASP_BASE_ARENA_H_
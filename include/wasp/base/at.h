@@ -19,12 +19,23 @@
 
 #include <functional>
 #include <utility>
+#include <type_traits>
 
 #include "wasp/base/optional.h"
 #include "wasp/base/span.h"
 
 namespace wasp {
 
+// At<T> pairs a value with the Location it was read from, so errors can be
+// reported at that location.
+//
+// When WASP_NO_LOCATIONS is defined (see the WASP_LOCATIONS CMake option),
+// At<T> stores only the value, and `loc()` is always empty. Every decoded
+// immediate, index and type is then smaller, which is useful when only a
+// yes/no answer or statistics are needed; errors are still reported, but
+// without a location.
+#if !WASP_NO_LOCATIONS
+
 template <typename T>
 struct At : std::pair<Location, T> {
   using value_type = T;
@@ -52,6 +63,48 @@ struct At : std::pair<Location, T> {
   T& operator*() { return this->second; }
 };
 
+#else
+
+template <typename T>
+struct At {
+  using value_type = T;
+
+  template <typename U = T,
+            typename = std::enable_if_t<std::is_default_constructible_v<U>>>
+  At() : value_{} {}
+  At(T v) : value_{std::move(v)} {}
+  explicit At(Location loc, T v) : value_{std::move(v)} {}
+
+  At& operator=(T v) {
+    value_ = v;
+    return *this;
+  }
+
+  operator const T&() const { return value_; }
+
+  Location loc() const { return Location{}; }
+
+  const T& value() const { return value_; }
+  T& value() { return value_; }
+
+  const T* operator->() const { return &value_; }
+  T* operator->() { return &value_; }
+  const T& operator*() const { return value_; }
+  T& operator*() { return value_; }
+
+ private:
+  T value_;
+};
+
+template <typename T>
+bool operator==(const At<T>& lhs, const At<T>& rhs) { return *lhs == *rhs; }
+template <typename T>
+bool operator!=(const At<T>& lhs, const At<T>& rhs) { return *lhs != *rhs; }
+template <typename T>
+bool operator<(const At<T>& lhs, const At<T>& rhs) { return *lhs < *rhs; }
+
+#endif  // !WASP_NO_LOCATIONS
+
 // Deduction guides.
 template <typename T>
 At(T v) -> At<T>;
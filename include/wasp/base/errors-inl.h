@@ -17,6 +17,9 @@
 namespace wasp {
 
 inline void Errors::PushContext(Location loc, string_view desc) {
+  if (guard_) {
+    PushGuardContexts(guard_);
+  }
   HandlePushContext(loc, desc);
 }
 
@@ -25,6 +28,9 @@ inline void Errors::PopContext() {
 }
 
 inline void Errors::OnError(Location loc, string_view message) {
+  if (guard_) {
+    PushGuardContexts(guard_);
+  }
   HandleOnError(loc, message);
 }
 
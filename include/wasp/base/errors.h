@@ -22,9 +22,17 @@
 
 namespace wasp {
 
+class ErrorsContextGuard;
+
 class Errors {
  public:
+  Errors() = default;
+  // Guards belong to the object they were created with, so they aren't
+  // copied.
+  Errors(const Errors&) {}
+  Errors& operator=(const Errors&) { return *this; }
   virtual ~Errors() {}
+
   void PushContext(Location loc, string_view desc);
   void PopContext();
   void OnError(Location loc, string_view message);
@@ -35,6 +43,18 @@ class Errors {
   virtual void HandlePushContext(Location loc, string_view desc) = 0;
   virtual void HandlePopContext() = 0;
   virtual void HandleOnError(Location loc, string_view message) = 0;
+
+ private:
+  friend class ErrorsContextGuard;
+
+  // Pushes the contexts of the active guards that haven't been pushed yet,
+  // outermost first.
+  void PushGuardContexts(ErrorsContextGuard*);
+
+  // The innermost active ErrorsContextGuard. A guard's context is only
+  // pushed once something else is pushed or an error is reported, so
+  // contexts cost nothing when there are no errors.
+  ErrorsContextGuard* guard_ = nullptr;
 };
 
 }  // namespace wasp
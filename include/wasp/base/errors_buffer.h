@@ -0,0 +1,84 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BASE_ERRORS_BUFFER_H_
+#define WASP_BASE_ERRORS_BUFFER_H_
+
+#include <string>
+#include <vector>
+
+#include "wasp/base/errors.h"
+
+namespace wasp {
+
+// Records all calls to the Errors interface, so they can be replayed later to
+// another Errors object. This is useful when errors are produced on another
+// thread, but must be reported in a deterministic order.
+class ErrorsBuffer : public Errors {
+ public:
+  bool HasError() const override { return has_error_; }
+
+  void ReplayTo(Errors& errors) const {
+    for (const auto& event : events_) {
+      switch (event.kind) {
+        case Event::PushContext:
+          errors.PushContext(event.loc, event.message);
+          break;
+
+        case Event::PopContext:
+          errors.PopContext();
+          break;
+
+        case Event::OnError:
+          errors.OnError(event.loc, event.message);
+          break;
+      }
+    }
+  }
+
+  void Clear() {
+    events_.clear();
+    has_error_ = false;
+  }
+
+ protected:
+  void HandlePushContext(Location loc, string_view desc) override {
+    events_.push_back(Event{Event::PushContext, loc, std::string{desc}});
+  }
+
+  void HandlePopContext() override {
+    events_.push_back(Event{Event::PopContext, {}, {}});
+  }
+
+  void HandleOnError(Location loc, string_view message) override {
+    events_.push_back(Event{Event::OnError, loc, std::string{message}});
+    has_error_ = true;
+  }
+
+ private:
+  struct Event {
+    enum Kind { PushContext, PopContext, OnError } kind;
+    Location loc;
+    std::string message;
+  };
+
+  std::vector<Event> events_;
+  bool has_error_ = false;
+};
+
+}  // namespace wasp
+
+#endif  // WASP_BASE_ERRORS_BUFFER_H_
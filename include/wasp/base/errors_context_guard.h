@@ -17,30 +17,47 @@
 #ifndef WASP_BASE_ERRORS_CONTEXT_GUARD_H_
 #define WASP_BASE_ERRORS_CONTEXT_GUARD_H_
 
+#include <cassert>
+
 #include "wasp/base/span.h"
 #include "wasp/base/string_view.h"
 #include "wasp/base/errors.h"
 
 namespace wasp {
 
-/// ---
+// Provides the context for errors reported while the guard is alive. The
+// context is pushed lazily, only if an error is reported (see
+// Errors::guard_), so `desc` must outlive the guard.
 class ErrorsContextGuard {
  public:
   explicit ErrorsContextGuard(Errors& errors, Location loc, string_view desc)
-      : errors_{errors} {
-    errors.PushContext(loc, desc);
+      : errors_{errors}, parent_{errors.guard_}, loc_{loc}, desc_{desc} {
+    errors.guard_ = this;
   }
   ~ErrorsContextGuard() { PopContext(); }
 
+  ErrorsContextGuard(const ErrorsContextGuard&) = delete;
+  ErrorsContextGuard& operator=(const ErrorsContextGuard&) = delete;
+
   void PopContext() {
     if (!popped_context_) {
-      errors_.PopContext();
+      assert(errors_.guard_ == this);
+      errors_.guard_ = parent_;
+      if (pushed_context_) {
+        errors_.PopContext();
+      }
       popped_context_ = true;
     }
   }
 
  private:
+  friend class Errors;
+
   Errors& errors_;
+  ErrorsContextGuard* parent_;
+  Location loc_;
+  string_view desc_;
+  bool pushed_context_ = false;
   bool popped_context_ = false;
 };
 
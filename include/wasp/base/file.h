@@ -28,6 +28,46 @@ namespace wasp {
 
 optional<Buffer> ReadFile(string_view filename);
 
+enum class Advice {
+  Normal,
+  Sequential,  // Pages will be read in order.
+  WillNeed,    // Pages will be read soon; start reading them in now.
+  DontNeed,    // Pages won't be read again soon; they can be dropped.
+};
+
+// A read-only view of a file's contents. Where supported, the file is
+// memory-mapped, so no copy is made and pages are only brought in as they are
+// read. Otherwise the file is read into an owned buffer.
+//
+// Since LazyModule and the binary types all refer directly into their input,
+// the MappedFile must outlive everything read from `data()`.
+class MappedFile {
+ public:
+  MappedFile() = default;
+  MappedFile(const MappedFile&) = delete;
+  MappedFile(MappedFile&&);
+  MappedFile& operator=(const MappedFile&) = delete;
+  MappedFile& operator=(MappedFile&&);
+  ~MappedFile();
+
+  SpanU8 data() const { return data_; }
+
+  // Give the OS a hint about how the given subrange of `data()` will be
+  // accessed. This is a no-op if the file isn't mapped.
+  void Advise(SpanU8 range, Advice) const;
+
+ private:
+  friend optional<MappedFile> MapFile(string_view filename);
+
+  void Unmap();
+
+  SpanU8 data_;
+  bool is_mapped_ = false;
+  Buffer buffer_;  // Only used if the file couldn't be mapped.
+};
+
+optional<MappedFile> MapFile(string_view filename);
+
 }  // namespace wasp
 
 #endif  // WASP_BASE_FILE_H_
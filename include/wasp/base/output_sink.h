@@ -0,0 +1,171 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BASE_OUTPUT_SINK_H_
+#define WASP_BASE_OUTPUT_SINK_H_
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include "wasp/base/buffer.h"
+#include "wasp/base/optional.h"
+#include "wasp/base/span.h"
+#include "wasp/base/string_view.h"
+#include "wasp/base/types.h"
+
+namespace wasp {
+
+// A destination for the bytes written by binary::Write and text::Write, which
+// buffers them in fixed-size chunks instead of a single growing Buffer. The
+// bytes can be:
+//
+//   * kept in memory (the default), and later copied elsewhere,
+//   * written through to a file descriptor whenever a chunk fills up, or
+//   * only counted, e.g. to find the size of something before writing it.
+//
+// Use OutputSink::Iterator as the output iterator for the writers.
+class OutputSink {
+ public:
+  class Iterator;
+
+  static constexpr size_t kChunkSize = 64 * 1024;
+
+  OutputSink();
+  OutputSink(const OutputSink&) = delete;
+  OutputSink(OutputSink&&);
+  OutputSink& operator=(const OutputSink&) = delete;
+  OutputSink& operator=(OutputSink&&);
+  ~OutputSink();  // Flushes a file sink.
+
+  // Writes through to a new file with the given name, or returns nullopt if
+  // it can't be created.
+  static optional<OutputSink> OpenFile(string_view filename);
+  // Writes through to stdout.
+  static OutputSink Stdout();
+  // Discards the bytes, only counting them.
+  static OutputSink Counting();
+
+  void Write(u8 value) {
+    if (pos_ == end_) {
+      NextChunk();
+    }
+    *pos_++ = value;
+  }
+  void Write(SpanU8);
+  void Write(string_view value) { Write(ToSpanU8(value)); }
+
+  // Writes everything written to `other` so far, which must be a memory sink.
+  void Write(const OutputSink& other);
+
+  // Writes any buffered bytes to the file. Returns false if writing to the
+  // file has failed, now or earlier. Memory and counting sinks always succeed.
+  bool Flush();
+
+  // The total number of bytes written.
+  size_t size() const { return size_before_chunk_ + (pos_ - chunk_begin_); }
+
+  // Copies the contents of a memory sink.
+  Buffer ToBuffer() const;
+
+  Iterator out();
+
+ private:
+  enum class Kind { Memory, File, Counting };
+
+  explicit OutputSink(Kind, int fd = -1);
+
+  static SpanU8 ToSpanU8(string_view value) {
+    return SpanU8{reinterpret_cast<const u8*>(value.data()), value.size()};
+  }
+
+  // Called when the current chunk is full (or there isn't one yet).
+  void NextChunk();
+  void ForgetScratch();
+  void WriteToFile(SpanU8);
+  void Close();
+
+  Kind kind_;
+  int fd_;
+  bool owns_fd_ = false;
+  bool failed_ = false;
+  // A memory sink keeps every chunk, and each one is filled before the next
+  // is started. A file sink reuses a single chunk, and a counting sink
+  // overwrites `scratch_`, so it never allocates.
+  std::vector<std::unique_ptr<u8[]>> chunks_;
+  u8 scratch_[64];
+  u8* chunk_begin_ = nullptr;
+  u8* pos_ = nullptr;
+  u8* end_ = nullptr;
+  size_t size_before_chunk_ = 0;  // Bytes written before `chunk_begin_`.
+};
+
+class OutputSink::Iterator {
+ public:
+  using iterator_category = std::output_iterator_tag;
+  using value_type = void;
+  using difference_type = std::ptrdiff_t;
+  using pointer = void;
+  using reference = void;
+
+  explicit Iterator(OutputSink& sink) : sink_{&sink} {}
+
+  Iterator& operator*() { return *this; }
+  Iterator& operator++() { return *this; }
+  Iterator& operator++(int) { return *this; }
+  Iterator& operator=(u8 value) {
+    sink_->Write(value);
+    return *this;
+  }
+
+  OutputSink& sink() const { return *sink_; }
+
+ private:
+  OutputSink* sink_;
+};
+
+inline OutputSink::Iterator OutputSink::out() {
+  return Iterator{*this};
+}
+
+// Copies `bytes` to `out`. This is overloaded below, so writing to an
+// OutputSink is a single bulk copy instead of one write per byte.
+template <typename Iterator>
+Iterator CopyBytes(SpanU8 bytes, Iterator out) {
+  return std::copy(bytes.begin(), bytes.end(), out);
+}
+
+template <typename Iterator>
+Iterator CopyBytes(string_view bytes, Iterator out) {
+  return std::copy(bytes.begin(), bytes.end(), out);
+}
+
+inline OutputSink::Iterator CopyBytes(SpanU8 bytes, OutputSink::Iterator out) {
+  out.sink().Write(bytes);
+  return out;
+}
+
+inline OutputSink::Iterator CopyBytes(string_view bytes,
+                                      OutputSink::Iterator out) {
+  out.sink().Write(bytes);
+  return out;
+}
+
+}  // namespace wasp
+
+#endif  // WASP_BASE_OUTPUT_SINK_H_
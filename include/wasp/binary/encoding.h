@@ -103,6 +103,51 @@ struct EncodedOpcode {
   optional<u32> u32_code;
 };
 
+// The immediates that follow an opcode. Most kinds are named after the type
+// of the immediate; the rest need additional checks when they're read (e.g.
+// End, Else, DataIndex).
+enum class ImmediateKind : u8 {
+  None,
+  End,
+  Else,
+  Catch,
+  Delegate,
+  CatchAll,
+  HeapType,
+  BlockType,
+  DataIndex,
+  Index,
+  FuncBind,
+  BrTable,
+  CallIndirect,
+  MemArg,
+  SimdMemoryLane,
+  Reserved,
+  S32,
+  S64,
+  F32,
+  F64,
+  V128,
+  MemoryInit,
+  TableInit,
+  MemoryCopy,
+  TableCopy,
+  Shuffle,
+  Select,
+  SimdLane,
+  Let,
+  StructField,
+  RttSub,
+  HeapType2,
+  BrOnCast,
+};
+
+struct OpcodeInfo {
+  ::wasp::Opcode opcode;
+  ImmediateKind immediate_kind;
+  u64 features;  // The Features::Bits that must be enabled.
+};
+
 struct Opcode {
   static constexpr u8 GcPrefix = 0xfb;
   static constexpr u8 MiscPrefix = 0xfc;
@@ -111,8 +156,13 @@ struct Opcode {
 
   static bool IsPrefixByte(u8, const Features&);
   static EncodedOpcode Encode(::wasp::Opcode);
-  static optional<::wasp::Opcode> Decode(u8 code, const Features&);
-  static optional<::wasp::Opcode> Decode(u8 prefix, u32 code, const Features&);
+  // Opcodes are decoded along with the kind of their immediates, so readers
+  // don't have to look them up again. Returns nullopt for unknown opcodes,
+  // and for opcodes whose features are disabled.
+  static optional<OpcodeInfo> DecodeInfo(u8 code, const Features&);
+  static optional<OpcodeInfo> DecodeInfo(u8 prefix,
+                                         u32 code,
+                                         const Features&);
 };
 
 struct RefType {
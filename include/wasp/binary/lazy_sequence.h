@@ -75,6 +75,9 @@ class LazySequence : public LazySequenceBase {
   const_iterator cbegin() const { return begin(); }
   const_iterator cend() const { return end(); }
 
+  // The context that the elements are read with.
+  ReadCtx& ctx() const { return ctx_; }
+
  private:
   template <typename Sequence>
   friend class LazySequenceIterator;
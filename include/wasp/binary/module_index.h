@@ -0,0 +1,86 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BINARY_MODULE_INDEX_H_
+#define WASP_BINARY_MODULE_INDEX_H_
+
+#include <utility>
+#include <vector>
+
+#include "wasp/base/buffer.h"
+#include "wasp/base/hashmap.h"
+#include "wasp/base/optional.h"
+#include "wasp/base/span.h"
+#include "wasp/base/string_view.h"
+#include "wasp/base/types.h"
+#include "wasp/base/wasm_types.h"
+#include "wasp/binary/lazy_module.h"
+#include "wasp/binary/lazy_module_utils.h"
+#include "wasp/binary/types.h"
+
+namespace wasp::binary {
+
+struct ReadCtx;
+
+struct IndexedSection {
+  SectionId id;  // SectionId::Custom for custom sections.
+  SpanU8 data;   // The section's contents, without its id and length.
+};
+
+// An index of a module, built with a single pass over its sections. Tools
+// can then find a function by index or by name, and read its body, without
+// decoding the sections again.
+//
+// Everything in the index refers directly into `data`, which must outlive
+// it.
+struct ModuleIndex {
+  Index GetImportCount(ExternalKind) const;
+  Index GetFunctionCount() const;
+  optional<Index> GetFunctionTypeIndex(Index function_index) const;
+
+  // Returns the first known section with the given id.
+  optional<SpanU8> GetSection(SectionId) const;
+
+  // Finds a function by the name of its import, an export, or its entry in
+  // the "name" section. If several functions have the same name, the first
+  // is returned, in that order.
+  optional<Index> FindFunction(string_view name) const;
+
+  // Reads the code of a defined function. Returns nullopt for imported
+  // functions, and for indexes out of range.
+  OptAt<Code> GetCode(Index function_index, ReadCtx&) const;
+
+  SpanU8 data;
+  std::vector<IndexedSection> sections;
+  std::vector<Index> import_counts;          // Indexed by ExternalKind.
+  std::vector<Index> function_type_indexes;  // Including imported functions.
+  std::vector<SpanU8> codes;  // Each code entry, including its length.
+  std::vector<IndexNamePair> function_names;  // As ForEachFunctionName.
+  flat_hash_map<string_view, Index> name_to_function;
+};
+
+ModuleIndex BuildModuleIndex(const LazyModule&);
+
+// The index can be written to a file and read back later, so tools that are
+// run repeatedly on the same large module don't need to rebuild it. Reading
+// fails if the index doesn't match `module_data`, e.g. because the module
+// has been modified since the index was written.
+void WriteModuleIndex(const ModuleIndex&, Buffer&);
+optional<ModuleIndex> ReadModuleIndex(SpanU8 index_data, SpanU8 module_data);
+
+}  // namespace wasp::binary
+
+#endif  // WASP_BINARY_MODULE_INDEX_H_
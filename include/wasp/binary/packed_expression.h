@@ -0,0 +1,133 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BINARY_PACKED_EXPRESSION_H_
+#define WASP_BINARY_PACKED_EXPRESSION_H_
+
+#include <type_traits>
+#include <vector>
+
+#include "wasp/base/at.h"
+#include "wasp/base/span.h"
+#include "wasp/base/types.h"
+#include "wasp/base/v128.h"
+#include "wasp/base/wasm_types.h"
+#include "wasp/binary/types.h"
+
+namespace wasp::binary {
+
+struct ReadCtx;
+
+// A fixed-size, trivially-copyable encoding of an Instruction. Small
+// immediates are stored inline; larger ones (br_table targets, select types,
+// v128 values, and the rarer GC immediates) are stored in side tables of the
+// PackedExpression that owns this instruction, and `immediate` holds their
+// offset.
+struct PackedInstruction {
+  u16 opcode;  // Opcode
+  u8 kind;     // InstructionKind
+  u8 tag;      // Extra per-kind data, e.g. the BlockType form.
+  u32 end;     // Offset of the end of this instruction in the expression.
+  u64 immediate;
+};
+
+static_assert(sizeof(PackedInstruction) == 16);
+static_assert(std::is_trivially_copyable_v<PackedInstruction>);
+
+// A sequence of PackedInstructions, along with the side tables they refer to.
+//
+// Indexing a PackedExpression unpacks the instruction into an Instruction.
+// Locations are only kept for instructions that were decoded contiguously from
+// `data()` (e.g. by ReadPackedExpression); each immediate has the location of
+// its whole instruction.
+class PackedExpression {
+ public:
+  PackedExpression() = default;
+  explicit PackedExpression(SpanU8 data);
+  explicit PackedExpression(const InstructionList&);
+
+  void push_back(const At<Instruction>&);
+
+  // Appends an instruction given its parts, so a reader can pack the
+  // immediate directly instead of building an Instruction first. `loc` is the
+  // location of the whole instruction.
+  void push_back(Location, At<Opcode>);
+  template <typename T>
+  void push_back(Location, At<Opcode>, const At<T>& immediate);
+
+  void clear();
+  void reserve(size_t);
+
+  bool empty() const { return instructions_.empty(); }
+  size_t size() const { return instructions_.size(); }
+  SpanU8 data() const { return data_; }
+  span<const PackedInstruction> instructions() const { return instructions_; }
+
+  Opcode opcode(size_t index) const;
+  Location loc(size_t index) const;
+
+  At<Instruction> operator[](size_t index) const;
+
+ private:
+  PackedInstruction Begin(Location, Opcode) const;
+
+  // Each of these sets the kind and immediate of the packed instruction, and
+  // returns false if the immediate must be stored unpacked instead.
+  bool Pack(PackedInstruction&, const At<s32>&);
+  bool Pack(PackedInstruction&, const At<s64>&);
+  bool Pack(PackedInstruction&, const At<f32>&);
+  bool Pack(PackedInstruction&, const At<f64>&);
+  bool Pack(PackedInstruction&, const At<v128>&);
+  bool Pack(PackedInstruction&, const At<Index>&);
+  bool Pack(PackedInstruction&, const At<BlockType>&);
+  bool Pack(PackedInstruction&, const At<BrOnCastImmediate>&);
+  bool Pack(PackedInstruction&, const At<BrTableImmediate>&);
+  bool Pack(PackedInstruction&, const At<CallIndirectImmediate>&);
+  bool Pack(PackedInstruction&, const At<CopyImmediate>&);
+  bool Pack(PackedInstruction&, const At<FuncBindImmediate>&);
+  bool Pack(PackedInstruction&, const At<HeapType>&);
+  bool Pack(PackedInstruction&, const At<HeapType2Immediate>&);
+  bool Pack(PackedInstruction&, const At<InitImmediate>&);
+  bool Pack(PackedInstruction&, const At<LetImmediate>&);
+  bool Pack(PackedInstruction&, const At<MemArgImmediate>&);
+  bool Pack(PackedInstruction&, const At<RttSubImmediate>&);
+  bool Pack(PackedInstruction&, const At<SelectImmediate>&);
+  bool Pack(PackedInstruction&, const At<ShuffleImmediate>&);
+  bool Pack(PackedInstruction&, const At<SimdLaneImmediate>&);
+  bool Pack(PackedInstruction&, const At<SimdMemoryLaneImmediate>&);
+  bool Pack(PackedInstruction&, const At<StructFieldImmediate>&);
+
+  SpanU8 data_;
+  std::vector<PackedInstruction> instructions_;
+  std::vector<Index> br_table_targets_;
+  std::vector<v128> v128s_;
+  std::vector<ShuffleImmediate> shuffles_;
+  ValueTypeList select_types_;
+  InstructionList others_;
+};
+
+// Reads a single instruction and appends it to `expr`, without building an
+// intermediate Instruction. Returns false if there was an error, which is
+// reported to `ctx.errors`. Defined in read.cc, alongside Read<Instruction>.
+bool ReadPackedInstruction(SpanU8*, ReadCtx&, PackedExpression& expr);
+
+// Reads the instructions of an expression, packing each as it is read.
+PackedExpression ReadPackedExpression(SpanU8, ReadCtx&);
+PackedExpression ReadPackedExpression(Expression, ReadCtx&);
+
+}  // namespace wasp::binary
+
+#endif  // WASP_BINARY_PACKED_EXPRESSION_H_
@@ -30,6 +30,8 @@ namespace binary {
 struct ReadCtx {
   explicit ReadCtx(Errors&);
   explicit ReadCtx(const Features&, Errors&);
+  // Copies the module state of `other`, but reports errors to `errors`.
+  explicit ReadCtx(const ReadCtx& other, Errors& errors);
 
   void Reset();
 
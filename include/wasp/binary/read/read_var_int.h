@@ -44,8 +44,10 @@ S SignExtend(std::make_unsigned_t<S> x, int N) {
   return static_cast<S>(x << (kNumBits - N - 1)) >> (kNumBits - N - 1);
 }
 
+// Reads a LEB128 value one byte at a time. This handles truncated input, and
+// reports errors with the location of the byte that caused them.
 template <typename T>
-OptAt<T> ReadVarInt(SpanU8* data, ReadCtx& ctx, string_view desc) {
+OptAt<T> ReadVarIntSlow(SpanU8* data, ReadCtx& ctx, string_view desc) {
   using U = std::make_unsigned_t<T>;
   constexpr bool is_signed = std::is_signed_v<T>;
   constexpr int kByteMask = VarInt<T>::kByteMask;
@@ -93,6 +95,56 @@ OptAt<T> ReadVarInt(SpanU8* data, ReadCtx& ctx, string_view desc) {
   }
 }
 
+template <typename T>
+OptAt<T> ReadVarInt(SpanU8* data, ReadCtx& ctx, string_view desc) {
+  using U = std::make_unsigned_t<T>;
+  constexpr bool is_signed = std::is_signed_v<T>;
+  constexpr int kMaxBytes = VarInt<T>::kMaxBytes;
+  constexpr int kByteMask = VarInt<T>::kByteMask;
+  constexpr int kLastByteMaskBits =
+      VarInt<T>::kUsedBitsInLastByte - (is_signed ? 1 : 0);
+  constexpr u8 kLastByteMask = ~((1 << kLastByteMaskBits) - 1);
+  constexpr u8 kLastByteOnes = kLastByteMask & kByteMask;
+
+  // Most values (e.g. indexes and lengths) fit in a single byte, so decode
+  // those before anything else.
+  if (!data->empty() && ((*data)[0] & VarInt<T>::kExtendBit) == 0) {
+    const u8 byte = (*data)[0];
+    Location loc = data->first(1);
+    data->remove_prefix(1);
+    return At{loc, is_signed ? SignExtend<T>(byte, 6) : T(byte)};
+  }
+
+  // Fast path: if there are at least kMaxBytes left, the value can't be
+  // truncated, so decode it directly from the buffer. A malformed last byte
+  // falls through to the slow path, which reports the error.
+  if (data->size() >= kMaxBytes) {
+    const u8* bytes = data->data();
+    U result{};
+    for (int i = 0; i < kMaxBytes; ++i) {
+      const u8 byte = bytes[i];
+      const int shift = i * 7;
+      result |= U(byte & kByteMask) << shift;
+
+      if (i == kMaxBytes - 1) {
+        if ((byte & kLastByteMask) == 0 ||
+            (is_signed && (byte & kLastByteMask) == kLastByteOnes)) {
+          Location loc = data->first(kMaxBytes);
+          data->remove_prefix(kMaxBytes);
+          return At{loc, T(result)};
+        }
+      } else if ((byte & VarInt<T>::kExtendBit) == 0) {
+        Location loc = data->first(i + 1);
+        data->remove_prefix(i + 1);
+        return At{loc,
+                  is_signed ? SignExtend<T>(result, 6 + shift) : T(result)};
+      }
+    }
+  }
+
+  return ReadVarIntSlow<T>(data, ctx, desc);
+}
+
 }  // namespace wasp::binary
 
 #endif  // WASP_BINARY_READ_READ_VAR_INT_H_
@@ -0,0 +1,150 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/base/concat.h"
+#include "wasp/base/errors.h"
+#include "wasp/base/macros.h"
+#include "wasp/binary/encoding.h"
+#include "wasp/binary/formatters.h"
+#include "wasp/binary/read.h"
+
+namespace wasp::binary {
+
+template <typename Visitor>
+StreamingModuleReader<Visitor>::StreamingModuleReader(const Features& features,
+                                                      Errors& errors,
+                                                      Visitor& visitor)
+    : StreamingModuleReaderBase{features, errors}, visitor_{visitor} {}
+
+template <typename Visitor>
+auto StreamingModuleReader<Visitor>::Feed(SpanU8 chunk) -> Result {
+  while (!failed) {
+    auto unit = Next(&chunk);
+    if (!unit) {
+      return Result::Ok;
+    }
+    // Unlike visit::Visit, stop at the first error, even if it was only
+    // reported while decoding (e.g. in a LazyExpression).
+    failed = Read(*unit) == Result::Fail || ctx.errors.HasError();
+  }
+  return Result::Fail;
+}
+
+template <typename Visitor>
+auto StreamingModuleReader<Visitor>::Finish() -> Result {
+  if (!failed) {
+    if (auto unit = Flush()) {
+      // A truncated unit always fails to read.
+      Read(*unit);
+      failed = true;
+    } else {
+      failed = !EndModule(end(), ctx) || ctx.errors.HasError();
+    }
+  }
+  return failed ? Result::Fail : Result::Ok;
+}
+
+template <typename Visitor>
+auto StreamingModuleReader<Visitor>::Read(Unit unit) -> Result {
+  SpanU8 data = unit.data;
+  switch (unit.kind) {
+    case UnitKind::Header: {
+      auto magic =
+          ReadBytesExpected(&data, SpanU8{encoding::Magic}, ctx, "magic");
+      auto version = magic ? ReadBytesExpected(&data, SpanU8{encoding::Version},
+                                               ctx, "version")
+                           : nullopt;
+      return version ? Result::Ok : Result::Fail;
+    }
+
+    case UnitKind::Section: {
+      auto section = binary::Read<Section>(&data, ctx);
+      if (!section) {
+        return Result::Fail;
+      }
+      return visit::VisitSection(*section, ctx, visitor_);
+    }
+
+    case UnitKind::CodeSection: {
+      // Only the header and count have arrived, so the section can't be read
+      // with Read<Section>; its length was already decoded by Next().
+      auto id = binary::Read<SectionId>(&data, ctx);
+      if (!id) {
+        return Result::Fail;
+      }
+      if (ctx.last_section_id && *ctx.last_section_id >= id->value()) {
+        ctx.errors.OnError(id->loc(), concat("Section out of order: ", *id,
+                                             " cannot occur after ",
+                                             *ctx.last_section_id));
+      }
+      ctx.last_section_id = *id;
+      At<Section> section{
+          unit.data,
+          Section{At{unit.data, KnownSection{*id, unit.contents}}}};
+      auto res = visitor_.OnSection(section);
+      if (res != Result::Ok) {
+        if (res == Result::Skip) {
+          SkipCodeSection();
+        }
+        return res;
+      }
+
+      // The bodies haven't arrived yet, so check the count against the
+      // length of the section rather than the bytes that follow it.
+      SpanU8 contents = unit.contents;
+      auto count = ReadIndex(&contents, ctx, "count");
+      if (!count) {
+        return Result::Fail;
+      }
+      size_t remaining = unit.contents_size - unit.contents.size();
+      if (*count > remaining) {
+        ctx.errors.OnError(count->loc(), concat("Count extends past end: ",
+                                                *count, " > ", remaining));
+        return Result::Fail;
+      }
+      code_section_.emplace(count, contents, "code section", ctx);
+      res = visitor_.BeginCodeSection(*code_section_);
+      if (res == Result::Skip) {
+        // As with visit::Visit, count the skipped bodies.
+        ctx.code_count += code_section_->count->value();
+        SkipCodeSection();
+      }
+      return res;
+    }
+
+    case UnitKind::Code: {
+      auto code = binary::Read<Code>(&data, ctx);
+      if (!code) {
+        return Result::Fail;
+      }
+      code_count_++;
+      return visit::VisitCode(*code, ctx, visitor_);
+    }
+
+    case UnitKind::CodeSectionEnd: {
+      Index expected = code_section_->count->value();
+      if (code_count_ != expected) {
+        ctx.errors.OnError(data, concat("Expected code section to have count ",
+                                        expected, ", got ", code_count_));
+        return Result::Fail;
+      }
+      return visitor_.EndCodeSection(*code_section_);
+    }
+  }
+  WASP_UNREACHABLE();
+}
+
+}  // namespace wasp::binary
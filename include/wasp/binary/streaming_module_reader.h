@@ -0,0 +1,182 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BINARY_STREAMING_MODULE_READER_H_
+#define WASP_BINARY_STREAMING_MODULE_READER_H_
+
+#include <memory>
+#include <vector>
+
+#include "wasp/base/features.h"
+#include "wasp/base/optional.h"
+#include "wasp/base/span.h"
+#include "wasp/base/types.h"
+#include "wasp/binary/read/read_ctx.h"
+#include "wasp/binary/sections.h"
+#include "wasp/binary/visitor.h"
+
+namespace wasp {
+
+class Errors;
+
+namespace binary {
+
+// The non-template part of StreamingModuleReader. It buffers the bytes of the
+// module as they arrive, and splits them into units that can be read as soon
+// as they are complete.
+//
+// Each unit (a section, or a single function body) is copied into its own
+// buffer, which grows as the unit's bytes arrive rather than being allocated
+// up front from its length. The buffer is released once the unit has been
+// read, so locations given to the visitor are only valid until it returns.
+// The code section's header is kept until the end of the section, and the
+// unit that caused an error is kept, so the error's offset can be found.
+class StreamingModuleReaderBase {
+ public:
+  // The number of bytes fed so far.
+  size_t size() const { return size_; }
+
+  // The offset in the stream of `ptr`, which must point into the unit being
+  // read, or the unit that caused an error (e.g. a Location passed to
+  // Errors::OnError).
+  optional<size_t> offset(const u8* ptr) const;
+
+ protected:
+  explicit StreamingModuleReaderBase(const Features&, Errors&);
+
+  enum class UnitKind {
+    Header,          // The magic and version.
+    Section,         // A complete section, other than the code section.
+    CodeSection,     // The code section, once its count has arrived.
+    Code,            // A single function body from the code section.
+    CodeSectionEnd,  // The end of the code section.
+  };
+
+  struct Unit {
+    UnitKind kind;
+    SpanU8 data;
+    // For a CodeSection unit, the part of the section's contents that has
+    // arrived (i.e. the count), and the size of the whole contents.
+    SpanU8 contents = {};
+    size_t contents_size = 0;
+  };
+
+  // Consumes bytes from `chunk` until the next unit is complete, and returns
+  // it. Returns nullopt if `chunk` is exhausted first.
+  optional<Unit> Next(SpanU8* chunk);
+
+  // Returns the incomplete unit at the end of the stream, if any. Reading it
+  // reports an error, since the module was truncated.
+  optional<Unit> Flush();
+
+  // Consumes the rest of the code section without producing Code units.
+  void SkipCodeSection();
+
+  // An empty span at the end of the bytes read so far.
+  SpanU8 end() const;
+
+  ReadCtx ctx;
+  bool failed = false;
+
+ private:
+  enum class State {
+    Header,
+    SectionHeader,
+    Section,
+    CodeCount,
+    CodeSize,
+    Code,
+    SkipCode,
+    Done,
+  };
+
+  struct Segment {
+    std::unique_ptr<u8[]> data;
+    size_t capacity = 0;
+    size_t size = 0;
+    size_t offset = 0;  // The stream offset of data[0].
+
+    SpanU8 span(size_t begin, size_t end) const;
+    bool Contains(const u8*) const;
+  };
+
+  // Releases the current segment, and starts a new one with the pending
+  // bytes (a section header or body size).
+  void NewSegment();
+  // Appends the pending byte at the front of `chunk`. Returns false if
+  // `chunk` is empty.
+  bool AppendPending(SpanU8* chunk);
+  // Appends at most `max_count` bytes of `chunk` to the current segment,
+  // growing it as needed. `max_count` is the number of bytes left in the
+  // unit, so the segment never grows past the end of the unit.
+  void Append(SpanU8* chunk, size_t max_count);
+  // Consumes at most `max_count` bytes of `chunk` without copying them.
+  void Skip(SpanU8* chunk, size_t max_count);
+
+  Segment segment_;
+  Segment code_header_;  // The code section's header, until its end.
+  State state_ = State::Header;
+  u8 pending_[6];  // A section id and length, or a body size.
+  size_t pending_size_ = 0;
+  size_t contents_begin_ = 0;  // Stream offset of the section's contents.
+  size_t section_end_ = 0;     // Stream offset of the end of the section.
+  size_t unit_end_ = 0;        // Stream offset of the end of the body.
+  size_t size_ = 0;
+};
+
+// Reads a module incrementally as its bytes arrive, e.g. from a socket or a
+// pipe, and visits each section as soon as it is complete. The code section is
+// visited one function body at a time, so validation of the bodies overlaps
+// the transfer of the rest of the section.
+//
+// Errors are reported as soon as the unit containing them is read. Once
+// `errors` has an error, Feed returns Fail and nothing more is read.
+//
+// The visitor is called as visit::Visit would call it, except:
+//  * BeginModule and EndModule aren't called, since there is no LazyModule.
+//  * The code section is passed to OnSection and BeginCodeSection as soon as
+//    its count has arrived, and its contents contain only the count. The
+//    bodies are provided to BeginCode as each one arrives. (In particular,
+//    ValidateVisitor must use a single code job.)
+template <typename Visitor>
+class StreamingModuleReader : public StreamingModuleReaderBase {
+ public:
+  using Result = visit::Result;
+
+  explicit StreamingModuleReader(const Features&, Errors&, Visitor&);
+
+  // Appends `chunk` to the module, and visits everything that is now
+  // complete.
+  Result Feed(SpanU8 chunk);
+
+  // Signals the end of the module, reporting an error if it is incomplete or
+  // malformed.
+  Result Finish();
+
+ private:
+  Result Read(Unit);
+
+  Visitor& visitor_;
+  optional<LazyCodeSection> code_section_;
+  Index code_count_ = 0;
+};
+
+}  // namespace binary
+}  // namespace wasp
+
+#include "wasp/binary/streaming_module_reader-inl.h"
+
+#endif  // WASP_BINARY_STREAMING_MODULE_READER_H_
@@ -123,6 +123,15 @@ struct SkipVisitor : Visitor {
 template <typename Visitor>
 Result Visit(LazyModule&, Visitor&);
 
+// Visits a single section, as Visit does for each section of a module. This
+// is used when the module isn't available as a whole, e.g. when streaming.
+template <typename Visitor>
+Result VisitSection(At<Section>, ReadCtx&, Visitor&);
+
+// Visits the instructions of a single function body.
+template <typename Visitor>
+Result VisitCode(const At<Code>&, ReadCtx&, Visitor&);
+
 #define WASP_CHECK(x)      \
   if (x == Result::Fail) { \
     return Result::Fail;   \
@@ -150,7 +159,7 @@ Result Visit(LazyModule&, Visitor&);
 
 #define WASP_SECTION_ELSE_SKIP(Name, skip_section)     \
   case SectionId::Name: {                              \
-    auto sec = Read##Name##Section(known, module.ctx); \
+    auto sec = Read##Name##Section(known, ctx);        \
     WASP_IF_OK_ELSE_SKIP(                              \
         visitor.Begin##Name##Section(sec),             \
         {                                              \
@@ -167,7 +176,7 @@ Result Visit(LazyModule&, Visitor&);
 
 #define WASP_OPT_SECTION(Name)                         \
   case SectionId::Name: {                              \
-    auto opt = Read##Name##Section(known, module.ctx); \
+    auto opt = Read##Name##Section(known, ctx);        \
     WASP_IF_OK(visitor.Begin##Name##Section(opt), {    \
       if (opt) {                                       \
         WASP_CHECK(visitor.On##Name(*opt));            \
@@ -186,68 +195,82 @@ inline Result Visit(LazyModule& module, Visitor& visitor) {
   }
 
   for (auto section : module.sections) {
-    auto res = visitor.OnSection(section);
-    if (res == Result::Skip) {
-      continue;
-    } else if (res == Result::Fail) {
-      return Result::Fail;
-    }
+    WASP_CHECK(VisitSection(section, module.ctx, visitor));
+  }
+  EndModule(module.data, module.ctx);
+  return visitor.EndModule(module);
+}
+
+template <typename Visitor>
+inline Result VisitSection(At<Section> section,
+                           ReadCtx& ctx,
+                           Visitor& visitor) {
+  auto res = visitor.OnSection(section);
+  if (res != Result::Ok) {
+    return res;
+  }
 
-    if (section->is_known()) {
-      const auto& known = section->known();
-      switch (known->id) {
-        WASP_SECTION(Type)
-        WASP_SECTION(Import)
-        WASP_SECTION_ELSE_SKIP(Function, {
-          module.ctx.defined_function_count += sec.count->value();
-        })
-        WASP_SECTION(Table)
-        WASP_SECTION(Memory)
-        WASP_SECTION(Global)
-        WASP_SECTION(Tag)
-        WASP_SECTION(Export)
-        WASP_OPT_SECTION(Start)
-        WASP_SECTION(Element)
-        WASP_OPT_SECTION(DataCount)
-
-        case SectionId::Code: {
-          auto sec = ReadCodeSection(known, module.ctx);
-          WASP_IF_OK_ELSE_SKIP(
-              visitor.BeginCodeSection(sec),
-              {
-                for (const auto& code : sec.sequence) {
-                  WASP_IF_OK(visitor.BeginCode(code), {
-                    for (auto&& instr :
-                         ReadExpression(*code->body, module.ctx)) {
-                      WASP_CHECK(visitor.OnInstruction(instr));
-                    }
-                    EndCode(code->body->data.last(0), module.ctx);
-                    WASP_CHECK(visitor.EndCode(code));
-                  })
-                }
-                WASP_CHECK(visitor.EndCodeSection(sec));
-              },
-              // If skipping this section, increment by the number of code
-              // items specified in this section.
-              { module.ctx.code_count += sec.count->value(); })
-          break;
-        }
-
-          WASP_SECTION_ELSE_SKIP(
-              Data,
-              // If skipping this section, increment by the number of data items
-              // specified in this section.
-              { module.ctx.data_count += sec.count->value(); })
-
-        default: break;
+  if (section->is_known()) {
+    const auto& known = section->known();
+    switch (known->id) {
+      WASP_SECTION(Type)
+      WASP_SECTION(Import)
+      WASP_SECTION_ELSE_SKIP(Function, {
+        ctx.defined_function_count += sec.count->value();
+      })
+      WASP_SECTION(Table)
+      WASP_SECTION(Memory)
+      WASP_SECTION(Global)
+      WASP_SECTION(Tag)
+      WASP_SECTION(Export)
+      WASP_OPT_SECTION(Start)
+      WASP_SECTION(Element)
+      WASP_OPT_SECTION(DataCount)
+
+      case SectionId::Code: {
+        auto sec = ReadCodeSection(known, ctx);
+        WASP_IF_OK_ELSE_SKIP(
+            visitor.BeginCodeSection(sec),
+            {
+              for (const auto& code : sec.sequence) {
+                WASP_CHECK(VisitCode(code, ctx, visitor));
+              }
+              WASP_CHECK(visitor.EndCodeSection(sec));
+            },
+            // If skipping this section, increment by the number of code
+            // items specified in this section.
+            { ctx.code_count += sec.count->value(); })
+        break;
       }
+
+        WASP_SECTION_ELSE_SKIP(
+            Data,
+            // If skipping this section, increment by the number of data items
+            // specified in this section.
+            { ctx.data_count += sec.count->value(); })
+
+      default: break;
     }
   }
-  EndModule(module.data, module.ctx);
-  return visitor.EndModule(module);
+  return Result::Ok;
+}
+
+template <typename Visitor>
+inline Result VisitCode(const At<Code>& code, ReadCtx& ctx, Visitor& visitor) {
+  WASP_IF_OK(visitor.BeginCode(code), {
+    for (auto&& instr : ReadExpression(*code->body, ctx)) {
+      WASP_CHECK(visitor.OnInstruction(instr));
+    }
+    EndCode(code->body->data.last(0), ctx);
+    WASP_CHECK(visitor.EndCode(code));
+  })
+  return Result::Ok;
 }
 
 #undef WASP_CHECK
+#undef WASP_IF_OK
+#undef WASP_IF_OK_ELSE_SKIP
+#undef WASP_SECTION_ELSE_SKIP
 #undef WASP_SECTION
 #undef WASP_OPT_SECTION
 
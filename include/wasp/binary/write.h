@@ -22,10 +22,12 @@
 #include <iterator>
 #include <limits>
 #include <type_traits>
+#include <vector>
 
 #include "wasp/base/buffer.h"
 #include "wasp/base/macros.h"
 #include "wasp/base/optional.h"
+#include "wasp/base/output_sink.h"
 #include "wasp/base/types.h"
 #include "wasp/base/wasm_types.h"
 #include "wasp/binary/encoding.h"
@@ -184,7 +186,7 @@ Iterator Write(const Limits& limits, Iterator out) {
 
 template <typename Iterator>
 Iterator WriteBytes(SpanU8 value, Iterator out) {
-  return std::copy(value.begin(), value.end(), out);
+  return CopyBytes(value, out);
 }
 
 template <typename Iterator>
@@ -277,14 +279,16 @@ Iterator Write(const CallIndirectImmediate& immediate, Iterator out) {
 
 template <typename Iterator>
 Iterator Write(Code value, Iterator out) {
-  // Write Code to a separate buffer, so we know its length.
-  Buffer buffer;
-  auto code_out = std::back_inserter(buffer);
-  code_out = WriteVector(value.locals.begin(), value.locals.end(), code_out);
-  code_out = WriteBytes(value.body->data, code_out);
+  // Count the size of the locals first, so the length can be written before
+  // them, without writing them to a separate buffer.
+  auto counter = OutputSink::Counting();
+  WriteVector(value.locals.begin(), value.locals.end(), counter.out());
+  size_t length = counter.size() + value.body->data.size();
+  assert(length < std::numeric_limits<u32>::max());
 
-  // Then write that buffer to the real output.
-  out = WriteLengthAndBytes(buffer, out);
+  out = Write(u32(length), out);
+  out = WriteVector(value.locals.begin(), value.locals.end(), out);
+  out = WriteBytes(value.body->data, out);
   return out;
 }
 
@@ -730,7 +734,7 @@ OutputIterator WriteKnownSection(SectionId section_id,
 
 template <typename Container, typename Iterator>
 Iterator WriteNonEmptyKnownSection(SectionId section_id,
-                                   Container container,
+                                   const Container& container,
                                    Iterator out) {
   if (!container.empty()) {
     out = WriteKnownSection(section_id, std::begin(container),
@@ -776,6 +780,47 @@ Iterator Write(const Module& value, Iterator out) {
   return out;
 }
 
+enum class LengthEncoding {
+  Minimal,  // The shortest LEB128 encoding, as written by Write(Module).
+  Fixed,    // Always a 5-byte LEB128 encoding.
+};
+
+// Writes the lengths of nested, length-prefixed items (e.g. sections and
+// function bodies) to a buffer, without writing the items to a separate
+// buffer first.
+//
+// Begin reserves a 5-byte length at the end of the buffer, and End patches
+// it once the item has been written. With LengthEncoding::Minimal, Finish
+// then compacts every length to its shortest encoding, in one pass over the
+// buffer.
+class LengthPatcher {
+ public:
+  explicit LengthPatcher(Buffer&, LengthEncoding);
+
+  void Begin();
+  void End();
+  void Finish();
+
+ private:
+  struct OpenLength {
+    size_t offset;
+    size_t savings;  // The value of savings_ when the length was reserved.
+  };
+
+  Buffer& buffer_;
+  LengthEncoding encoding_;
+  std::vector<OpenLength> open_;
+  std::vector<size_t> offsets_;  // Every reserved length, in buffer order.
+  size_t savings_ = 0;  // Bytes that will be removed by Finish, so far.
+};
+
+// Writes `module` to the end of `buffer` in a single pass, patching the
+// section and function body lengths in place. With LengthEncoding::Minimal,
+// the result is the same as Write(module, std::back_inserter(buffer)).
+void WriteModule(const Module&,
+                 Buffer&,
+                 LengthEncoding = LengthEncoding::Minimal);
+
 }  // namespace wasp::binary
 
 #endif  // WASP_BINARY_WRITE_H_
@@ -17,14 +17,11 @@
 #ifndef WASP_CONVERT_TO_TEXT_H_
 #define WASP_CONVERT_TO_TEXT_H_
 
-#include <map>
-#include <memory>
-#include <string>
-#include <vector>
-
+#include "wasp/base/arena.h"
 #include "wasp/base/at.h"
 #include "wasp/base/buffer.h"
 #include "wasp/base/optional.h"
+#include "wasp/binary/packed_expression.h"
 #include "wasp/binary/types.h"
 #include "wasp/text/types.h"
 
@@ -33,11 +30,8 @@ namespace wasp::convert {
 struct TextCtx {
   text::Text Add(string_view);
 
-  // TODO: The buffers need to have stable pointers (for use by string_view or
-  // span), so for now they are all std::unique_ptr<T>. This could be optimized
-  // in a number of ways, however (e.g. allocating in larger blocks of chars,
-  // and appending to that).
-  std::vector<std::unique_ptr<std::string>> strings;
+  // Storage for the strings referenced by the converted module.
+  Arena arena;
 };
 
 // Helpers.
@@ -111,6 +105,7 @@ auto ToText(TextCtx&, const At<binary::Instruction>&) -> At<text::Instruction>;
 auto ToText(TextCtx&, const binary::InstructionList&) -> text::InstructionList;
 
 auto ToText(TextCtx&, const At<binary::UnpackedExpression>&) -> text::InstructionList;
+auto ToText(TextCtx&, const binary::PackedExpression&) -> text::InstructionList;
 auto ToText(TextCtx&, const binary::LocalsList&) -> At<text::BoundValueTypeList>;
 auto ToText(TextCtx&, const At<binary::UnpackedCode>&, At<text::Function>&) -> At<text::Function>&;
 
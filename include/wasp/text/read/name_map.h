@@ -17,11 +17,22 @@
 #ifndef WASP_TEXT_READ_NAME_MAP_H_
 #define WASP_TEXT_READ_NAME_MAP_H_
 
+#include <vector>
+
+#include "wasp/base/hashmap.h"
+#include "wasp/base/optional.h"
 #include "wasp/base/string_view.h"
 #include "wasp/text/types.h"
 
 namespace wasp::text {
 
+// Maps names to indexes, where each Push() starts a new scope whose names
+// come first, e.g. for labels or let-bound locals. A name bound in a newer
+// scope shadows the same name in an older one, until that scope is popped.
+//
+// Small maps (e.g. labels) are searched linearly. Once a map grows past
+// kMaxLinearSize names, it is indexed by a hash map from each name to its
+// most recent binding, so lookups in large maps are constant time.
 class NameMap {
  public:
   explicit NameMap();
@@ -39,10 +50,21 @@ class NameMap {
   auto Size() const -> Index;
 
  private:
-  optional<size_t> FindInRange(size_t begin, size_t end, BindVar) const;
+  static constexpr size_t kMaxLinearSize = 16;
+
+  struct Entry {
+    optional<BindVar> name;
+    optional<size_t> shadowed;  // The previous binding of `name`, if any.
+  };
+
+  // The offset of the most recent binding of `var` in `names_`.
+  optional<size_t> Find(BindVar) const;
+  void BuildIndex();
 
-  std::vector<optional<BindVar>> names_;
+  std::vector<Entry> names_;
   std::vector<size_t> stack_;
+  bool indexed_ = false;
+  flat_hash_map<BindVar, size_t> bindings_;  // Only used when `indexed_`.
 };
 
 }  // namespace wasp::text
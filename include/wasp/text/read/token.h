@@ -20,6 +20,7 @@
 #include <string>
 #include <vector>
 
+#include "wasp/base/arena.h"
 #include "wasp/base/at.h"
 #include "wasp/base/buffer.h"
 #include "wasp/base/features.h"
@@ -73,6 +74,9 @@ struct OpcodeInfo {
 struct Text {
   void AppendToBuffer(Buffer& buffer) const;
   auto ToString() const -> std::string;
+  // Unescapes the text into `arena`, returning a view that lives as long as
+  // the arena does.
+  auto ToString(Arena&) const -> string_view;
 
   string_view text;
   u32 byte_size;
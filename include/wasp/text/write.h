@@ -24,6 +24,7 @@
 
 #include "wasp/base/concat.h"
 #include "wasp/base/formatters.h"
+#include "wasp/base/output_sink.h"
 #include "wasp/base/types.h"
 #include "wasp/base/v128.h"
 #include "wasp/text/numeric.h"
@@ -61,12 +62,12 @@ Iterator WriteRaw(WriteCtx& ctx, char value, Iterator out) {
 
 template <typename Iterator>
 Iterator WriteRaw(WriteCtx& ctx, string_view value, Iterator out) {
-  return std::copy(value.begin(), value.end(), out);
+  return CopyBytes(value, out);
 }
 
 template <typename Iterator>
 Iterator WriteRaw(WriteCtx& ctx, const std::string& value, Iterator out) {
-  return std::copy(value.begin(), value.end(), out);
+  return CopyBytes(string_view{value}, out);
 }
 
 template <typename Iterator>
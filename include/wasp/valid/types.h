@@ -28,9 +28,22 @@ namespace wasp::valid {
 
 struct Any {};
 
+// A value type, or "any", packed into a few integers. Stack types are pushed,
+// popped and compared for every instruction, so they are cheap to copy and
+// equality is an integer comparison. Locations are not stored.
 struct StackType {
+  enum class Form : u8 {
+    Any,
+    NumericType,    // `code` is the NumericType.
+    ReferenceKind,  // `code` is the ReferenceKind.
+    RefHeapKind,    // `code` is the HeapKind.
+    RefIndex,       // `index` is the heap type index.
+    RttHeapKind,    // `code` is the HeapKind, and `depth` is the Rtt depth.
+    RttIndex,       // `index` is the heap type index, and `depth` as above.
+  };
+
   explicit StackType();
-  explicit StackType(binary::ValueType);
+  explicit StackType(const binary::ValueType&);
   explicit StackType(Any);
 
   static StackType I32();
@@ -46,11 +59,16 @@ struct StackType {
 
   bool is_value_type() const;
   bool is_any() const;
+  bool is_numeric_type() const;
 
-  auto value_type() -> binary::ValueType&;
-  auto value_type() const -> const binary::ValueType&;
+  // Unpacks the value type, without locations.
+  auto value_type() const -> binary::ValueType;
 
-  variant<binary::ValueType, Any> type;
+  Form form = Form::Any;
+  u8 code = 0;
+  bool nullable = false;  // Only for RefHeapKind and RefIndex.
+  Index index = 0;
+  Index depth = 0;
 };
 
 using StackTypeList = std::vector<StackType>;
@@ -88,7 +106,7 @@ auto AsNonNullableType(StackType) -> StackType;
 
 #define WASP_VALID_STRUCTS_CUSTOM_FORMAT(WASP_V) \
   WASP_V(valid::Any, 0)            \
-  WASP_V(valid::StackType, 1, type)
+  WASP_V(valid::StackType, 5, form, code, nullable, index, depth)
 
 #define WASP_VALID_CONTAINERS(WASP_V) \
   WASP_V(valid::StackTypeList)        \
@@ -17,12 +17,12 @@
 #ifndef WASP_VALID_CONTEXT_H_
 #define WASP_VALID_CONTEXT_H_
 
-#include <map>
-#include <set>
+#include <utility>
 #include <vector>
 
 #include "wasp/base/errors.h"
 #include "wasp/base/features.h"
+#include "wasp/base/hashmap.h"
 #include "wasp/base/span.h"
 #include "wasp/base/string_view.h"
 #include "wasp/base/types.h"
@@ -45,19 +45,21 @@ enum class LabelType {
   Let,
 };
 
+// The param and result types of a label aren't stored in the label itself,
+// but in ValidCtx::label_types, so pushing a label doesn't allocate once the
+// context has validated a few functions. Use ValidCtx::GetParamTypes, etc. to
+// access them.
 struct Label {
   Label(LabelType,
-        StackTypeSpan param_types,
-        StackTypeSpan result_types,
+        Index types_begin,
+        Index param_count,
+        Index result_count,
         Index type_stack_limit);
 
-  const StackTypeList& br_types() const {
-    return label_type == LabelType::Loop ? param_types : result_types;
-  }
-
   LabelType label_type;
-  StackTypeList param_types;
-  StackTypeList result_types;
+  Index types_begin;  // The param types, followed by the result types.
+  Index param_count;
+  Index result_count;
   Index type_stack_limit;
   bool unreachable;
 };
@@ -74,7 +76,7 @@ class SameTypes {
   void MaybeSwapIndexes(Index&, Index&);
 
   DisjointSet disjoint_set_;
-  std::map<std::pair<Index, Index>, bool> assume_;
+  flat_hash_map<std::pair<Index, Index>, bool> assume_;
 };
 
 class MatchTypes {
@@ -85,8 +87,14 @@ class MatchTypes {
   void Assume(Index, Index);
   void Resolve(Index, Index, bool);
 
+  // The results of IsMatch for stack types that aren't identical, which only
+  // depend on the defined types.
+  auto Get(const StackType&, const StackType&) -> optional<bool>;
+  void Set(const StackType&, const StackType&, bool);
+
  private:
-  std::map<std::pair<Index, Index>, bool> assume_;
+  flat_hash_map<std::pair<Index, Index>, bool> assume_;
+  flat_hash_map<std::pair<StackType, StackType>, bool> stack_types_;
   Index num_types_ = 0;
 };
 
@@ -95,7 +103,26 @@ struct ValidCtx {
   ValidCtx(const Features&, Errors&);
   ValidCtx(const ValidCtx&, Errors&);
 
+  // Resets the module and expression state, but keeps the capacity of the
+  // expression state, since it is reused by the next module.
   void Reset();
+  // Resets only the expression state, before validating a new expression.
+  void ResetExpression();
+
+  void PushLabel(LabelType,
+                 StackTypeSpan param_types,
+                 StackTypeSpan result_types,
+                 Index type_stack_limit);
+  void PushLabel(LabelType,
+                 const binary::FunctionType&,
+                 Index type_stack_limit);
+  void PopLabel();
+
+  StackTypeSpan GetParamTypes(const Label&) const;
+  StackTypeSpan GetResultTypes(const Label&) const;
+  // The types of a branch to the label: the param types of a loop, or the
+  // result types of any other label.
+  StackTypeSpan GetBrTypes(const Label&) const;
 
   bool IsStackPolymorphic() const;
   bool IsFunctionType(Index) const;
@@ -117,14 +144,38 @@ struct ValidCtx {
   Index imported_global_count = 0;
   optional<Index> declared_data_count;
   Index code_count = 0;
+  flat_hash_set<string_view> export_names;
+  flat_hash_set<Index> declared_functions;
+
+  SameTypes same_types;
+  MatchTypes match_types;
+
+  // The state of the expression being validated, either a function body or a
+  // constant expression. Everything above is module state, which is shared
+  // by all expressions.
   LocalMap locals;
   StackTypeList type_stack;
   std::vector<Label> label_stack;
-  std::set<string_view> export_names;
-  std::set<Index> declared_functions;
+  StackTypeList label_types;  // See Label.
+};
 
-  SameTypes same_types;
-  MatchTypes match_types;
+// Saves and resets the expression state of `ctx`, so another expression can
+// be validated with the same module state, without copying it. The saved
+// state is restored when the scope ends.
+class ExpressionScope {
+ public:
+  explicit ExpressionScope(ValidCtx&);
+  ~ExpressionScope();
+
+  ExpressionScope(const ExpressionScope&) = delete;
+  ExpressionScope& operator=(const ExpressionScope&) = delete;
+
+ private:
+  ValidCtx& ctx_;
+  LocalMap locals_;
+  StackTypeList type_stack_;
+  std::vector<Label> label_stack_;
+  StackTypeList label_types_;
 };
 
 }  // namespace wasp::valid
@@ -18,6 +18,7 @@
 #define WASP_VALID_VALIDATE_H_
 
 #include "wasp/base/types.h"
+#include "wasp/binary/packed_expression.h"
 #include "wasp/valid/types.h"
 
 namespace wasp::valid {
@@ -102,6 +103,7 @@ bool Validate(ValidCtx&,
 bool Validate(ValidCtx&, const binary::ValueTypeList&);
 bool Validate(ValidCtx&, const At<binary::UnpackedCode>&);
 bool Validate(ValidCtx&, const At<binary::UnpackedExpression>&);
+bool Validate(ValidCtx&, const binary::PackedExpression&);
 
 bool Validate(ValidCtx&, const binary::Module&);
 
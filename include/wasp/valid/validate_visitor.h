@@ -31,7 +31,9 @@ struct ValidateVisitor : binary::visit::Visitor {
   using Result = binary::visit::Result;
 
   explicit ValidateVisitor(Features features, Errors& errors);
+  explicit ValidateVisitor(Features features, Errors& errors, u32 code_jobs);
 
+  auto OnSection(At<binary::Section>) -> Result;
   auto BeginTypeSection(binary::LazyTypeSection) -> Result;
   auto OnType(const At<binary::DefinedType>&) -> Result;
   auto EndTypeSection(binary::LazyTypeSection) -> Result;
@@ -45,15 +47,25 @@ struct ValidateVisitor : binary::visit::Visitor {
   auto OnStart(const At<binary::Start>&) -> Result;
   auto OnElement(const At<binary::ElementSegment>&) -> Result;
   auto OnDataCount(const At<binary::DataCount>&) -> Result;
+  auto BeginCodeSection(binary::LazyCodeSection) -> Result;
   auto BeginCode(const At<binary::Code>&) -> Result;
   auto OnInstruction(const At<binary::Instruction>&) -> Result;
   auto OnData(const At<binary::DataSegment>&) -> Result;
 
   auto FailUnless(bool) -> Result;
 
+  // Validates the function bodies in the code section using `code_jobs`
+  // threads. Each thread has its own copy of `ctx`, made once all of the
+  // module-level sections have been validated. Errors are reported in
+  // function order, as if the bodies were validated serially.
+  auto ValidateCodeSectionParallel(SpanU8 data, const binary::ReadCtx&)
+      -> Result;
+
   ValidCtx ctx;
   Features features;
   Errors& errors;
+  u32 code_jobs = 1;
+  optional<SpanU8> code_section_data;
 };
 
 }  // namespace valid
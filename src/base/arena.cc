@@ -0,0 +1,92 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/base/arena.h"
+
+#include <cstring>
+#include <utility>
+
+namespace wasp {
+
+// static
+constexpr size_t Arena::kDefaultBlockSize;
+
+Arena::Arena(size_t block_size) : block_size_{block_size} {}
+
+// The moved-from Arena is left empty, so it can't allocate from a block that
+// it no longer owns.
+Arena::Arena(Arena&& other)
+    : blocks_{std::exchange(other.blocks_, {})},
+      block_size_{other.block_size_},
+      next_{std::exchange(other.next_, nullptr)},
+      remaining_{std::exchange(other.remaining_, 0)},
+      allocated_bytes_{std::exchange(other.allocated_bytes_, 0)} {}
+
+Arena& Arena::operator=(Arena&& other) {
+  if (this != &other) {
+    blocks_ = std::exchange(other.blocks_, {});
+    block_size_ = other.block_size_;
+    next_ = std::exchange(other.next_, nullptr);
+    remaining_ = std::exchange(other.remaining_, 0);
+    allocated_bytes_ = std::exchange(other.allocated_bytes_, 0);
+  }
+  return *this;
+}
+
+u8* Arena::Allocate(size_t size) {
+  allocated_bytes_ += size;
+  if (size == 0 || size <= remaining_) {
+    u8* result = next_;
+    next_ += size;
+    remaining_ -= size;
+    return result;
+  }
+
+  if (size > block_size_ / 4) {
+    // Large allocations get their own block, so the rest of the current block
+    // isn't wasted. The current block stays at the end.
+    u8* result = new u8[size];
+    blocks_.emplace(blocks_.empty() ? blocks_.end() : blocks_.end() - 1,
+                    result);
+    return result;
+  }
+
+  u8* result = new u8[block_size_];
+  blocks_.emplace_back(result);
+  next_ = result + size;
+  remaining_ = block_size_ - size;
+  return result;
+}
+
+string_view Arena::Add(string_view str) {
+  if (str.empty()) {
+    return {};
+  }
+  u8* data = Allocate(str.size());
+  std::memcpy(data, str.data(), str.size());
+  return string_view{reinterpret_cast<const char*>(data), str.size()};
+}
+
+SpanU8 Arena::Add(SpanU8 span) {
+  if (span.empty()) {
+    return {};
+  }
+  u8* data = Allocate(span.size());
+  std::memcpy(data, span.data(), span.size());
+  return SpanU8{data, span.size()};
+}
+
+}  // namespace wasp
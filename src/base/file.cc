@@ -16,11 +16,50 @@
 
 #include "wasp/base/file.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <fstream>
+#include <iterator>
 #include <string>
+#include <utility>
+
+#if !defined(_WIN32)
+#define WASP_HAS_MMAP 1
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define WASP_HAS_MMAP 0
+#endif
 
 namespace wasp {
 
+namespace {
+
+#if WASP_HAS_MMAP
+// Reads from `fd` until EOF.
+optional<Buffer> ReadAll(int fd) {
+  Buffer buffer;
+  u8 chunk[64 * 1024];
+  while (true) {
+    auto count = read(fd, chunk, sizeof(chunk));
+    if (count == 0) {
+      return buffer;
+    } else if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return nullopt;
+    }
+    buffer.insert(buffer.end(), chunk, chunk + count);
+  }
+}
+#endif
+
+}  // namespace
+
 optional<Buffer> ReadFile(string_view filename) {
   std::ifstream stream{std::string{filename}, std::ios::in | std::ios::binary};
   if (!stream) {
@@ -29,7 +68,15 @@ optional<Buffer> ReadFile(string_view filename) {
 
   Buffer buffer;
   stream.seekg(0, std::ios::end);
-  buffer.resize(stream.tellg());
+  auto size = stream.tellg();
+  if (size == -1) {
+    // Not seekable, e.g. a pipe; read until EOF instead.
+    stream.clear();
+    buffer.assign(std::istreambuf_iterator<char>{stream},
+                  std::istreambuf_iterator<char>{});
+    return buffer;
+  }
+  buffer.resize(size);
   stream.seekg(0, std::ios::beg);
   stream.read(reinterpret_cast<char*>(&buffer[0]), buffer.size());
   if (stream.fail()) {
@@ -39,4 +86,107 @@ optional<Buffer> ReadFile(string_view filename) {
   return buffer;
 }
 
+MappedFile::MappedFile(MappedFile&& rhs) {
+  *this = std::move(rhs);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& rhs) {
+  if (this != &rhs) {
+    Unmap();
+    // Moving a std::vector keeps its storage, so data_ remains valid when it
+    // refers into buffer_.
+    buffer_ = std::move(rhs.buffer_);
+    data_ = std::exchange(rhs.data_, SpanU8{});
+    is_mapped_ = std::exchange(rhs.is_mapped_, false);
+  }
+  return *this;
+}
+
+MappedFile::~MappedFile() {
+  Unmap();
+}
+
+void MappedFile::Unmap() {
+#if WASP_HAS_MMAP
+  if (is_mapped_) {
+    munmap(const_cast<u8*>(data_.data()), data_.size());
+  }
+#endif
+  data_ = SpanU8{};
+  is_mapped_ = false;
+  buffer_.clear();
+}
+
+void MappedFile::Advise(SpanU8 range, Advice advice) const {
+#if WASP_HAS_MMAP
+  if (!is_mapped_ || range.empty()) {
+    return;
+  }
+
+  int flag;
+  switch (advice) {
+    case Advice::Normal:     flag = MADV_NORMAL; break;
+    case Advice::Sequential: flag = MADV_SEQUENTIAL; break;
+    case Advice::WillNeed:   flag = MADV_WILLNEED; break;
+    case Advice::DontNeed:   flag = MADV_DONTNEED; break;
+    default: return;
+  }
+
+  // madvise requires a page-aligned address, so round the start of the range
+  // down. The range is clamped to the mapping.
+  static const uintptr_t page_size = sysconf(_SC_PAGESIZE);
+  auto map_begin = reinterpret_cast<uintptr_t>(data_.data());
+  auto map_end = map_begin + data_.size();
+  auto range_begin = reinterpret_cast<uintptr_t>(range.data());
+  auto begin = std::max(range_begin, map_begin);
+  auto end = std::min(range_begin + range.size(), map_end);
+  if (begin >= end) {
+    return;
+  }
+  begin &= ~(page_size - 1);
+  madvise(reinterpret_cast<void*>(begin), end - begin, flag);
+#endif
+}
+
+optional<MappedFile> MapFile(string_view filename) {
+  MappedFile file;
+#if WASP_HAS_MMAP
+  int fd = open(std::string{filename}.c_str(), O_RDONLY);
+  if (fd == -1) {
+    return nullopt;
+  }
+  struct stat st;
+  if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+    if (st.st_size == 0) {
+      // mmap doesn't allow zero-length mappings.
+      close(fd);
+      return file;
+    }
+
+    size_t size = st.st_size;
+    void* addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+      return nullopt;
+    }
+    file.data_ = SpanU8{static_cast<const u8*>(addr), size};
+    file.is_mapped_ = true;
+    file.Advise(file.data_, Advice::Sequential);
+    return file;
+  }
+  // Not a regular file (e.g. a pipe or /dev/stdin). Read from the descriptor
+  // that is already open; reopening it would block again or lose data.
+  auto optbuf = ReadAll(fd);
+  close(fd);
+#else
+  auto optbuf = ReadFile(filename);
+#endif
+  if (!optbuf) {
+    return nullopt;
+  }
+  file.buffer_ = std::move(*optbuf);
+  file.data_ = SpanU8{file.buffer_};
+  return file;
+}
+
 }  // namespace wasp
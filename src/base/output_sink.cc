@@ -0,0 +1,252 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/base/output_sink.h"
+
+#include <cassert>
+#include <cerrno>
+#include <cstdio>
+#include <string>
+#include <utility>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#endif
+
+namespace wasp {
+
+namespace {
+
+#if !defined(_WIN32)
+int OpenForWriting(const std::string& filename) {
+  return ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+}
+
+bool WriteAll(int fd, SpanU8 data) {
+  while (!data.empty()) {
+    auto written = ::write(fd, data.data(), data.size());
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    data.remove_prefix(written);
+  }
+  return true;
+}
+
+void CloseFile(int fd) {
+  ::close(fd);
+}
+#else
+int OpenForWriting(const std::string& filename) {
+  return ::_open(filename.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY,
+                 _S_IREAD | _S_IWRITE);
+}
+
+bool WriteAll(int fd, SpanU8 data) {
+  while (!data.empty()) {
+    auto size = static_cast<unsigned>(data.size());
+    auto written = ::_write(fd, data.data(), size);
+    if (written < 0) {
+      return false;
+    }
+    data.remove_prefix(written);
+  }
+  return true;
+}
+
+void CloseFile(int fd) {
+  ::_close(fd);
+}
+#endif
+
+}  // namespace
+
+// static
+constexpr size_t OutputSink::kChunkSize;
+
+OutputSink::OutputSink() : OutputSink{Kind::Memory} {}
+
+OutputSink::OutputSink(Kind kind, int fd) : kind_{kind}, fd_{fd} {}
+
+OutputSink::OutputSink(OutputSink&& other)
+    : kind_{other.kind_},
+      fd_{std::exchange(other.fd_, -1)},
+      owns_fd_{std::exchange(other.owns_fd_, false)},
+      failed_{other.failed_},
+      chunks_{std::move(other.chunks_)},
+      chunk_begin_{std::exchange(other.chunk_begin_, nullptr)},
+      pos_{std::exchange(other.pos_, nullptr)},
+      end_{std::exchange(other.end_, nullptr)},
+      size_before_chunk_{std::exchange(other.size_before_chunk_, 0)} {
+  ForgetScratch();
+}
+
+OutputSink& OutputSink::operator=(OutputSink&& other) {
+  if (this != &other) {
+    Close();
+    kind_ = other.kind_;
+    fd_ = std::exchange(other.fd_, -1);
+    owns_fd_ = std::exchange(other.owns_fd_, false);
+    failed_ = other.failed_;
+    chunks_ = std::move(other.chunks_);
+    chunk_begin_ = std::exchange(other.chunk_begin_, nullptr);
+    pos_ = std::exchange(other.pos_, nullptr);
+    end_ = std::exchange(other.end_, nullptr);
+    size_before_chunk_ = std::exchange(other.size_before_chunk_, 0);
+    ForgetScratch();
+  }
+  return *this;
+}
+
+OutputSink::~OutputSink() {
+  Close();
+}
+
+// static
+optional<OutputSink> OutputSink::OpenFile(string_view filename) {
+  int fd = OpenForWriting(std::string{filename});
+  if (fd < 0) {
+    return nullopt;
+  }
+  OutputSink sink{Kind::File, fd};
+  sink.owns_fd_ = true;
+  return sink;
+}
+
+// static
+OutputSink OutputSink::Stdout() {
+  std::fflush(stdout);
+  return OutputSink{Kind::File, 1};
+}
+
+// static
+OutputSink OutputSink::Counting() {
+  return OutputSink{Kind::Counting};
+}
+
+void OutputSink::Write(SpanU8 data) {
+  if (kind_ == Kind::Counting) {
+    size_before_chunk_ += data.size();
+    return;
+  } else if (kind_ == Kind::File && data.size() >= kChunkSize) {
+    // Too large to be worth copying into the chunk first.
+    Flush();
+    WriteToFile(data);
+    size_before_chunk_ += data.size();
+    return;
+  }
+
+  while (!data.empty()) {
+    if (pos_ == end_) {
+      NextChunk();
+    }
+    size_t count = std::min<size_t>(data.size(), end_ - pos_);
+    std::memcpy(pos_, data.data(), count);
+    pos_ += count;
+    data.remove_prefix(count);
+  }
+}
+
+void OutputSink::Write(const OutputSink& other) {
+  assert(other.kind_ == Kind::Memory);
+  size_t remaining = other.size();
+  for (const auto& chunk : other.chunks_) {
+    size_t count = std::min(remaining, kChunkSize);
+    Write(SpanU8{chunk.get(), count});
+    remaining -= count;
+  }
+}
+
+bool OutputSink::Flush() {
+  if (kind_ == Kind::File && pos_ != chunk_begin_) {
+    WriteToFile(SpanU8{chunk_begin_, static_cast<size_t>(pos_ - chunk_begin_)});
+    size_before_chunk_ += pos_ - chunk_begin_;
+    pos_ = chunk_begin_;
+  }
+  return !failed_;
+}
+
+Buffer OutputSink::ToBuffer() const {
+  assert(kind_ == Kind::Memory);
+  Buffer buffer;
+  buffer.reserve(size());
+  size_t remaining = size();
+  for (const auto& chunk : chunks_) {
+    size_t count = std::min(remaining, kChunkSize);
+    buffer.insert(buffer.end(), chunk.get(), chunk.get() + count);
+    remaining -= count;
+  }
+  return buffer;
+}
+
+void OutputSink::NextChunk() {
+  size_t used = pos_ - chunk_begin_;
+  switch (kind_) {
+    case Kind::Memory:
+      size_before_chunk_ += used;
+      chunks_.emplace_back(new u8[kChunkSize]);
+      break;
+
+    case Kind::File:
+      if (chunks_.empty()) {
+        chunks_.emplace_back(new u8[kChunkSize]);
+      } else {
+        WriteToFile(SpanU8{chunk_begin_, used});
+        size_before_chunk_ += used;
+      }
+      break;
+
+    case Kind::Counting:
+      size_before_chunk_ += used;
+      chunk_begin_ = pos_ = scratch_;
+      end_ = scratch_ + sizeof(scratch_);
+      return;
+  }
+  chunk_begin_ = pos_ = chunks_.back().get();
+  end_ = chunk_begin_ + kChunkSize;
+}
+
+void OutputSink::ForgetScratch() {
+  // The pointers refer to the moved-from sink's scratch space.
+  if (kind_ == Kind::Counting) {
+    size_before_chunk_ += pos_ - chunk_begin_;
+    chunk_begin_ = pos_ = end_ = nullptr;
+  }
+}
+
+void OutputSink::WriteToFile(SpanU8 data) {
+  if (!failed_ && !WriteAll(fd_, data)) {
+    failed_ = true;
+  }
+}
+
+void OutputSink::Close() {
+  Flush();
+  if (owns_fd_) {
+    CloseFile(fd_);
+    owns_fd_ = false;
+  }
+}
+
+}  // namespace wasp
@@ -16,6 +16,7 @@
 
 #include "wasp/binary/encoding.h"
 
+#include <array>
 #include <cassert>
 
 #include "wasp/base/features.h"
@@ -296,54 +297,346 @@ EncodedOpcode Opcode::Encode(::wasp::Opcode decoded) {
   }
 }
 
-// static
-optional<::wasp::Opcode> Opcode::Decode(u8 code, const Features& features) {
-  switch (code) {
-#define WASP_V(prefix, code, Name, str) \
-  case code:                            \
-    return ::wasp::Opcode::Name;
-#define WASP_FEATURE_V(prefix, code, Name, str, feature) \
-  case code:                                             \
-    if (features.feature##_enabled()) {                  \
-      return ::wasp::Opcode::Name;                       \
-    }                                                    \
-    break;
-#define WASP_PREFIX_V(...) /* Invalid. */
+namespace {
+
+// The immediates of each opcode, other than ImmediateKind::None.
+constexpr ImmediateKind GetImmediateKind(::wasp::Opcode opcode) {
+  using ::wasp::Opcode;
+  switch (opcode) {
+    case Opcode::End:
+      return ImmediateKind::End;
+
+    case Opcode::Else:
+      return ImmediateKind::Else;
+
+    case Opcode::Catch:
+      return ImmediateKind::Catch;
+
+    case Opcode::Delegate:
+      return ImmediateKind::Delegate;
+
+    case Opcode::CatchAll:
+      return ImmediateKind::CatchAll;
+
+    case Opcode::RefNull:
+    case Opcode::RttCanon:
+      return ImmediateKind::HeapType;
+
+    case Opcode::Block:
+    case Opcode::Loop:
+    case Opcode::If:
+    case Opcode::Try:
+      return ImmediateKind::BlockType;
+
+    case Opcode::DataDrop:
+      return ImmediateKind::DataIndex;
+
+    case Opcode::Throw:
+    case Opcode::Rethrow:
+    case Opcode::Br:
+    case Opcode::BrIf:
+    case Opcode::Call:
+    case Opcode::ReturnCall:
+    case Opcode::LocalGet:
+    case Opcode::LocalSet:
+    case Opcode::LocalTee:
+    case Opcode::GlobalGet:
+    case Opcode::GlobalSet:
+    case Opcode::TableGet:
+    case Opcode::TableSet:
+    case Opcode::RefFunc:
+    case Opcode::ElemDrop:
+    case Opcode::TableGrow:
+    case Opcode::TableSize:
+    case Opcode::TableFill:
+    case Opcode::BrOnNull:
+    case Opcode::StructNewWithRtt:
+    case Opcode::StructNewDefaultWithRtt:
+    case Opcode::ArrayNewWithRtt:
+    case Opcode::ArrayNewDefaultWithRtt:
+    case Opcode::ArrayGet:
+    case Opcode::ArrayGetS:
+    case Opcode::ArrayGetU:
+    case Opcode::ArraySet:
+    case Opcode::ArrayLen:
+      return ImmediateKind::Index;
+
+    case Opcode::FuncBind:
+      return ImmediateKind::FuncBind;
+
+    case Opcode::BrTable:
+      return ImmediateKind::BrTable;
+
+    case Opcode::CallIndirect:
+    case Opcode::ReturnCallIndirect:
+      return ImmediateKind::CallIndirect;
+
+    case Opcode::I32Load:
+    case Opcode::I64Load:
+    case Opcode::F32Load:
+    case Opcode::F64Load:
+    case Opcode::I32Load8S:
+    case Opcode::I32Load8U:
+    case Opcode::I32Load16S:
+    case Opcode::I32Load16U:
+    case Opcode::I64Load8S:
+    case Opcode::I64Load8U:
+    case Opcode::I64Load16S:
+    case Opcode::I64Load16U:
+    case Opcode::I64Load32S:
+    case Opcode::I64Load32U:
+    case Opcode::V128Load:
+    case Opcode::I32Store:
+    case Opcode::I64Store:
+    case Opcode::F32Store:
+    case Opcode::F64Store:
+    case Opcode::I32Store8:
+    case Opcode::I32Store16:
+    case Opcode::I64Store8:
+    case Opcode::I64Store16:
+    case Opcode::I64Store32:
+    case Opcode::V128Store:
+    case Opcode::V128Load8X8S:
+    case Opcode::V128Load8X8U:
+    case Opcode::V128Load16X4S:
+    case Opcode::V128Load16X4U:
+    case Opcode::V128Load32X2S:
+    case Opcode::V128Load32X2U:
+    case Opcode::V128Load8Splat:
+    case Opcode::V128Load16Splat:
+    case Opcode::V128Load32Splat:
+    case Opcode::V128Load64Splat:
+    case Opcode::V128Load32Zero:
+    case Opcode::V128Load64Zero:
+    case Opcode::MemoryAtomicNotify:
+    case Opcode::MemoryAtomicWait32:
+    case Opcode::MemoryAtomicWait64:
+    case Opcode::I32AtomicLoad:
+    case Opcode::I64AtomicLoad:
+    case Opcode::I32AtomicLoad8U:
+    case Opcode::I32AtomicLoad16U:
+    case Opcode::I64AtomicLoad8U:
+    case Opcode::I64AtomicLoad16U:
+    case Opcode::I64AtomicLoad32U:
+    case Opcode::I32AtomicStore:
+    case Opcode::I64AtomicStore:
+    case Opcode::I32AtomicStore8:
+    case Opcode::I32AtomicStore16:
+    case Opcode::I64AtomicStore8:
+    case Opcode::I64AtomicStore16:
+    case Opcode::I64AtomicStore32:
+    case Opcode::I32AtomicRmwAdd:
+    case Opcode::I64AtomicRmwAdd:
+    case Opcode::I32AtomicRmw8AddU:
+    case Opcode::I32AtomicRmw16AddU:
+    case Opcode::I64AtomicRmw8AddU:
+    case Opcode::I64AtomicRmw16AddU:
+    case Opcode::I64AtomicRmw32AddU:
+    case Opcode::I32AtomicRmwSub:
+    case Opcode::I64AtomicRmwSub:
+    case Opcode::I32AtomicRmw8SubU:
+    case Opcode::I32AtomicRmw16SubU:
+    case Opcode::I64AtomicRmw8SubU:
+    case Opcode::I64AtomicRmw16SubU:
+    case Opcode::I64AtomicRmw32SubU:
+    case Opcode::I32AtomicRmwAnd:
+    case Opcode::I64AtomicRmwAnd:
+    case Opcode::I32AtomicRmw8AndU:
+    case Opcode::I32AtomicRmw16AndU:
+    case Opcode::I64AtomicRmw8AndU:
+    case Opcode::I64AtomicRmw16AndU:
+    case Opcode::I64AtomicRmw32AndU:
+    case Opcode::I32AtomicRmwOr:
+    case Opcode::I64AtomicRmwOr:
+    case Opcode::I32AtomicRmw8OrU:
+    case Opcode::I32AtomicRmw16OrU:
+    case Opcode::I64AtomicRmw8OrU:
+    case Opcode::I64AtomicRmw16OrU:
+    case Opcode::I64AtomicRmw32OrU:
+    case Opcode::I32AtomicRmwXor:
+    case Opcode::I64AtomicRmwXor:
+    case Opcode::I32AtomicRmw8XorU:
+    case Opcode::I32AtomicRmw16XorU:
+    case Opcode::I64AtomicRmw8XorU:
+    case Opcode::I64AtomicRmw16XorU:
+    case Opcode::I64AtomicRmw32XorU:
+    case Opcode::I32AtomicRmwXchg:
+    case Opcode::I64AtomicRmwXchg:
+    case Opcode::I32AtomicRmw8XchgU:
+    case Opcode::I32AtomicRmw16XchgU:
+    case Opcode::I64AtomicRmw8XchgU:
+    case Opcode::I64AtomicRmw16XchgU:
+    case Opcode::I64AtomicRmw32XchgU:
+    case Opcode::I32AtomicRmwCmpxchg:
+    case Opcode::I64AtomicRmwCmpxchg:
+    case Opcode::I32AtomicRmw8CmpxchgU:
+    case Opcode::I32AtomicRmw16CmpxchgU:
+    case Opcode::I64AtomicRmw8CmpxchgU:
+    case Opcode::I64AtomicRmw16CmpxchgU:
+    case Opcode::I64AtomicRmw32CmpxchgU:
+      return ImmediateKind::MemArg;
+
+    case Opcode::V128Load8Lane:
+    case Opcode::V128Load16Lane:
+    case Opcode::V128Load32Lane:
+    case Opcode::V128Load64Lane:
+    case Opcode::V128Store8Lane:
+    case Opcode::V128Store16Lane:
+    case Opcode::V128Store32Lane:
+    case Opcode::V128Store64Lane:
+      return ImmediateKind::SimdMemoryLane;
+
+    case Opcode::MemorySize:
+    case Opcode::MemoryGrow:
+    case Opcode::MemoryFill:
+      return ImmediateKind::Reserved;
+
+    case Opcode::I32Const:
+      return ImmediateKind::S32;
+
+    case Opcode::I64Const:
+      return ImmediateKind::S64;
+
+    case Opcode::F32Const:
+      return ImmediateKind::F32;
+
+    case Opcode::F64Const:
+      return ImmediateKind::F64;
+
+    case Opcode::V128Const:
+      return ImmediateKind::V128;
+
+    case Opcode::MemoryInit:
+      return ImmediateKind::MemoryInit;
+
+    case Opcode::TableInit:
+      return ImmediateKind::TableInit;
+
+    case Opcode::MemoryCopy:
+      return ImmediateKind::MemoryCopy;
+
+    case Opcode::TableCopy:
+      return ImmediateKind::TableCopy;
+
+    case Opcode::I8X16Shuffle:
+      return ImmediateKind::Shuffle;
+
+    case Opcode::SelectT:
+      return ImmediateKind::Select;
+
+    case Opcode::I8X16ExtractLaneS:
+    case Opcode::I8X16ExtractLaneU:
+    case Opcode::I16X8ExtractLaneS:
+    case Opcode::I16X8ExtractLaneU:
+    case Opcode::I32X4ExtractLane:
+    case Opcode::I64X2ExtractLane:
+    case Opcode::F32X4ExtractLane:
+    case Opcode::F64X2ExtractLane:
+    case Opcode::I8X16ReplaceLane:
+    case Opcode::I16X8ReplaceLane:
+    case Opcode::I32X4ReplaceLane:
+    case Opcode::I64X2ReplaceLane:
+    case Opcode::F32X4ReplaceLane:
+    case Opcode::F64X2ReplaceLane:
+      return ImmediateKind::SimdLane;
+
+    case Opcode::Let:
+      return ImmediateKind::Let;
+
+    case Opcode::StructGet:
+    case Opcode::StructGetS:
+    case Opcode::StructGetU:
+    case Opcode::StructSet:
+      return ImmediateKind::StructField;
+
+    case Opcode::RttSub:
+      return ImmediateKind::RttSub;
+
+    case Opcode::RefTest:
+    case Opcode::RefCast:
+      return ImmediateKind::HeapType2;
+
+    case Opcode::BrOnCast:
+      return ImmediateKind::BrOnCast;
+
+    default:
+      return ImmediateKind::None;
+  }
+}
+
+// Maps the feature names used in opcode.inc to their bits.
+struct FeatureBits {
+#define WASP_V(enum_, variable, flag, default_) \
+  static constexpr Features::Bits variable = Features::enum_;
+#include "wasp/base/features.inc"
+#undef WASP_V
+};
+
+constexpr optional<OpcodeInfo> MakeOpcodeInfo(::wasp::Opcode opcode,
+                                              Features::Bits features) {
+  return OpcodeInfo{opcode, GetImmediateKind(opcode), features};
+}
+
+// Entries for unknown opcodes are nullopt.
+using OpcodeTable = std::array<optional<OpcodeInfo>, 256>;
+
+// Builds the table for the opcodes with prefix `table_prefix`, indexed by
+// code. The single-byte opcodes have prefix 0.
+constexpr OpcodeTable MakeOpcodeTable(u8 table_prefix) {
+  OpcodeTable table{};
+#define WASP_V(prefix, code, Name, str)                    \
+  if (table_prefix == prefix) {                            \
+    table[code] = MakeOpcodeInfo(::wasp::Opcode::Name, 0); \
+  }
+#define WASP_FEATURE_V(prefix, code, Name, str, feature)            \
+  if (table_prefix == prefix) {                                     \
+    table[code] =                                                   \
+        MakeOpcodeInfo(::wasp::Opcode::Name, FeatureBits::feature); \
+  }
+#define WASP_PREFIX_V(prefix, code, Name, str, feature) \
+  WASP_FEATURE_V(prefix, code, Name, str, feature)
 #include "wasp/base/inc/opcode.inc"
 #undef WASP_V
 #undef WASP_FEATURE_V
 #undef WASP_PREFIX_V
-    default:
-      break;
+  return table;
+}
+
+constexpr OpcodeTable kOpcodeTable = MakeOpcodeTable(0);
+
+// Indexed by prefix - Opcode::GcPrefix. Every prefixed opcode in opcode.inc
+// has a code less than 256.
+constexpr std::array<OpcodeTable, 4> kPrefixOpcodeTables = {{
+    MakeOpcodeTable(Opcode::GcPrefix),
+    MakeOpcodeTable(Opcode::MiscPrefix),
+    MakeOpcodeTable(Opcode::SimdPrefix),
+    MakeOpcodeTable(Opcode::ThreadsPrefix),
+}};
+
+optional<OpcodeInfo> CheckFeatures(const optional<OpcodeInfo>& info,
+                                   const Features& features) {
+  if (!info || (info->features & ~features.bits()) != 0) {
+    return nullopt;
   }
-  return nullopt;
+  return info;
 }
 
-constexpr u64 MakePrefixCode(u8 prefix, u32 code) {
-  return (u64{prefix} << 32) | code;
+}  // namespace
+
+// static
+optional<OpcodeInfo> Opcode::DecodeInfo(u8 code, const Features& features) {
+  return CheckFeatures(kOpcodeTable[code], features);
 }
 
 // static
-optional<::wasp::Opcode> Opcode::Decode(u8 prefix,
+optional<OpcodeInfo> Opcode::DecodeInfo(u8 prefix,
                                         u32 code,
                                         const Features& features) {
-  switch (MakePrefixCode(prefix, code)) {
-#define WASP_V(...) /* Invalid. */
-#define WASP_FEATURE_V(...) /* Invalid. */
-#define WASP_PREFIX_V(prefix, code, Name, str, feature) \
-  case MakePrefixCode(prefix, code):                    \
-    if (features.feature##_enabled()) {                 \
-      return ::wasp::Opcode::Name;                      \
-    }                                                   \
-    break;
-#include "wasp/base/inc/opcode.inc"
-#undef WASP_V
-#undef WASP_FEATURE_V
-#undef WASP_PREFIX_V
-    default:
-      break;
+  u32 table_index = u32{prefix} - GcPrefix;
+  if (table_index >= kPrefixOpcodeTables.size() || code >= 256) {
+    return nullopt;
   }
-  return nullopt;
+  return CheckFeatures(kPrefixOpcodeTables[table_index][code], features);
 }
 
 // static
@@ -0,0 +1,401 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/module_index.h"
+
+#include <iterator>
+
+#include "wasp/base/errors_nop.h"
+#include "wasp/base/features.h"
+#include "wasp/binary/encoding.h"
+#include "wasp/binary/name_section/sections.h"
+#include "wasp/binary/read.h"
+#include "wasp/binary/read/read_ctx.h"
+#include "wasp/binary/read/read_var_int.h"
+#include "wasp/binary/sections.h"
+#include "wasp/binary/write.h"
+
+namespace wasp::binary {
+
+namespace {
+
+constexpr u8 kIndexMagicBytes[] = {0, 'w', 'p', 'i'};
+constexpr SpanU8 kIndexMagic{kIndexMagicBytes};
+constexpr u32 kIndexVersion = 3;
+
+// Hashes the whole module, so any modification is detected. Byte-wise FNV-1a
+// was the slowest part of reading the index of a large module, so the module
+// is instead read 8 bytes at a time, in four independent lanes. Words are
+// read as little-endian, so the hash is stable across platforms and builds,
+// unlike absl::Hash.
+constexpr u64 kHashMul = 0x9e3779b97f4a7c15;
+
+u64 LoadU64(const u8* p) {
+  u64 value = 0;
+  for (int i = 0; i < 8; ++i) {
+    value |= u64{p[i]} << (i * 8);
+  }
+  return value;
+}
+
+u64 Mix(u64 hash, u64 word) {
+  hash = (hash ^ word) * kHashMul;
+  return hash ^ (hash >> 32);
+}
+
+u64 HashModule(SpanU8 data) {
+  u64 lanes[4] = {1, 2, 3, 4};
+  const u8* p = data.data();
+  size_t size = data.size();
+  for (; size >= 32; p += 32, size -= 32) {
+    for (int i = 0; i < 4; ++i) {
+      lanes[i] = Mix(lanes[i], LoadU64(p + i * 8));
+    }
+  }
+  u64 hash = Mix(0, data.size());
+  for (u64 lane : lanes) {
+    hash = Mix(hash, lane);
+  }
+  for (; size >= 8; p += 8, size -= 8) {
+    hash = Mix(hash, LoadU64(p));
+  }
+  u64 tail = 0;
+  for (size_t i = 0; i < size; ++i) {
+    tail |= u64{p[i]} << (i * 8);
+  }
+  return Mix(hash, tail);
+}
+
+// Records the span of each code entry, without reading its locals or body.
+void IndexCodes(SpanU8 data, ReadCtx& ctx, std::vector<SpanU8>& codes) {
+  auto count = ReadCount(&data, ctx);
+  if (!count) {
+    return;
+  }
+  codes.reserve(codes.size() + *count);
+  for (Index i = 0; i < *count; ++i) {
+    const u8* begin = data.data();
+    auto length = ReadLength(&data, ctx);
+    if (!length || !ReadBytes(&data, *length, ctx)) {
+      return;
+    }
+    codes.push_back(SpanU8{begin, static_cast<size_t>(data.data() - begin)});
+  }
+}
+
+void BuildNameToFunction(ModuleIndex& index) {
+  index.name_to_function.reserve(index.function_names.size());
+  for (const auto& pair : index.function_names) {
+    index.name_to_function.try_emplace(pair.second, pair.first);
+  }
+}
+
+void WriteU32(u32 value, Buffer& out) {
+  WriteVarInt(value, std::back_inserter(out));
+}
+
+void WriteU64(u64 value, Buffer& out) {
+  WriteVarInt(value, std::back_inserter(out));
+}
+
+// Spans are written as an offset into the module and a size. Both are u64,
+// since modules can be larger than 4GiB.
+void WriteSpan(SpanU8 span, SpanU8 module_data, Buffer& out) {
+  WriteU64(static_cast<u64>(span.data() - module_data.data()), out);
+  WriteU64(span.size(), out);
+}
+
+class IndexReader {
+ public:
+  IndexReader(SpanU8 data, SpanU8 module_data)
+      : data_{data}, module_data_{module_data}, ctx_{errors_} {}
+
+  bool empty() const { return data_.empty(); }
+
+  bool Magic() {
+    if (data_.size() < kIndexMagic.size() ||
+        data_.first(kIndexMagic.size()) != kIndexMagic) {
+      return false;
+    }
+    data_.remove_prefix(kIndexMagic.size());
+    return true;
+  }
+
+  optional<u32> U32() { return Value<u32>(); }
+  optional<u64> U64() { return Value<u64>(); }
+
+  // Reads a count, then calls `f` to read each element.
+  template <typename F>
+  bool Vector(F&& f) {
+    auto count = U32();
+    if (!count) {
+      return false;
+    }
+    for (u32 i = 0; i < *count; ++i) {
+      if (!f()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  optional<SpanU8> Span() {
+    auto offset = U64();
+    auto size = U64();
+    if (!offset || !size || *offset > module_data_.size() ||
+        *size > module_data_.size() - *offset) {
+      return nullopt;
+    }
+    return module_data_.subspan(*offset, *size);
+  }
+
+ private:
+  template <typename T>
+  optional<T> Value() {
+    auto value = ReadVarInt<T>(&data_, ctx_, "value");
+    if (!value) {
+      return nullopt;
+    }
+    return value->value();
+  }
+
+  SpanU8 data_;
+  SpanU8 module_data_;
+  ErrorsNop errors_;
+  ReadCtx ctx_;
+};
+
+}  // namespace
+
+Index ModuleIndex::GetImportCount(ExternalKind kind) const {
+  auto index = static_cast<size_t>(kind);
+  return index < import_counts.size() ? import_counts[index] : 0;
+}
+
+Index ModuleIndex::GetFunctionCount() const {
+  return static_cast<Index>(function_type_indexes.size());
+}
+
+optional<Index> ModuleIndex::GetFunctionTypeIndex(Index function_index) const {
+  if (function_index >= function_type_indexes.size()) {
+    return nullopt;
+  }
+  return function_type_indexes[function_index];
+}
+
+optional<SpanU8> ModuleIndex::GetSection(SectionId id) const {
+  for (const auto& section : sections) {
+    if (section.id == id) {
+      return section.data;
+    }
+  }
+  return nullopt;
+}
+
+optional<Index> ModuleIndex::FindFunction(string_view name) const {
+  auto iter = name_to_function.find(name);
+  if (iter == name_to_function.end()) {
+    return nullopt;
+  }
+  return iter->second;
+}
+
+OptAt<Code> ModuleIndex::GetCode(Index function_index, ReadCtx& ctx) const {
+  Index imported_count = GetImportCount(ExternalKind::Function);
+  if (function_index < imported_count ||
+      function_index - imported_count >= codes.size()) {
+    return nullopt;
+  }
+  SpanU8 data = codes[function_index - imported_count];
+  return Read<Code>(&data, ctx);
+}
+
+ModuleIndex BuildModuleIndex(const LazyModule& module) {
+  ModuleIndex index;
+  index.data = module.data;
+  // Read the sections with a module and context of our own, so building the
+  // index doesn't change the state of `module`, which may already have been
+  // read.
+  LazyModule copy{module.data, module.ctx.features, module.ctx.errors};
+  ReadCtx& ctx = copy.ctx;
+  for (auto section : copy.sections) {
+    if (section->is_known()) {
+      auto known = section->known();
+      index.sections.push_back(IndexedSection{known->id, known->data});
+      switch (known->id) {
+        case SectionId::Import:
+          for (auto import : ReadImportSection(known, ctx).sequence) {
+            auto kind = static_cast<size_t>(import->kind());
+            if (kind >= index.import_counts.size()) {
+              index.import_counts.resize(kind + 1);
+            }
+            index.import_counts[kind]++;
+            if (import->kind() == ExternalKind::Function) {
+              index.function_names.push_back(
+                  IndexNamePair{index.GetFunctionCount(), import->name});
+              index.function_type_indexes.push_back(import->index());
+            }
+          }
+          break;
+
+        case SectionId::Function:
+          for (auto function : ReadFunctionSection(known, ctx).sequence) {
+            index.function_type_indexes.push_back(function->type_index);
+          }
+          break;
+
+        case SectionId::Export:
+          for (auto export_ : ReadExportSection(known, ctx).sequence) {
+            if (export_->kind == ExternalKind::Function) {
+              index.function_names.push_back(
+                  IndexNamePair{export_->index, export_->name});
+            }
+          }
+          break;
+
+        case SectionId::Code:
+          IndexCodes(known->data, ctx, index.codes);
+          break;
+
+        default:
+          break;
+      }
+    } else if (section->is_custom()) {
+      auto custom = section->custom();
+      index.sections.push_back(IndexedSection{SectionId::Custom, custom->data});
+      if (*custom->name == "name") {
+        for (auto subsection : ReadNameSection(custom, ctx)) {
+          if (subsection->id == NameSubsectionId::FunctionNames) {
+            for (auto name_assoc :
+                 ReadFunctionNamesSubsection(*subsection, ctx).sequence) {
+              index.function_names.push_back(
+                  IndexNamePair{name_assoc->index, name_assoc->name});
+            }
+          }
+        }
+      }
+    }
+  }
+  BuildNameToFunction(index);
+  return index;
+}
+
+void WriteModuleIndex(const ModuleIndex& index, Buffer& out) {
+  const SpanU8 module_data = index.data;
+  out.insert(out.end(), kIndexMagic.begin(), kIndexMagic.end());
+  WriteU32(kIndexVersion, out);
+  WriteU64(module_data.size(), out);
+  WriteU64(HashModule(module_data), out);
+
+  WriteU32(static_cast<u32>(index.sections.size()), out);
+  for (const auto& section : index.sections) {
+    WriteU32(encoding::SectionId::Encode(section.id), out);
+    WriteSpan(section.data, module_data, out);
+  }
+
+  WriteU32(static_cast<u32>(index.import_counts.size()), out);
+  for (auto count : index.import_counts) {
+    WriteU32(count, out);
+  }
+
+  WriteU32(static_cast<u32>(index.function_type_indexes.size()), out);
+  for (auto type_index : index.function_type_indexes) {
+    WriteU32(type_index, out);
+  }
+
+  WriteU32(static_cast<u32>(index.codes.size()), out);
+  for (auto code : index.codes) {
+    WriteSpan(code, module_data, out);
+  }
+
+  WriteU32(static_cast<u32>(index.function_names.size()), out);
+  for (const auto& pair : index.function_names) {
+    WriteU32(pair.first, out);
+    WriteSpan(SpanU8{reinterpret_cast<const u8*>(pair.second.data()),
+                     pair.second.size()},
+              module_data, out);
+  }
+}
+
+optional<ModuleIndex> ReadModuleIndex(SpanU8 index_data, SpanU8 module_data) {
+  IndexReader reader{index_data, module_data};
+  if (!reader.Magic() || reader.U32() != kIndexVersion ||
+      reader.U64() != module_data.size() ||
+      reader.U64() != HashModule(module_data)) {
+    return nullopt;
+  }
+
+  Features features;
+  features.EnableAll();
+  ModuleIndex index;
+  index.data = module_data;
+  bool ok =
+      reader.Vector([&]() {
+        auto encoded_id = reader.U32();
+        auto data = reader.Span();
+        if (!encoded_id || !data) {
+          return false;
+        }
+        auto id = encoding::SectionId::Decode(*encoded_id, features);
+        if (!id) {
+          return false;
+        }
+        index.sections.push_back(IndexedSection{*id, *data});
+        return true;
+      }) &&
+      reader.Vector([&]() {
+        auto count = reader.U32();
+        if (!count) {
+          return false;
+        }
+        index.import_counts.push_back(*count);
+        return true;
+      }) &&
+      reader.Vector([&]() {
+        auto type_index = reader.U32();
+        if (!type_index) {
+          return false;
+        }
+        index.function_type_indexes.push_back(*type_index);
+        return true;
+      }) &&
+      reader.Vector([&]() {
+        auto code = reader.Span();
+        if (!code) {
+          return false;
+        }
+        index.codes.push_back(*code);
+        return true;
+      }) &&
+      reader.Vector([&]() {
+        auto function_index = reader.U32();
+        auto name = reader.Span();
+        if (!function_index || !name) {
+          return false;
+        }
+        index.function_names.push_back(
+            IndexNamePair{*function_index, ToStringView(*name)});
+        return true;
+      });
+
+  if (!ok || !reader.empty()) {
+    return nullopt;
+  }
+  BuildNameToFunction(index);
+  return index;
+}
+
+}  // namespace wasp::binary
@@ -0,0 +1,614 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/packed_expression.h"
+
+#include <cassert>
+#include <cstring>
+
+#include "wasp/base/macros.h"
+#include "wasp/binary/read/read_ctx.h"
+
+namespace wasp::binary {
+
+namespace {
+
+constexpr u32 kNoLocation = ~u32{0};
+
+// Values of PackedInstruction::tag for BlockType and HeapType immediates.
+enum : u8 {
+  kTagVoid,
+  kTagIndex,
+  kTagNumericType,
+  kTagReferenceKind,
+  kTagHeapKind,
+  kTagOther,  // Stored unpacked in `others_`.
+};
+
+u64 Pack2(u32 lo, u32 hi) {
+  return u64{lo} | (u64{hi} << 32);
+}
+
+u32 Lo(u64 bits) {
+  return static_cast<u32>(bits);
+}
+
+u32 Hi(u64 bits) {
+  return static_cast<u32>(bits >> 32);
+}
+
+template <typename T>
+u64 ToBits(T value) {
+  static_assert(sizeof(T) <= sizeof(u64));
+  u64 bits = 0;
+  memcpy(&bits, &value, sizeof(value));
+  return bits;
+}
+
+template <typename T>
+T FromBits(u64 bits) {
+  T value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+}  // namespace
+
+PackedExpression::PackedExpression(SpanU8 data) : data_{data} {}
+
+PackedExpression::PackedExpression(const InstructionList& instructions) {
+  reserve(instructions.size());
+  for (auto&& instruction : instructions) {
+    push_back(instruction);
+  }
+}
+
+void PackedExpression::push_back(const At<Instruction>& value) {
+  Location loc = value.loc();
+  const At<Opcode>& opcode = value->opcode;
+  switch (value->kind()) {
+    case InstructionKind::None:
+      return push_back(loc, opcode);
+
+    case InstructionKind::S32:
+      return push_back(loc, opcode, value->s32_immediate());
+
+    case InstructionKind::S64:
+      return push_back(loc, opcode, value->s64_immediate());
+
+    case InstructionKind::F32:
+      return push_back(loc, opcode, value->f32_immediate());
+
+    case InstructionKind::F64:
+      return push_back(loc, opcode, value->f64_immediate());
+
+    case InstructionKind::V128:
+      return push_back(loc, opcode, value->v128_immediate());
+
+    case InstructionKind::Index:
+      return push_back(loc, opcode, value->index_immediate());
+
+    case InstructionKind::BlockType:
+      return push_back(loc, opcode, value->block_type_immediate());
+
+    case InstructionKind::BrOnCast:
+      return push_back(loc, opcode, value->br_on_cast_immediate());
+
+    case InstructionKind::BrTable:
+      return push_back(loc, opcode, value->br_table_immediate());
+
+    case InstructionKind::CallIndirect:
+      return push_back(loc, opcode, value->call_indirect_immediate());
+
+    case InstructionKind::Copy:
+      return push_back(loc, opcode, value->copy_immediate());
+
+    case InstructionKind::FuncBind:
+      return push_back(loc, opcode, value->func_bind_immediate());
+
+    case InstructionKind::HeapType:
+      return push_back(loc, opcode, value->heap_type_immediate());
+
+    case InstructionKind::HeapType2:
+      return push_back(loc, opcode, value->heap_type_2_immediate());
+
+    case InstructionKind::Init:
+      return push_back(loc, opcode, value->init_immediate());
+
+    case InstructionKind::Let:
+      return push_back(loc, opcode, value->let_immediate());
+
+    case InstructionKind::MemArg:
+      return push_back(loc, opcode, value->mem_arg_immediate());
+
+    case InstructionKind::RttSub:
+      return push_back(loc, opcode, value->rtt_sub_immediate());
+
+    case InstructionKind::Select:
+      return push_back(loc, opcode, value->select_immediate());
+
+    case InstructionKind::Shuffle:
+      return push_back(loc, opcode, value->shuffle_immediate());
+
+    case InstructionKind::SimdLane:
+      return push_back(loc, opcode, value->simd_lane_immediate());
+
+    case InstructionKind::SimdMemoryLane:
+      return push_back(loc, opcode, value->simd_memory_lane_immediate());
+
+    case InstructionKind::StructField:
+      return push_back(loc, opcode, value->struct_field_immediate());
+  }
+}
+
+void PackedExpression::push_back(Location loc, At<Opcode> opcode) {
+  PackedInstruction packed = Begin(loc, *opcode);
+  packed.kind = static_cast<u8>(InstructionKind::None);
+  instructions_.push_back(packed);
+}
+
+template <typename T>
+void PackedExpression::push_back(Location loc,
+                                 At<Opcode> opcode,
+                                 const At<T>& immediate) {
+  PackedInstruction packed = Begin(loc, *opcode);
+  if (!Pack(packed, immediate)) {
+    packed.tag = kTagOther;
+    packed.immediate = others_.size();
+    others_.push_back(At{loc, Instruction{opcode, immediate}});
+  }
+  instructions_.push_back(packed);
+}
+
+template void PackedExpression::push_back(Location,
+                                          At<Opcode>,
+                                          const At<s32>&);
+template void PackedExpression::push_back(Location,
+                                          At<Opcode>,
+                                          const At<s64>&);
+template void PackedExpression::push_back(Location,
+                                          At<Opcode>,
+                                          const At<f32>&);
+template void PackedExpression::push_back(Location,
+                                          At<Opcode>,
+                                          const At<f64>&);
+template void PackedExpression::push_back(Location,
+                                          At<Opcode>,
+                                          const At<v128>&);
+template void PackedExpression::push_back(Location,
+                                          At<Opcode>,
+                                          const At<Index>&);
+template void PackedExpression::push_back(Location,
+                                          At<Opcode>,
+                                          const At<BlockType>&);
+template void PackedExpression::push_back(Location,
+                                          At<Opcode>,
+                                          const At<BrOnCastImmediate>&);
+template void PackedExpression::push_back(Location,
+                                          At<Opcode>,
+                                          const At<BrTableImmediate>&);
+template void PackedExpression::push_back(Location,
+                                          At<Opcode>,
+                                          const At<CallIndirectImmediate>&);
+template void PackedExpression::push_back(Location,
+                                          At<Opcode>,
+                                          const At<CopyImmediate>&);
+template void PackedExpression::push_back(Location,
+                                          At<Opcode>,
+                                          const At<FuncBindImmediate>&);
+template void PackedExpression::push_back(Location,
+                                          At<Opcode>,
+                                          const At<HeapType>&);
+template void PackedExpression::push_back(Location,
+                                          At<Opcode>,
+                                          const At<HeapType2Immediate>&);
+template void PackedExpression::push_back(Location,
+                                          At<Opcode>,
+                                          const At<InitImmediate>&);
+template void PackedExpression::push_back(Location,
+                                          At<Opcode>,
+                                          const At<LetImmediate>&);
+template void PackedExpression::push_back(Location,
+                                          At<Opcode>,
+                                          const At<MemArgImmediate>&);
+template void PackedExpression::push_back(Location,
+                                          At<Opcode>,
+                                          const At<RttSubImmediate>&);
+template void PackedExpression::push_back(Location,
+                                          At<Opcode>,
+                                          const At<SelectImmediate>&);
+template void PackedExpression::push_back(Location,
+                                          At<Opcode>,
+                                          const At<ShuffleImmediate>&);
+template void PackedExpression::push_back(Location,
+                                          At<Opcode>,
+                                          const At<SimdLaneImmediate>&);
+template void PackedExpression::push_back(Location,
+                                          At<Opcode>,
+                                          const At<SimdMemoryLaneImmediate>&);
+template void PackedExpression::push_back(Location,
+                                          At<Opcode>,
+                                          const At<StructFieldImmediate>&);
+
+PackedInstruction PackedExpression::Begin(Location loc, Opcode opcode) const {
+  assert(static_cast<u32>(opcode) <= 0xffff);
+  PackedInstruction packed{};
+  packed.opcode = static_cast<u16>(opcode);
+
+  // Only keep the location if this instruction directly follows the previous
+  // one in `data_`, so the start of each instruction is the end of the
+  // previous one.
+  packed.end = kNoLocation;
+  if (!data_.empty() && loc.data() != nullptr) {
+    u32 begin = instructions_.empty() ? 0 : instructions_.back().end;
+    if (begin != kNoLocation && loc.begin() == data_.begin() + begin &&
+        loc.end() <= data_.end()) {
+      packed.end = static_cast<u32>(loc.end() - data_.begin());
+    }
+  }
+  return packed;
+}
+
+bool PackedExpression::Pack(PackedInstruction& packed, const At<s32>& value) {
+  packed.kind = static_cast<u8>(InstructionKind::S32);
+  packed.immediate = ToBits(value.value());
+  return true;
+}
+
+bool PackedExpression::Pack(PackedInstruction& packed, const At<s64>& value) {
+  packed.kind = static_cast<u8>(InstructionKind::S64);
+  packed.immediate = ToBits(value.value());
+  return true;
+}
+
+bool PackedExpression::Pack(PackedInstruction& packed, const At<f32>& value) {
+  packed.kind = static_cast<u8>(InstructionKind::F32);
+  packed.immediate = ToBits(value.value());
+  return true;
+}
+
+bool PackedExpression::Pack(PackedInstruction& packed, const At<f64>& value) {
+  packed.kind = static_cast<u8>(InstructionKind::F64);
+  packed.immediate = ToBits(value.value());
+  return true;
+}
+
+bool PackedExpression::Pack(PackedInstruction& packed, const At<v128>& value) {
+  packed.kind = static_cast<u8>(InstructionKind::V128);
+  packed.immediate = v128s_.size();
+  v128s_.push_back(value);
+  return true;
+}
+
+bool PackedExpression::Pack(PackedInstruction& packed, const At<Index>& value) {
+  packed.kind = static_cast<u8>(InstructionKind::Index);
+  packed.immediate = value;
+  return true;
+}
+
+bool PackedExpression::Pack(PackedInstruction& packed,
+                            const At<BlockType>& block_type) {
+  packed.kind = static_cast<u8>(InstructionKind::BlockType);
+  if (block_type->is_void()) {
+    packed.tag = kTagVoid;
+  } else if (block_type->is_index()) {
+    packed.tag = kTagIndex;
+    packed.immediate = block_type->index();
+  } else if (block_type->value_type()->is_numeric_type()) {
+    packed.tag = kTagNumericType;
+    packed.immediate =
+        static_cast<u8>(*block_type->value_type()->numeric_type());
+  } else if (block_type->value_type()->is_reference_type() &&
+             block_type->value_type()->reference_type()->is_reference_kind()) {
+    packed.tag = kTagReferenceKind;
+    packed.immediate = static_cast<u8>(
+        *block_type->value_type()->reference_type()->reference_kind());
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool PackedExpression::Pack(PackedInstruction& packed,
+                            const At<BrOnCastImmediate>&) {
+  packed.kind = static_cast<u8>(InstructionKind::BrOnCast);
+  return false;
+}
+
+bool PackedExpression::Pack(PackedInstruction& packed,
+                            const At<BrTableImmediate>& immediate) {
+  packed.kind = static_cast<u8>(InstructionKind::BrTable);
+  packed.immediate = Pack2(static_cast<u32>(br_table_targets_.size()),
+                           static_cast<u32>(immediate->targets.size()));
+  for (auto&& target : immediate->targets) {
+    br_table_targets_.push_back(target);
+  }
+  br_table_targets_.push_back(immediate->default_target);
+  return true;
+}
+
+bool PackedExpression::Pack(PackedInstruction& packed,
+                            const At<CallIndirectImmediate>& immediate) {
+  packed.kind = static_cast<u8>(InstructionKind::CallIndirect);
+  packed.immediate = Pack2(immediate->index, immediate->table_index);
+  return true;
+}
+
+bool PackedExpression::Pack(PackedInstruction& packed,
+                            const At<CopyImmediate>& immediate) {
+  packed.kind = static_cast<u8>(InstructionKind::Copy);
+  packed.immediate = Pack2(immediate->dst_index, immediate->src_index);
+  return true;
+}
+
+bool PackedExpression::Pack(PackedInstruction& packed,
+                            const At<FuncBindImmediate>& immediate) {
+  packed.kind = static_cast<u8>(InstructionKind::FuncBind);
+  packed.immediate = immediate->index;
+  return true;
+}
+
+bool PackedExpression::Pack(PackedInstruction& packed,
+                            const At<HeapType>& heap_type) {
+  packed.kind = static_cast<u8>(InstructionKind::HeapType);
+  if (heap_type->is_heap_kind()) {
+    packed.tag = kTagHeapKind;
+    packed.immediate = static_cast<u8>(*heap_type->heap_kind());
+  } else {
+    packed.tag = kTagIndex;
+    packed.immediate = heap_type->index();
+  }
+  return true;
+}
+
+bool PackedExpression::Pack(PackedInstruction& packed,
+                            const At<HeapType2Immediate>&) {
+  packed.kind = static_cast<u8>(InstructionKind::HeapType2);
+  return false;
+}
+
+bool PackedExpression::Pack(PackedInstruction& packed,
+                            const At<InitImmediate>& immediate) {
+  packed.kind = static_cast<u8>(InstructionKind::Init);
+  packed.immediate = Pack2(immediate->segment_index, immediate->dst_index);
+  return true;
+}
+
+bool PackedExpression::Pack(PackedInstruction& packed,
+                            const At<LetImmediate>&) {
+  packed.kind = static_cast<u8>(InstructionKind::Let);
+  return false;
+}
+
+bool PackedExpression::Pack(PackedInstruction& packed,
+                            const At<MemArgImmediate>& immediate) {
+  packed.kind = static_cast<u8>(InstructionKind::MemArg);
+  packed.immediate = Pack2(immediate->align_log2, immediate->offset);
+  return true;
+}
+
+bool PackedExpression::Pack(PackedInstruction& packed,
+                            const At<RttSubImmediate>&) {
+  packed.kind = static_cast<u8>(InstructionKind::RttSub);
+  return false;
+}
+
+bool PackedExpression::Pack(PackedInstruction& packed,
+                            const At<SelectImmediate>& immediate) {
+  packed.kind = static_cast<u8>(InstructionKind::Select);
+  packed.immediate = Pack2(static_cast<u32>(select_types_.size()),
+                           static_cast<u32>(immediate->size()));
+  select_types_.insert(select_types_.end(), immediate->begin(),
+                       immediate->end());
+  return true;
+}
+
+bool PackedExpression::Pack(PackedInstruction& packed,
+                            const At<ShuffleImmediate>& immediate) {
+  packed.kind = static_cast<u8>(InstructionKind::Shuffle);
+  packed.immediate = shuffles_.size();
+  shuffles_.push_back(immediate);
+  return true;
+}
+
+bool PackedExpression::Pack(PackedInstruction& packed,
+                            const At<SimdLaneImmediate>& immediate) {
+  packed.kind = static_cast<u8>(InstructionKind::SimdLane);
+  packed.immediate = immediate;
+  return true;
+}
+
+bool PackedExpression::Pack(PackedInstruction& packed,
+                            const At<SimdMemoryLaneImmediate>& immediate) {
+  packed.kind = static_cast<u8>(InstructionKind::SimdMemoryLane);
+  packed.tag = immediate->lane;
+  packed.immediate =
+      Pack2(immediate->memarg.align_log2, immediate->memarg.offset);
+  return true;
+}
+
+bool PackedExpression::Pack(PackedInstruction& packed,
+                            const At<StructFieldImmediate>& immediate) {
+  packed.kind = static_cast<u8>(InstructionKind::StructField);
+  packed.immediate = Pack2(immediate->struct_, immediate->field);
+  return true;
+}
+
+void PackedExpression::clear() {
+  instructions_.clear();
+  br_table_targets_.clear();
+  v128s_.clear();
+  shuffles_.clear();
+  select_types_.clear();
+  others_.clear();
+}
+
+void PackedExpression::reserve(size_t size) {
+  instructions_.reserve(size);
+}
+
+Opcode PackedExpression::opcode(size_t index) const {
+  return static_cast<Opcode>(instructions_[index].opcode);
+}
+
+Location PackedExpression::loc(size_t index) const {
+  u32 end = instructions_[index].end;
+  if (end == kNoLocation) {
+    return {};
+  }
+  u32 begin = index == 0 ? 0 : instructions_[index - 1].end;
+  return Location{data_.begin() + begin, end - begin};
+}
+
+At<Instruction> PackedExpression::operator[](size_t index) const {
+  const PackedInstruction& packed = instructions_[index];
+  if (packed.kind == static_cast<u8>(InstructionKind::BlockType) &&
+      packed.tag == kTagOther) {
+    return others_[packed.immediate];
+  }
+
+  Location loc = this->loc(index);
+  At<Opcode> opcode{loc, static_cast<Opcode>(packed.opcode)};
+  u64 bits = packed.immediate;
+
+  auto make = [&](auto&& immediate) {
+    return At{loc, Instruction{opcode, At{loc, immediate}}};
+  };
+
+  switch (static_cast<InstructionKind>(packed.kind)) {
+    case InstructionKind::None:
+      return At{loc, Instruction{opcode}};
+
+    case InstructionKind::S32:
+      return make(FromBits<s32>(bits));
+
+    case InstructionKind::S64:
+      return make(FromBits<s64>(bits));
+
+    case InstructionKind::F32:
+      return make(FromBits<f32>(bits));
+
+    case InstructionKind::F64:
+      return make(FromBits<f64>(bits));
+
+    case InstructionKind::V128:
+      return make(v128s_[bits]);
+
+    case InstructionKind::Index:
+      return make(Index{Lo(bits)});
+
+    case InstructionKind::BlockType:
+      switch (packed.tag) {
+        case kTagVoid:
+          return make(BlockType{At{loc, VoidType{}}});
+
+        case kTagIndex:
+          return make(BlockType{At{loc, Index{Lo(bits)}}});
+
+        case kTagNumericType:
+          return make(BlockType{At{
+              loc, ValueType{At{loc, static_cast<NumericType>(bits)}}}});
+
+        case kTagReferenceKind:
+          return make(BlockType{
+              At{loc, ValueType{At{
+                          loc, ReferenceType{At{
+                                   loc, static_cast<ReferenceKind>(bits)}}}}}});
+
+        default:
+          WASP_UNREACHABLE();
+      }
+
+    case InstructionKind::BrTable: {
+      u32 offset = Lo(bits), count = Hi(bits);
+      IndexList targets;
+      targets.reserve(count);
+      for (u32 i = 0; i < count; ++i) {
+        targets.push_back(At{loc, br_table_targets_[offset + i]});
+      }
+      return make(BrTableImmediate{
+          std::move(targets), At{loc, br_table_targets_[offset + count]}});
+    }
+
+    case InstructionKind::CallIndirect:
+      return make(CallIndirectImmediate{At{loc, Index{Lo(bits)}},
+                                        At{loc, Index{Hi(bits)}}});
+
+    case InstructionKind::Copy:
+      return make(
+          CopyImmediate{At{loc, Index{Lo(bits)}}, At{loc, Index{Hi(bits)}}});
+
+    case InstructionKind::Init:
+      return make(
+          InitImmediate{At{loc, Index{Lo(bits)}}, At{loc, Index{Hi(bits)}}});
+
+    case InstructionKind::MemArg:
+      return make(MemArgImmediate{At{loc, Lo(bits)}, At{loc, Hi(bits)}});
+
+    case InstructionKind::HeapType:
+      if (packed.tag == kTagHeapKind) {
+        return make(HeapType{At{loc, static_cast<HeapKind>(bits)}});
+      } else {
+        return make(HeapType{At{loc, Index{Lo(bits)}}});
+      }
+
+    case InstructionKind::Select: {
+      auto first = select_types_.begin() + Lo(bits);
+      return make(SelectImmediate(first, first + Hi(bits)));
+    }
+
+    case InstructionKind::Shuffle:
+      return make(shuffles_[bits]);
+
+    case InstructionKind::SimdLane:
+      return make(static_cast<SimdLaneImmediate>(bits));
+
+    case InstructionKind::SimdMemoryLane:
+      return make(SimdMemoryLaneImmediate{
+          MemArgImmediate{At{loc, Lo(bits)}, At{loc, Hi(bits)}},
+          At{loc, packed.tag}});
+
+    case InstructionKind::FuncBind:
+      return make(FuncBindImmediate{At{loc, Index{Lo(bits)}}});
+
+    case InstructionKind::StructField:
+      return make(StructFieldImmediate{At{loc, Index{Lo(bits)}},
+                                       At{loc, Index{Hi(bits)}}});
+
+    case InstructionKind::Let:
+    case InstructionKind::BrOnCast:
+    case InstructionKind::HeapType2:
+    case InstructionKind::RttSub:
+      return others_[bits];
+
+    default:
+      WASP_UNREACHABLE();
+  }
+}
+
+PackedExpression ReadPackedExpression(SpanU8 data, ReadCtx& ctx) {
+  PackedExpression result{data};
+  ctx.seen_final_end = false;
+  while (!data.empty() && ReadPackedInstruction(&data, ctx, result)) {
+  }
+  return result;
+}
+
+PackedExpression ReadPackedExpression(Expression expr, ReadCtx& ctx) {
+  return ReadPackedExpression(expr.data, ctx);
+}
+
+}  // namespace wasp::binary
@@ -18,6 +18,7 @@
 
 #include <cassert>
 #include <limits>
+#include <utility>
 
 #include "wasp/base/errors.h"
 #include "wasp/base/errors_context_guard.h"
@@ -27,6 +28,7 @@
 #include "wasp/base/utf8.h"
 #include "wasp/binary/encoding.h"
 #include "wasp/binary/formatters.h"
+#include "wasp/binary/packed_expression.h"
 #include "wasp/binary/read/location_guard.h"
 #include "wasp/binary/read/macros.h"
 #include "wasp/binary/read/read_var_int.h"
@@ -570,9 +572,40 @@ bool RequireDataCountSection(ReadCtx& ctx, const At<Opcode>& opcode) {
   return true;
 }
 
-OptAt<Instruction> Read(SpanU8* data, ReadCtx& ctx, ReadTag<Instruction>) {
+// Reads an opcode along with the kind of its immediates, so Read<Instruction>
+// doesn't have to look it up again.
+OptAt<encoding::OpcodeInfo> ReadOpcodeInfo(SpanU8* data, ReadCtx& ctx) {
+  ErrorsContextGuard error_guard{ctx.errors, *data, "opcode"};
+  LocationGuard guard{data};
+  WASP_TRY_READ(val, Read<u8>(data, ctx));
+
+  if (encoding::Opcode::IsPrefixByte(*val, ctx.features)) {
+    WASP_TRY_READ(code, Read<u32>(data, ctx));
+    auto decoded = encoding::Opcode::DecodeInfo(val, code, ctx.features);
+    if (!decoded) {
+      ctx.errors.OnError(guard.range(data),
+                         concat("Unknown opcode: ", val, " ", code));
+      return nullopt;
+    }
+    return At{guard.range(data), *decoded};
+  } else {
+    auto decoded = encoding::Opcode::DecodeInfo(val, ctx.features);
+    if (!decoded) {
+      ctx.errors.OnError(val.loc(), concat("Unknown opcode: ", *val));
+      return nullopt;
+    }
+    return At{val.loc(), *decoded};
+  }
+}
+
+// Reads an instruction, passing its location, opcode and immediate (if any) to
+// `emit`. This is shared by Read<Instruction> and ReadPackedInstruction, so
+// the latter can pack the immediates without first building an Instruction.
+template <typename T, typename Emit>
+optional<T> ReadInstruction(SpanU8* data, ReadCtx& ctx, Emit&& emit) {
   LocationGuard guard{data};
-  WASP_TRY_READ(opcode, Read<Opcode>(data, ctx));
+  WASP_TRY_READ(info, ReadOpcodeInfo(data, ctx));
+  At<Opcode> opcode{info.loc(), info->opcode};
 
   if (ctx.seen_final_end) {
     ctx.errors.OnError(opcode.loc(), concat("Unexpected ", *opcode,
@@ -580,360 +613,14 @@ OptAt<Instruction> Read(SpanU8* data, ReadCtx& ctx, ReadTag<Instruction>) {
     return nullopt;
   }
 
-  switch (opcode) {
+  switch (info->immediate_kind) {
     // No immediates:
-    case Opcode::Unreachable:
-    case Opcode::Nop:
-    case Opcode::Return:
-    case Opcode::Drop:
-    case Opcode::Select:
-    case Opcode::I32Eqz:
-    case Opcode::I32Eq:
-    case Opcode::I32Ne:
-    case Opcode::I32LtS:
-    case Opcode::I32LeS:
-    case Opcode::I32LtU:
-    case Opcode::I32LeU:
-    case Opcode::I32GtS:
-    case Opcode::I32GeS:
-    case Opcode::I32GtU:
-    case Opcode::I32GeU:
-    case Opcode::I64Eqz:
-    case Opcode::I64Eq:
-    case Opcode::I64Ne:
-    case Opcode::I64LtS:
-    case Opcode::I64LeS:
-    case Opcode::I64LtU:
-    case Opcode::I64LeU:
-    case Opcode::I64GtS:
-    case Opcode::I64GeS:
-    case Opcode::I64GtU:
-    case Opcode::I64GeU:
-    case Opcode::F32Eq:
-    case Opcode::F32Ne:
-    case Opcode::F32Lt:
-    case Opcode::F32Le:
-    case Opcode::F32Gt:
-    case Opcode::F32Ge:
-    case Opcode::F64Eq:
-    case Opcode::F64Ne:
-    case Opcode::F64Lt:
-    case Opcode::F64Le:
-    case Opcode::F64Gt:
-    case Opcode::F64Ge:
-    case Opcode::I32Clz:
-    case Opcode::I32Ctz:
-    case Opcode::I32Popcnt:
-    case Opcode::I32Add:
-    case Opcode::I32Sub:
-    case Opcode::I32Mul:
-    case Opcode::I32DivS:
-    case Opcode::I32DivU:
-    case Opcode::I32RemS:
-    case Opcode::I32RemU:
-    case Opcode::I32And:
-    case Opcode::I32Or:
-    case Opcode::I32Xor:
-    case Opcode::I32Shl:
-    case Opcode::I32ShrS:
-    case Opcode::I32ShrU:
-    case Opcode::I32Rotl:
-    case Opcode::I32Rotr:
-    case Opcode::I64Clz:
-    case Opcode::I64Ctz:
-    case Opcode::I64Popcnt:
-    case Opcode::I64Add:
-    case Opcode::I64Sub:
-    case Opcode::I64Mul:
-    case Opcode::I64DivS:
-    case Opcode::I64DivU:
-    case Opcode::I64RemS:
-    case Opcode::I64RemU:
-    case Opcode::I64And:
-    case Opcode::I64Or:
-    case Opcode::I64Xor:
-    case Opcode::I64Shl:
-    case Opcode::I64ShrS:
-    case Opcode::I64ShrU:
-    case Opcode::I64Rotl:
-    case Opcode::I64Rotr:
-    case Opcode::F32Abs:
-    case Opcode::F32Neg:
-    case Opcode::F32Ceil:
-    case Opcode::F32Floor:
-    case Opcode::F32Trunc:
-    case Opcode::F32Nearest:
-    case Opcode::F32Sqrt:
-    case Opcode::F32Add:
-    case Opcode::F32Sub:
-    case Opcode::F32Mul:
-    case Opcode::F32Div:
-    case Opcode::F32Min:
-    case Opcode::F32Max:
-    case Opcode::F32Copysign:
-    case Opcode::F64Abs:
-    case Opcode::F64Neg:
-    case Opcode::F64Ceil:
-    case Opcode::F64Floor:
-    case Opcode::F64Trunc:
-    case Opcode::F64Nearest:
-    case Opcode::F64Sqrt:
-    case Opcode::F64Add:
-    case Opcode::F64Sub:
-    case Opcode::F64Mul:
-    case Opcode::F64Div:
-    case Opcode::F64Min:
-    case Opcode::F64Max:
-    case Opcode::F64Copysign:
-    case Opcode::I32WrapI64:
-    case Opcode::I32TruncF32S:
-    case Opcode::I32TruncF32U:
-    case Opcode::I32TruncF64S:
-    case Opcode::I32TruncF64U:
-    case Opcode::I64ExtendI32S:
-    case Opcode::I64ExtendI32U:
-    case Opcode::I64TruncF32S:
-    case Opcode::I64TruncF32U:
-    case Opcode::I64TruncF64S:
-    case Opcode::I64TruncF64U:
-    case Opcode::F32ConvertI32S:
-    case Opcode::F32ConvertI32U:
-    case Opcode::F32ConvertI64S:
-    case Opcode::F32ConvertI64U:
-    case Opcode::F32DemoteF64:
-    case Opcode::F64ConvertI32S:
-    case Opcode::F64ConvertI32U:
-    case Opcode::F64ConvertI64S:
-    case Opcode::F64ConvertI64U:
-    case Opcode::F64PromoteF32:
-    case Opcode::I32ReinterpretF32:
-    case Opcode::I64ReinterpretF64:
-    case Opcode::F32ReinterpretI32:
-    case Opcode::F64ReinterpretI64:
-    case Opcode::I32Extend8S:
-    case Opcode::I32Extend16S:
-    case Opcode::I64Extend8S:
-    case Opcode::I64Extend16S:
-    case Opcode::I64Extend32S:
-    case Opcode::I32TruncSatF32S:
-    case Opcode::I32TruncSatF32U:
-    case Opcode::I32TruncSatF64S:
-    case Opcode::I32TruncSatF64U:
-    case Opcode::I64TruncSatF32S:
-    case Opcode::I64TruncSatF32U:
-    case Opcode::I64TruncSatF64S:
-    case Opcode::I64TruncSatF64U:
-    case Opcode::RefIsNull:
-    case Opcode::I8X16Swizzle:
-    case Opcode::I8X16Splat:
-    case Opcode::I16X8Splat:
-    case Opcode::I32X4Splat:
-    case Opcode::I64X2Splat:
-    case Opcode::F32X4Splat:
-    case Opcode::F64X2Splat:
-    case Opcode::I8X16Eq:
-    case Opcode::I8X16Ne:
-    case Opcode::I8X16LtS:
-    case Opcode::I8X16LtU:
-    case Opcode::I8X16GtS:
-    case Opcode::I8X16GtU:
-    case Opcode::I8X16LeS:
-    case Opcode::I8X16LeU:
-    case Opcode::I8X16GeS:
-    case Opcode::I8X16GeU:
-    case Opcode::I16X8Eq:
-    case Opcode::I16X8Ne:
-    case Opcode::I16X8LtS:
-    case Opcode::I16X8LtU:
-    case Opcode::I16X8GtS:
-    case Opcode::I16X8GtU:
-    case Opcode::I16X8LeS:
-    case Opcode::I16X8LeU:
-    case Opcode::I16X8GeS:
-    case Opcode::I16X8GeU:
-    case Opcode::I32X4Eq:
-    case Opcode::I32X4Ne:
-    case Opcode::I32X4LtS:
-    case Opcode::I32X4LtU:
-    case Opcode::I32X4GtS:
-    case Opcode::I32X4GtU:
-    case Opcode::I32X4LeS:
-    case Opcode::I32X4LeU:
-    case Opcode::I32X4GeS:
-    case Opcode::I32X4GeU:
-    case Opcode::F32X4Eq:
-    case Opcode::F32X4Ne:
-    case Opcode::F32X4Lt:
-    case Opcode::F32X4Gt:
-    case Opcode::F32X4Le:
-    case Opcode::F32X4Ge:
-    case Opcode::F64X2Eq:
-    case Opcode::F64X2Ne:
-    case Opcode::F64X2Lt:
-    case Opcode::F64X2Gt:
-    case Opcode::F64X2Le:
-    case Opcode::F64X2Ge:
-    case Opcode::V128Not:
-    case Opcode::V128And:
-    case Opcode::V128Andnot:
-    case Opcode::V128Or:
-    case Opcode::V128Xor:
-    case Opcode::V128BitSelect:
-    case Opcode::V128AnyTrue:
-    case Opcode::F32X4DemoteF64X2Zero:
-    case Opcode::F64X2PromoteLowF32X4:
-    case Opcode::I8X16Abs:
-    case Opcode::I8X16Neg:
-    case Opcode::I8X16Popcnt:
-    case Opcode::I8X16AllTrue:
-    case Opcode::I8X16Bitmask:
-    case Opcode::I8X16NarrowI16X8S:
-    case Opcode::I8X16NarrowI16X8U:
-    case Opcode::F32X4Ceil:
-    case Opcode::F32X4Floor:
-    case Opcode::F32X4Trunc:
-    case Opcode::F32X4Nearest:
-    case Opcode::I8X16Shl:
-    case Opcode::I8X16ShrS:
-    case Opcode::I8X16ShrU:
-    case Opcode::I8X16Add:
-    case Opcode::I8X16AddSatS:
-    case Opcode::I8X16AddSatU:
-    case Opcode::I8X16Sub:
-    case Opcode::I8X16SubSatS:
-    case Opcode::I8X16SubSatU:
-    case Opcode::F64X2Ceil:
-    case Opcode::F64X2Floor:
-    case Opcode::I8X16MinS:
-    case Opcode::I8X16MinU:
-    case Opcode::I8X16MaxS:
-    case Opcode::I8X16MaxU:
-    case Opcode::F64X2Trunc:
-    case Opcode::I8X16AvgrU:
-    case Opcode::I16X8ExtaddPairwiseI8X16S:
-    case Opcode::I16X8ExtaddPairwiseI8X16U:
-    case Opcode::I32X4ExtaddPairwiseI16X8S:
-    case Opcode::I32X4ExtaddPairwiseI16X8U:
-    case Opcode::I16X8Abs:
-    case Opcode::I16X8Neg:
-    case Opcode::I16X8Q15mulrSatS:
-    case Opcode::I16X8AllTrue:
-    case Opcode::I16X8Bitmask:
-    case Opcode::I16X8NarrowI32X4S:
-    case Opcode::I16X8NarrowI32X4U:
-    case Opcode::I16X8ExtendLowI8X16S:
-    case Opcode::I16X8ExtendHighI8X16S:
-    case Opcode::I16X8ExtendLowI8X16U:
-    case Opcode::I16X8ExtendHighI8X16U:
-    case Opcode::I16X8Shl:
-    case Opcode::I16X8ShrS:
-    case Opcode::I16X8ShrU:
-    case Opcode::I16X8Add:
-    case Opcode::I16X8AddSatS:
-    case Opcode::I16X8AddSatU:
-    case Opcode::I16X8Sub:
-    case Opcode::I16X8SubSatS:
-    case Opcode::I16X8SubSatU:
-    case Opcode::F64X2Nearest:
-    case Opcode::I16X8Mul:
-    case Opcode::I16X8MinS:
-    case Opcode::I16X8MinU:
-    case Opcode::I16X8MaxS:
-    case Opcode::I16X8MaxU:
-    case Opcode::I16X8AvgrU:
-    case Opcode::I16X8ExtmulLowI8X16S:
-    case Opcode::I16X8ExtmulHighI8X16S:
-    case Opcode::I16X8ExtmulLowI8X16U:
-    case Opcode::I16X8ExtmulHighI8X16U:
-    case Opcode::I32X4Abs:
-    case Opcode::I32X4Neg:
-    case Opcode::I32X4AllTrue:
-    case Opcode::I32X4Bitmask:
-    case Opcode::I32X4ExtendLowI16X8S:
-    case Opcode::I32X4ExtendHighI16X8S:
-    case Opcode::I32X4ExtendLowI16X8U:
-    case Opcode::I32X4ExtendHighI16X8U:
-    case Opcode::I32X4Shl:
-    case Opcode::I32X4ShrS:
-    case Opcode::I32X4ShrU:
-    case Opcode::I32X4Add:
-    case Opcode::I32X4Sub:
-    case Opcode::I32X4Mul:
-    case Opcode::I32X4MinS:
-    case Opcode::I32X4MinU:
-    case Opcode::I32X4MaxS:
-    case Opcode::I32X4MaxU:
-    case Opcode::I32X4DotI16X8S:
-    case Opcode::I32X4ExtmulLowI16X8S:
-    case Opcode::I32X4ExtmulHighI16X8S:
-    case Opcode::I32X4ExtmulLowI16X8U:
-    case Opcode::I32X4ExtmulHighI16X8U:
-    case Opcode::I64X2Abs:
-    case Opcode::I64X2Neg:
-    case Opcode::I64X2AllTrue:
-    case Opcode::I64X2Bitmask:
-    case Opcode::I64X2ExtendLowI32X4S:
-    case Opcode::I64X2ExtendHighI32X4S:
-    case Opcode::I64X2ExtendLowI32X4U:
-    case Opcode::I64X2ExtendHighI32X4U:
-    case Opcode::I64X2Shl:
-    case Opcode::I64X2ShrS:
-    case Opcode::I64X2ShrU:
-    case Opcode::I64X2Add:
-    case Opcode::I64X2Sub:
-    case Opcode::I64X2Mul:
-    case Opcode::I64X2Eq:
-    case Opcode::I64X2Ne:
-    case Opcode::I64X2LtS:
-    case Opcode::I64X2GtS:
-    case Opcode::I64X2LeS:
-    case Opcode::I64X2GeS:
-    case Opcode::I64X2ExtmulLowI32X4S:
-    case Opcode::I64X2ExtmulHighI32X4S:
-    case Opcode::I64X2ExtmulLowI32X4U:
-    case Opcode::I64X2ExtmulHighI32X4U:
-    case Opcode::F32X4Abs:
-    case Opcode::F32X4Neg:
-    case Opcode::F32X4Sqrt:
-    case Opcode::F32X4Add:
-    case Opcode::F32X4Sub:
-    case Opcode::F32X4Mul:
-    case Opcode::F32X4Div:
-    case Opcode::F32X4Min:
-    case Opcode::F32X4Max:
-    case Opcode::F32X4Pmin:
-    case Opcode::F32X4Pmax:
-    case Opcode::F64X2Abs:
-    case Opcode::F64X2Neg:
-    case Opcode::F64X2Sqrt:
-    case Opcode::F64X2Add:
-    case Opcode::F64X2Sub:
-    case Opcode::F64X2Mul:
-    case Opcode::F64X2Div:
-    case Opcode::F64X2Min:
-    case Opcode::F64X2Max:
-    case Opcode::F64X2Pmin:
-    case Opcode::F64X2Pmax:
-    case Opcode::I32X4TruncSatF32X4S:
-    case Opcode::I32X4TruncSatF32X4U:
-    case Opcode::F32X4ConvertI32X4S:
-    case Opcode::F32X4ConvertI32X4U:
-    case Opcode::I32X4TruncSatF64X2SZero:
-    case Opcode::I32X4TruncSatF64X2UZero:
-    case Opcode::F64X2ConvertLowI32X4S:
-    case Opcode::F64X2ConvertLowI32X4U:
-    case Opcode::RefAsNonNull:
-    case Opcode::CallRef:
-    case Opcode::ReturnCallRef:
-    case Opcode::RefEq:
-    case Opcode::I31New:
-    case Opcode::I31GetS:
-    case Opcode::I31GetU:
-      return At{guard.range(data), Instruction{opcode}};
+    case encoding::ImmediateKind::None:
+      return emit(guard.range(data), opcode);
 
     // No immediates, but only allowed if there's a matching block/loop/if/try
     // instruction.
-    case Opcode::End:
+    case encoding::ImmediateKind::End:
       if (ctx.open_blocks.empty()) {
         ctx.seen_final_end = true;
       } else if (ctx.open_blocks.back() == Opcode::Try) {
@@ -944,37 +631,37 @@ OptAt<Instruction> Read(SpanU8* data, ReadCtx& ctx, ReadTag<Instruction>) {
       } else {
         ctx.open_blocks.pop_back();
       }
-      return At{guard.range(data), Instruction{opcode}};
+      return emit(guard.range(data), opcode);
 
     // No immediates, but only allowed if there's a matching if instruction.
-    case Opcode::Else:
+    case encoding::ImmediateKind::Else:
       if (ctx.open_blocks.empty() || ctx.open_blocks.back() != Opcode::If) {
         ctx.errors.OnError(opcode.loc(), "Unexpected else instruction");
         return nullopt;
       } else {
         ctx.open_blocks.back() = opcode;
       }
-      return At{guard.range(data), Instruction{opcode}};
+      return emit(guard.range(data), opcode);
 
     // Index immediate. Only allowed if there's a previous try/catch
     // instruction.
-    case Opcode::Catch: {
+    case encoding::ImmediateKind::Catch: {
       if (ctx.open_blocks.empty() ||
-          (ctx.open_blocks.back().second != Opcode::Try &&
-           ctx.open_blocks.back().second != Opcode::Catch)) {
+          (ctx.open_blocks.back().value() != Opcode::Try &&
+           ctx.open_blocks.back().value() != Opcode::Catch)) {
         ctx.errors.OnError(opcode.loc(), concat("Unexpected catch instruction"));
         return nullopt;
       } else {
         ctx.open_blocks.back() = opcode;
       }
       WASP_TRY_READ(index, ReadIndex(data, ctx, "index"));
-      return At{guard.range(data), Instruction{opcode, index}};
+      return emit(guard.range(data), opcode, index);
     }
 
     // Index immediate. Only allowed if there's a previous try instruction.
-    case Opcode::Delegate: {
+    case encoding::ImmediateKind::Delegate: {
       if (ctx.open_blocks.empty() ||
-          ctx.open_blocks.back().second != Opcode::Try) {
+          ctx.open_blocks.back().value() != Opcode::Try) {
         ctx.errors.OnError(opcode.loc(),
                            concat("Unexpected delegate instruction"));
         return nullopt;
@@ -982,366 +669,223 @@ OptAt<Instruction> Read(SpanU8* data, ReadCtx& ctx, ReadTag<Instruction>) {
         ctx.open_blocks.back() = opcode;
       }
       WASP_TRY_READ(index, ReadIndex(data, ctx, "index"));
-      return At{guard.range(data), Instruction{opcode, index}};
+      return emit(guard.range(data), opcode, index);
     }
 
     // No immediates, but only allowed if there's a previous try/catch
     // instruction.
-    case Opcode::CatchAll: {
+    case encoding::ImmediateKind::CatchAll: {
       if (ctx.open_blocks.empty() ||
-          (ctx.open_blocks.back().second != Opcode::Try &&
-           ctx.open_blocks.back().second != Opcode::Catch)) {
+          (ctx.open_blocks.back().value() != Opcode::Try &&
+           ctx.open_blocks.back().value() != Opcode::Catch)) {
         ctx.errors.OnError(opcode.loc(), "Unexpected catch_all instruction");
         return nullopt;
       } else {
         ctx.open_blocks.back() = opcode;
       }
-      return At{guard.range(data), Instruction{opcode}};
+      return emit(guard.range(data), opcode);
     }
 
     // HeapType type immediate.
-    case Opcode::RefNull:
-    case Opcode::RttCanon: {
+    case encoding::ImmediateKind::HeapType: {
       WASP_TRY_READ(type, Read<HeapType>(data, ctx));
-      return At{guard.range(data), Instruction{opcode, type}};
+      return emit(guard.range(data), opcode, type);
     }
 
     // Block type immediate.
-    case Opcode::Block:
-    case Opcode::Loop:
-    case Opcode::If:
-    case Opcode::Try: {
+    case encoding::ImmediateKind::BlockType: {
       WASP_TRY_READ(type, Read<BlockType>(data, ctx));
       ctx.open_blocks.push_back(opcode);
-      return At{guard.range(data), Instruction{opcode, type}};
+      return emit(guard.range(data), opcode, type);
     }
 
     // Index immediate, w/ additional data count requirement.
-    case Opcode::DataDrop:
+    case encoding::ImmediateKind::DataIndex:
       if (!RequireDataCountSection(ctx, opcode)) {
         return nullopt;
       }
       // Fallthrough.
 
     // Index immediate.
-    case Opcode::Throw:
-    case Opcode::Rethrow:
-    case Opcode::Br:
-    case Opcode::BrIf:
-    case Opcode::Call:
-    case Opcode::ReturnCall:
-    case Opcode::LocalGet:
-    case Opcode::LocalSet:
-    case Opcode::LocalTee:
-    case Opcode::GlobalGet:
-    case Opcode::GlobalSet:
-    case Opcode::TableGet:
-    case Opcode::TableSet:
-    case Opcode::RefFunc:
-    case Opcode::ElemDrop:
-    case Opcode::TableGrow:
-    case Opcode::TableSize:
-    case Opcode::TableFill:
-    case Opcode::BrOnNull:
-    case Opcode::StructNewWithRtt:
-    case Opcode::StructNewDefaultWithRtt:
-    case Opcode::ArrayNewWithRtt:
-    case Opcode::ArrayNewDefaultWithRtt:
-    case Opcode::ArrayGet:
-    case Opcode::ArrayGetS:
-    case Opcode::ArrayGetU:
-    case Opcode::ArraySet:
-    case Opcode::ArrayLen: {
+    case encoding::ImmediateKind::Index: {
       WASP_TRY_READ(index, ReadIndex(data, ctx, "index"));
-      return At{guard.range(data), Instruction{opcode, index}};
+      return emit(guard.range(data), opcode, index);
     }
 
     // FuncBind immediate.
-    case Opcode::FuncBind: {
+    case encoding::ImmediateKind::FuncBind: {
       WASP_TRY_READ(immediate, Read<FuncBindImmediate>(data, ctx));
-      return At{guard.range(data), Instruction{opcode, immediate}};
+      return emit(guard.range(data), opcode, immediate);
     }
 
     // Index* immediates.
-    case Opcode::BrTable: {
+    case encoding::ImmediateKind::BrTable: {
       WASP_TRY_READ(immediate, Read<BrTableImmediate>(data, ctx));
-      return At{guard.range(data), Instruction{opcode, std::move(immediate)}};
+      return emit(guard.range(data), opcode, std::move(immediate));
     }
 
     // Index, reserved immediates.
-    case Opcode::CallIndirect:
-    case Opcode::ReturnCallIndirect: {
+    case encoding::ImmediateKind::CallIndirect: {
       WASP_TRY_READ(immediate, Read<CallIndirectImmediate>(data, ctx));
-      return At{guard.range(data), Instruction{opcode, immediate}};
+      return emit(guard.range(data), opcode, immediate);
     }
 
     // Memarg (alignment, offset) immediates.
-    case Opcode::I32Load:
-    case Opcode::I64Load:
-    case Opcode::F32Load:
-    case Opcode::F64Load:
-    case Opcode::I32Load8S:
-    case Opcode::I32Load8U:
-    case Opcode::I32Load16S:
-    case Opcode::I32Load16U:
-    case Opcode::I64Load8S:
-    case Opcode::I64Load8U:
-    case Opcode::I64Load16S:
-    case Opcode::I64Load16U:
-    case Opcode::I64Load32S:
-    case Opcode::I64Load32U:
-    case Opcode::V128Load:
-    case Opcode::I32Store:
-    case Opcode::I64Store:
-    case Opcode::F32Store:
-    case Opcode::F64Store:
-    case Opcode::I32Store8:
-    case Opcode::I32Store16:
-    case Opcode::I64Store8:
-    case Opcode::I64Store16:
-    case Opcode::I64Store32:
-    case Opcode::V128Store:
-    case Opcode::V128Load8X8S:
-    case Opcode::V128Load8X8U:
-    case Opcode::V128Load16X4S:
-    case Opcode::V128Load16X4U:
-    case Opcode::V128Load32X2S:
-    case Opcode::V128Load32X2U:
-    case Opcode::V128Load8Splat:
-    case Opcode::V128Load16Splat:
-    case Opcode::V128Load32Splat:
-    case Opcode::V128Load64Splat:
-    case Opcode::V128Load32Zero:
-    case Opcode::V128Load64Zero:
-    case Opcode::MemoryAtomicNotify:
-    case Opcode::MemoryAtomicWait32:
-    case Opcode::MemoryAtomicWait64:
-    case Opcode::I32AtomicLoad:
-    case Opcode::I64AtomicLoad:
-    case Opcode::I32AtomicLoad8U:
-    case Opcode::I32AtomicLoad16U:
-    case Opcode::I64AtomicLoad8U:
-    case Opcode::I64AtomicLoad16U:
-    case Opcode::I64AtomicLoad32U:
-    case Opcode::I32AtomicStore:
-    case Opcode::I64AtomicStore:
-    case Opcode::I32AtomicStore8:
-    case Opcode::I32AtomicStore16:
-    case Opcode::I64AtomicStore8:
-    case Opcode::I64AtomicStore16:
-    case Opcode::I64AtomicStore32:
-    case Opcode::I32AtomicRmwAdd:
-    case Opcode::I64AtomicRmwAdd:
-    case Opcode::I32AtomicRmw8AddU:
-    case Opcode::I32AtomicRmw16AddU:
-    case Opcode::I64AtomicRmw8AddU:
-    case Opcode::I64AtomicRmw16AddU:
-    case Opcode::I64AtomicRmw32AddU:
-    case Opcode::I32AtomicRmwSub:
-    case Opcode::I64AtomicRmwSub:
-    case Opcode::I32AtomicRmw8SubU:
-    case Opcode::I32AtomicRmw16SubU:
-    case Opcode::I64AtomicRmw8SubU:
-    case Opcode::I64AtomicRmw16SubU:
-    case Opcode::I64AtomicRmw32SubU:
-    case Opcode::I32AtomicRmwAnd:
-    case Opcode::I64AtomicRmwAnd:
-    case Opcode::I32AtomicRmw8AndU:
-    case Opcode::I32AtomicRmw16AndU:
-    case Opcode::I64AtomicRmw8AndU:
-    case Opcode::I64AtomicRmw16AndU:
-    case Opcode::I64AtomicRmw32AndU:
-    case Opcode::I32AtomicRmwOr:
-    case Opcode::I64AtomicRmwOr:
-    case Opcode::I32AtomicRmw8OrU:
-    case Opcode::I32AtomicRmw16OrU:
-    case Opcode::I64AtomicRmw8OrU:
-    case Opcode::I64AtomicRmw16OrU:
-    case Opcode::I64AtomicRmw32OrU:
-    case Opcode::I32AtomicRmwXor:
-    case Opcode::I64AtomicRmwXor:
-    case Opcode::I32AtomicRmw8XorU:
-    case Opcode::I32AtomicRmw16XorU:
-    case Opcode::I64AtomicRmw8XorU:
-    case Opcode::I64AtomicRmw16XorU:
-    case Opcode::I64AtomicRmw32XorU:
-    case Opcode::I32AtomicRmwXchg:
-    case Opcode::I64AtomicRmwXchg:
-    case Opcode::I32AtomicRmw8XchgU:
-    case Opcode::I32AtomicRmw16XchgU:
-    case Opcode::I64AtomicRmw8XchgU:
-    case Opcode::I64AtomicRmw16XchgU:
-    case Opcode::I64AtomicRmw32XchgU:
-    case Opcode::I32AtomicRmwCmpxchg:
-    case Opcode::I64AtomicRmwCmpxchg:
-    case Opcode::I32AtomicRmw8CmpxchgU:
-    case Opcode::I32AtomicRmw16CmpxchgU:
-    case Opcode::I64AtomicRmw8CmpxchgU:
-    case Opcode::I64AtomicRmw16CmpxchgU:
-    case Opcode::I64AtomicRmw32CmpxchgU: {
+    case encoding::ImmediateKind::MemArg: {
       WASP_TRY_READ(memarg, Read<MemArgImmediate>(data, ctx));
-      return At{guard.range(data), Instruction{opcode, memarg}};
+      return emit(guard.range(data), opcode, memarg);
     }
 
-    case Opcode::V128Load8Lane:
-    case Opcode::V128Load16Lane:
-    case Opcode::V128Load32Lane:
-    case Opcode::V128Load64Lane:
-    case Opcode::V128Store8Lane:
-    case Opcode::V128Store16Lane:
-    case Opcode::V128Store32Lane:
-    case Opcode::V128Store64Lane: {
+    case encoding::ImmediateKind::SimdMemoryLane: {
       WASP_TRY_READ(immediate, Read<SimdMemoryLaneImmediate>(data, ctx));
-      return At{guard.range(data), Instruction{opcode, immediate}};
+      return emit(guard.range(data), opcode, immediate);
     }
 
     // Reserved immediates.
-    case Opcode::MemorySize:
-    case Opcode::MemoryGrow:
-    case Opcode::MemoryFill: {
+    case encoding::ImmediateKind::Reserved: {
       WASP_TRY_READ(reserved, ReadReserved(data, ctx));
-      return At{guard.range(data), Instruction{opcode, reserved}};
+      return emit(guard.range(data), opcode, reserved);
     }
 
     // Const immediates.
-    case Opcode::I32Const: {
+    case encoding::ImmediateKind::S32: {
       WASP_TRY_READ_CONTEXT(value, Read<s32>(data, ctx), "i32 constant");
-      return At{guard.range(data), Instruction{opcode, value}};
+      return emit(guard.range(data), opcode, value);
     }
 
-    case Opcode::I64Const: {
+    case encoding::ImmediateKind::S64: {
       WASP_TRY_READ_CONTEXT(value, Read<s64>(data, ctx), "i64 constant");
-      return At{guard.range(data), Instruction{opcode, value}};
+      return emit(guard.range(data), opcode, value);
     }
 
-    case Opcode::F32Const: {
+    case encoding::ImmediateKind::F32: {
       WASP_TRY_READ_CONTEXT(value, Read<f32>(data, ctx), "f32 constant");
-      return At{guard.range(data), Instruction{opcode, value}};
+      return emit(guard.range(data), opcode, value);
     }
 
-    case Opcode::F64Const: {
+    case encoding::ImmediateKind::F64: {
       WASP_TRY_READ_CONTEXT(value, Read<f64>(data, ctx), "f64 constant");
-      return At{guard.range(data), Instruction{opcode, value}};
+      return emit(guard.range(data), opcode, value);
     }
 
-    case Opcode::V128Const: {
+    case encoding::ImmediateKind::V128: {
       WASP_TRY_READ_CONTEXT(value, Read<v128>(data, ctx), "v128 constant");
-      return At{guard.range(data), Instruction{opcode, value}};
+      return emit(guard.range(data), opcode, value);
     }
 
     // Reserved, Index immediates.
-    case Opcode::MemoryInit: {
+    case encoding::ImmediateKind::MemoryInit: {
       WASP_TRY_READ(immediate,
                     Read<InitImmediate>(data, ctx, BulkImmediateKind::Memory));
       if (!RequireDataCountSection(ctx, opcode)) {
         return nullopt;
       }
-      return At{guard.range(data), Instruction{opcode, immediate}};
+      return emit(guard.range(data), opcode, immediate);
     }
-    case Opcode::TableInit: {
+    case encoding::ImmediateKind::TableInit: {
       WASP_TRY_READ(immediate,
                     Read<InitImmediate>(data, ctx, BulkImmediateKind::Table));
-      return At{guard.range(data), Instruction{opcode, immediate}};
+      return emit(guard.range(data), opcode, immediate);
     }
 
     // Reserved, reserved immediates.
-    case Opcode::MemoryCopy: {
+    case encoding::ImmediateKind::MemoryCopy: {
       WASP_TRY_READ(immediate,
                     Read<CopyImmediate>(data, ctx, BulkImmediateKind::Memory));
-      return At{guard.range(data), Instruction{opcode, immediate}};
+      return emit(guard.range(data), opcode, immediate);
     }
-    case Opcode::TableCopy: {
+    case encoding::ImmediateKind::TableCopy: {
       WASP_TRY_READ(immediate,
                     Read<CopyImmediate>(data, ctx, BulkImmediateKind::Table));
-      return At{guard.range(data), Instruction{opcode, immediate}};
+      return emit(guard.range(data), opcode, immediate);
     }
 
     // Shuffle immediate.
-    case Opcode::I8X16Shuffle: {
+    case encoding::ImmediateKind::Shuffle: {
       WASP_TRY_READ(immediate, Read<ShuffleImmediate>(data, ctx));
-      return At{guard.range(data), Instruction{opcode, immediate}};
+      return emit(guard.range(data), opcode, immediate);
     }
 
     // Select immediate.
-    case Opcode::SelectT: {
+    case encoding::ImmediateKind::Select: {
       LocationGuard immediate_guard{data};
       WASP_TRY_READ(immediate, ReadVector<ValueType>(data, ctx, "types"));
-      return At{
-          guard.range(data),
-          Instruction{opcode, At{immediate_guard.range(data), immediate}}};
+      return emit(guard.range(data), opcode,
+                  At{immediate_guard.range(data), immediate});
     }
 
     // u8 immediate.
-    case Opcode::I8X16ExtractLaneS:
-    case Opcode::I8X16ExtractLaneU:
-    case Opcode::I16X8ExtractLaneS:
-    case Opcode::I16X8ExtractLaneU:
-    case Opcode::I32X4ExtractLane:
-    case Opcode::I64X2ExtractLane:
-    case Opcode::F32X4ExtractLane:
-    case Opcode::F64X2ExtractLane:
-    case Opcode::I8X16ReplaceLane:
-    case Opcode::I16X8ReplaceLane:
-    case Opcode::I32X4ReplaceLane:
-    case Opcode::I64X2ReplaceLane:
-    case Opcode::F32X4ReplaceLane:
-    case Opcode::F64X2ReplaceLane: {
+    case encoding::ImmediateKind::SimdLane: {
       WASP_TRY_READ(lane, Read<u8>(data, ctx));
-      return At{guard.range(data), Instruction{opcode, lane}};
+      return emit(guard.range(data), opcode, lane);
     }
 
     // Let immediate.
-    case Opcode::Let: {
+    case encoding::ImmediateKind::Let: {
       WASP_TRY_READ(immediate, Read<LetImmediate>(data, ctx));
       ctx.open_blocks.push_back(opcode);
-      return At{guard.range(data), Instruction{opcode, immediate}};
+      return emit(guard.range(data), opcode, immediate);
     }
 
     // StructField immediate.
-    case Opcode::StructGet:
-    case Opcode::StructGetS:
-    case Opcode::StructGetU:
-    case Opcode::StructSet: {
+    case encoding::ImmediateKind::StructField: {
       WASP_TRY_READ(immediate, Read<StructFieldImmediate>(data, ctx));
-      return At{guard.range(data), Instruction{opcode, immediate}};
+      return emit(guard.range(data), opcode, immediate);
     }
 
     // RttSub immediate.
-    case Opcode::RttSub: {
+    case encoding::ImmediateKind::RttSub: {
       // TODO: Determine whether this instruction should have heap type
       // immediates.
 #if 0
       WASP_TRY_READ(immediate, Read<RttSubImmediate>(data, ctx));
-      return At{guard.range(data), Instruction{opcode, immediate}};
+      return emit(guard.range(data), opcode, immediate);
 #else
       WASP_TRY_READ(type, Read<HeapType>(data, ctx));
-      return At{guard.range(data), Instruction{opcode, type}};
+      return emit(guard.range(data), opcode, type);
 #endif
     }
 
     // Two HeapType immediate.
-    case Opcode::RefTest:
-    case Opcode::RefCast: {
+    case encoding::ImmediateKind::HeapType2: {
       WASP_TRY_READ(immediate, Read<HeapType2Immediate>(data, ctx));
-      return At{guard.range(data), Instruction{opcode, immediate}};
+      return emit(guard.range(data), opcode, immediate);
     }
 
     // BrOnCast immediate.
-    case Opcode::BrOnCast: {
+    case encoding::ImmediateKind::BrOnCast: {
       // TODO: Determine whether this instruction should have heap type
       // immediates.
 #if 0
       WASP_TRY_READ(immediate, Read<BrOnCastImmediate>(data, ctx));
-      return At{guard.range(data), Instruction{opcode, immediate}};
+      return emit(guard.range(data), opcode, immediate);
 #else
       WASP_TRY_READ(index, ReadIndex(data, ctx, "index"));
-      return At{guard.range(data), Instruction{opcode, index}};
+      return emit(guard.range(data), opcode, index);
 #endif
     }
   }
   WASP_UNREACHABLE();
 }
 
+OptAt<Instruction> Read(SpanU8* data, ReadCtx& ctx, ReadTag<Instruction>) {
+  return ReadInstruction<At<Instruction>>(
+      data, ctx, [](Location loc, At<Opcode> opcode, auto&&... immediate) {
+        return At{loc, Instruction{opcode, std::move(immediate)...}};
+      });
+}
+
+bool ReadPackedInstruction(SpanU8* data,
+                           ReadCtx& ctx,
+                           PackedExpression& expr) {
+  auto packed = ReadInstruction<Location>(
+      data, ctx, [&](Location loc, At<Opcode> opcode, auto&&... immediate) {
+        expr.push_back(loc, opcode, immediate...);
+        return loc;
+      });
+  return packed.has_value();
+}
+
 OptAt<InstructionList> Read(SpanU8* data,
                             ReadCtx& ctx,
                             ReadTag<InstructionList>) {
@@ -1448,23 +992,8 @@ OptAt<Mutability> Read(SpanU8* data, ReadCtx& ctx, ReadTag<Mutability>) {
 }
 
 OptAt<Opcode> Read(SpanU8* data, ReadCtx& ctx, ReadTag<Opcode>) {
-  ErrorsContextGuard error_guard{ctx.errors, *data, "opcode"};
-  LocationGuard guard{data};
-  WASP_TRY_READ(val, Read<u8>(data, ctx));
-
-  if (encoding::Opcode::IsPrefixByte(*val, ctx.features)) {
-    WASP_TRY_READ(code, Read<u32>(data, ctx));
-    auto decoded = encoding::Opcode::Decode(val, code, ctx.features);
-    if (!decoded) {
-      ctx.errors.OnError(guard.range(data),
-                         concat("Unknown opcode: ", val, " ", code));
-      return nullopt;
-    }
-    return At{guard.range(data), *decoded};
-  } else {
-    WASP_TRY_DECODE_FEATURES(decoded, val, Opcode, "opcode", ctx.features);
-    return decoded;
-  }
+  WASP_TRY_READ(info, ReadOpcodeInfo(data, ctx));
+  return At{info.loc(), info->opcode};
 }
 
 OptAt<u8> ReadReserved(SpanU8* data, ReadCtx& ctx) {
@@ -1689,8 +1218,8 @@ OptAt<ValueType> Read(SpanU8* data, ReadCtx& ctx, ReadTag<ValueType>) {
 
 bool EndCode(SpanU8 data, ReadCtx& ctx) {
   if (!ctx.open_blocks.empty()) {
-    for (auto& [loc, op] : ctx.open_blocks) {
-      ctx.errors.OnError(loc, concat("Unclosed ", op, " instruction"));
+    for (auto& op : ctx.open_blocks) {
+      ctx.errors.OnError(op.loc(), concat("Unclosed ", *op, " instruction"));
     }
     return false;
   }
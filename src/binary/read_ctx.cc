@@ -23,6 +23,15 @@ ReadCtx::ReadCtx(Errors& errors) : errors(errors) {}
 ReadCtx::ReadCtx(const Features& features, Errors& errors)
     : features(features), errors(errors) {}
 
+ReadCtx::ReadCtx(const ReadCtx& other, Errors& errors)
+    : features(other.features),
+      errors(errors),
+      last_section_id(other.last_section_id),
+      defined_function_count(other.defined_function_count),
+      declared_data_count(other.declared_data_count),
+      code_count(other.code_count),
+      data_count(other.data_count) {}
+
 void ReadCtx::Reset() {
   last_section_id.reset();
   defined_function_count = 0;
@@ -0,0 +1,316 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/streaming_module_reader.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "wasp/base/macros.h"
+#include "wasp/binary/encoding.h"
+
+namespace wasp::binary {
+
+namespace {
+
+constexpr size_t kHeaderSize =
+    sizeof(encoding::Magic) + sizeof(encoding::Version);
+
+// The smallest capacity a segment grows to, so small units that arrive a few
+// bytes at a time aren't reallocated for every chunk.
+constexpr size_t kMinSegmentCapacity = 256;
+
+enum class PeekResult { Incomplete, Invalid, Ok };
+
+// Decodes the LEB128-encoded u32 at the start of `data` without reporting
+// errors, so the size of a unit can be found before all of its bytes have
+// arrived. Malformed values are reported later, when the unit is read.
+PeekResult PeekU32(SpanU8 data, u32* value, size_t* length) {
+  const size_t kMaxBytes = 5;
+  u32 result = 0;
+  for (size_t i = 0; i < std::min(data.size(), kMaxBytes); ++i) {
+    u8 byte = data[i];
+    result |= u32(byte & 0x7f) << (7 * i);
+    if ((byte & 0x80) == 0) {
+      if (i == kMaxBytes - 1 && (byte & 0xf0) != 0) {
+        return PeekResult::Invalid;
+      }
+      *value = result;
+      *length = i + 1;
+      return PeekResult::Ok;
+    }
+  }
+  return data.size() >= kMaxBytes ? PeekResult::Invalid
+                                  : PeekResult::Incomplete;
+}
+
+}  // namespace
+
+StreamingModuleReaderBase::StreamingModuleReaderBase(const Features& features,
+                                                     Errors& errors)
+    : ctx{features, errors} {
+  NewSegment();
+}
+
+optional<size_t> StreamingModuleReaderBase::offset(const u8* ptr) const {
+  for (const Segment* segment : {&segment_, &code_header_}) {
+    if (segment->Contains(ptr)) {
+      return segment->offset + (ptr - segment->data.get());
+    }
+  }
+  return nullopt;
+}
+
+auto StreamingModuleReaderBase::Next(SpanU8* chunk) -> optional<Unit> {
+  while (true) {
+    switch (state_) {
+      case State::Header: {
+        Append(chunk, kHeaderSize - segment_.size);
+        if (segment_.size < kHeaderSize) {
+          return nullopt;
+        }
+        state_ = State::SectionHeader;
+        return Unit{UnitKind::Header, segment_.span(0, kHeaderSize)};
+      }
+
+      case State::SectionHeader: {
+        // Copy the section header a byte at a time, since its size isn't
+        // known until the length has been decoded.
+        if (!AppendPending(chunk)) {
+          return nullopt;
+        }
+
+        u32 length = 0;
+        size_t length_size = 0;
+        auto peek = PeekU32(SpanU8{pending_ + 1, pending_size_ - 1}, &length,
+                            &length_size);
+        if (peek == PeekResult::Incomplete) {
+          continue;
+        }
+
+        // The previous section has been read, including the code section.
+        code_header_ = Segment{};
+        bool is_code =
+            pending_[0] == encoding::SectionId::Encode(SectionId::Code);
+        NewSegment();
+        if (peek == PeekResult::Invalid) {
+          // Reading the header alone reports the error.
+          state_ = State::Done;
+          return Unit{UnitKind::Section, segment_.span(0, segment_.size)};
+        }
+
+        contents_begin_ = size_;
+        section_end_ = size_ + length;
+        state_ = is_code ? State::CodeCount : State::Section;
+        continue;
+      }
+
+      case State::Section: {
+        Append(chunk, section_end_ - size_);
+        if (size_ < section_end_) {
+          return nullopt;
+        }
+        state_ = State::SectionHeader;
+        return Unit{UnitKind::Section, segment_.span(0, segment_.size)};
+      }
+
+      case State::CodeCount: {
+        // Wait for the count, so the section can be passed to the visitor.
+        // Copy it a byte at a time, so none of the first body is copied into
+        // the code section's header.
+        if (size_ < section_end_ && chunk->empty()) {
+          return nullopt;
+        }
+        Append(chunk, std::min<size_t>(1, section_end_ - size_));
+        SpanU8 count_bytes =
+            segment_.span(contents_begin_ - segment_.offset, segment_.size);
+        u32 count = 0;
+        size_t count_size = 0;
+        auto peek = PeekU32(count_bytes, &count, &count_size);
+        if (peek == PeekResult::Incomplete && size_ < section_end_) {
+          continue;
+        }
+        Unit unit{UnitKind::CodeSection, segment_.span(0, segment_.size),
+                  count_bytes, section_end_ - contents_begin_};
+        if (peek == PeekResult::Ok) {
+          // The header is kept until the end of the section, since the
+          // LazyCodeSection given to the visitor refers to it.
+          code_header_ = std::move(segment_);
+          NewSegment();
+          state_ = State::CodeSize;
+        } else {
+          // Reading the section reports the error.
+          state_ = State::Done;
+        }
+        return unit;
+      }
+
+      case State::CodeSize: {
+        if (size_ == section_end_) {
+          state_ = State::SectionHeader;
+          return Unit{UnitKind::CodeSectionEnd, end()};
+        }
+
+        // Copy the body size a byte at a time, as with the section header.
+        if (!AppendPending(chunk)) {
+          return nullopt;
+        }
+        u32 body_size = 0;
+        size_t body_size_size = 0;
+        auto peek = PeekU32(SpanU8{pending_, pending_size_}, &body_size,
+                            &body_size_size);
+        if (peek == PeekResult::Incomplete && size_ < section_end_) {
+          continue;
+        }
+
+        // The previous body has been read, so its bytes can be released.
+        NewSegment();
+        if (peek == PeekResult::Ok) {
+          // A body that extends past the end of the section is truncated, so
+          // reading it reports the error.
+          unit_end_ = std::min<size_t>(section_end_, size_ + body_size);
+          state_ = State::Code;
+          continue;
+        }
+        // Reading the body size alone reports the error.
+        state_ = State::Done;
+        return Unit{UnitKind::Code, segment_.span(0, segment_.size)};
+      }
+
+      case State::Code: {
+        Append(chunk, unit_end_ - size_);
+        if (size_ < unit_end_) {
+          return nullopt;
+        }
+        state_ = State::CodeSize;
+        return Unit{UnitKind::Code, segment_.span(0, segment_.size)};
+      }
+
+      case State::SkipCode: {
+        Skip(chunk, section_end_ - size_);
+        if (size_ < section_end_) {
+          return nullopt;
+        }
+        state_ = State::SectionHeader;
+        continue;
+      }
+
+      case State::Done:
+        return nullopt;
+    }
+  }
+}
+
+auto StreamingModuleReaderBase::Flush() -> optional<Unit> {
+  auto state = state_;
+  state_ = State::Done;
+  switch (state) {
+    case State::Header:
+      return Unit{UnitKind::Header, segment_.span(0, segment_.size)};
+
+    case State::SectionHeader:
+      if (pending_size_ == 0) {
+        return nullopt;
+      }
+      NewSegment();
+      return Unit{UnitKind::Section, segment_.span(0, segment_.size)};
+
+    case State::Section:
+    case State::CodeCount:
+      // The section's length extends past the end of the module, so reading
+      // it as a whole reports the error.
+      return Unit{UnitKind::Section, segment_.span(0, segment_.size)};
+
+    case State::CodeSize:
+      NewSegment();
+      // Fallthrough.
+
+    case State::Code:
+    case State::SkipCode:
+      // The function body is incomplete (or, if skipping, missing), so
+      // reading it reports the error.
+      return Unit{UnitKind::Code, segment_.span(0, segment_.size)};
+
+    case State::Done:
+      return nullopt;
+  }
+  WASP_UNREACHABLE();
+}
+
+void StreamingModuleReaderBase::SkipCodeSection() {
+  if (state_ == State::CodeSize) {
+    state_ = State::SkipCode;
+  }
+}
+
+SpanU8 StreamingModuleReaderBase::end() const {
+  return segment_.span(segment_.size, segment_.size);
+}
+
+SpanU8 StreamingModuleReaderBase::Segment::span(size_t begin,
+                                                size_t end) const {
+  return SpanU8{data.get() + begin, end - begin};
+}
+
+bool StreamingModuleReaderBase::Segment::Contains(const u8* ptr) const {
+  return data && ptr >= data.get() && ptr <= data.get() + size;
+}
+
+void StreamingModuleReaderBase::NewSegment() {
+  segment_ = Segment{std::unique_ptr<u8[]>(new u8[pending_size_]),
+                     pending_size_, pending_size_, size_ - pending_size_};
+  std::memcpy(segment_.data.get(), pending_, pending_size_);
+  pending_size_ = 0;
+}
+
+bool StreamingModuleReaderBase::AppendPending(SpanU8* chunk) {
+  if (chunk->empty()) {
+    return false;
+  }
+  pending_[pending_size_++] = chunk->front();
+  chunk->remove_prefix(1);
+  size_++;
+  return true;
+}
+
+void StreamingModuleReaderBase::Append(SpanU8* chunk, size_t max_count) {
+  size_t count = std::min(max_count, chunk->size());
+  size_t size = segment_.size + count;
+  if (size > segment_.capacity) {
+    // Grow geometrically, but never past the end of the unit. The unit's
+    // length hasn't been checked yet, so nothing is allocated for bytes that
+    // haven't arrived.
+    size_t capacity =
+        std::min(segment_.size + max_count,
+                 std::max({size, segment_.capacity * 2, kMinSegmentCapacity}));
+    std::unique_ptr<u8[]> data{new u8[capacity]};
+    std::memcpy(data.get(), segment_.data.get(), segment_.size);
+    segment_.data = std::move(data);
+    segment_.capacity = capacity;
+  }
+  std::memcpy(segment_.data.get() + segment_.size, chunk->data(), count);
+  segment_.size = size;
+  size_ += count;
+  chunk->remove_prefix(count);
+}
+
+void StreamingModuleReaderBase::Skip(SpanU8* chunk, size_t max_count) {
+  size_t count = std::min(max_count, chunk->size());
+  size_ += count;
+  chunk->remove_prefix(count);
+}
+
+}  // namespace wasp::binary
@@ -0,0 +1,190 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/write.h"
+
+#include <cassert>
+#include <cstring>
+#include <iterator>
+#include <limits>
+
+namespace wasp::binary {
+
+namespace {
+
+constexpr size_t kFixedLengthSize = VarInt<u32>::kMaxBytes;
+
+size_t GetVarIntSize(u32 value) {
+  size_t size = 1;
+  while (value >= VarInt<u32>::kExtendBit) {
+    value >>= VarInt<u32>::kBitsPerByte;
+    ++size;
+  }
+  return size;
+}
+
+void WriteFixedLength(u32 value, u8* out) {
+  for (size_t i = 0; i < kFixedLengthSize - 1; ++i) {
+    out[i] = (value & VarInt<u32>::kByteMask) | VarInt<u32>::kExtendBit;
+    value >>= VarInt<u32>::kBitsPerByte;
+  }
+  out[kFixedLengthSize - 1] = value;
+}
+
+u32 ReadFixedLength(const u8* data) {
+  u32 value = 0;
+  for (size_t i = 0; i < kFixedLengthSize; ++i) {
+    value |= u32(data[i] & VarInt<u32>::kByteMask)
+             << (i * VarInt<u32>::kBitsPerByte);
+  }
+  return value;
+}
+
+template <typename Container>
+void WriteSection(LengthPatcher& patcher,
+                  Buffer& buffer,
+                  SectionId section_id,
+                  const Container& container) {
+  if (container.empty()) {
+    return;
+  }
+  Write(section_id, std::back_inserter(buffer));
+  patcher.Begin();
+  WriteVector(container.begin(), container.end(), std::back_inserter(buffer));
+  patcher.End();
+}
+
+template <typename T>
+void WriteSection(LengthPatcher& patcher,
+                  Buffer& buffer,
+                  SectionId section_id,
+                  const optional<T>& value_opt) {
+  if (!value_opt) {
+    return;
+  }
+  Write(section_id, std::back_inserter(buffer));
+  patcher.Begin();
+  Write(*value_opt, std::back_inserter(buffer));
+  patcher.End();
+}
+
+void WriteCodeSection(LengthPatcher& patcher,
+                      Buffer& buffer,
+                      const std::vector<At<UnpackedCode>>& codes) {
+  if (codes.empty()) {
+    return;
+  }
+  auto out = std::back_inserter(buffer);
+  out = Write(SectionId::Code, out);
+  patcher.Begin();
+  out = WriteIndex(static_cast<Index>(codes.size()), out);
+  for (const auto& code : codes) {
+    patcher.Begin();
+    out = WriteVector(code->locals.begin(), code->locals.end(), out);
+    out = Write(code->body, out);
+    patcher.End();
+  }
+  patcher.End();
+}
+
+// Most instructions are an opcode and one or two small immediates.
+constexpr size_t kEstimatedInstructionSize = 3;
+
+// Estimates the size of the code section, which is usually most of the
+// module, before the lengths are compacted.
+size_t EstimateCodeSectionSize(const std::vector<At<UnpackedCode>>& codes) {
+  size_t size = 1 + kFixedLengthSize * 2;
+  for (const auto& code : codes) {
+    size += kFixedLengthSize + code->locals.size() * 2 +
+            code->body.instructions.size() * kEstimatedInstructionSize;
+  }
+  return size;
+}
+
+}  // namespace
+
+LengthPatcher::LengthPatcher(Buffer& buffer, LengthEncoding encoding)
+    : buffer_{buffer}, encoding_{encoding} {}
+
+void LengthPatcher::Begin() {
+  open_.push_back(OpenLength{buffer_.size(), savings_});
+  offsets_.push_back(buffer_.size());
+  buffer_.resize(buffer_.size() + kFixedLengthSize);
+}
+
+void LengthPatcher::End() {
+  assert(!open_.empty());
+  auto open = open_.back();
+  open_.pop_back();
+
+  size_t length = buffer_.size() - open.offset - kFixedLengthSize;
+  if (encoding_ == LengthEncoding::Minimal) {
+    // The lengths nested in this item will be compacted too, so the length
+    // written is the length after compaction.
+    length -= savings_ - open.savings;
+    savings_ += kFixedLengthSize - GetVarIntSize(static_cast<u32>(length));
+  }
+  assert(length < std::numeric_limits<u32>::max());
+  WriteFixedLength(static_cast<u32>(length), buffer_.data() + open.offset);
+}
+
+void LengthPatcher::Finish() {
+  assert(open_.empty());
+  if (encoding_ == LengthEncoding::Minimal && !offsets_.empty()) {
+    u8* data = buffer_.data();
+    size_t read = offsets_[0];
+    size_t write = offsets_[0];
+    for (size_t offset : offsets_) {
+      std::memmove(data + write, data + read, offset - read);
+      write += offset - read;
+      // The minimal encoding is never longer than the fixed encoding, so
+      // this never overwrites anything that hasn't been read yet.
+      u8* end = WriteVarInt(ReadFixedLength(data + offset), data + write);
+      write = end - data;
+      read = offset + kFixedLengthSize;
+    }
+    std::memmove(data + write, data + read, buffer_.size() - read);
+    buffer_.resize(write + buffer_.size() - read);
+  }
+  offsets_.clear();
+  savings_ = 0;
+}
+
+void WriteModule(const Module& value,
+                 Buffer& buffer,
+                 LengthEncoding length_encoding) {
+  buffer.reserve(buffer.size() + EstimateCodeSectionSize(value.codes));
+  LengthPatcher patcher{buffer, length_encoding};
+  auto out = std::back_inserter(buffer);
+  out = WriteBytes(encoding::Magic, out);
+  out = WriteBytes(encoding::Version, out);
+  WriteSection(patcher, buffer, SectionId::Type, value.types);
+  WriteSection(patcher, buffer, SectionId::Import, value.imports);
+  WriteSection(patcher, buffer, SectionId::Function, value.functions);
+  WriteSection(patcher, buffer, SectionId::Table, value.tables);
+  WriteSection(patcher, buffer, SectionId::Memory, value.memories);
+  WriteSection(patcher, buffer, SectionId::Global, value.globals);
+  WriteSection(patcher, buffer, SectionId::Tag, value.tags);
+  WriteSection(patcher, buffer, SectionId::Export, value.exports);
+  WriteSection(patcher, buffer, SectionId::Start, value.start);
+  WriteSection(patcher, buffer, SectionId::Element, value.element_segments);
+  WriteSection(patcher, buffer, SectionId::DataCount, value.data_count);
+  WriteCodeSection(patcher, buffer, value.codes);
+  WriteSection(patcher, buffer, SectionId::Data, value.data_segments);
+  patcher.Finish();
+}
+
+}  // namespace wasp::binary
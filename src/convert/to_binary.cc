@@ -25,14 +25,16 @@ namespace wasp::convert {
 
 BinCtx::BinCtx(const Features& features) : features{features} {}
 
-string_view BinCtx::Add(std::string str) {
-  strings.push_back(std::make_unique<std::string>(str));
-  return string_view{*strings.back()};
+string_view BinCtx::Add(string_view str) {
+  return arena.Add(str);
 }
 
-SpanU8 BinCtx::Add(Buffer buffer) {
-  buffers.push_back(std::make_unique<Buffer>(std::move(buffer)));
-  return SpanU8{*buffers.back()};
+string_view BinCtx::Add(const text::Text& text) {
+  return text.ToString(arena);
+}
+
+SpanU8 BinCtx::Add(SpanU8 span) {
+  return arena.Add(span);
 }
 
 auto ToBinary(BinCtx& ctx, const At<text::HeapType>& value)
@@ -99,7 +101,7 @@ auto ToBinary(BinCtx& ctx, const At<text::StorageType>& value)
 }
 
 auto ToBinary(BinCtx& ctx, const At<text::Text>& value) -> At<string_view> {
-  return At{value.loc(), ctx.Add(value->ToString())};
+  return At{value.loc(), ctx.Add(*value)};
 }
 
 auto ToBinary(BinCtx& ctx, const At<text::Var>& value) -> At<Index> {
@@ -23,35 +23,64 @@
 
 namespace wasp::convert {
 
-std::string EncodeAsText(string_view str) {
+namespace {
+
+// Returns the size of `str` as a quoted, escaped string.
+size_t EncodedSize(string_view str) {
+  size_t size = 2;
+  for (u8 byte : str) {
+    if (byte == '"' || byte == '\\' || byte == '\t' || byte == '\n' ||
+        byte == '\r') {
+      size += 2;
+    } else if (byte >= 32 && byte <= 127) {
+      size += 1;
+    } else {
+      size += 3;
+    }
+  }
+  return size;
+}
+
+// Writes `str` as a quoted, escaped string to `out`, which must have room for
+// EncodedSize(str) bytes. Returns the end of the written text.
+u8* EncodeAsText(string_view str, u8* out) {
   const char kHexDigit[] = "0123456789abcdef";
-  std::string text = "\"";
+  *out++ = '"';
   for (u8 byte : str) {
-    if (byte == '"') {
-      text += "\\\"";
-    } else if (byte == '\\') {
-      text += "\\\\";
+    if (byte == '"' || byte == '\\') {
+      *out++ = '\\';
+      *out++ = byte;
     } else if (byte >= 32 && byte <= 127) {
-      text += byte;
+      *out++ = byte;
     } else if (byte == '\t') {
-      text += "\\t";
+      *out++ = '\\';
+      *out++ = 't';
     } else if (byte == '\n') {
-      text += "\\n";
+      *out++ = '\\';
+      *out++ = 'n';
     } else if (byte == '\r') {
-      text += "\\r";
+      *out++ = '\\';
+      *out++ = 'r';
     } else {
-      text += "\\";
-      text += kHexDigit[byte >> 4];
-      text += kHexDigit[byte & 15];
+      *out++ = '\\';
+      *out++ = kHexDigit[byte >> 4];
+      *out++ = kHexDigit[byte & 15];
     }
   }
-  text += "\"";
-  return text;
+  *out++ = '"';
+  return out;
 }
 
+}  // namespace
+
 text::Text TextCtx::Add(string_view str) {
-  strings.push_back(std::make_unique<std::string>(EncodeAsText(str)));
-  return text::Text{string_view{*strings.back()}, static_cast<u32>(str.size())};
+  size_t size = EncodedSize(str);
+  u8* begin = arena.Allocate(size);
+  u8* end = EncodeAsText(str, begin);
+  assert(static_cast<size_t>(end - begin) == size);
+  WASP_USE(end);
+  return text::Text{string_view{reinterpret_cast<const char*>(begin), size},
+                    static_cast<u32>(str.size())};
 }
 
 // Helpers.
@@ -611,6 +640,16 @@ auto ToText(TextCtx& ctx, const At<binary::UnpackedExpression>& value)
   return ToText(ctx, value->instructions);
 }
 
+auto ToText(TextCtx& ctx, const binary::PackedExpression& value)
+    -> text::InstructionList {
+  text::InstructionList result;
+  result.reserve(value.size());
+  for (size_t i = 0; i < value.size(); ++i) {
+    result.push_back(ToText(ctx, value[i]));
+  }
+  return result;
+}
+
 auto ToText(TextCtx& ctx, const binary::LocalsList& values)
     -> At<text::BoundValueTypeList> {
   text::BoundValueTypeList result;
@@ -17,6 +17,28 @@
 #include "wasp/text/read/lex.h"
 
 #include <cassert>
+#include <cstddef>
+
+// Long runs of whitespace, comments, string bodies and reserved characters
+// are scanned a vector at a time when SSE2 or AVX2 is available. Define
+// WASP_NO_SIMD (see the WASP_SIMD CMake option) to always use the scalar
+// loops.
+#if !WASP_NO_SIMD && defined(__AVX2__)
+#define WASP_LEX_SIMD 1
+#define WASP_LEX_AVX2 1
+#include <immintrin.h>
+#elif !WASP_NO_SIMD && (defined(__SSE2__) || defined(_M_X64) || \
+                        (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define WASP_LEX_SIMD 1
+#define WASP_LEX_AVX2 0
+#include <emmintrin.h>
+#else
+#define WASP_LEX_SIMD 0
+#endif
+
+#if WASP_LEX_SIMD && defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 namespace wasp::text {
 
@@ -82,15 +104,177 @@ void SkipChar(SpanU8* data) {
   data->remove_prefix(1);
 }
 
-int ReadReservedChars(SpanU8* data) {
-  int count = 0;
-  while (IsReserved(PeekChar(data))) {
-    SkipChar(data);
-    ++count;
+#if WASP_LEX_SIMD
+
+#if WASP_LEX_AVX2
+using Vector = __m256i;
+constexpr u32 kVectorMask = 0xffffffff;
+
+Vector LoadVector(const u8* p) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+}
+
+Vector Splat(u8 c) {
+  return _mm256_set1_epi8(static_cast<char>(c));
+}
+
+Vector Or(Vector lhs, Vector rhs) {
+  return _mm256_or_si256(lhs, rhs);
+}
+
+Vector Eq(Vector v, u8 c) {
+  return _mm256_cmpeq_epi8(v, Splat(c));
+}
+
+// Compares each byte as unsigned: lo <= c <= hi.
+Vector InRange(Vector v, u8 lo, u8 hi) {
+  auto offset = _mm256_sub_epi8(v, Splat(lo));
+  return _mm256_cmpeq_epi8(_mm256_min_epu8(offset, Splat(hi - lo)), offset);
+}
+
+u32 MoveMask(Vector v) {
+  return static_cast<u32>(_mm256_movemask_epi8(v));
+}
+#else
+using Vector = __m128i;
+constexpr u32 kVectorMask = 0xffff;
+
+Vector LoadVector(const u8* p) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+Vector Splat(u8 c) {
+  return _mm_set1_epi8(static_cast<char>(c));
+}
+
+Vector Or(Vector lhs, Vector rhs) {
+  return _mm_or_si128(lhs, rhs);
+}
+
+Vector Eq(Vector v, u8 c) {
+  return _mm_cmpeq_epi8(v, Splat(c));
+}
+
+// Compares each byte as unsigned: lo <= c <= hi.
+Vector InRange(Vector v, u8 lo, u8 hi) {
+  auto offset = _mm_sub_epi8(v, Splat(lo));
+  return _mm_cmpeq_epi8(_mm_min_epu8(offset, Splat(hi - lo)), offset);
+}
+
+u32 MoveMask(Vector v) {
+  return static_cast<u32>(_mm_movemask_epi8(v));
+}
+#endif
+
+constexpr size_t kVectorSize = sizeof(Vector);
+
+// Sets each byte that is equal to any of `c, cs...` to 0xff, and the rest
+// to 0.
+template <typename... Chars>
+Vector EqAny(Vector v, u8 c, Chars... cs) {
+  auto result = Eq(v, c);
+  ((result = Or(result, Eq(v, cs))), ...);
+  return result;
+}
+
+int CountTrailingZeros(u32 mask) {
+  assert(mask != 0);
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return static_cast<int>(index);
+#else
+  return __builtin_ctz(mask);
+#endif
+}
+
+#endif  // WASP_LEX_SIMD
+
+// The predicates below are used with FindFirst. Each one can test a single
+// character, and, when SIMD is available, a whole vector of characters,
+// returning a bitmask with a bit set for each matching character.
+struct IsNotWhitespace {
+  bool operator()(u8 c) const {
+    return !(c == ' ' || c == '\t' || c == '\r' || c == '\n');
+  }
+#if WASP_LEX_SIMD
+  u32 operator()(Vector v) const {
+    return MoveMask(EqAny(v, ' ', '\t', '\r', '\n')) ^ kVectorMask;
+  }
+#endif
+};
+
+struct IsNewline {
+  bool operator()(u8 c) const { return c == '\n'; }
+#if WASP_LEX_SIMD
+  u32 operator()(Vector v) const { return MoveMask(Eq(v, '\n')); }
+#endif
+};
+
+// The characters that can start or end a nested block comment.
+struct IsBlockCommentDelimiter {
+  bool operator()(u8 c) const { return c == '(' || c == ';'; }
+#if WASP_LEX_SIMD
+  u32 operator()(Vector v) const { return MoveMask(EqAny(v, '(', ';')); }
+#endif
+};
+
+// The characters in a string that need more than just counting.
+struct IsTextSpecial {
+  bool operator()(u8 c) const { return c == '"' || c == '\\' || c == '\n'; }
+#if WASP_LEX_SIMD
+  u32 operator()(Vector v) const {
+    return MoveMask(EqAny(v, '"', '\\', '\n'));
+  }
+#endif
+};
+
+struct IsNotReserved {
+  bool operator()(u8 c) const { return !IsReserved(c); }
+#if WASP_LEX_SIMD
+  u32 operator()(Vector v) const {
+    auto excluded = EqAny(v, '"', '(', ')', ',', ';', '[', ']', '{', '}');
+    return (MoveMask(InRange(v, '!', '~')) ^ kVectorMask) | MoveMask(excluded);
+  }
+#endif
+};
+
+// Returns the number of characters at the start of `data` for which `Pred`
+// is false, i.e. the index of the first match, or data.size() if there is
+// none.
+template <typename Pred>
+auto FindFirst(SpanU8 data) -> span_extent_t {
+  Pred pred;
+  span_extent_t i = 0;
+#if WASP_LEX_SIMD
+  for (; i + kVectorSize <= data.size(); i += kVectorSize) {
+    u32 mask = pred(LoadVector(data.data() + i));
+    if (mask != 0) {
+      return i + CountTrailingZeros(mask);
+    }
+  }
+#endif
+  while (i < data.size() && !pred(data[i])) {
+    ++i;
   }
+  return i;
+}
+
+template <typename Pred>
+auto SkipUntil(SpanU8* data) -> span_extent_t {
+  auto count = FindFirst<Pred>(*data);
+  data->remove_prefix(count);
   return count;
 }
 
+int ReadReservedChars(SpanU8* data) {
+  // Most calls are from NoTrailingReservedChars, which usually finds none.
+  if (!IsReserved(PeekChar(data))) {
+    return 0;
+  }
+  return static_cast<int>(SkipUntil<IsNotReserved>(data));
+}
+
 bool NoTrailingReservedChars(SpanU8* data) {
   return ReadReservedChars(data) == 0;
 }
@@ -166,9 +350,7 @@ bool MatchHexNum(SpanU8* data, HasUnderscores& has_underscores) {
 
 auto LexReserved(SpanU8* data) -> Token {
   MatchGuard guard{data};
-  while (IsReserved(PeekChar(data))) {
-    SkipChar(data);
-  }
+  ReadReservedChars(data);
   return Token(guard.loc(), TokenType::Reserved);
 }
 
@@ -182,6 +364,7 @@ auto LexBlockComment(SpanU8* data) -> Token {
   MatchGuard guard{data};
   int nesting = 0;
   while (true) {
+    SkipUntil<IsBlockCommentDelimiter>(data);
     switch (ReadChar(data)) {
       case -1:
         return Token(guard.loc(), TokenType::InvalidBlockComment);
@@ -214,16 +397,11 @@ auto LexId(SpanU8* data) -> Token {
 
 auto LexLineComment(SpanU8* data) -> Token {
   MatchGuard guard{data};
-  while (true) {
-    switch (ReadChar(data)) {
-      case -1:
-        return Token(guard.loc(), TokenType::InvalidLineComment);
-
-      case '\n':
-        return Token(guard.loc(), TokenType::LineComment);
-      default: break;
-    }
+  SkipUntil<IsNewline>(data);
+  if (!MatchChar(data, '\n')) {
+    return Token(guard.loc(), TokenType::InvalidLineComment);
   }
+  return Token(guard.loc(), TokenType::LineComment);
 }
 
 auto LexNameEqNum(SpanU8* data, string_view sv, TokenType tt) -> Token {
@@ -328,6 +506,7 @@ auto LexText(SpanU8* data) -> Token {
   bool in_string = true;
   u32 byte_size = 0;
   while (in_string) {
+    byte_size += SkipUntil<IsTextSpecial>(data);
     switch (ReadChar(data)) {
       case -1:
         has_error = true;
@@ -405,22 +584,8 @@ auto LexText(SpanU8* data) -> Token {
 
 auto LexWhitespace(SpanU8* data) -> Token {
   MatchGuard guard{data};
-  while (true) {
-    switch (PeekChar(data)) {
-      case ' ':
-      case '\t':
-      case '\r':
-        SkipChar(data);
-        break;
-
-      case '\n':
-        SkipChar(data);
-        break;
-
-      default:
-        return Token(guard.loc(), TokenType::Whitespace);
-    }
-  }
+  SkipUntil<IsNotWhitespace>(data);
+  return Token(guard.loc(), TokenType::Whitespace);
 }
 
 auto LexKeyword(SpanU8* data, string_view sv, TokenType tt) -> Token {
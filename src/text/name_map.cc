@@ -16,7 +16,9 @@
 
 #include "wasp/text/read/name_map.h"
 
+#include <algorithm>
 #include <cassert>
+
 #include "wasp/base/macros.h"
 
 namespace wasp::text {
@@ -26,17 +28,38 @@ NameMap::NameMap() : stack_{0} {}
 void NameMap::Reset() {
   names_.clear();
   stack_ = {0};
+  indexed_ = false;
+  bindings_.clear();
 }
 
 void NameMap::NewUnbound() {
-  names_.push_back(nullopt);
+  names_.push_back(Entry{nullopt, nullopt});
 }
 
 bool NameMap::NewBound(BindVar var) {
+  if (indexed_) {
+    // Check for a duplicate and bind the name with a single lookup.
+    size_t offset = names_.size();
+    auto [iter, inserted] = bindings_.try_emplace(var, offset);
+    optional<size_t> shadowed;
+    if (!inserted) {
+      if (iter->second >= stack_.back()) {
+        return false;
+      }
+      shadowed = iter->second;
+      iter->second = offset;
+    }
+    names_.push_back(Entry{var, shadowed});
+    return true;
+  }
+
   if (HasSinceLastPush(var)) {
     return false;
   }
-  names_.push_back(var);
+  names_.push_back(Entry{var, nullopt});
+  if (names_.size() > kMaxLinearSize) {
+    BuildIndex();
+  }
   return true;
 }
 
@@ -46,43 +69,76 @@ void NameMap::Push() {
 
 void NameMap::Pop() {
   assert(stack_.size() > 1);
+  if (indexed_) {
+    // Unbind the names in reverse, restoring any names they shadowed.
+    for (size_t i = names_.size(); i > stack_.back(); --i) {
+      auto& entry = names_[i - 1];
+      if (entry.name) {
+        if (entry.shadowed) {
+          bindings_[*entry.name] = *entry.shadowed;
+        } else {
+          bindings_.erase(*entry.name);
+        }
+      }
+    }
+  }
   names_.resize(stack_.back());
   stack_.pop_back();
 }
 
 bool NameMap::Has(BindVar var) const {
-  return FindInRange(0, names_.size(), var).has_value();
+  return Find(var).has_value();
 }
 
 bool NameMap::HasSinceLastPush(BindVar var) const {
-  return FindInRange(stack_.back(), names_.size(), var).has_value();
+  auto found = Find(var);
+  return found && *found >= stack_.back();
 }
 
-optional<size_t> NameMap::FindInRange(size_t begin,
-                                      size_t end,
-                                      BindVar var) const {
-  for (size_t i = begin; i < end; ++i) {
-    auto&& opt_name = names_[i];
-    if (opt_name && opt_name == var) {
-      return i;
+optional<size_t> NameMap::Find(BindVar var) const {
+  if (indexed_) {
+    auto iter = bindings_.find(var);
+    if (iter == bindings_.end()) {
+      return nullopt;
+    }
+    return iter->second;
+  }
+
+  // The most recent binding is the last one, since a name can only be bound
+  // again in a newer scope.
+  for (size_t i = names_.size(); i > 0; --i) {
+    if (names_[i - 1].name == var) {
+      return i - 1;
     }
   }
   return nullopt;
 }
 
-optional<Index> NameMap::Get(BindVar var) const {
-  Index offset = 0;
-  size_t end = names_.size();
-  for (auto iter = stack_.rbegin(); iter != stack_.rend(); ++iter) {
-    size_t begin = *iter;
-    auto found = FindInRange(begin, end, var);
-    if (found) {
-      return offset + static_cast<Index>(*found - begin);
+void NameMap::BuildIndex() {
+  indexed_ = true;
+  for (size_t i = 0; i < names_.size(); ++i) {
+    auto& entry = names_[i];
+    if (entry.name) {
+      auto [iter, inserted] = bindings_.try_emplace(*entry.name, i);
+      if (!inserted) {
+        entry.shadowed = iter->second;
+        iter->second = i;
+      }
     }
-    offset += static_cast<Index>(end - begin);
-    end = begin;
   }
-  return nullopt;
+}
+
+optional<Index> NameMap::Get(BindVar var) const {
+  auto found = Find(var);
+  if (!found) {
+    return nullopt;
+  }
+  // Newer scopes come first, so the index is the number of names in newer
+  // scopes, plus the offset of the name in its own scope.
+  auto scope = std::upper_bound(stack_.begin(), stack_.end(), *found) - 1;
+  size_t begin = *scope;
+  size_t end = scope + 1 == stack_.end() ? names_.size() : *(scope + 1);
+  return static_cast<Index>(names_.size() - end + (*found - begin));
 }
 
 auto NameMap::Size() const -> Index {
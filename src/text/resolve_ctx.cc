@@ -19,7 +19,9 @@
 #include <algorithm>
 #include <cassert>
 #include <iterator>
+#include <utility>
 
+#include "wasp/base/hash.h"
 #include "wasp/base/macros.h"
 
 namespace wasp::text {
@@ -85,10 +87,14 @@ auto ResolveCtx::GetFieldNameMap(Index index) -> NameMap* {
 void FunctionTypeMap::BeginModule() {
   list_.clear();
   deferred_list_.clear();
+  list_map_.clear();
+  deferred_map_.clear();
 }
 
 void FunctionTypeMap::Define(BoundFunctionType bound_type) {
-  list_.push_back(ToFunctionType(bound_type));
+  auto type = ToFunctionType(bound_type);
+  list_map_.try_emplace(type, static_cast<Index>(list_.size()));
+  list_.push_back(std::move(type));
 }
 
 void FunctionTypeMap::SkipIndex() {
@@ -96,18 +102,17 @@ void FunctionTypeMap::SkipIndex() {
 }
 
 Index FunctionTypeMap::Use(FunctionType type) {
-  auto iter = FindIter(list_, type);
-  if (iter != list_.end()) {
-    return static_cast<Index>(iter - list_.begin());
+  auto iter = list_map_.find(type);
+  if (iter != list_map_.end()) {
+    return iter->second;
   }
 
-  iter = FindIter(deferred_list_, type);
-  if (iter != deferred_list_.end()) {
-    return static_cast<Index>(list_.size() + (iter - deferred_list_.begin()));
+  auto [deferred_iter, inserted] = deferred_map_.try_emplace(
+      type, static_cast<Index>(deferred_list_.size()));
+  if (inserted) {
+    deferred_list_.push_back(std::move(type));
   }
-
-  deferred_list_.push_back(type);
-  return static_cast<Index>(list_.size() + deferred_list_.size() - 1);
+  return static_cast<Index>(list_.size()) + deferred_iter->second;
 }
 
 Index FunctionTypeMap::Use(BoundFunctionType type) {
@@ -118,10 +123,12 @@ auto FunctionTypeMap::EndModule() -> DefinedTypeList {
   DefinedTypeList defined_types;
   for (auto&& deferred : deferred_list_) {
     assert(deferred.has_value());
+    list_map_.try_emplace(*deferred, static_cast<Index>(list_.size()));
     list_.push_back(*deferred);
     defined_types.push_back(ToDefinedType(*deferred));
   }
   deferred_list_.clear();
+  deferred_map_.clear();
   return defined_types;
 }
 
@@ -151,20 +158,67 @@ DefinedType FunctionTypeMap::ToDefinedType(const FunctionType& unbound_type) {
                      BoundFunctionType{bound_params, unbound_type.results}};
 }
 
-// static
-FunctionTypeMap::List::const_iterator FunctionTypeMap::FindIter(
-    const List& list,
-    const FunctionType& type) {
-  return std::find_if(list.begin(), list.end(),
-                      [&](const optional<FunctionType>& ft) {
-                        return ft && IsSame(type, *ft);
-                      });
+namespace {
+
+// Wraps a FunctionType so absl::Hash hashes its values, but not their
+// locations.
+struct StructuralFunctionType {
+  const FunctionType& type;
+};
+
+template <typename H>
+H HashHeapType(H h, const HeapType& heap_type) {
+  if (heap_type.is_heap_kind()) {
+    return H::combine(std::move(h), 0, heap_type.heap_kind().value());
+  }
+  const Var& var = heap_type.var().value();
+  if (var.is_index()) {
+    return H::combine(std::move(h), 1, var.index());
+  }
+  return H::combine(std::move(h), 2, var.name());
+}
+
+template <typename H>
+H HashValueType(H h, const ValueType& value_type) {
+  if (value_type.is_numeric_type()) {
+    return H::combine(std::move(h), 0, value_type.numeric_type().value());
+  } else if (value_type.is_reference_type()) {
+    const ReferenceType& reference_type = value_type.reference_type();
+    if (reference_type.is_reference_kind()) {
+      return H::combine(std::move(h), 1,
+                        reference_type.reference_kind().value());
+    }
+    const RefType& ref = reference_type.ref();
+    return HashHeapType(H::combine(std::move(h), 2, ref.null), ref.heap_type);
+  } else {
+    const Rtt& rtt = value_type.rtt();
+    return HashHeapType(H::combine(std::move(h), 3, rtt.depth.value()),
+                        rtt.type);
+  }
 }
 
-// static
-bool FunctionTypeMap::IsSame(const FunctionType& lhs, const FunctionType& rhs) {
-  // Note: FunctionTypes already have an operator==, but that also checks
-  // whether the locations are the same too.
+template <typename H>
+H HashValueTypeList(H h, const ValueTypeList& value_types) {
+  for (const auto& value_type : value_types) {
+    h = HashValueType(std::move(h), value_type);
+  }
+  return H::combine(std::move(h), value_types.size());
+}
+
+template <typename H>
+H AbslHashValue(H h, const StructuralFunctionType& value) {
+  return HashValueTypeList(HashValueTypeList(std::move(h), value.type.params),
+                           value.type.results);
+}
+
+}  // namespace
+
+size_t FunctionTypeMap::Hash::operator()(const FunctionType& type) const {
+  return absl::Hash<StructuralFunctionType>{}(StructuralFunctionType{type});
+}
+
+bool FunctionTypeMap::Eq::operator()(const FunctionType& lhs,
+                                     const FunctionType& rhs) const {
   return IsSame(lhs.params, rhs.params) && IsSame(lhs.results, rhs.results);
 }
 
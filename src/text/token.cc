@@ -18,9 +18,31 @@
 
 #include <cassert>
 
+#include "wasp/base/macros.h"
+
 namespace wasp::text {
 
-void Text::AppendToBuffer(Buffer& buffer) const {
+namespace {
+
+// Returns the size of the quoted text `text` after it is unescaped.
+size_t UnescapedSize(string_view text) {
+  assert(text.size() >= 2 && text[0] == '"' && text[text.size() - 1] == '"');
+  size_t size = 0;
+  for (size_t i = 1, end = text.size() - 1; i < end; ++i, ++size) {
+    if (text[i] == '\\') {
+      auto c = text[++i];
+      if (c != 't' && c != 'n' && c != 'r' && c != '"' && c != '\'' &&
+          c != '\\') {
+        ++i;  // "\xx" hexadecimal sequence.
+      }
+    }
+  }
+  return size;
+}
+
+// Unescapes the quoted text `text` into [out, out_end), without writing past
+// out_end. Returns true if the unescaped text fills it exactly.
+bool Unescape(string_view text, u8* out, u8* out_end) {
   static const char kHexDigit[256] = {
       /*00*/ 0, 0,  0,  0,  0,  0,  0,  0, 0, 0, 0, 0, 0, 0, 0, 0,
       /*10*/ 0, 0,  0,  0,  0,  0,  0,  0, 0, 0, 0, 0, 0, 0, 0, 0,
@@ -32,44 +54,85 @@ void Text::AppendToBuffer(Buffer& buffer) const {
       // The rest are zero.
   };
 
-  buffer.reserve(buffer.size() + byte_size);
-
   // Remove surrounding quotes.
   assert(text.size() >= 2 && text[0] == '"' && text[text.size() - 1] == '"');
   string_view input = text.substr(1, text.size() - 2);
 
   // Unescape characters.
   for (auto p = input.begin(), end = input.end(); p < end; ++p) {
+    if (out == out_end) {
+      return false;
+    }
     char c = *p;
     if (c == '\\') {
       c = *++p;
       switch (c) {
-        case 't': buffer.push_back('\t'); break;
-        case 'n': buffer.push_back('\n'); break;
-        case 'r': buffer.push_back('\r'); break;
+        case 't': *out++ = '\t'; break;
+        case 'n': *out++ = '\n'; break;
+        case 'r': *out++ = '\r'; break;
 
         case '"':
         case '\'':
         case '\\':
-          buffer.push_back(c);
+          *out++ = c;
           break;
 
         default:
           // Must be a "\xx" hexadecimal sequence.
-          buffer.push_back((kHexDigit[int(c)] << 4) | kHexDigit[int(*++p)]);
+          *out++ = (kHexDigit[int(c)] << 4) | kHexDigit[int(*++p)];
           break;
       }
     } else {
-      buffer.push_back(c);
+      *out++ = c;
     }
   }
+  return out == out_end;
+}
+
+// Unescapes `text` into the storage returned by `allocate(size)`, and
+// returns its size. The lexer counts the unescaped bytes as `byte_size`, so
+// the text usually doesn't need to be scanned twice. But Text is an
+// aggregate that can be built with any byte_size, so if the text doesn't
+// unescape to exactly that size, it is measured and unescaped again.
+template <typename Allocate>
+size_t UnescapeInto(string_view text, size_t byte_size, Allocate&& allocate) {
+  u8* begin = allocate(byte_size);
+  if (Unescape(text, begin, begin + byte_size)) {
+    return byte_size;
+  }
+  size_t size = UnescapedSize(text);
+  begin = allocate(size);
+  bool ok = Unescape(text, begin, begin + size);
+  assert(ok);
+  WASP_USE(ok);
+  return size;
+}
+
+}  // namespace
+
+void Text::AppendToBuffer(Buffer& buffer) const {
+  size_t old_size = buffer.size();
+  UnescapeInto(text, byte_size, [&](size_t new_size) {
+    buffer.resize(old_size + new_size);
+    return buffer.data() + old_size;
+  });
 }
 
 auto Text::ToString() const -> std::string {
-  Buffer buffer;
-  AppendToBuffer(buffer);
-  return std::string(reinterpret_cast<const char*>(buffer.data()),
-                     buffer.size());
+  std::string result;
+  UnescapeInto(text, byte_size, [&](size_t new_size) {
+    result.resize(new_size);
+    return reinterpret_cast<u8*>(result.data());
+  });
+  return result;
+}
+
+auto Text::ToString(Arena& arena) const -> string_view {
+  u8* data = nullptr;
+  size_t size = UnescapeInto(text, byte_size, [&](size_t new_size) {
+    return data = arena.Allocate(new_size);
+  });
+  return string_view{reinterpret_cast<const char*>(data), size};
 }
 
 Token::Token() : loc{}, type{TokenType::Eof}, immediate{monostate{}} {}
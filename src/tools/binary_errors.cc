@@ -44,6 +44,11 @@ void BinaryErrors::HandleOnError(Location loc, string_view message) {
 
 auto BinaryErrors::ErrorToString(const Error& error) const -> std::string {
   auto& loc = error.loc;
+  if (loc.data() == nullptr) {
+    // No location, e.g. when built without WASP_LOCATIONS.
+    return absl::StrFormat("%s: %s\n", filename, error.message);
+  }
+
   const ptrdiff_t before = 4, after = 8, max_size = 32;
   size_t start = std::max(before, loc.begin() - data.begin()) - before;
   size_t end = data.size() - std::max(after, data.end() - loc.end()) + after;
@@ -26,6 +26,7 @@
 
 #include "src/tools/argparser.h"
 #include "src/tools/binary_errors.h"
+#include "src/tools/module_index_file.h"
 #include "wasp/base/concat.h"
 #include "wasp/base/enumerate.h"
 #include "wasp/base/features.h"
@@ -37,9 +38,7 @@
 #include "wasp/binary/formatters.h"
 #include "wasp/binary/lazy_expression.h"
 #include "wasp/binary/lazy_module.h"
-#include "wasp/binary/lazy_module_utils.h"
-#include "wasp/binary/name_section/sections.h"
-#include "wasp/binary/sections.h"
+#include "wasp/binary/module_index.h"
 
 namespace wasp::tools::cfg {
 
@@ -52,6 +51,7 @@ struct Options {
   Features features;
   string_view function;
   string_view output_filename;
+  string_view index_filename;
 };
 
 using BBID = u32;
@@ -101,8 +101,7 @@ struct Tool {
   BinaryErrors errors;
   Options options;
   LazyModule module;
-  std::map<string_view, Index> name_to_function;
-  Index imported_function_count = 0;
+  ModuleIndex index;
   std::vector<Label> labels;
   std::vector<BasicBlock> cfg;
   BBID start_bbid = InvalidBBID;
@@ -122,6 +121,9 @@ int Main(span<const string_view> args) {
            [&](string_view arg) { options.output_filename = arg; })
       .Add('f', "--function", "<func>", "generate CFG for <func>",
            [&](string_view arg) { options.function = arg; })
+      .Add("--index", "<filename>",
+           "read the module index from <filename>, or write it there",
+           [&](string_view arg) { options.index_filename = arg; })
       .Add("<filename>", "input wasm file", [&](string_view arg) {
         if (filename.empty()) {
           filename = arg;
@@ -141,13 +143,13 @@ int Main(span<const string_view> args) {
     parser.PrintHelpAndExit(1);
   }
 
-  auto optbuf = ReadFile(filename);
-  if (!optbuf) {
+  auto optfile = MapFile(filename);
+  if (!optfile) {
     Format(&std::cerr, "Error reading file %s.\n", filename);
     return 1;
   }
 
-  SpanU8 data{*optbuf};
+  SpanU8 data = optfile->data();
   Tool tool{data, options};
   int result = tool.Run();
   tool.errors.PrintTo(std::cerr);
@@ -178,17 +180,13 @@ int Tool::Run() {
 }
 
 void Tool::DoPrepass() {
-  ForEachFunctionName(module, [this](const IndexNamePair& pair) {
-    name_to_function.insert(std::make_pair(pair.second, pair.first));
-  });
-  imported_function_count = GetImportCount(module, ExternalKind::Function);
+  index = GetModuleIndex(module, options.index_filename);
 }
 
 optional<Index> Tool::GetFunctionIndex() {
   // Search by name.
-  auto iter = name_to_function.find(options.function);
-  if (iter != name_to_function.end()) {
-    return iter->second;
+  if (auto func_index = index.FindFunction(options.function)) {
+    return func_index;
   }
 
   // Try to convert the string to an integer and search by index.
@@ -196,20 +194,11 @@ optional<Index> Tool::GetFunctionIndex() {
 }
 
 optional<Code> Tool::GetCode(Index find_index) {
-  for (auto section : module.sections) {
-    if (section->is_known()) {
-      auto known = section->known();
-      if (known->id == SectionId::Code) {
-        auto section = ReadCodeSection(known, module.ctx);
-        for (auto code : enumerate(section.sequence, imported_function_count)) {
-          if (code.index == find_index) {
-            return code.value;
-          }
-        }
-      }
-    }
+  auto code = index.GetCode(find_index, module.ctx);
+  if (!code) {
+    return nullopt;
   }
-  return nullopt;
+  return code->value();
 }
 
 void Tool::CalculateCFG(Code code) {
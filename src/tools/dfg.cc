@@ -25,8 +25,8 @@
 
 #include "src/tools/argparser.h"
 #include "src/tools/binary_errors.h"
+#include "src/tools/module_index_file.h"
 #include "wasp/base/concat.h"
-#include "wasp/base/enumerate.h"
 #include "wasp/base/errors_nop.h"
 #include "wasp/base/features.h"
 #include "wasp/base/file.h"
@@ -37,8 +37,7 @@
 #include "wasp/binary/formatters.h"
 #include "wasp/binary/lazy_expression.h"
 #include "wasp/binary/lazy_module.h"
-#include "wasp/binary/lazy_module_utils.h"
-#include "wasp/binary/name_section/sections.h"
+#include "wasp/binary/module_index.h"
 #include "wasp/binary/sections.h"
 
 namespace wasp {
@@ -54,6 +53,7 @@ struct Options {
   Features features;
   string_view function;
   string_view output_filename;
+  string_view index_filename;
 };
 
 using BBID = u32;
@@ -143,10 +143,8 @@ struct Tool {
   BinaryErrors errors;
   Options options;
   LazyModule module;
+  ModuleIndex index;
   std::vector<DefinedType> defined_types;
-  std::vector<Function> functions;
-  std::map<string_view, Index> name_to_function;
-  Index imported_function_count = 0;
   std::vector<Label> labels;
   std::vector<Block> bbs;
   std::vector<Value> values;
@@ -170,6 +168,9 @@ int Main(span<const string_view> args) {
            [&](string_view arg) { options.output_filename = arg; })
       .Add('f', "--function", "<func>", "generate DFG for <func>",
            [&](string_view arg) { options.function = arg; })
+      .Add("--index", "<filename>",
+           "read the module index from <filename>, or write it there",
+           [&](string_view arg) { options.index_filename = arg; })
       .Add("<filename>", "input wasm file", [&](string_view arg) {
         if (filename.empty()) {
           filename = arg;
@@ -189,13 +190,13 @@ int Main(span<const string_view> args) {
     parser.PrintHelpAndExit(1);
   }
 
-  auto optbuf = ReadFile(filename);
-  if (!optbuf) {
+  auto optfile = MapFile(filename);
+  if (!optfile) {
     Format(&std::cerr, "Error reading file %s.\n", filename);
     return 1;
   }
 
-  SpanU8 data{*optbuf};
+  SpanU8 data = optfile->data();
   Tool tool{data, options};
   int result = tool.Run();
   tool.errors.PrintTo(std::cerr);
@@ -227,49 +228,18 @@ int Tool::Run() {
 }
 
 void Tool::DoPrepass() {
-  ForEachFunctionName(module, [this](const IndexNamePair& pair) {
-    name_to_function.insert(std::make_pair(pair.second, pair.first));
-  });
-
-  for (auto section : module.sections) {
-    if (section->is_known()) {
-      auto known = section->known();
-      switch (known->id) {
-        case SectionId::Type: {
-          auto seq = ReadTypeSection(known, module.ctx).sequence;
-          std::copy(seq.begin(), seq.end(), std::back_inserter(defined_types));
-          break;
-        }
-
-        case SectionId::Import:
-          for (auto import :
-               ReadImportSection(known, module.ctx).sequence) {
-            if (import->kind() == ExternalKind::Function) {
-              functions.push_back(Function{import->index()});
-            }
-          }
-          imported_function_count = static_cast<Index>(functions.size());
-          break;
-
-        case SectionId::Function: {
-          auto seq = ReadFunctionSection(known, module.ctx).sequence;
-          std::copy(seq.begin(), seq.end(), std::back_inserter(functions));
-          break;
-        }
-
-        default:
-          break;
-      }
-    }
+  index = GetModuleIndex(module, options.index_filename);
+  if (auto types = index.GetSection(SectionId::Type)) {
+    auto seq = ReadTypeSection(*types, module.ctx).sequence;
+    std::copy(seq.begin(), seq.end(), std::back_inserter(defined_types));
   }
 }
 
 // TODO(binji): share code with cfg.cc
 optional<Index> Tool::GetFunctionIndex() {
   // Search by name.
-  auto iter = name_to_function.find(options.function);
-  if (iter != name_to_function.end()) {
-    return iter->second;
+  if (auto func_index = index.FindFunction(options.function)) {
+    return func_index;
   }
 
   // Try to convert the string to an integer and search by index.
@@ -277,34 +247,22 @@ optional<Index> Tool::GetFunctionIndex() {
 }
 
 optional<FunctionType> Tool::GetFunctionType(Index func_index) {
-  if (func_index >= functions.size()) {
-    return nullopt;
-  }
-  Index type_index = functions[func_index].type_index;
-  if (type_index >= defined_types.size()) {
+  auto type_index = index.GetFunctionTypeIndex(func_index);
+  if (!type_index || *type_index >= defined_types.size()) {
     return nullopt;
   }
-  if (!defined_types[type_index].is_function_type()) {
+  if (!defined_types[*type_index].is_function_type()) {
     return nullopt;
   }
-  return defined_types[type_index].function_type();
+  return defined_types[*type_index].function_type();
 }
 
 optional<Code> Tool::GetCode(Index find_index) {
-  for (auto section : module.sections) {
-    if (section->is_known()) {
-      auto known = section->known();
-      if (known->id == SectionId::Code) {
-        auto section = ReadCodeSection(known, module.ctx);
-        for (auto code : enumerate(section.sequence, imported_function_count)) {
-          if (code.index == find_index) {
-            return code.value;
-          }
-        }
-      }
-    }
+  auto code = index.GetCode(find_index, module.ctx);
+  if (!code) {
+    return nullopt;
   }
-  return nullopt;
+  return code->value();
 }
 
 void Tool::CalculateDFG(const FunctionType& type, Code code) {
@@ -15,10 +15,13 @@
 //
 
 #include <algorithm>
+#include <atomic>
 #include <cctype>
 #include <iostream>
 #include <map>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include "absl/strings/str_format.h"
@@ -27,6 +30,7 @@
 #include "src/tools/binary_errors.h"
 #include "wasp/base/concat.h"
 #include "wasp/base/enumerate.h"
+#include "wasp/base/errors_buffer.h"
 #include "wasp/base/features.h"
 #include "wasp/base/file.h"
 #include "wasp/base/formatters.h"
@@ -50,6 +54,7 @@ namespace dump {
 
 using absl::Format;
 using absl::PrintF;
+using absl::StrAppendFormat;
 using absl::StrFormat;
 
 using namespace ::wasp::binary;
@@ -70,10 +75,11 @@ struct Options {
   string_view section_name;
   optional<string_view> function;
   optional<u32> func_index;
+  u32 jobs = 1;
 };
 
 struct Tool {
-  explicit Tool(string_view filename, SpanU8 data, Options);
+  explicit Tool(string_view filename, const MappedFile&, Options);
 
   using SectionIndex = u32;
 
@@ -110,6 +116,7 @@ struct Tool {
     visit::Result BeginDataCountSection(DataCountSection);
     visit::Result BeginCodeSection(LazyCodeSection);
     visit::Result BeginCode(const At<Code>&);
+    visit::Result EndCodeSection(LazyCodeSection);
     visit::Result BeginDataSection(LazyDataSection);
     visit::Result OnData(const At<DataSegment>&);
 
@@ -124,6 +131,8 @@ struct Tool {
     Index memory_count = 0;
     Index global_count = 0;
     Index tag_count = 0;
+    // The function bodies to disassemble, with their function indexes.
+    std::vector<std::pair<Index, Code>> codes;
   };
 
   void DoNameSection(Pass, SectionIndex, LazyNameSection);
@@ -132,7 +141,12 @@ struct Tool {
 
   void DoCount(Pass, optional<Index> count);
 
-  void Disassemble(SectionIndex, Index func_index, Code);
+  void Disassemble(SectionIndex, span<const std::pair<Index, Code>>);
+  void Disassemble(std::string& out,
+                   ReadCtx&,
+                   SectionIndex,
+                   Index func_index,
+                   Code);
 
   void InsertFunctionName(Index, string_view name);
   void InsertGlobalName(Index, string_view name);
@@ -154,19 +168,26 @@ struct Tool {
   template <typename Format, typename... Args>
   void PrintDetails(Pass, Format format, const Args&...);
   void PrintFunctionName(Index func_index);
-  void PrintGlobalName(Index global_index);
   void PrintMemory(SpanU8 data,
                    Index offset,
                    PrintChars print_chars = PrintChars::Yes,
                    string_view prefix = "",
                    int octets_per_line = 16,
                    int octets_per_group = 2);
-  void PrintFunctionHeader(Index func_index, Code);
-  void PrintInstruction(const Instruction&,
-                        SpanU8 data,
-                        SpanU8 post_data,
-                        int indent);
-  void PrintRelocation(const RelocationEntry& entry, size_t file_offset);
+
+  // The disassembly is appended to a string rather than printed, so functions
+  // can be disassembled in parallel.
+  void AppendFunctionName(std::string& out, Index func_index);
+  void AppendGlobalName(std::string& out, Index global_index);
+  void AppendFunctionHeader(std::string& out, Index func_index, Code);
+  void AppendInstruction(std::string& out,
+                         const Instruction&,
+                         SpanU8 data,
+                         SpanU8 post_data,
+                         int indent);
+  void AppendRelocation(std::string& out,
+                        const RelocationEntry& entry,
+                        size_t file_offset);
 
   size_t file_offset(SpanU8 data);
 
@@ -180,6 +201,7 @@ struct Tool {
 
   std::string filename;
   Options options;
+  const MappedFile& file;
   SpanU8 data;
   BinaryErrors errors;
   LazyModule module;
@@ -224,6 +246,16 @@ int Main(span<const string_view> args) {
            [&](string_view arg) { options.section_name = arg; })
       .Add('f', "--function", "<func>", "only print information for <func>",
            [&](string_view arg) { options.function = arg; })
+      .Add("--jobs", "<n>",
+           "disassemble functions using <n> threads (0 means one per core)",
+           [&](string_view arg) {
+             auto jobs = StrToU32(arg);
+             if (!jobs) {
+               Format(&std::cerr, "Invalid job count `%s`\n", arg);
+               parser.PrintHelpAndExit(1);
+             }
+             options.jobs = *jobs;
+           })
       .Add("<filenames...>", "input wasm files",
            [&](string_view arg) { filenames.push_back(arg); });
   parser.Parse(args);
@@ -243,15 +275,18 @@ int Main(span<const string_view> args) {
     parser.PrintHelpAndExit(1);
   }
 
+  if (options.jobs == 0) {
+    options.jobs = std::max(1u, std::thread::hardware_concurrency());
+  }
+
   for (auto filename : filenames) {
-    auto optbuf = ReadFile(filename);
-    if (!optbuf) {
+    auto optfile = MapFile(filename);
+    if (!optfile) {
       Format(&std::cerr, "Error reading file %s.\n", filename);
       continue;
     }
 
-    SpanU8 data{*optbuf};
-    Tool tool{filename, data, options};
+    Tool tool{filename, *optfile, options};
     tool.Run();
     tool.errors.PrintTo(std::cerr);
   }
@@ -259,10 +294,11 @@ int Main(span<const string_view> args) {
   return 0;
 }
 
-Tool::Tool(string_view filename, SpanU8 data, Options options)
+Tool::Tool(string_view filename, const MappedFile& file, Options options)
     : filename(filename),
       options{options},
-      data{data},
+      file{file},
+      data{file.data()},
       errors{data},
       module{ReadLazyModule(data, options.features, errors)} {}
 
@@ -448,6 +484,7 @@ Tool::Visitor::Visitor(Tool& tool, Pass pass) : tool{tool}, pass{pass} {}
 visit::Result Tool::Visitor::OnSection(At<Section> section) {
   auto this_idx = section_index++;
   if (tool.SectionMatches(section)) {
+    tool.file.Advise(section.loc(), Advice::WillNeed);
     tool.DoSectionHeader(pass, section);
     if (section->is_custom()) {
       tool.DoCustomSection(pass, this_idx, section->custom());
@@ -758,7 +795,7 @@ visit::Result Tool::Visitor::BeginCode(const At<Code>& code) {
     if (pass == Pass::Details) {
       PrintF(" - func[%d] size=%d\n", index, code->body->data.size());
     } else {
-      tool.Disassemble(section_index, index, code);
+      codes.emplace_back(index, code);
     }
   }
   ++index;
@@ -766,6 +803,14 @@ visit::Result Tool::Visitor::BeginCode(const At<Code>& code) {
   return visit::Result::Skip;
 }
 
+visit::Result Tool::Visitor::EndCodeSection(LazyCodeSection) {
+  if (pass == Pass::Disassemble) {
+    tool.Disassemble(section_index, codes);
+    codes.clear();
+  }
+  return visit::Result::Ok;
+}
+
 visit::Result Tool::Visitor::BeginDataSection(LazyDataSection section) {
   index = 0;
   tool.DoCount(pass, section.count);
@@ -1007,10 +1052,68 @@ void Tool::DoCount(Pass pass, optional<Index> count) {
   }
 }
 
+namespace {
+
+// A contiguous range of functions, disassembled by a single thread.
+struct DisassemblyChunk {
+  size_t begin;
+  size_t end;
+  std::string out;
+  ErrorsBuffer errors;
+};
+
+}  // namespace
+
 void Tool::Disassemble(SectionIndex section_index,
+                       span<const std::pair<Index, Code>> codes) {
+  if (codes.empty()) {
+    return;
+  }
+  const size_t jobs = std::min<size_t>(options.jobs, codes.size());
+  const size_t chunk_size = std::max<size_t>(1, codes.size() / (jobs * 16));
+  std::vector<DisassemblyChunk> chunks;
+  for (size_t begin = 0; begin < codes.size(); begin += chunk_size) {
+    chunks.push_back(DisassemblyChunk{
+        begin, std::min(begin + chunk_size, codes.size()), {}, {}});
+  }
+
+  std::atomic<size_t> next_chunk{0};
+  auto worker = [&]() {
+    for (size_t i; (i = next_chunk++) < chunks.size();) {
+      auto& chunk = chunks[i];
+      ReadCtx read_ctx{module.ctx, chunk.errors};
+      for (size_t index = chunk.begin; index < chunk.end; ++index) {
+        read_ctx.open_blocks.clear();
+        Disassemble(chunk.out, read_ctx, section_index, codes[index].first,
+                    codes[index].second);
+      }
+    }
+  };
+
+  if (jobs <= 1) {
+    worker();
+  } else {
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < jobs; ++i) {
+      threads.emplace_back(worker);
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  for (const auto& chunk : chunks) {
+    PrintF("%s", chunk.out);
+    chunk.errors.ReplayTo(errors);
+  }
+}
+
+void Tool::Disassemble(std::string& out,
+                       ReadCtx& read_ctx,
+                       SectionIndex section_index,
                        Index func_index,
                        Code code) {
-  PrintFunctionHeader(func_index, code);
+  AppendFunctionHeader(out, func_index, code);
   int indent = 0;
   auto section_start = section_starts[section_index];
   auto section_offset = [&](SpanU8 data) {
@@ -1024,7 +1127,7 @@ void Tool::Disassemble(SectionIndex section_index,
                        [&](const RelocationEntry& lhs, size_t offset) {
                          return lhs.offset < offset;
                        });
-  auto instrs = ReadExpression(*code.body, module.ctx);
+  auto instrs = ReadExpression(*code.body, read_ctx);
   for (auto it = instrs.begin(), end = instrs.end(); it != end; ++it) {
     const auto& instr = *it;
     auto opcode = instr->opcode;
@@ -1032,12 +1135,12 @@ void Tool::Disassemble(SectionIndex section_index,
         opcode == Opcode::End) {
       indent = std::max(indent - 2, 0);
     }
-    PrintInstruction(instr, last_data, it.data(), indent);
+    AppendInstruction(out, instr, last_data, it.data(), indent);
     last_data = it.data();
     for (; reloc_it < relocs.end() &&
            reloc_it->offset < section_offset(it.data());
          ++reloc_it) {
-      PrintRelocation(*reloc_it, section_start + reloc_it->offset);
+      AppendRelocation(out, *reloc_it, section_start + reloc_it->offset);
     }
     if (opcode == Opcode::Block || opcode == Opcode::If ||
         opcode == Opcode::Loop || opcode == Opcode::Else ||
@@ -1167,14 +1270,20 @@ void Tool::PrintDetails(Pass pass, Format format, const Args&... args) {
 }
 
 void Tool::PrintFunctionName(Index func_index) {
+  std::string out;
+  AppendFunctionName(out, func_index);
+  PrintF("%s", out);
+}
+
+void Tool::AppendFunctionName(std::string& out, Index func_index) {
   if (auto name = GetFunctionName(func_index)) {
-    PrintF(" <%s>", *name);
+    StrAppendFormat(&out, " <%s>", *name);
   }
 }
 
-void Tool::PrintGlobalName(Index func_index) {
-  if (auto name = GetGlobalName(func_index)) {
-    PrintF(" <%s>", *name);
+void Tool::AppendGlobalName(std::string& out, Index global_index) {
+  if (auto name = GetGlobalName(global_index)) {
+    StrAppendFormat(&out, " <%s>", *name);
   }
 }
 
@@ -1212,77 +1321,84 @@ void Tool::PrintMemory(SpanU8 start,
   }
 }
 
-void Tool::PrintFunctionHeader(Index func_index, Code code) {
+void Tool::AppendFunctionHeader(std::string& out,
+                                Index func_index,
+                                Code code) {
   auto func_type = GetFunctionType(func_index);
   size_t param_count = 0;
-  PrintF("func[%d]", func_index);
-  PrintFunctionName(func_index);
-  PrintF(":");
+  StrAppendFormat(&out, "func[%d]", func_index);
+  AppendFunctionName(out, func_index);
+  out += ":";
   if (func_type) {
-    PrintF(" %s\n", concat(*func_type));
+    StrAppendFormat(&out, " %s\n", concat(*func_type));
     param_count = func_type->param_types.size();
   } else {
-    PrintF("\n");
+    out += "\n";
   }
   size_t local_count = param_count;
   for (auto locals : code.locals) {
-    PrintF(" %*s | locals[%d", 7 + max_octets_per_line * 3, "", local_count);
+    StrAppendFormat(&out, " %*s | locals[%d", 7 + max_octets_per_line * 3, "",
+                    local_count);
     if (locals->count != 1) {
-      PrintF("..%d", local_count + locals->count - 1);
+      StrAppendFormat(&out, "..%d", local_count + locals->count - 1);
     }
-    PrintF("] type=%s\n", concat(locals->type));
+    StrAppendFormat(&out, "] type=%s\n", concat(locals->type));
     local_count += locals->count;
   }
 }
 
-void Tool::PrintInstruction(const Instruction& instr,
-                            SpanU8 data,
-                            SpanU8 post_data,
-                            int indent) {
+void Tool::AppendInstruction(std::string& out,
+                             const Instruction& instr,
+                             SpanU8 data,
+                             SpanU8 post_data,
+                             int indent) {
   bool first_line = true;
   while (data.begin() < post_data.begin()) {
-    PrintF(" %06x:", file_offset(data));
+    StrAppendFormat(&out, " %06x:", file_offset(data));
     int line_octets =
         std::min<int>(max_octets_per_line,
                       static_cast<int>(post_data.begin() - data.begin()));
     for (int i = 0; i < line_octets; ++i) {
-      PrintF(" %02x", data[i]);
+      StrAppendFormat(&out, " %02x", data[i]);
     }
     data.remove_prefix(line_octets);
-    PrintF("%*s |", (max_octets_per_line - line_octets) * 3, "");
+    StrAppendFormat(&out, "%*s |", (max_octets_per_line - line_octets) * 3,
+                    "");
     if (first_line) {
       first_line = false;
-      PrintF(" %*s%s", indent, "", concat(instr));
+      StrAppendFormat(&out, " %*s%s", indent, "", concat(instr));
 
       if (instr.opcode == Opcode::Call) {
-        PrintFunctionName(instr.index_immediate());
+        AppendFunctionName(out, instr.index_immediate());
       } else if (instr.opcode == Opcode::GlobalGet ||
                  instr.opcode == Opcode::GlobalSet) {
-        PrintGlobalName(instr.index_immediate());
+        AppendGlobalName(out, instr.index_immediate());
       } else if (instr.has_block_type_immediate()) {
         auto block_type = instr.block_type_immediate();
         if (block_type->is_index()) {
           auto defined_type_opt = GetDefinedType(block_type->index());
           if (defined_type_opt) {
-            PrintF(" <%s>", concat(defined_type_opt->type));
+            StrAppendFormat(&out, " <%s>", concat(defined_type_opt->type));
           }
         }
       }
     }
-    PrintF("\n");
+    out += "\n";
   }
 }
 
-void Tool::PrintRelocation(const RelocationEntry& entry, size_t file_offset) {
-  PrintF("           %06x: %18s %d", file_offset, concat(entry.type),
-         entry.index);
+void Tool::AppendRelocation(std::string& out,
+                            const RelocationEntry& entry,
+                            size_t file_offset) {
+  StrAppendFormat(&out, "           %06x: %18s %d", file_offset,
+                  concat(entry.type), entry.index);
   if (entry.addend && *entry.addend) {
-    PrintF(" %+d", *entry.addend);
+    StrAppendFormat(&out, " %+d", *entry.addend);
   }
   if (entry.type != RelocationType::TypeIndexLEB) {
-    PrintF(" <%s>", GetSymbolName(entry.index).value_or(""));
+    StrAppendFormat(&out, " <%s>", GetSymbolName(entry.index).value_or(""));
   }
-  PrintF("\n");
+  out += "\n";
 }
 
 size_t Tool::file_offset(SpanU8 data) {
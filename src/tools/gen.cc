@@ -0,0 +1,113 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "src/tools/gen.h"
+
+#include <iostream>
+#include <string>
+
+#include "absl/strings/str_format.h"
+
+#include "src/tools/argparser.h"
+#include "src/tools/generator.h"
+#include "wasp/base/buffer.h"
+#include "wasp/base/output_sink.h"
+#include "wasp/base/span.h"
+#include "wasp/base/str_to_u32.h"
+#include "wasp/base/string_view.h"
+#include "wasp/base/types.h"
+
+namespace wasp {
+namespace tools {
+namespace gen {
+
+using absl::Format;
+
+int Main(span<const string_view> args) {
+  std::string output_filename;
+  GeneratorOptions options;
+
+  ArgParser parser{"wasp gen"};
+  // Returns a callback that parses a u32 into `value`.
+  auto u32_param = [&](u32* value) {
+    return [&parser, value](string_view arg) {
+      auto result = StrToU32(arg);
+      if (!result) {
+        Format(&std::cerr, "Invalid number `%s`\n", arg);
+        parser.PrintHelpAndExit(1);
+      }
+      *value = *result;
+    };
+  };
+
+  parser
+      .Add('h', "--help", "print help and exit",
+           [&]() { parser.PrintHelpAndExit(0); })
+      .Add('o', "--output", "<filename>", "write wasm output to <filename>",
+           [&](string_view arg) { output_filename = arg; })
+      .Add("--seed", "<n>", "seed for the random number generator (default: 0)",
+           u32_param(&options.seed))
+      .Add("--functions", "<n>", "number of functions (default: 100)",
+           u32_param(&options.functions))
+      .Add("--types", "<n>", "number of function types (default: 10)",
+           u32_param(&options.function_types))
+      .Add("--struct-types", "<n>",
+           "number of GC struct types (default: 0, validating the module "
+           "requires the gc feature)",
+           u32_param(&options.struct_types))
+      .Add("--array-types", "<n>",
+           "number of GC array types (default: 0, validating the module "
+           "requires the gc feature)",
+           u32_param(&options.array_types))
+      .Add("--locals", "<n>", "number of locals per function (default: 8)",
+           u32_param(&options.locals))
+      .Add("--globals", "<n>", "number of globals (default: 10)",
+           u32_param(&options.globals))
+      .Add("--instructions", "<n>",
+           "approximate number of instructions per function (default: 100)",
+           u32_param(&options.instructions))
+      .Add("--depth", "<n>",
+           "maximum nesting of blocks, loops and ifs (default: 4)",
+           u32_param(&options.max_depth))
+      .Add("--br-table-size", "<n>",
+           "number of targets of each br_table (default: 8)",
+           u32_param(&options.br_table_size));
+  parser.Parse(args);
+
+  if (output_filename.empty()) {
+    Format(&std::cerr, "No output filename given.\n");
+    parser.PrintHelpAndExit(1);
+  }
+
+  Buffer buffer = GenerateModule(options);
+
+  auto sink = OutputSink::OpenFile(output_filename);
+  if (!sink) {
+    Format(&std::cerr, "Unable to open file %s.\n", output_filename);
+    return 1;
+  }
+
+  sink->Write(buffer);
+  if (!sink->Flush()) {
+    Format(&std::cerr, "Unable to write file %s.\n", output_filename);
+    return 1;
+  }
+  return 0;
+}
+
+}  // namespace gen
+}  // namespace tools
+}  // namespace wasp
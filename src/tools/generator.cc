@@ -0,0 +1,662 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "src/tools/generator.h"
+
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include "wasp/base/macros.h"
+#include "wasp/binary/types.h"
+#include "wasp/binary/write.h"
+
+namespace wasp::tools {
+
+namespace {
+
+using namespace ::wasp::binary;
+
+enum class Kind { I32, I64, F32, F64, Ref };
+
+// A value type, where a Ref always refers to a struct or array type index,
+// and is nullable.
+struct Type {
+  Kind kind;
+  Index index = 0;
+};
+
+enum class FieldKind { I8, I16, I32, I64, F32, F64, Ref };
+
+struct FieldShape {
+  FieldKind kind;
+  Index shape;  // For a Ref, the shape of the struct it refers to.
+  Mutability mut;
+};
+
+// The limit on nesting of operands, so expressions don't grow too large.
+constexpr u32 kMaxExprDepth = 4;
+
+class Generator {
+ public:
+  explicit Generator(const GeneratorOptions& options)
+      : options_{options},
+        rng_{options.seed},
+        shape_count_{std::max<Index>(1, (options.struct_types + 3) / 4)} {}
+
+  Buffer Generate();
+
+ private:
+  // Returns a value in [0, max). The distributions in <random> are
+  // implementation-defined, so reduce the engine's output directly to
+  // generate the same module everywhere.
+  u32 Random(u32 max) {
+    return static_cast<u32>((static_cast<u64>(rng_()) * max) >> 32);
+  }
+
+  bool Chance(u32 percent) { return Random(100) < percent; }
+
+  Index ShapeOf(Index struct_index) const {
+    return struct_index % shape_count_;
+  }
+
+  // Types match if they are the same, or are structurally equivalent structs.
+  bool Matches(const Type& expected, const Type& actual) const {
+    if (expected.kind != actual.kind) {
+      return false;
+    }
+    if (expected.kind != Kind::Ref || expected.index == actual.index) {
+      return true;
+    }
+    return expected.index < options_.struct_types &&
+           actual.index < options_.struct_types &&
+           ShapeOf(expected.index) == ShapeOf(actual.index);
+  }
+
+  // Returns a type index that is structurally equivalent to `index`.
+  Index EquivalentIndex(Index index) {
+    if (index >= options_.struct_types) {
+      return index;
+    }
+    Index shape = ShapeOf(index);
+    Index count = (options_.struct_types - shape + shape_count_ - 1) /
+                  shape_count_;
+    return shape + Random(count) * shape_count_;
+  }
+
+  Type RandomType();
+  ValueType ToValueType(const Type&) const;
+  HeapType ToHeapType(Index index) const { return HeapType{At{index}}; }
+
+  void GenerateTypes(Module&);
+  void GenerateFunctions(Module&);
+  void GenerateGlobals(Module&);
+  UnpackedCode GenerateCode(Index func_index);
+
+  // Function bodies.
+  void Emit(Instruction instr) {
+    instrs_.push_back(std::move(instr));
+    if (budget_ > 0) {
+      budget_--;
+    }
+  }
+  void EmitConst(const Type&);
+  void EmitStatements(u32 depth);
+  void EmitStatement(u32 depth);
+  void EmitExpr(const Type&, u32 depth, u32 expr_depth);
+  void EmitBinary(const Type&, u32 depth, u32 expr_depth);
+  void EmitCall(Index func_index, u32 depth, u32 expr_depth);
+  optional<Index> FindLocal(const Type&);
+  optional<Index> FindGlobal(const Type&, bool must_be_mutable);
+  optional<Index> FindFunction(const Type&);
+
+  GeneratorOptions options_;
+  std::mt19937 rng_;
+  Index shape_count_;
+
+  std::vector<std::vector<Type>> params_;   // Per function type.
+  std::vector<optional<Type>> results_;     // Per function type.
+  std::vector<Index> function_types_;       // Per function.
+  std::vector<std::pair<Type, Mutability>> globals_;
+
+  // The function body being generated.
+  InstructionList instrs_;
+  std::vector<Type> locals_;
+  std::vector<bool> void_labels_;
+  Index budget_ = 0;
+};
+
+Type Generator::RandomType() {
+  switch (Random(10)) {
+    case 0:
+    case 1:
+    case 2:
+    case 3:
+      return Type{Kind::I32};
+    case 4:
+    case 5:
+      return Type{Kind::I64};
+    case 6:
+      return Type{Kind::F32};
+    case 7:
+      return Type{Kind::F64};
+    default: {
+      Index ref_types = options_.struct_types + options_.array_types;
+      if (ref_types == 0) {
+        return Type{Kind::I32};
+      }
+      return Type{Kind::Ref, Random(ref_types)};
+    }
+  }
+}
+
+ValueType Generator::ToValueType(const Type& type) const {
+  switch (type.kind) {
+    case Kind::I32: return ValueType::I32_NoLocation();
+    case Kind::I64: return ValueType::I64_NoLocation();
+    case Kind::F32: return ValueType::F32_NoLocation();
+    case Kind::F64: return ValueType::F64_NoLocation();
+    case Kind::Ref:
+      return ValueType{At{ReferenceType{
+          At{RefType{At{ToHeapType(type.index)}, Null::Yes}}}}};
+  }
+  WASP_UNREACHABLE();
+}
+
+void Generator::GenerateTypes(Module& module) {
+  // Struct types come first, so the fields can refer to earlier structs. Each
+  // shape is chosen once, and every struct with that shape refers to a
+  // randomly chosen struct of the same shape, so they're all equivalent.
+  std::vector<std::vector<FieldShape>> shapes;
+  for (Index shape = 0; shape < shape_count_; ++shape) {
+    std::vector<FieldShape> fields;
+    for (u32 i = 0, count = 1 + Random(6); i < count; ++i) {
+      auto kind = static_cast<FieldKind>(Random(shape > 0 ? 7 : 6));
+      auto mut = Chance(50) ? Mutability::Var : Mutability::Const;
+      Index ref_shape = kind == FieldKind::Ref ? Random(shape) : 0;
+      fields.push_back(FieldShape{kind, ref_shape, mut});
+    }
+    shapes.push_back(std::move(fields));
+  }
+
+  auto storage_type = [&](FieldKind kind, Index ref_index) -> StorageType {
+    switch (kind) {
+      case FieldKind::I8: return StorageType{At{PackedType::I8}};
+      case FieldKind::I16: return StorageType{At{PackedType::I16}};
+      case FieldKind::I32: return StorageType{At{ToValueType(Type{Kind::I32})}};
+      case FieldKind::I64: return StorageType{At{ToValueType(Type{Kind::I64})}};
+      case FieldKind::F32: return StorageType{At{ToValueType(Type{Kind::F32})}};
+      case FieldKind::F64: return StorageType{At{ToValueType(Type{Kind::F64})}};
+      case FieldKind::Ref:
+        return StorageType{At{ToValueType(Type{Kind::Ref, ref_index})}};
+    }
+    WASP_UNREACHABLE();
+  };
+
+  for (Index index = 0; index < options_.struct_types; ++index) {
+    StructType struct_type;
+    for (const auto& field : shapes[ShapeOf(index)]) {
+      // Refer to an earlier struct with the field's shape; one always exists,
+      // since the field's shape is less than this struct's shape.
+      Index ref_index = 0;
+      if (field.kind == FieldKind::Ref) {
+        Index count = (index - field.shape + shape_count_ - 1) / shape_count_;
+        ref_index = field.shape + Random(count) * shape_count_;
+      }
+      struct_type.fields.push_back(
+          FieldType{At{storage_type(field.kind, ref_index)}, At{field.mut}});
+    }
+    module.types.push_back(DefinedType{At{struct_type}});
+  }
+
+  for (Index index = 0; index < options_.array_types; ++index) {
+    auto kind = static_cast<FieldKind>(
+        Random(options_.struct_types > 0 ? 7 : 6));
+    Index ref_index = options_.struct_types > 0
+                          ? Random(options_.struct_types) : 0;
+    module.types.push_back(DefinedType{At{ArrayType{At{FieldType{
+        At{storage_type(kind, ref_index)}, At{Mutability::Var}}}}}});
+  }
+
+  // Function types.
+  for (Index index = 0; index < std::max<Index>(1, options_.function_types);
+       ++index) {
+    FunctionType function_type;
+    std::vector<Type> params;
+    for (u32 i = 0, count = Random(5); i < count; ++i) {
+      params.push_back(RandomType());
+      function_type.param_types.push_back(ToValueType(params.back()));
+    }
+    optional<Type> result;
+    if (Chance(70)) {
+      result = RandomType();
+      function_type.result_types.push_back(ToValueType(*result));
+    }
+    module.types.push_back(DefinedType{At{function_type}});
+    params_.push_back(std::move(params));
+    results_.push_back(result);
+  }
+}
+
+void Generator::GenerateFunctions(Module& module) {
+  Index first_function_type = options_.struct_types + options_.array_types;
+  for (Index index = 0; index < options_.functions; ++index) {
+    Index type = Random(params_.size());
+    function_types_.push_back(type);
+    module.functions.push_back(Function{At{first_function_type + type}});
+  }
+}
+
+void Generator::GenerateGlobals(Module& module) {
+  for (Index index = 0; index < options_.globals; ++index) {
+    Type type = RandomType();
+    auto mut = Chance(50) ? Mutability::Var : Mutability::Const;
+    globals_.emplace_back(type, mut);
+
+    // Initialize the global with a constant, using the body generator.
+    instrs_.clear();
+    EmitConst(type);
+    module.globals.push_back(Global{
+        At{GlobalType{At{ToValueType(type)}, At{mut}}},
+        At{ConstantExpression{instrs_}}});
+  }
+}
+
+UnpackedCode Generator::GenerateCode(Index func_index) {
+  Index type = function_types_[func_index];
+  UnpackedCode code;
+  locals_ = params_[type];
+  for (Index i = 0; i < options_.locals; ++i) {
+    Type local = RandomType();
+    locals_.push_back(local);
+    code.locals.push_back(Locals{At{Index{1}}, At{ToValueType(local)}});
+  }
+
+  instrs_.clear();
+  void_labels_.assign(1, !results_[type].has_value());
+  budget_ = options_.instructions;
+  while (budget_ > 0) {
+    EmitStatement(0);
+  }
+  if (results_[type]) {
+    EmitExpr(*results_[type], 0, 0);
+  }
+  Emit(Instruction{At{Opcode::End}});
+  code.body.instructions = std::move(instrs_);
+  instrs_ = InstructionList{};
+  return code;
+}
+
+void Generator::EmitConst(const Type& type) {
+  switch (type.kind) {
+    case Kind::I32:
+      Emit(Instruction{Opcode::I32Const, s32(Random(1 << 20))});
+      break;
+    case Kind::I64:
+      Emit(Instruction{Opcode::I64Const, s64(Random(1 << 30)) << Random(32)});
+      break;
+    case Kind::F32:
+      Emit(Instruction{Opcode::F32Const, f32(Random(1000)) / 8});
+      break;
+    case Kind::F64:
+      Emit(Instruction{Opcode::F64Const, f64(Random(1000000)) / 64});
+      break;
+    case Kind::Ref:
+      Emit(Instruction{At{Opcode::RefNull},
+                       At{ToHeapType(EquivalentIndex(type.index))}});
+      break;
+  }
+}
+
+void Generator::EmitStatements(u32 depth) {
+  for (u32 i = 0, count = 1 + Random(4); i < count && budget_ > 0; ++i) {
+    EmitStatement(depth);
+  }
+}
+
+void Generator::EmitStatement(u32 depth) {
+  bool can_nest = depth < options_.max_depth;
+  switch (Random(can_nest ? 12 : 7)) {
+    case 0:
+    case 1:
+    case 2: {
+      if (locals_.empty()) {
+        break;
+      }
+      Index local = Random(locals_.size());
+      EmitExpr(locals_[local], depth, 0);
+      Emit(Instruction{Chance(80) ? Opcode::LocalSet : Opcode::LocalTee,
+                       local});
+      if (instrs_.back()->opcode == Opcode::LocalTee) {
+        Emit(Instruction{At{Opcode::Drop}});
+      }
+      break;
+    }
+
+    case 3: {
+      Type type = RandomType();
+      if (auto global = FindGlobal(type, true)) {
+        EmitExpr(type, depth, 0);
+        Emit(Instruction{Opcode::GlobalSet, *global});
+      }
+      break;
+    }
+
+    case 4: {
+      static const std::pair<Kind, Opcode> stores[] = {
+          {Kind::I32, Opcode::I32Store}, {Kind::I64, Opcode::I64Store},
+          {Kind::F32, Opcode::F32Store}, {Kind::F64, Opcode::F64Store}};
+      auto [kind, opcode] = stores[Random(4)];
+      u32 align_log2 = kind == Kind::I32 || kind == Kind::F32 ? 2 : 3;
+      Emit(Instruction{Opcode::I32Const, s32(Random(1 << 16))});
+      EmitExpr(Type{kind}, depth, 1);
+      MemArgImmediate memarg{At{Random(align_log2 + 1)}, At{Random(64)}};
+      Emit(Instruction{At{opcode}, At{memarg}});
+      break;
+    }
+
+    case 5:
+      if (!function_types_.empty()) {
+        Index func = Random(function_types_.size());
+        EmitCall(func, depth, 0);
+        if (results_[function_types_[func]]) {
+          Emit(Instruction{At{Opcode::Drop}});
+        }
+      }
+      break;
+
+    case 6:
+      EmitExpr(RandomType(), depth, 0);
+      Emit(Instruction{At{Opcode::Drop}});
+      break;
+
+    case 7:
+    case 8:
+      Emit(Instruction{At{Opcode::Block}, At{BlockType{At{VoidType{}}}}});
+      void_labels_.push_back(true);
+      EmitStatements(depth + 1);
+      void_labels_.pop_back();
+      Emit(Instruction{At{Opcode::End}});
+      break;
+
+    case 9:
+      Emit(Instruction{At{Opcode::Loop}, At{BlockType{At{VoidType{}}}}});
+      void_labels_.push_back(true);
+      EmitStatements(depth + 1);
+      EmitExpr(Type{Kind::I32}, depth + 1, 0);
+      Emit(Instruction{Opcode::BrIf, Index{0}});
+      void_labels_.pop_back();
+      Emit(Instruction{At{Opcode::End}});
+      break;
+
+    case 10:
+      EmitExpr(Type{Kind::I32}, depth, 0);
+      Emit(Instruction{At{Opcode::If}, At{BlockType{At{VoidType{}}}}});
+      void_labels_.push_back(true);
+      EmitStatements(depth + 1);
+      Emit(Instruction{At{Opcode::Else}});
+      EmitStatements(depth + 1);
+      void_labels_.pop_back();
+      Emit(Instruction{At{Opcode::End}});
+      break;
+
+    case 11: {
+      // Branch to this block, or any enclosing label without a result.
+      Emit(Instruction{At{Opcode::Block}, At{BlockType{At{VoidType{}}}}});
+      void_labels_.push_back(true);
+      EmitStatements(depth + 1);
+      EmitExpr(Type{Kind::I32}, depth + 1, 0);
+      std::vector<Index> depths;
+      for (Index label = 0; label < void_labels_.size(); ++label) {
+        if (void_labels_[void_labels_.size() - 1 - label]) {
+          depths.push_back(label);
+        }
+      }
+      BrTableImmediate immediate;
+      for (Index i = 0; i < options_.br_table_size; ++i) {
+        immediate.targets.push_back(depths[Random(depths.size())]);
+      }
+      immediate.default_target = depths[Random(depths.size())];
+      Emit(Instruction{At{Opcode::BrTable}, At{immediate}});
+      void_labels_.pop_back();
+      Emit(Instruction{At{Opcode::End}});
+      break;
+    }
+  }
+}
+
+void Generator::EmitExpr(const Type& type, u32 depth, u32 expr_depth) {
+  bool can_nest = budget_ > 0 && expr_depth < kMaxExprDepth;
+  if (type.kind == Kind::Ref || !can_nest || Chance(30)) {
+    switch (Random(3)) {
+      case 0:
+        if (auto local = FindLocal(type)) {
+          Emit(Instruction{Opcode::LocalGet, *local});
+          return;
+        }
+        break;
+      case 1:
+        if (auto global = FindGlobal(type, false)) {
+          Emit(Instruction{Opcode::GlobalGet, *global});
+          return;
+        }
+        break;
+    }
+    EmitConst(type);
+    return;
+  }
+
+  bool can_nest_block = depth < options_.max_depth;
+  switch (Random(can_nest_block ? 7 : 5)) {
+    case 0:
+    case 1:
+      EmitBinary(type, depth, expr_depth);
+      break;
+
+    case 2: {
+      static const Opcode loads[] = {Opcode::I32Load, Opcode::I64Load,
+                                     Opcode::F32Load, Opcode::F64Load};
+      u32 align_log2 = type.kind == Kind::I32 || type.kind == Kind::F32 ? 2 : 3;
+      EmitExpr(Type{Kind::I32}, depth, expr_depth + 1);
+      Emit(Instruction{At{loads[static_cast<int>(type.kind)]},
+                       At{MemArgImmediate{At{Random(align_log2 + 1)},
+                                          At{Random(64)}}}});
+      break;
+    }
+
+    case 3:
+      if (auto func = FindFunction(type)) {
+        EmitCall(*func, depth, expr_depth + 1);
+      } else {
+        EmitBinary(type, depth, expr_depth);
+      }
+      break;
+
+    case 4:
+      EmitExpr(type, depth, expr_depth + 1);
+      EmitExpr(type, depth, expr_depth + 1);
+      EmitExpr(Type{Kind::I32}, depth, expr_depth + 1);
+      Emit(Instruction{At{Opcode::Select}});
+      break;
+
+    case 5:
+      Emit(Instruction{At{Opcode::Block},
+                       At{BlockType{At{ToValueType(type)}}}});
+      void_labels_.push_back(false);
+      EmitStatements(depth + 1);
+      EmitExpr(type, depth + 1, 0);
+      void_labels_.pop_back();
+      Emit(Instruction{At{Opcode::End}});
+      break;
+
+    case 6:
+      EmitExpr(Type{Kind::I32}, depth, expr_depth + 1);
+      Emit(Instruction{At{Opcode::If}, At{BlockType{At{ToValueType(type)}}}});
+      void_labels_.push_back(false);
+      EmitExpr(type, depth + 1, 0);
+      Emit(Instruction{At{Opcode::Else}});
+      EmitExpr(type, depth + 1, 0);
+      void_labels_.pop_back();
+      Emit(Instruction{At{Opcode::End}});
+      break;
+  }
+}
+
+void Generator::EmitBinary(const Type& type, u32 depth, u32 expr_depth) {
+  // Unary conversions from another type, and binary operators.
+  static const Opcode i32_ops[] = {Opcode::I32Add, Opcode::I32Sub,
+                                   Opcode::I32Mul, Opcode::I32And,
+                                   Opcode::I32Or,  Opcode::I32Xor,
+                                   Opcode::I32Shl};
+  static const Opcode i64_ops[] = {Opcode::I64Add, Opcode::I64Sub,
+                                   Opcode::I64Mul, Opcode::I64And};
+  static const Opcode f32_ops[] = {Opcode::F32Add, Opcode::F32Sub,
+                                   Opcode::F32Mul};
+  static const Opcode f64_ops[] = {Opcode::F64Add, Opcode::F64Sub,
+                                   Opcode::F64Mul};
+
+  if (Chance(20)) {
+    switch (type.kind) {
+      case Kind::I32:
+        if (Chance(50)) {
+          EmitExpr(Type{Kind::I64}, depth, expr_depth + 1);
+          Emit(Instruction{At{Opcode::I32WrapI64}});
+        } else {
+          EmitExpr(Type{Kind::I64}, depth, expr_depth + 1);
+          EmitExpr(Type{Kind::I64}, depth, expr_depth + 1);
+          Emit(Instruction{At{Opcode::I64LtS}});
+        }
+        return;
+      case Kind::I64:
+        EmitExpr(Type{Kind::I32}, depth, expr_depth + 1);
+        Emit(Instruction{At{Opcode::I64ExtendI32S}});
+        return;
+      case Kind::F32:
+        EmitExpr(Type{Kind::I32}, depth, expr_depth + 1);
+        Emit(Instruction{At{Opcode::F32ConvertI32S}});
+        return;
+      case Kind::F64:
+        EmitExpr(Type{Kind::F32}, depth, expr_depth + 1);
+        Emit(Instruction{At{Opcode::F64PromoteF32}});
+        return;
+      case Kind::Ref:
+        break;
+    }
+  }
+
+  EmitExpr(type, depth, expr_depth + 1);
+  EmitExpr(type, depth, expr_depth + 1);
+  switch (type.kind) {
+    case Kind::I32: Emit(Instruction{At{i32_ops[Random(7)]}}); break;
+    case Kind::I64: Emit(Instruction{At{i64_ops[Random(4)]}}); break;
+    case Kind::F32: Emit(Instruction{At{f32_ops[Random(3)]}}); break;
+    case Kind::F64: Emit(Instruction{At{f64_ops[Random(3)]}}); break;
+    case Kind::Ref: WASP_UNREACHABLE();
+  }
+}
+
+void Generator::EmitCall(Index func_index, u32 depth, u32 expr_depth) {
+  for (const auto& param : params_[function_types_[func_index]]) {
+    EmitExpr(param, depth, expr_depth);
+  }
+  Emit(Instruction{Opcode::Call, func_index});
+}
+
+optional<Index> Generator::FindLocal(const Type& type) {
+  // Try a few random locals, rather than searching them all.
+  for (int i = 0; i < 4 && !locals_.empty(); ++i) {
+    Index local = Random(locals_.size());
+    if (Matches(type, locals_[local])) {
+      return local;
+    }
+  }
+  return nullopt;
+}
+
+optional<Index> Generator::FindGlobal(const Type& type, bool must_be_mutable) {
+  for (int i = 0; i < 4 && !globals_.empty(); ++i) {
+    Index global = Random(globals_.size());
+    const auto& [global_type, mut] = globals_[global];
+    if ((!must_be_mutable || mut == Mutability::Var) &&
+        (must_be_mutable ? global_type.kind == type.kind &&
+                               global_type.index == type.index
+                         : Matches(type, global_type))) {
+      return global;
+    }
+  }
+  return nullopt;
+}
+
+optional<Index> Generator::FindFunction(const Type& type) {
+  for (int i = 0; i < 4 && !function_types_.empty(); ++i) {
+    Index func = Random(function_types_.size());
+    const auto& result = results_[function_types_[func]];
+    if (result && Matches(type, *result)) {
+      return func;
+    }
+  }
+  return nullopt;
+}
+
+Buffer Generator::Generate() {
+  // Everything but the code section is written with binary::Write(Module).
+  Module module;
+  GenerateTypes(module);
+  GenerateFunctions(module);
+  module.memories.push_back(
+      Memory{At{MemoryType{At{Limits{At{u32{1}}}}}}});
+  GenerateGlobals(module);
+
+  Buffer buffer;
+  Write(module, std::back_inserter(buffer));
+
+  // The function bodies are written as they're generated, so only one is in
+  // memory at a time.
+  if (!function_types_.empty()) {
+    LengthPatcher patcher{buffer, LengthEncoding::Minimal};
+    auto out = std::back_inserter(buffer);
+    out = Write(SectionId::Code, out);
+    patcher.Begin();
+    out = WriteIndex(function_types_.size(), out);
+    for (Index func = 0; func < function_types_.size(); ++func) {
+      auto code = GenerateCode(func);
+      patcher.Begin();
+      out = WriteVector(code.locals.begin(), code.locals.end(), out);
+      out = Write(code.body, out);
+      patcher.End();
+    }
+    patcher.End();
+    patcher.Finish();
+  }
+  return buffer;
+}
+
+}  // namespace
+
+Buffer GenerateModule(const GeneratorOptions& options) {
+  return Generator{options}.Generate();
+}
+
+Features GeneratorFeatures(const GeneratorOptions& options) {
+  Features features;
+  if (options.struct_types > 0 || options.array_types > 0) {
+    features.enable_gc();
+  }
+  return features;
+}
+
+}  // namespace wasp::tools
@@ -0,0 +1,56 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_TOOLS_GENERATOR_H_
+#define WASP_TOOLS_GENERATOR_H_
+
+#include "wasp/base/buffer.h"
+#include "wasp/base/features.h"
+#include "wasp/base/types.h"
+
+namespace wasp::tools {
+
+struct GeneratorOptions {
+  u32 seed = 0;
+  Index functions = 100;
+  Index function_types = 10;
+  Index struct_types = 0;
+  Index array_types = 0;
+  Index locals = 8;           // Per function, not including the params.
+  Index globals = 10;
+  Index instructions = 100;   // Per function, approximately.
+  u32 max_depth = 4;          // Maximum nesting of blocks, loops and ifs.
+  Index br_table_size = 8;    // Number of targets of each br_table.
+};
+
+// Generates a valid module from random instruction sequences. The same
+// options always generate the same module, so large modules can be
+// reproduced from their options alone rather than shared.
+//
+// Struct types are generated in groups that are structurally equivalent but
+// have different indexes, and values are passed between them, so validation
+// has to compare the types structurally.
+//
+// Only the function bodies are kept in memory as instructions, one at a time,
+// so the size of the module is only limited by the size of its binary form.
+Buffer GenerateModule(const GeneratorOptions&);
+
+// The features required to validate a module generated with `options`.
+Features GeneratorFeatures(const GeneratorOptions& options);
+
+}  // namespace wasp::tools
+
+#endif  // WASP_TOOLS_GENERATOR_H_
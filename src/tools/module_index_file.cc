@@ -0,0 +1,56 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "src/tools/module_index_file.h"
+
+#include <iostream>
+#include <string>
+#include <utility>
+
+#include "absl/strings/str_format.h"
+
+#include "wasp/base/buffer.h"
+#include "wasp/base/file.h"
+#include "wasp/base/output_sink.h"
+
+namespace wasp::tools {
+
+binary::ModuleIndex GetModuleIndex(const binary::LazyModule& module,
+                                   string_view filename) {
+  if (filename.empty()) {
+    return binary::BuildModuleIndex(module);
+  }
+
+  if (auto data = ReadFile(filename)) {
+    if (auto index = binary::ReadModuleIndex(*data, module.data)) {
+      return std::move(*index);
+    }
+  }
+
+  auto index = binary::BuildModuleIndex(module);
+  Buffer buffer;
+  binary::WriteModuleIndex(index, buffer);
+  auto sink = OutputSink::OpenFile(filename);
+  if (sink) {
+    sink->Write(buffer);
+  }
+  if (!sink || !sink->Flush()) {
+    absl::Format(&std::cerr, "Unable to write index %s\n", filename);
+  }
+  return index;
+}
+
+}  // namespace wasp::tools
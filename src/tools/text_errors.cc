@@ -89,6 +89,11 @@ auto TextErrors::GetLineColumn(Offset offset) const -> std::pair<Line, Column> {
 
 auto TextErrors::ErrorToString(const Error& error) const -> std::string {
   auto& loc = error.loc;
+  if (loc.data() == nullptr) {
+    // No location, e.g. when built without WASP_LOCATIONS.
+    return absl::StrFormat("%s: %s\n", filename, error.message);
+  }
+
   Offset loc_start = loc.begin() - data.data();
   Offset loc_end = loc.end() - data.data();
   auto [line, column] = GetLineColumn(loc_start);
@@ -18,10 +18,17 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <mutex>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "absl/strings/str_format.h"
@@ -33,8 +40,10 @@
 #include "wasp/base/file.h"
 #include "wasp/base/formatters.h"
 #include "wasp/base/optional.h"
+#include "wasp/base/str_to_u32.h"
 #include "wasp/base/string_view.h"
 #include "wasp/binary/formatters.h"
+#include "wasp/binary/streaming_module_reader.h"
 #include "wasp/valid/valid_ctx.h"
 #include "wasp/valid/validate_visitor.h"
 
@@ -50,19 +59,46 @@ using namespace ::wasp::binary;
 struct Options {
   Features features;
   bool verbose = false;
+  bool print_stats = false;
+  bool stream = false;
+  u32 jobs = 1;
+  u32 code_jobs = 1;
+  u32 chunk_size = 64 * 1024;
 };
 
+// The result of validating one file. The output is buffered so reports can be
+// printed in the order the files were given, regardless of which worker
+// finished first.
+struct Report {
+  bool ok = false;
+  size_t size = 0;
+  std::string out;
+  std::string err;
+};
+
+Report ValidateFile(string_view filename, const Options&);
+bool StreamFile(string_view filename, const Options&);
+
 struct Tool {
-  explicit Tool(string_view filename, SpanU8 data, Options);
+  explicit Tool(string_view filename, const MappedFile&, Options);
 
   bool Run();
 
+  struct Visitor : valid::ValidateVisitor {
+    explicit Visitor(Tool&);
+
+    auto OnSection(At<Section>) -> Result;
+
+    Tool& tool;
+  };
+
   std::string filename;
   Options options;
+  const MappedFile& file;
   SpanU8 data;
   BinaryErrors errors;
   LazyModule module;
-  valid::ValidateVisitor visitor;
+  Visitor visitor;
 };
 
 int Main(span<const string_view> args) {
@@ -75,6 +111,42 @@ int Main(span<const string_view> args) {
            [&]() { parser.PrintHelpAndExit(0); })
       .Add('v', "--verbose", "print filename and whether it was valid",
            [&]() { options.verbose = true; })
+      .Add('j', "--jobs", "<n>",
+           "validate <n> files in parallel (0 means one per core)",
+           [&](string_view arg) {
+             auto jobs = StrToU32(arg);
+             if (!jobs) {
+               Format(&std::cerr, "Invalid job count `%s`\n", arg);
+               parser.PrintHelpAndExit(1);
+             }
+             options.jobs = *jobs;
+           })
+      .Add("--code-jobs", "<n>",
+           "validate function bodies of each file using <n> threads (0 "
+           "means one per core)",
+           [&](string_view arg) {
+             auto jobs = StrToU32(arg);
+             if (!jobs) {
+               Format(&std::cerr, "Invalid job count `%s`\n", arg);
+               parser.PrintHelpAndExit(1);
+             }
+             options.code_jobs = *jobs;
+           })
+      .Add("--stats", "print throughput statistics when done",
+           [&]() { options.print_stats = true; })
+      .Add("--stream",
+           "read each file in chunks, validating as they arrive (use `-` "
+           "for stdin)",
+           [&]() { options.stream = true; })
+      .Add("--chunk-size", "<n>", "read <n> bytes at a time when streaming",
+           [&](string_view arg) {
+             auto size = StrToU32(arg);
+             if (!size || *size == 0) {
+               Format(&std::cerr, "Invalid chunk size `%s`\n", arg);
+               parser.PrintHelpAndExit(1);
+             }
+             options.chunk_size = *size;
+           })
       .AddFeatureFlags(options.features)
       .Add("<filenames...>", "input wasm files",
            [&](string_view arg) { filenames.push_back(arg); });
@@ -85,35 +157,204 @@ int Main(span<const string_view> args) {
     parser.PrintHelpAndExit(1);
   }
 
-  bool ok = true;
-  for (auto filename : filenames) {
-    auto optbuf = ReadFile(filename);
-    if (!optbuf) {
-      Format(&std::cerr, "Error reading file %s.\n", filename);
-      ok = false;
-      continue;
+  if (options.stream) {
+    // Streamed files are validated one at a time, so errors can be reported
+    // as soon as they are found.
+    bool ok = true;
+    for (auto filename : filenames) {
+      ok &= StreamFile(filename, options);
     }
+    return ok ? 0 : 1;
+  }
+
+  u32 jobs = options.jobs;
+  if (jobs == 0) {
+    jobs = std::max(1u, std::thread::hardware_concurrency());
+  }
+  jobs = std::min<size_t>(jobs, filenames.size());
+  if (options.code_jobs == 0) {
+    options.code_jobs = std::max(1u, std::thread::hardware_concurrency());
+  }
 
-    SpanU8 data{*optbuf};
-    Tool tool{filename, data, options};
-    bool valid = tool.Run();
-    if (!valid || options.verbose) {
-      PrintF("[%4s] %s\n", valid ? " OK " : "FAIL", filename);
-      tool.errors.PrintTo(std::cerr);
+  auto start = std::chrono::steady_clock::now();
+
+  // Each worker claims the next unvalidated file, and has its own Tool (and
+  // therefore its own ValidCtx and BinaryErrors). The main thread prints the
+  // reports in filename order as they become available.
+  std::vector<Report> reports(filenames.size());
+  std::vector<bool> done(filenames.size());
+  std::mutex mutex;
+  std::condition_variable cond;
+  std::atomic<size_t> next{0};
+
+  auto worker = [&]() {
+    for (size_t i; (i = next++) < filenames.size();) {
+      auto report = ValidateFile(filenames[i], options);
+      {
+        std::lock_guard<std::mutex> lock{mutex};
+        reports[i] = std::move(report);
+        done[i] = true;
+      }
+      cond.notify_one();
     }
-    ok &= valid;
+  };
+
+  std::vector<std::thread> threads;
+  for (u32 i = 0; i < jobs; ++i) {
+    threads.emplace_back(worker);
+  }
+
+  bool ok = true;
+  size_t total_size = 0;
+  for (size_t i = 0; i < filenames.size(); ++i) {
+    Report report;
+    {
+      std::unique_lock<std::mutex> lock{mutex};
+      cond.wait(lock, [&]() { return done[i]; });
+      report = std::move(reports[i]);
+    }
+    std::cout << report.out;
+    std::cerr << report.err;
+    ok &= report.ok;
+    total_size += report.size;
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  if (options.print_stats) {
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    double seconds = std::max(elapsed.count(), 1e-9);
+    double megabytes = total_size / (1024.0 * 1024.0);
+    PrintF("%zu files, %.2f MiB in %.3fs (%.1f files/s, %.2f MiB/s, %u jobs)\n",
+           filenames.size(), megabytes, seconds, filenames.size() / seconds,
+           megabytes / seconds, jobs);
   }
 
   return ok ? 0 : 1;
 }
 
-Tool::Tool(string_view filename, SpanU8 data, Options options)
+Report ValidateFile(string_view filename, const Options& options) {
+  Report report;
+  auto optfile = MapFile(filename);
+  if (!optfile) {
+    report.err = absl::StrFormat("Error reading file %s.\n", filename);
+    return report;
+  }
+
+  Tool tool{filename, *optfile, options};
+  report.ok = tool.Run();
+  report.size = optfile->data().size();
+  if (!report.ok || options.verbose) {
+    report.out = absl::StrFormat("[%4s] %s\n", report.ok ? " OK " : "FAIL",
+                                 filename);
+    std::ostringstream err;
+    tool.errors.PrintTo(err);
+    report.err = err.str();
+  }
+  return report;
+}
+
+// Prints each error as soon as it is reported, with its offset in the
+// stream.
+class StreamErrors : public Errors {
+ public:
+  explicit StreamErrors(string_view filename) : filename{filename} {}
+
+  bool HasError() const override { return has_error; }
+
+  std::string filename;
+  const StreamingModuleReaderBase* reader = nullptr;
+  bool has_error = false;
+
+ protected:
+  void HandlePushContext(Location loc, string_view desc) override {}
+  void HandlePopContext() override {}
+  void HandleOnError(Location loc, string_view message) override {
+    has_error = true;
+    auto offset = reader->offset(loc.data());
+    if (offset) {
+      Format(&std::cerr, "%s:%08x: %s\n", filename, *offset, message);
+    } else {
+      Format(&std::cerr, "%s: %s\n", filename, message);
+    }
+  }
+};
+
+bool StreamFile(string_view filename, const Options& options) {
+  using Clock = std::chrono::steady_clock;
+  auto start = Clock::now();
+
+  std::FILE* file = filename == "-" ? stdin
+                                    : std::fopen(std::string{filename}.c_str(),
+                                                 "rb");
+  if (!file) {
+    Format(&std::cerr, "Error reading file %s.\n", filename);
+    return false;
+  }
+
+  // Function bodies are validated as they arrive, so there is no code
+  // section to split between threads.
+  StreamErrors errors{filename};
+  valid::ValidateVisitor visitor{options.features, errors};
+  StreamingModuleReader<valid::ValidateVisitor> reader{options.features,
+                                                       errors, visitor};
+  errors.reader = &reader;
+
+  optional<Clock::time_point> first_error;
+  std::vector<u8> chunk(options.chunk_size);
+  size_t count;
+  while ((count = std::fread(chunk.data(), 1, chunk.size(), file)) > 0) {
+    if (reader.Feed(SpanU8{chunk.data(), count}) == visit::Result::Fail) {
+      first_error = Clock::now();
+      break;
+    }
+  }
+  // fread returns 0 on a read error as well as at the end of the file, and
+  // the bytes read so far may end at a section boundary, so they would be
+  // valid on their own.
+  if (!first_error && std::ferror(file)) {
+    if (file != stdin) {
+      std::fclose(file);
+    }
+    Format(&std::cerr, "Error reading file %s.\n", filename);
+    return false;
+  }
+  auto last_byte = Clock::now();
+  bool ok = reader.Finish() == visit::Result::Ok;
+  auto done = Clock::now();
+  if (file != stdin) {
+    std::fclose(file);
+  }
+
+  if (!ok || options.verbose) {
+    PrintF("[%4s] %s\n", ok ? " OK " : "FAIL", filename);
+  }
+  if (options.print_stats) {
+    auto seconds = [&](Clock::time_point t) {
+      return std::chrono::duration<double>(t - start).count();
+    };
+    if (first_error) {
+      PrintF("%s: first error after %zu bytes, at %.3fs\n", filename,
+             reader.size(), seconds(*first_error));
+    } else {
+      PrintF("%s: %zu bytes, last byte at %.3fs, done at %.3fs\n", filename,
+             reader.size(), seconds(last_byte), seconds(done));
+    }
+  }
+  return ok;
+}
+
+Tool::Tool(string_view filename, const MappedFile& file, Options options)
     : filename(filename),
       options{options},
-      data{data},
+      file{file},
+      data{file.data()},
       errors{data},
       module{ReadLazyModule(data, options.features, errors)},
-      visitor{options.features, errors} {}
+      visitor{*this} {}
 
 bool Tool::Run() {
   if (module.magic && module.version) {
@@ -122,6 +363,18 @@ bool Tool::Run() {
   return !errors.HasError();
 }
 
+Tool::Visitor::Visitor(Tool& tool)
+    : valid::ValidateVisitor{tool.options.features, tool.errors,
+                             tool.options.code_jobs},
+      tool{tool} {}
+
+auto Tool::Visitor::OnSection(At<Section> section) -> Result {
+  // Start paging in each section as it is reached, rather than faulting it in
+  // one page at a time.
+  tool.file.Advise(section.loc(), Advice::WillNeed);
+  return ValidateVisitor::OnSection(section);
+}
+
 }  // namespace validate
 }  // namespace tools
 }  // namespace wasp
@@ -14,9 +14,13 @@
 // limitations under the License.
 //
 
+#include <algorithm>
+#include <atomic>
+#include <cassert>
 #include <filesystem>
-#include <fstream>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 #include "absl/strings/str_format.h"
 
@@ -27,19 +31,25 @@
 #include "wasp/base/features.h"
 #include "wasp/base/file.h"
 #include "wasp/base/formatters.h"
+#include "wasp/base/output_sink.h"
 #include "wasp/base/span.h"
+#include "wasp/base/str_to_u32.h"
 #include "wasp/base/string_view.h"
 #include "wasp/binary/encoding.h"
 #include "wasp/binary/formatters.h"
+#include "wasp/binary/lazy_module.h"
+#include "wasp/binary/packed_expression.h"
 #include "wasp/binary/read.h"
 #include "wasp/binary/read/read_ctx.h"
 #include "wasp/binary/types.h"
+#include "wasp/binary/visitor.h"
 #include "wasp/convert/to_text.h"
 #include "wasp/text/formatters.h"
 #include "wasp/text/types.h"
 #include "wasp/text/write.h"
 #include "wasp/valid/valid_ctx.h"
 #include "wasp/valid/validate.h"
+#include "wasp/valid/validate_visitor.h"
 
 namespace fs = std::filesystem;
 
@@ -50,18 +60,40 @@ namespace wasm2wat {
 using absl::PrintF;
 using absl::Format;
 
+using binary::visit::Result;
+
 struct Options {
   Features features;
   bool validate = true;
+  bool stream = false;
+  u32 jobs = 1;
   optional<std::string> output_filename;
 };
 
+// The number of functions read and validated at a time in streaming mode,
+// per job.
+constexpr size_t kStreamingFunctionsPerJob = 16;
+
 struct Tool {
   explicit Tool(string_view filename, SpanU8 data, Options);
 
   enum class PrintChars { No, Yes };
 
   int Run();
+  int RunStreaming();
+  optional<OutputSink> OpenOutput();
+  int CloseOutput(OutputSink&);
+  void WriteFields(text::WriteCtx&, const binary::Module&, OutputSink&);
+  // Converts and writes the functions using `options.jobs` threads. Each chunk
+  // of functions has its own TextCtx and WriteCtx, and the chunks are written
+  // in order, so the output is the same as converting them serially.
+  // `after_function` is true if a function has already been written.
+  template <typename Code>
+  void WriteFunctions(const text::WriteCtx&,
+                      span<const At<binary::Function>>,
+                      span<const Code>,
+                      bool after_function,
+                      OutputSink&);
 
   std::string filename;
   Options options;
@@ -80,6 +112,20 @@ int Main(span<const string_view> args) {
            [&](string_view arg) { options.output_filename = arg; })
       .Add("--no-validate", "Don't validate before writing",
            [&]() { options.validate = false; })
+      .Add("--stream",
+           "convert one function at a time, to reduce memory use. If a "
+           "function is invalid, the functions before it are still written",
+           [&]() { options.stream = true; })
+      .Add('j', "--jobs", "<n>",
+           "convert function bodies using <n> threads (0 means one per core)",
+           [&](string_view arg) {
+             auto jobs = StrToU32(arg);
+             if (!jobs) {
+               Format(&std::cerr, "Invalid job count `%s`\n", arg);
+               parser.PrintHelpAndExit(1);
+             }
+             options.jobs = *jobs;
+           })
       .AddFeatureFlags(options.features)
       .Add("<filename>", "input wasm file", [&](string_view arg) {
         if (filename.empty()) {
@@ -95,8 +141,8 @@ int Main(span<const string_view> args) {
     parser.PrintHelpAndExit(1);
   }
 
-  auto optbuf = ReadFile(filename);
-  if (!optbuf) {
+  auto optfile = MapFile(filename);
+  if (!optfile) {
     Format(&std::cerr, "Error reading file %s.\n", filename);
     return 1;
   }
@@ -107,7 +153,11 @@ int Main(span<const string_view> args) {
         fs::path(filename).replace_extension(".wat").string();
   }
 
-  SpanU8 data{*optbuf};
+  if (options.jobs == 0) {
+    options.jobs = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  SpanU8 data = optfile->data();
   Tool tool{filename, data, options};
   return tool.Run();
 }
@@ -116,6 +166,10 @@ Tool::Tool(string_view filename, SpanU8 data, Options options)
     : filename{filename}, options{options}, data{data} {}
 
 int Tool::Run() {
+  if (options.stream) {
+    return RunStreaming();
+  }
+
   BinaryErrors errors{data};
   binary::ReadCtx read_context{options.features, errors};
   auto binary_module = binary::ReadModule(data, read_context);
@@ -134,28 +188,272 @@ int Tool::Run() {
     }
   }
 
-  convert::TextCtx convert_context;
-  auto text_module = convert::ToText(convert_context, *binary_module);
+  auto sink = OpenOutput();
+  if (!sink) {
+    return 1;
+  }
+
+  // The functions are converted separately from the rest of the module, so
+  // they can be converted in parallel.
+  auto functions = std::move(binary_module->functions);
+  auto codes = std::move(binary_module->codes);
+  binary_module->functions.clear();
+  binary_module->codes.clear();
 
   text::WriteCtx write_context;
-  Buffer buffer;
-  text::Write(write_context, text_module, std::back_inserter(buffer));
+  WriteFields(write_context, *binary_module, *sink);
+  WriteFunctions<At<binary::UnpackedCode>>(write_context, functions, codes,
+                                          false, *sink);
+  return CloseOutput(*sink);
+}
 
-  auto span = ToStringView(buffer);
-  if (options.output_filename) {
-    std::ofstream fstream(*options.output_filename,
-                          std::ios_base::out | std::ios_base::binary);
-    if (!fstream) {
-      Format(&std::cerr, "Unable to open file %s.\n", *options.output_filename);
-      return 1;
+optional<OutputSink> Tool::OpenOutput() {
+  if (!options.output_filename) {
+    return OutputSink::Stdout();
+  }
+  auto sink = OutputSink::OpenFile(*options.output_filename);
+  if (!sink) {
+    Format(&std::cerr, "Unable to open file %s.\n", *options.output_filename);
+  }
+  return sink;
+}
+
+int Tool::CloseOutput(OutputSink& sink) {
+  if (!sink.Flush()) {
+    Format(&std::cerr, "Unable to write output.\n");
+    return 1;
+  }
+  return 0;
+}
+
+// Collects every section of the module except the function bodies, which are
+// only located, and validates them if `validator` is non-null.
+struct ModuleFieldsVisitor : binary::visit::Visitor {
+  template <typename T>
+  using ValidateFunction =
+      Result (valid::ValidateVisitor::*)(const At<T>&);
+
+  template <typename T>
+  Result Add(std::vector<At<T>>& items,
+             const At<T>& item,
+             ValidateFunction<T> validate) {
+    items.push_back(item);
+    return validator ? (validator->*validate)(item) : Result::Ok;
+  }
+
+  Result BeginTypeSection(binary::LazyTypeSection sec) {
+    return validator ? validator->BeginTypeSection(sec) : Result::Ok;
+  }
+  Result OnType(const At<binary::DefinedType>& value) {
+    return Add(module.types, value, &valid::ValidateVisitor::OnType);
+  }
+  Result EndTypeSection(binary::LazyTypeSection sec) {
+    return validator ? validator->EndTypeSection(sec) : Result::Ok;
+  }
+  Result OnImport(const At<binary::Import>& value) {
+    return Add(module.imports, value, &valid::ValidateVisitor::OnImport);
+  }
+  Result OnFunction(const At<binary::Function>& value) {
+    return Add(functions, value, &valid::ValidateVisitor::OnFunction);
+  }
+  Result OnTable(const At<binary::Table>& value) {
+    return Add(module.tables, value, &valid::ValidateVisitor::OnTable);
+  }
+  Result OnMemory(const At<binary::Memory>& value) {
+    return Add(module.memories, value, &valid::ValidateVisitor::OnMemory);
+  }
+  Result OnGlobal(const At<binary::Global>& value) {
+    return Add(module.globals, value, &valid::ValidateVisitor::OnGlobal);
+  }
+  Result OnTag(const At<binary::Tag>& value) {
+    return Add(module.tags, value, &valid::ValidateVisitor::OnTag);
+  }
+  Result OnExport(const At<binary::Export>& value) {
+    return Add(module.exports, value, &valid::ValidateVisitor::OnExport);
+  }
+  Result OnStart(const At<binary::Start>& value) {
+    module.start = value;
+    return validator ? validator->OnStart(value) : Result::Ok;
+  }
+  Result OnElement(const At<binary::ElementSegment>& value) {
+    return Add(module.element_segments, value,
+               &valid::ValidateVisitor::OnElement);
+  }
+  Result OnDataCount(const At<binary::DataCount>& value) {
+    module.data_count = value;
+    return validator ? validator->OnDataCount(value) : Result::Ok;
+  }
+  Result BeginCode(const At<binary::Code>& value) {
+    codes.push_back(value);
+    return Result::Skip;
+  }
+  Result OnData(const At<binary::DataSegment>& value) {
+    return Add(module.data_segments, value, &valid::ValidateVisitor::OnData);
+  }
+
+  valid::ValidateVisitor* validator;
+  binary::Module module;  // Without functions or codes.
+  std::vector<At<binary::Function>> functions;
+  std::vector<At<binary::Code>> codes;
+};
+
+// A function body read in streaming mode. The instructions are decoded
+// directly into a PackedExpression, which is much smaller than the equivalent
+// InstructionList.
+struct PackedCode {
+  binary::LocalsList locals;
+  binary::PackedExpression body;
+};
+
+int Tool::RunStreaming() {
+  BinaryErrors errors{data};
+  auto lazy_module = binary::ReadLazyModule(data, options.features, errors);
+  optional<valid::ValidateVisitor> validator;
+  if (options.validate) {
+    validator.emplace(options.features, errors);
+  }
+
+  // Everything but the function bodies is read and validated up front, so
+  // errors there are reported before anything is written.
+  ModuleFieldsVisitor fields_visitor;
+  fields_visitor.validator = validator ? &*validator : nullptr;
+  if (binary::visit::Visit(lazy_module, fields_visitor) == Result::Fail ||
+      errors.HasError()) {
+    errors.PrintTo(std::cerr);
+    return 1;
+  }
+
+  auto sink = OpenOutput();
+  if (!sink) {
+    return 1;
+  }
+
+  text::WriteCtx write_context;
+  WriteFields(write_context, fields_visitor.module, *sink);
+
+  // Then the functions are read and validated a few at a time, and converted
+  // and written before moving on to the next few.
+  const size_t window = kStreamingFunctionsPerJob * options.jobs;
+  const auto& codes = fields_visitor.codes;
+  span<const At<binary::Function>> functions = fields_visitor.functions;
+  std::vector<PackedCode> packed_codes;
+  for (size_t begin = 0; begin < codes.size(); begin += window) {
+    size_t end = std::min(begin + window, codes.size());
+    packed_codes.clear();
+    for (size_t i = begin; i < end; ++i) {
+      const auto& code = codes[i];
+      if (validator && validator->BeginCode(code) == Result::Fail) {
+        errors.PrintTo(std::cerr);
+        return 1;
+      }
+      lazy_module.ctx.open_blocks.clear();
+      auto body = binary::ReadPackedExpression(*code->body, lazy_module.ctx);
+      binary::EndCode(code->body->data.last(0), lazy_module.ctx);
+      bool ok = !errors.HasError();
+      for (size_t j = 0; validator && ok && j < body.size(); ++j) {
+        ok = validator->OnInstruction(body[j]) != Result::Fail;
+      }
+      if (!ok || errors.HasError()) {
+        errors.PrintTo(std::cerr);
+        return 1;
+      }
+      packed_codes.push_back(PackedCode{code->locals, std::move(body)});
+    }
+    WriteFunctions<PackedCode>(write_context,
+                               functions.subspan(begin, end - begin),
+                               packed_codes, begin > 0, *sink);
+  }
+
+  return CloseOutput(*sink);
+}
+
+void Tool::WriteFields(text::WriteCtx& write_context,
+                       const binary::Module& module,
+                       OutputSink& sink) {
+  convert::TextCtx convert_context;
+  auto text_module = convert::ToText(convert_context, module);
+  text::Write(write_context, *text_module, sink.out());
+}
+
+namespace {
+
+void CodeToText(convert::TextCtx& ctx,
+                const At<binary::UnpackedCode>& code,
+                At<text::Function>& function) {
+  convert::ToText(ctx, code, function);
+}
+
+void CodeToText(convert::TextCtx& ctx,
+                const PackedCode& code,
+                At<text::Function>& function) {
+  function->locals = convert::ToText(ctx, code.locals);
+  function->instructions = convert::ToText(ctx, code.body);
+}
+
+// A contiguous range of functions, converted and written by a single thread.
+struct FunctionChunk {
+  size_t begin;
+  size_t end;
+  OutputSink sink;
+};
+
+}  // namespace
+
+template <typename Code>
+void Tool::WriteFunctions(const text::WriteCtx& write_context,
+                          span<const At<binary::Function>> functions,
+                          span<const Code> codes,
+                          bool after_function,
+                          OutputSink& sink) {
+  assert(functions.size() == codes.size());
+  if (codes.empty()) {
+    return;
+  }
+  const size_t jobs = std::min<size_t>(options.jobs, codes.size());
+  const size_t chunk_size = std::max<size_t>(1, codes.size() / (jobs * 16));
+  std::vector<FunctionChunk> chunks;
+  for (size_t begin = 0; begin < codes.size(); begin += chunk_size) {
+    chunks.push_back(
+        FunctionChunk{begin, std::min(begin + chunk_size, codes.size()), {}});
+  }
+
+  std::atomic<size_t> next_chunk{0};
+  auto worker = [&]() {
+    for (size_t i; (i = next_chunk++) < chunks.size();) {
+      auto& chunk = chunks[i];
+      // Start with the state `write_context` would have after writing the
+      // previous function, so the output doesn't depend on the chunk size.
+      text::WriteCtx chunk_write_context = write_context;
+      if (after_function || chunk.begin > 0) {
+        chunk_write_context.Newline();
+      }
+      auto out = chunk.sink.out();
+      for (size_t index = chunk.begin; index < chunk.end; ++index) {
+        convert::TextCtx convert_context;
+        At<text::Function> function =
+            convert::ToText(convert_context, functions[index]);
+        CodeToText(convert_context, codes[index], function);
+        out = text::Write(chunk_write_context, text::ModuleItem{*function},
+                          out);
+      }
     }
+  };
 
-    fstream.write(span.data(), span.size());
+  if (jobs <= 1) {
+    worker();
   } else {
-    std::cout.write(span.data(), span.size());
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < jobs; ++i) {
+      threads.emplace_back(worker);
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
   }
 
-  return 0;
+  for (const auto& chunk : chunks) {
+    sink.Write(chunk.sink);
+  }
 }
 
 }  // namespace wasm2wat
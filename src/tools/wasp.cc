@@ -25,6 +25,7 @@
 #include "src/tools/cfg.h"
 #include "src/tools/dfg.h"
 #include "src/tools/dump.h"
+#include "src/tools/gen.h"
 #include "src/tools/pattern.h"
 #include "src/tools/validate.h"
 #include "src/tools/wat2wasm.h"
@@ -55,6 +56,7 @@ int main(int argc, char** argv) {
       {"pattern", wasp::tools::pattern::Main},
       {"wat2wasm", wasp::tools::wat2wasm::Main},
       {"wasm2wat", wasp::tools::wasm2wat::Main},
+      {"gen", wasp::tools::gen::Main},
   };
 
   wasp::tools::ArgParser parser{"wasp"};
@@ -84,5 +86,6 @@ void PrintHelp(int errcode) {
   Format(&std::cerr, "  pattern     Find common instruction sequences.\n");
   Format(&std::cerr, "  wat2wasm    Convert a WebAssembly text file to binary.\n");
   Format(&std::cerr, "  wasm2wat    Convert a WebAssembly binary file to text.\n");
+  Format(&std::cerr, "  gen         Generate a random WebAssembly file.\n");
   exit(errcode);
 }
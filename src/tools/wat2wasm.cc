@@ -15,7 +15,6 @@
 //
 
 #include <filesystem>
-#include <fstream>
 #include <iostream>
 
 #include "absl/strings/str_format.h"
@@ -27,6 +26,7 @@
 #include "wasp/base/features.h"
 #include "wasp/base/file.h"
 #include "wasp/base/formatters.h"
+#include "wasp/base/output_sink.h"
 #include "wasp/base/span.h"
 #include "wasp/base/string_view.h"
 #include "wasp/binary/encoding.h"
@@ -101,8 +101,8 @@ int Main(span<const string_view> args) {
     parser.PrintHelpAndExit(1);
   }
 
-  auto optbuf = ReadFile(filename);
-  if (!optbuf) {
+  auto optfile = MapFile(filename);
+  if (!optfile) {
     Format(&std::cerr, "Error reading file %s.\n", filename);
     return 1;
   }
@@ -113,7 +113,7 @@ int Main(span<const string_view> args) {
         fs::path(filename).replace_extension(".wasm").string();
   }
 
-  SpanU8 data{*optbuf};
+  SpanU8 data = optfile->data();
   Tool tool{filename, data, options};
   return tool.Run();
 }
@@ -151,17 +151,19 @@ int Tool::Run() {
   }
 
   Buffer buffer;
-  Write(binary_module, std::back_inserter(buffer));
+  WriteModule(*binary_module, buffer);
 
-  std::ofstream fstream(options.output_filename,
-                        std::ios_base::out | std::ios_base::binary);
-  if (!fstream) {
+  auto sink = OutputSink::OpenFile(options.output_filename);
+  if (!sink) {
     Format(&std::cerr, "Unable to open file %s.\n", options.output_filename);
     return 1;
   }
 
-  auto span = ToStringView(buffer);
-  fstream.write(span.data(), span.size());
+  sink->Write(buffer);
+  if (!sink->Flush()) {
+    Format(&std::cerr, "Unable to write file %s.\n", options.output_filename);
+    return 1;
+  }
   return 0;
 }
 
@@ -120,9 +120,15 @@ bool IsSame(ValidCtx& ctx,
 
 bool IsSame(ValidCtx& ctx, const StackType& expected, const StackType& actual) {
   // One of the types is "any" (i.e. universal supertype or subtype), or the
-  // value types are the same.
-  return expected.is_any() || actual.is_any() ||
-         IsSame(ctx, expected.value_type(), actual.value_type());
+  // value types are the same. Identical stack types are always the same, and
+  // different numeric types never are, so only reference types and rtts need
+  // to be unpacked.
+  if (expected == actual || expected.is_any() || actual.is_any()) {
+    return true;
+  } else if (expected.is_numeric_type() || actual.is_numeric_type()) {
+    return false;
+  }
+  return IsSame(ctx, expected.value_type(), actual.value_type());
 }
 
 bool IsSame(ValidCtx& ctx, StackTypeSpan expected, StackTypeSpan actual) {
@@ -315,9 +321,20 @@ bool IsMatch(ValidCtx& ctx,
              const StackType& expected,
              const StackType& actual) {
   // One of the types is "any" (i.e. universal supertype or subtype), or the
-  // value types match.
-  return expected.is_any() || actual.is_any() ||
-         IsMatch(ctx, expected.value_type(), actual.value_type());
+  // value types match. See IsSame(StackType, StackType) above.
+  if (expected == actual || expected.is_any() || actual.is_any()) {
+    return true;
+  } else if (expected.is_numeric_type() || actual.is_numeric_type()) {
+    return false;
+  }
+
+  auto is_match_opt = ctx.match_types.Get(expected, actual);
+  if (is_match_opt) {
+    return *is_match_opt;
+  }
+  bool is_match = IsMatch(ctx, expected.value_type(), actual.value_type());
+  ctx.match_types.Set(expected, actual, is_match);
+  return is_match;
 }
 
 bool IsMatch(ValidCtx& ctx, StackTypeSpan expected, StackTypeSpan actual) {
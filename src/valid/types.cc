@@ -24,11 +24,43 @@
 
 namespace wasp::valid {
 
-StackType::StackType() : type{Any{}} {}
-
-StackType::StackType(binary::ValueType type) : type{type} {}
+StackType::StackType() {}
+
+StackType::StackType(const binary::ValueType& type) {
+  if (type.is_numeric_type()) {
+    form = Form::NumericType;
+    code = static_cast<u8>(type.numeric_type().value());
+  } else if (type.is_reference_type()) {
+    const auto& reference_type = type.reference_type().value();
+    if (reference_type.is_reference_kind()) {
+      form = Form::ReferenceKind;
+      code = static_cast<u8>(reference_type.reference_kind().value());
+    } else {
+      const auto& ref = reference_type.ref().value();
+      if (ref.heap_type->is_heap_kind()) {
+        form = Form::RefHeapKind;
+        code = static_cast<u8>(ref.heap_type->heap_kind().value());
+      } else {
+        form = Form::RefIndex;
+        index = ref.heap_type->index().value();
+      }
+      nullable = ref.null == Null::Yes;
+    }
+  } else {
+    assert(type.is_rtt());
+    const auto& rtt = type.rtt().value();
+    if (rtt.type->is_heap_kind()) {
+      form = Form::RttHeapKind;
+      code = static_cast<u8>(rtt.type->heap_kind().value());
+    } else {
+      form = Form::RttIndex;
+      index = rtt.type->index().value();
+    }
+    depth = rtt.depth.value();
+  }
+}
 
-StackType::StackType(Any type) : type{type} {}
+StackType::StackType(Any type) {}
 
 // static
 StackType StackType::I32() {
@@ -81,19 +113,49 @@ StackType StackType::I31ref() {
 }
 
 bool StackType::is_value_type() const {
-  return holds_alternative<binary::ValueType>(type);
+  return form != Form::Any;
 }
 
 bool StackType::is_any() const {
-  return holds_alternative<Any>(type);
+  return form == Form::Any;
 }
 
-auto StackType::value_type() -> binary::ValueType& {
-  return get<binary::ValueType>(type);
+bool StackType::is_numeric_type() const {
+  return form == Form::NumericType;
 }
 
-auto StackType::value_type() const -> const binary::ValueType& {
-  return get<binary::ValueType>(type);
+auto StackType::value_type() const -> binary::ValueType {
+  using binary::HeapType;
+  using binary::ReferenceType;
+  using binary::RefType;
+  using binary::Rtt;
+  using binary::ValueType;
+
+  switch (form) {
+    case Form::NumericType:
+      return ValueType{static_cast<NumericType>(code)};
+
+    case Form::ReferenceKind:
+      return ValueType{ReferenceType{static_cast<ReferenceKind>(code)}};
+
+    case Form::RefHeapKind:
+    case Form::RefIndex: {
+      HeapType heap_type = form == Form::RefHeapKind
+                               ? HeapType{static_cast<HeapKind>(code)}
+                               : HeapType{index};
+      return ValueType{ReferenceType{
+          RefType{heap_type, nullable ? Null::Yes : Null::No}}};
+    }
+
+    case Form::RttHeapKind:
+      return ValueType{Rtt{depth, HeapType{static_cast<HeapKind>(code)}}};
+
+    case Form::RttIndex:
+      return ValueType{Rtt{depth, HeapType{index}}};
+
+    default:
+      WASP_UNREACHABLE();
+  }
 }
 
 auto ToValueType(binary::StorageType type) -> binary::ValueType {
@@ -17,16 +17,19 @@
 #include "wasp/valid/valid_ctx.h"
 
 #include <cassert>
+#include <utility>
 
 namespace wasp::valid {
 
 Label::Label(LabelType label_type,
-             StackTypeSpan param_types,
-             StackTypeSpan result_types,
+             Index types_begin,
+             Index param_count,
+             Index result_count,
              Index type_stack_limit)
     : label_type{label_type},
-      param_types{param_types.begin(), param_types.end()},
-      result_types{result_types.begin(), result_types.end()},
+      types_begin{types_begin},
+      param_count{param_count},
+      result_count{result_count},
       type_stack_limit{type_stack_limit},
       unreachable{false} {}
 
@@ -41,7 +44,72 @@ ValidCtx::ValidCtx(const ValidCtx& other, Errors& errors) {
 }
 
 void ValidCtx::Reset() {
-  *this = ValidCtx{features, *errors};
+  ValidCtx ctx{features, *errors};
+  ctx.locals = std::move(locals);
+  ctx.type_stack = std::move(type_stack);
+  ctx.label_stack = std::move(label_stack);
+  ctx.label_types = std::move(label_types);
+  *this = std::move(ctx);
+  ResetExpression();
+}
+
+void ValidCtx::ResetExpression() {
+  locals.Reset();
+  type_stack.clear();
+  label_stack.clear();
+  label_types.clear();
+}
+
+void ValidCtx::PushLabel(LabelType label_type,
+                         StackTypeSpan param_types,
+                         StackTypeSpan result_types,
+                         Index type_stack_limit) {
+  auto types_begin = static_cast<Index>(label_types.size());
+  label_types.insert(label_types.end(), param_types.begin(),
+                     param_types.end());
+  label_types.insert(label_types.end(), result_types.begin(),
+                     result_types.end());
+  label_stack.emplace_back(label_type, types_begin,
+                           static_cast<Index>(param_types.size()),
+                           static_cast<Index>(result_types.size()),
+                           type_stack_limit);
+}
+
+void ValidCtx::PushLabel(LabelType label_type,
+                         const binary::FunctionType& function_type,
+                         Index type_stack_limit) {
+  auto types_begin = static_cast<Index>(label_types.size());
+  for (const auto& value_type : function_type.param_types) {
+    label_types.push_back(StackType{value_type});
+  }
+  for (const auto& value_type : function_type.result_types) {
+    label_types.push_back(StackType{value_type});
+  }
+  auto param_count = static_cast<Index>(function_type.param_types.size());
+  auto result_count = static_cast<Index>(function_type.result_types.size());
+  label_stack.emplace_back(label_type, types_begin, param_count, result_count,
+                           type_stack_limit);
+}
+
+void ValidCtx::PopLabel() {
+  assert(!label_stack.empty());
+  label_types.resize(label_stack.back().types_begin);
+  label_stack.pop_back();
+}
+
+StackTypeSpan ValidCtx::GetParamTypes(const Label& label) const {
+  return StackTypeSpan{label_types}.subspan(label.types_begin,
+                                            label.param_count);
+}
+
+StackTypeSpan ValidCtx::GetResultTypes(const Label& label) const {
+  return StackTypeSpan{label_types}.subspan(
+      label.types_begin + label.param_count, label.result_count);
+}
+
+StackTypeSpan ValidCtx::GetBrTypes(const Label& label) const {
+  return label.label_type == LabelType::Loop ? GetParamTypes(label)
+                                             : GetResultTypes(label);
 }
 
 bool ValidCtx::IsStackPolymorphic() const {
@@ -61,6 +129,22 @@ bool ValidCtx::IsArrayType(Index index) const {
   return index < types.size() && types[index].is_array_type();
 }
 
+ExpressionScope::ExpressionScope(ValidCtx& ctx)
+    : ctx_{ctx},
+      locals_{std::move(ctx.locals)},
+      type_stack_{std::move(ctx.type_stack)},
+      label_stack_{std::move(ctx.label_stack)},
+      label_types_{std::move(ctx.label_types)} {
+  ctx_.ResetExpression();
+}
+
+ExpressionScope::~ExpressionScope() {
+  ctx_.locals = std::move(locals_);
+  ctx_.type_stack = std::move(type_stack_);
+  ctx_.label_stack = std::move(label_stack_);
+  ctx_.label_types = std::move(label_types_);
+}
+
 void SameTypes::Reset(Index size) {
   disjoint_set_.Reset(size);
   assume_.clear();
@@ -111,6 +195,7 @@ void SameTypes::MaybeSwapIndexes(Index& lhs, Index& rhs) {
 
 void MatchTypes::Reset(Index num_types) {
   assume_.clear();
+  stack_types_.clear();
   num_types_ = num_types;
 }
 
@@ -141,4 +226,19 @@ void MatchTypes::Resolve(Index expected, Index actual, bool is_same) {
   }
 }
 
+auto MatchTypes::Get(const StackType& expected, const StackType& actual)
+    -> optional<bool> {
+  auto iter = stack_types_.find({expected, actual});
+  if (iter == stack_types_.end()) {
+    return nullopt;
+  }
+  return iter->second;
+}
+
+void MatchTypes::Set(const StackType& expected,
+                     const StackType& actual,
+                     bool is_match) {
+  stack_types_.emplace(std::make_pair(expected, actual), is_match);
+}
+
 }  // namespace wasp::valid
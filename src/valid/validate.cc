@@ -61,9 +61,7 @@ bool BeginCode(ValidCtx& ctx, Location loc) {
   }
   ctx.code_count++;
   const binary::Function& function = ctx.functions[func_index];
-  ctx.type_stack.clear();
-  ctx.label_stack.clear();
-  ctx.locals.Reset();
+  ctx.ResetExpression();
   // Don't validate the index, should have already been validated at this point.
   if (function.type_index < ctx.types.size()) {
     const auto& defined_type = ctx.types[function.type_index];
@@ -75,13 +73,11 @@ bool BeginCode(ValidCtx& ctx, Location loc) {
     assert(defined_type.is_function_type());
     const auto& function_type = defined_type.function_type();
     ctx.locals.Append(function_type->param_types);
-    ctx.label_stack.push_back(
-        Label{LabelType::Function, ToStackTypeList(function_type->param_types),
-              ToStackTypeList(function_type->result_types), 0});
+    ctx.PushLabel(LabelType::Function, *function_type, 0);
     return true;
   } else {
     // Not valid, but try to continue anyway.
-    ctx.label_stack.push_back(Label{LabelType::Function, {}, {}, 0});
+    ctx.PushLabel(LabelType::Function, {}, {}, 0);
     return false;
   }
 }
@@ -127,6 +123,14 @@ bool Validate(ValidCtx& ctx, const At<binary::UnpackedExpression>& value) {
   return valid;
 }
 
+bool Validate(ValidCtx& ctx, const binary::PackedExpression& value) {
+  bool valid = true;
+  for (size_t i = 0; i < value.size(); ++i) {
+    valid &= Validate(ctx, value[i]);
+  }
+  return valid;
+}
+
 bool Validate(ValidCtx& ctx, const At<binary::UnpackedCode>& value) {
   bool valid = true;
   valid &= BeginCode(ctx, value.loc());
@@ -152,18 +156,12 @@ bool Validate(ValidCtx& ctx,
   }
 
   bool valid = true;
-  ValidCtx new_context{ctx};
-  new_context.type_stack.clear();
-  new_context.label_stack.clear();
-  new_context.locals.Reset();
+  ExpressionScope scope{ctx};
 
   // Validate as if this expression was a function that takes no parameters,
   // and returns the expected type.
-  new_context.label_stack.push_back(
-      Label{LabelType::Function,
-            {},
-            ToStackTypeList(binary::ValueTypeList{expected_type}),
-            0});
+  StackType result_type{expected_type};
+  ctx.PushLabel(LabelType::Function, {}, StackTypeSpan{&result_type, 1}, 0);
 
   for (auto&& instruction : value->instructions) {
     switch (instruction->opcode) {
@@ -187,8 +185,8 @@ bool Validate(ValidCtx& ctx,
           return false;
         }
 
-        if (new_context.globals[index].mut == Mutability::Var) {
-          new_context.errors->OnError(
+        if (ctx.globals[index].mut == Mutability::Var) {
+          ctx.errors->OnError(
               instruction->index_immediate().loc(),
               "A constant expression cannot contain a mutable global");
           return false;
@@ -198,14 +196,13 @@ bool Validate(ValidCtx& ctx,
 
       case Opcode::RefFunc: {
         auto index = instruction->index_immediate();
-        if (!ValidateFunctionIndex(new_context, index)) {
+        if (!ValidateFunctionIndex(ctx, index)) {
           return false;
         }
 
         // ref.func indexes are implicitly declared by referencing them in a
         // constant expression.
         ctx.declared_functions.insert(index);
-        new_context.declared_functions.insert(index);
         break;
       }
 
@@ -218,13 +215,12 @@ bool Validate(ValidCtx& ctx,
     }
 
     // Do normal instruction validation.
-    valid &= Validate(new_context, instruction);
+    valid &= Validate(ctx, instruction);
   }
 
   // Insert an implicit end instruction to check that the instruction sequence
   // actually produces a value of the expected type.
-  valid &=
-      Validate(new_context, At{value.loc(), binary::Instruction{Opcode::End}});
+  valid &= Validate(ctx, At{value.loc(), binary::Instruction{Opcode::End}});
   return valid;
 }
 
@@ -351,12 +347,11 @@ bool Validate(ValidCtx& ctx, const At<binary::Export>& value) {
   ErrorsContextGuard guard{*ctx.errors, value.loc(), "export"};
   bool valid = true;
 
-  if (ctx.export_names.find(value->name) != ctx.export_names.end()) {
+  if (!ctx.export_names.insert(value->name).second) {
     ctx.errors->OnError(value.loc(),
                         concat("Duplicate export name ", value->name));
     valid = false;
   }
-  ctx.export_names.insert(value->name);
 
   switch (value->kind) {
     case ExternalKind::Function:
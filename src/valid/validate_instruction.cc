@@ -14,6 +14,7 @@
 // limitations under the License.
 //
 
+#include <array>
 #include <cassert>
 #include <limits>
 
@@ -37,27 +38,38 @@ namespace {
 
 using namespace ::wasp::binary;
 
-#define STACK_TYPE_SPANS(V)                                            \
-  V(i32, StackType::I32())                                             \
-  V(i64, StackType::I64())                                             \
-  V(f32, StackType::F32())                                             \
-  V(f64, StackType::F64())                                             \
-  V(v128, StackType::V128())                                           \
-  V(i31ref, StackType::I31ref())                                       \
-  V(i32_i32, StackType::I32(), StackType::I32())                       \
-  V(i32_v128, StackType::I32(), StackType::V128())                     \
-  V(i64_i64, StackType::I64(), StackType::I64())                       \
-  V(i64_v128, StackType::I64(), StackType::V128())                     \
-  V(f32_f32, StackType::F32(), StackType::F32())                       \
-  V(f64_f64, StackType::F64(), StackType::F64())                       \
-  V(v128_i32, StackType::V128(), StackType::I32())                     \
-  V(v128_i64, StackType::V128(), StackType::I64())                     \
-  V(v128_f32, StackType::V128(), StackType::F32())                     \
-  V(v128_f64, StackType::V128(), StackType::F64())                     \
-  V(v128_v128, StackType::V128(), StackType::V128())                   \
-  V(eqref_eqref, StackType::Eqref(), StackType::Eqref())               \
-  V(i32_i32_i32, StackType::I32(), StackType::I32(), StackType::I32()) \
-  V(v128_v128_v128, StackType::V128(), StackType::V128(), StackType::V128())
+#define STACK_TYPE_SPANS(V)                                                  \
+  V(i32, StackType::I32())                                                   \
+  V(i64, StackType::I64())                                                   \
+  V(f32, StackType::F32())                                                   \
+  V(f64, StackType::F64())                                                   \
+  V(v128, StackType::V128())                                                 \
+  V(i31ref, StackType::I31ref())                                             \
+  V(i32_i32, StackType::I32(), StackType::I32())                             \
+  V(i32_v128, StackType::I32(), StackType::V128())                           \
+  V(i64_i64, StackType::I64(), StackType::I64())                             \
+  V(i64_v128, StackType::I64(), StackType::V128())                           \
+  V(f32_f32, StackType::F32(), StackType::F32())                             \
+  V(f64_f64, StackType::F64(), StackType::F64())                             \
+  V(v128_i32, StackType::V128(), StackType::I32())                           \
+  V(v128_i64, StackType::V128(), StackType::I64())                           \
+  V(v128_f32, StackType::V128(), StackType::F32())                           \
+  V(v128_f64, StackType::V128(), StackType::F64())                           \
+  V(v128_v128, StackType::V128(), StackType::V128())                         \
+  V(eqref_eqref, StackType::Eqref(), StackType::Eqref())                     \
+  V(i32_f32, StackType::I32(), StackType::F32())                             \
+  V(i32_f64, StackType::I32(), StackType::F64())                             \
+  V(i32_i64, StackType::I32(), StackType::I64())                             \
+  V(i64_f32, StackType::I64(), StackType::F32())                             \
+  V(i64_f64, StackType::I64(), StackType::F64())                             \
+  V(i64_i32, StackType::I64(), StackType::I32())                             \
+  V(i32_i32_i32, StackType::I32(), StackType::I32(), StackType::I32())       \
+  V(v128_v128_v128, StackType::V128(), StackType::V128(), StackType::V128()) \
+  V(i32_i32_i64, StackType::I32(), StackType::I32(), StackType::I64())       \
+  V(i32_i64_i64, StackType::I32(), StackType::I64(), StackType::I64())       \
+  V(i64_i32_i32, StackType::I64(), StackType::I32(), StackType::I32())       \
+  V(i64_i32_i64, StackType::I64(), StackType::I32(), StackType::I64())       \
+  V(i64_i64_i64, StackType::I64(), StackType::I64(), StackType::I64())
 
 #define WASP_V(name, ...)                         \
   const StackType array_##name[] = {__VA_ARGS__}; \
@@ -65,24 +77,692 @@ using namespace ::wasp::binary;
 STACK_TYPE_SPANS(WASP_V)
 
 #undef WASP_V
+
+enum class SpanId : u8 {
+  none,
+#define WASP_V(name, ...) name,
+  STACK_TYPE_SPANS(WASP_V)
+#undef WASP_V
+};
+
+const StackTypeSpan spans[] = {
+  StackTypeSpan{},
+#define WASP_V(name, ...) span_##name,
+  STACK_TYPE_SPANS(WASP_V)
+#undef WASP_V
+};
+
 #undef STACK_TYPE_SPANS
 
+StackTypeSpan GetSpan(SpanId id) {
+  return spans[static_cast<size_t>(id)];
+}
+
+// Instructions whose stack effect depends only on the opcode. These are
+// validated with a single table lookup instead of the switch in Validate().
+//
+//   V(opcode, params, results)
+#define NUMERIC_OPCODES(V)                  \
+  V(I32Const, none, i32)                    \
+  V(I64Const, none, i64)                    \
+  V(F32Const, none, f32)                    \
+  V(F64Const, none, f64)                    \
+  V(I32Eqz, i32, i32)                       \
+  V(I32Clz, i32, i32)                       \
+  V(I32Ctz, i32, i32)                       \
+  V(I32Popcnt, i32, i32)                    \
+  V(I32Extend8S, i32, i32)                  \
+  V(I32Extend16S, i32, i32)                 \
+  V(I64Eqz, i64, i32)                       \
+  V(I32WrapI64, i64, i32)                   \
+  V(I64Clz, i64, i64)                       \
+  V(I64Ctz, i64, i64)                       \
+  V(I64Popcnt, i64, i64)                    \
+  V(I64Extend8S, i64, i64)                  \
+  V(I64Extend16S, i64, i64)                 \
+  V(I64Extend32S, i64, i64)                 \
+  V(I32Eq, i32_i32, i32)                    \
+  V(I32Ne, i32_i32, i32)                    \
+  V(I32LtS, i32_i32, i32)                   \
+  V(I32LtU, i32_i32, i32)                   \
+  V(I32GtS, i32_i32, i32)                   \
+  V(I32GtU, i32_i32, i32)                   \
+  V(I32LeS, i32_i32, i32)                   \
+  V(I32LeU, i32_i32, i32)                   \
+  V(I32GeS, i32_i32, i32)                   \
+  V(I32GeU, i32_i32, i32)                   \
+  V(I32Add, i32_i32, i32)                   \
+  V(I32Sub, i32_i32, i32)                   \
+  V(I32Mul, i32_i32, i32)                   \
+  V(I32DivS, i32_i32, i32)                  \
+  V(I32DivU, i32_i32, i32)                  \
+  V(I32RemS, i32_i32, i32)                  \
+  V(I32RemU, i32_i32, i32)                  \
+  V(I32And, i32_i32, i32)                   \
+  V(I32Or, i32_i32, i32)                    \
+  V(I32Xor, i32_i32, i32)                   \
+  V(I32Shl, i32_i32, i32)                   \
+  V(I32ShrS, i32_i32, i32)                  \
+  V(I32ShrU, i32_i32, i32)                  \
+  V(I32Rotl, i32_i32, i32)                  \
+  V(I32Rotr, i32_i32, i32)                  \
+  V(I64Eq, i64_i64, i32)                    \
+  V(I64Ne, i64_i64, i32)                    \
+  V(I64LtS, i64_i64, i32)                   \
+  V(I64LtU, i64_i64, i32)                   \
+  V(I64GtS, i64_i64, i32)                   \
+  V(I64GtU, i64_i64, i32)                   \
+  V(I64LeS, i64_i64, i32)                   \
+  V(I64LeU, i64_i64, i32)                   \
+  V(I64GeS, i64_i64, i32)                   \
+  V(I64GeU, i64_i64, i32)                   \
+  V(F32Eq, f32_f32, i32)                    \
+  V(F32Ne, f32_f32, i32)                    \
+  V(F32Lt, f32_f32, i32)                    \
+  V(F32Gt, f32_f32, i32)                    \
+  V(F32Le, f32_f32, i32)                    \
+  V(F32Ge, f32_f32, i32)                    \
+  V(F64Eq, f64_f64, i32)                    \
+  V(F64Ne, f64_f64, i32)                    \
+  V(F64Lt, f64_f64, i32)                    \
+  V(F64Gt, f64_f64, i32)                    \
+  V(F64Le, f64_f64, i32)                    \
+  V(F64Ge, f64_f64, i32)                    \
+  V(I64Add, i64_i64, i64)                   \
+  V(I64Sub, i64_i64, i64)                   \
+  V(I64Mul, i64_i64, i64)                   \
+  V(I64DivS, i64_i64, i64)                  \
+  V(I64DivU, i64_i64, i64)                  \
+  V(I64RemS, i64_i64, i64)                  \
+  V(I64RemU, i64_i64, i64)                  \
+  V(I64And, i64_i64, i64)                   \
+  V(I64Or, i64_i64, i64)                    \
+  V(I64Xor, i64_i64, i64)                   \
+  V(I64Shl, i64_i64, i64)                   \
+  V(I64ShrS, i64_i64, i64)                  \
+  V(I64ShrU, i64_i64, i64)                  \
+  V(I64Rotl, i64_i64, i64)                  \
+  V(I64Rotr, i64_i64, i64)                  \
+  V(F32Abs, f32, f32)                       \
+  V(F32Neg, f32, f32)                       \
+  V(F32Ceil, f32, f32)                      \
+  V(F32Floor, f32, f32)                     \
+  V(F32Trunc, f32, f32)                     \
+  V(F32Nearest, f32, f32)                   \
+  V(F32Sqrt, f32, f32)                      \
+  V(F32Add, f32_f32, f32)                   \
+  V(F32Sub, f32_f32, f32)                   \
+  V(F32Mul, f32_f32, f32)                   \
+  V(F32Div, f32_f32, f32)                   \
+  V(F32Min, f32_f32, f32)                   \
+  V(F32Max, f32_f32, f32)                   \
+  V(F32Copysign, f32_f32, f32)              \
+  V(F64Abs, f64, f64)                       \
+  V(F64Neg, f64, f64)                       \
+  V(F64Ceil, f64, f64)                      \
+  V(F64Floor, f64, f64)                     \
+  V(F64Trunc, f64, f64)                     \
+  V(F64Nearest, f64, f64)                   \
+  V(F64Sqrt, f64, f64)                      \
+  V(F64Add, f64_f64, f64)                   \
+  V(F64Sub, f64_f64, f64)                   \
+  V(F64Mul, f64_f64, f64)                   \
+  V(F64Div, f64_f64, f64)                   \
+  V(F64Min, f64_f64, f64)                   \
+  V(F64Max, f64_f64, f64)                   \
+  V(F64Copysign, f64_f64, f64)              \
+  V(I32TruncF32S, f32, i32)                 \
+  V(I32TruncF32U, f32, i32)                 \
+  V(I32ReinterpretF32, f32, i32)            \
+  V(I32TruncSatF32S, f32, i32)              \
+  V(I32TruncSatF32U, f32, i32)              \
+  V(I32TruncF64S, f64, i32)                 \
+  V(I32TruncF64U, f64, i32)                 \
+  V(I32TruncSatF64S, f64, i32)              \
+  V(I32TruncSatF64U, f64, i32)              \
+  V(I64ExtendI32S, i32, i64)                \
+  V(I64ExtendI32U, i32, i64)                \
+  V(I64TruncF32S, f32, i64)                 \
+  V(I64TruncF32U, f32, i64)                 \
+  V(I64TruncSatF32S, f32, i64)              \
+  V(I64TruncSatF32U, f32, i64)              \
+  V(I64TruncF64S, f64, i64)                 \
+  V(I64TruncF64U, f64, i64)                 \
+  V(I64ReinterpretF64, f64, i64)            \
+  V(I64TruncSatF64S, f64, i64)              \
+  V(I64TruncSatF64U, f64, i64)              \
+  V(F32ConvertI32S, i32, f32)               \
+  V(F32ConvertI32U, i32, f32)               \
+  V(F32ReinterpretI32, i32, f32)            \
+  V(F32ConvertI64S, i64, f32)               \
+  V(F32ConvertI64U, i64, f32)               \
+  V(F32DemoteF64, f64, f32)                 \
+  V(F64ConvertI32S, i32, f64)               \
+  V(F64ConvertI32U, i32, f64)               \
+  V(F64ConvertI64S, i64, f64)               \
+  V(F64ConvertI64U, i64, f64)               \
+  V(F64ReinterpretI64, i64, f64)            \
+  V(F64PromoteF32, f32, f64)                \
+  V(V128Const, none, v128)                  \
+  V(V128Not, v128, v128)                    \
+  V(F32X4DemoteF64X2Zero, v128, v128)       \
+  V(F64X2PromoteLowF32X4, v128, v128)       \
+  V(I8X16Abs, v128, v128)                   \
+  V(I8X16Neg, v128, v128)                   \
+  V(I8X16Popcnt, v128, v128)                \
+  V(F32X4Ceil, v128, v128)                  \
+  V(F32X4Floor, v128, v128)                 \
+  V(F32X4Trunc, v128, v128)                 \
+  V(F32X4Nearest, v128, v128)               \
+  V(F64X2Ceil, v128, v128)                  \
+  V(F64X2Floor, v128, v128)                 \
+  V(F64X2Trunc, v128, v128)                 \
+  V(I16X8ExtaddPairwiseI8X16S, v128, v128)  \
+  V(I16X8ExtaddPairwiseI8X16U, v128, v128)  \
+  V(I32X4ExtaddPairwiseI16X8S, v128, v128)  \
+  V(I32X4ExtaddPairwiseI16X8U, v128, v128)  \
+  V(I16X8Abs, v128, v128)                   \
+  V(I16X8Neg, v128, v128)                   \
+  V(I16X8ExtendLowI8X16S, v128, v128)       \
+  V(I16X8ExtendHighI8X16S, v128, v128)      \
+  V(I16X8ExtendLowI8X16U, v128, v128)       \
+  V(I16X8ExtendHighI8X16U, v128, v128)      \
+  V(F64X2Nearest, v128, v128)               \
+  V(I32X4Abs, v128, v128)                   \
+  V(I32X4Neg, v128, v128)                   \
+  V(I32X4ExtendLowI16X8S, v128, v128)       \
+  V(I32X4ExtendHighI16X8S, v128, v128)      \
+  V(I32X4ExtendLowI16X8U, v128, v128)       \
+  V(I32X4ExtendHighI16X8U, v128, v128)      \
+  V(I64X2Abs, v128, v128)                   \
+  V(I64X2Neg, v128, v128)                   \
+  V(I64X2ExtendLowI32X4S, v128, v128)       \
+  V(I64X2ExtendHighI32X4S, v128, v128)      \
+  V(I64X2ExtendLowI32X4U, v128, v128)       \
+  V(I64X2ExtendHighI32X4U, v128, v128)      \
+  V(F32X4Abs, v128, v128)                   \
+  V(F32X4Neg, v128, v128)                   \
+  V(F32X4Sqrt, v128, v128)                  \
+  V(F64X2Abs, v128, v128)                   \
+  V(F64X2Neg, v128, v128)                   \
+  V(F64X2Sqrt, v128, v128)                  \
+  V(I32X4TruncSatF32X4S, v128, v128)        \
+  V(I32X4TruncSatF32X4U, v128, v128)        \
+  V(F32X4ConvertI32X4S, v128, v128)         \
+  V(F32X4ConvertI32X4U, v128, v128)         \
+  V(I32X4TruncSatF64X2SZero, v128, v128)    \
+  V(I32X4TruncSatF64X2UZero, v128, v128)    \
+  V(F64X2ConvertLowI32X4S, v128, v128)      \
+  V(F64X2ConvertLowI32X4U, v128, v128)      \
+  V(V128BitSelect, v128_v128_v128, v128)    \
+  V(I8X16Swizzle, v128_v128, v128)          \
+  V(I8X16Eq, v128_v128, v128)               \
+  V(I8X16Ne, v128_v128, v128)               \
+  V(I8X16LtS, v128_v128, v128)              \
+  V(I8X16LtU, v128_v128, v128)              \
+  V(I8X16GtS, v128_v128, v128)              \
+  V(I8X16GtU, v128_v128, v128)              \
+  V(I8X16LeS, v128_v128, v128)              \
+  V(I8X16LeU, v128_v128, v128)              \
+  V(I8X16GeS, v128_v128, v128)              \
+  V(I8X16GeU, v128_v128, v128)              \
+  V(I16X8Eq, v128_v128, v128)               \
+  V(I16X8Ne, v128_v128, v128)               \
+  V(I16X8LtS, v128_v128, v128)              \
+  V(I16X8LtU, v128_v128, v128)              \
+  V(I16X8GtS, v128_v128, v128)              \
+  V(I16X8GtU, v128_v128, v128)              \
+  V(I16X8LeS, v128_v128, v128)              \
+  V(I16X8LeU, v128_v128, v128)              \
+  V(I16X8GeS, v128_v128, v128)              \
+  V(I16X8GeU, v128_v128, v128)              \
+  V(I32X4Eq, v128_v128, v128)               \
+  V(I32X4Ne, v128_v128, v128)               \
+  V(I32X4LtS, v128_v128, v128)              \
+  V(I32X4LtU, v128_v128, v128)              \
+  V(I32X4GtS, v128_v128, v128)              \
+  V(I32X4GtU, v128_v128, v128)              \
+  V(I32X4LeS, v128_v128, v128)              \
+  V(I32X4LeU, v128_v128, v128)              \
+  V(I32X4GeS, v128_v128, v128)              \
+  V(I32X4GeU, v128_v128, v128)              \
+  V(F32X4Eq, v128_v128, v128)               \
+  V(F32X4Ne, v128_v128, v128)               \
+  V(F32X4Lt, v128_v128, v128)               \
+  V(F32X4Gt, v128_v128, v128)               \
+  V(F32X4Le, v128_v128, v128)               \
+  V(F32X4Ge, v128_v128, v128)               \
+  V(F64X2Eq, v128_v128, v128)               \
+  V(F64X2Ne, v128_v128, v128)               \
+  V(F64X2Lt, v128_v128, v128)               \
+  V(F64X2Gt, v128_v128, v128)               \
+  V(F64X2Le, v128_v128, v128)               \
+  V(F64X2Ge, v128_v128, v128)               \
+  V(V128And, v128_v128, v128)               \
+  V(V128Andnot, v128_v128, v128)            \
+  V(V128Or, v128_v128, v128)                \
+  V(V128Xor, v128_v128, v128)               \
+  V(I8X16NarrowI16X8S, v128_v128, v128)     \
+  V(I8X16NarrowI16X8U, v128_v128, v128)     \
+  V(I8X16Add, v128_v128, v128)              \
+  V(I8X16AddSatS, v128_v128, v128)          \
+  V(I8X16AddSatU, v128_v128, v128)          \
+  V(I8X16Sub, v128_v128, v128)              \
+  V(I8X16SubSatS, v128_v128, v128)          \
+  V(I8X16SubSatU, v128_v128, v128)          \
+  V(I8X16MinS, v128_v128, v128)             \
+  V(I8X16MinU, v128_v128, v128)             \
+  V(I8X16MaxS, v128_v128, v128)             \
+  V(I8X16MaxU, v128_v128, v128)             \
+  V(I8X16AvgrU, v128_v128, v128)            \
+  V(I16X8Q15mulrSatS, v128_v128, v128)      \
+  V(I16X8NarrowI32X4S, v128_v128, v128)     \
+  V(I16X8NarrowI32X4U, v128_v128, v128)     \
+  V(I16X8Add, v128_v128, v128)              \
+  V(I16X8AddSatS, v128_v128, v128)          \
+  V(I16X8AddSatU, v128_v128, v128)          \
+  V(I16X8Sub, v128_v128, v128)              \
+  V(I16X8SubSatS, v128_v128, v128)          \
+  V(I16X8SubSatU, v128_v128, v128)          \
+  V(I16X8Mul, v128_v128, v128)              \
+  V(I16X8MinS, v128_v128, v128)             \
+  V(I16X8MinU, v128_v128, v128)             \
+  V(I16X8MaxS, v128_v128, v128)             \
+  V(I16X8MaxU, v128_v128, v128)             \
+  V(I16X8AvgrU, v128_v128, v128)            \
+  V(I16X8ExtmulLowI8X16S, v128_v128, v128)  \
+  V(I16X8ExtmulHighI8X16S, v128_v128, v128) \
+  V(I16X8ExtmulLowI8X16U, v128_v128, v128)  \
+  V(I16X8ExtmulHighI8X16U, v128_v128, v128) \
+  V(I32X4Add, v128_v128, v128)              \
+  V(I32X4Sub, v128_v128, v128)              \
+  V(I32X4Mul, v128_v128, v128)              \
+  V(I32X4MinS, v128_v128, v128)             \
+  V(I32X4MinU, v128_v128, v128)             \
+  V(I32X4MaxS, v128_v128, v128)             \
+  V(I32X4MaxU, v128_v128, v128)             \
+  V(I32X4DotI16X8S, v128_v128, v128)        \
+  V(I32X4ExtmulLowI16X8S, v128_v128, v128)  \
+  V(I32X4ExtmulHighI16X8S, v128_v128, v128) \
+  V(I32X4ExtmulLowI16X8U, v128_v128, v128)  \
+  V(I32X4ExtmulHighI16X8U, v128_v128, v128) \
+  V(I64X2Add, v128_v128, v128)              \
+  V(I64X2Sub, v128_v128, v128)              \
+  V(I64X2Mul, v128_v128, v128)              \
+  V(I64X2Eq, v128_v128, v128)               \
+  V(I64X2Ne, v128_v128, v128)               \
+  V(I64X2LtS, v128_v128, v128)              \
+  V(I64X2GtS, v128_v128, v128)              \
+  V(I64X2LeS, v128_v128, v128)              \
+  V(I64X2GeS, v128_v128, v128)              \
+  V(I64X2ExtmulLowI32X4S, v128_v128, v128)  \
+  V(I64X2ExtmulHighI32X4S, v128_v128, v128) \
+  V(I64X2ExtmulLowI32X4U, v128_v128, v128)  \
+  V(I64X2ExtmulHighI32X4U, v128_v128, v128) \
+  V(F32X4Add, v128_v128, v128)              \
+  V(F32X4Sub, v128_v128, v128)              \
+  V(F32X4Mul, v128_v128, v128)              \
+  V(F32X4Div, v128_v128, v128)              \
+  V(F32X4Min, v128_v128, v128)              \
+  V(F32X4Max, v128_v128, v128)              \
+  V(F32X4Pmin, v128_v128, v128)             \
+  V(F32X4Pmax, v128_v128, v128)             \
+  V(F64X2Add, v128_v128, v128)              \
+  V(F64X2Sub, v128_v128, v128)              \
+  V(F64X2Mul, v128_v128, v128)              \
+  V(F64X2Div, v128_v128, v128)              \
+  V(F64X2Min, v128_v128, v128)              \
+  V(F64X2Max, v128_v128, v128)              \
+  V(F64X2Pmin, v128_v128, v128)             \
+  V(F64X2Pmax, v128_v128, v128)             \
+  V(I8X16Splat, i32, v128)                  \
+  V(I16X8Splat, i32, v128)                  \
+  V(I32X4Splat, i32, v128)                  \
+  V(I64X2Splat, i64, v128)                  \
+  V(F32X4Splat, f32, v128)                  \
+  V(F64X2Splat, f64, v128)                  \
+  V(V128AnyTrue, v128, i32)                 \
+  V(I8X16AllTrue, v128, i32)                \
+  V(I8X16Bitmask, v128, i32)                \
+  V(I16X8AllTrue, v128, i32)                \
+  V(I16X8Bitmask, v128, i32)                \
+  V(I32X4AllTrue, v128, i32)                \
+  V(I32X4Bitmask, v128, i32)                \
+  V(I64X2AllTrue, v128, i32)                \
+  V(I64X2Bitmask, v128, i32)                \
+  V(I8X16Shl, v128_i32, v128)               \
+  V(I8X16ShrS, v128_i32, v128)              \
+  V(I8X16ShrU, v128_i32, v128)              \
+  V(I16X8Shl, v128_i32, v128)               \
+  V(I16X8ShrS, v128_i32, v128)              \
+  V(I16X8ShrU, v128_i32, v128)              \
+  V(I32X4Shl, v128_i32, v128)               \
+  V(I32X4ShrS, v128_i32, v128)              \
+  V(I32X4ShrU, v128_i32, v128)              \
+  V(I64X2Shl, v128_i32, v128)               \
+  V(I64X2ShrS, v128_i32, v128)              \
+  V(I64X2ShrU, v128_i32, v128)              \
+  V(RefEq, eqref_eqref, i32)                \
+  V(I31New, i32, i31ref)                    \
+  V(I31GetS, i31ref, i32)                   \
+  V(I31GetU, i31ref, i32)
+
+// Loads, stores and atomic memory instructions. These operate on memory 0, so
+// the params depend on the memory's index type. The alignment is the maximum
+// alignment for `Memory` instructions, and the required alignment for
+// `AtomicMemory` instructions.
+//
+//   V(opcode, kind, params (i32 index), params (i64 index), results, align)
+#define MEMORY_OPCODES(V)                                                   \
+  V(I32Load, Memory, i32, i64, i32, 2)                                      \
+  V(I64Load, Memory, i32, i64, i64, 3)                                      \
+  V(F32Load, Memory, i32, i64, f32, 2)                                      \
+  V(F64Load, Memory, i32, i64, f64, 3)                                      \
+  V(I32Load8S, Memory, i32, i64, i32, 0)                                    \
+  V(I32Load8U, Memory, i32, i64, i32, 0)                                    \
+  V(I32Load16S, Memory, i32, i64, i32, 1)                                   \
+  V(I32Load16U, Memory, i32, i64, i32, 1)                                   \
+  V(I64Load8S, Memory, i32, i64, i64, 0)                                    \
+  V(I64Load8U, Memory, i32, i64, i64, 0)                                    \
+  V(I64Load16S, Memory, i32, i64, i64, 1)                                   \
+  V(I64Load16U, Memory, i32, i64, i64, 1)                                   \
+  V(I64Load32S, Memory, i32, i64, i64, 2)                                   \
+  V(I64Load32U, Memory, i32, i64, i64, 2)                                   \
+  V(V128Load, Memory, i32, i64, v128, 4)                                    \
+  V(V128Load8Splat, Memory, i32, i64, v128, 0)                              \
+  V(V128Load16Splat, Memory, i32, i64, v128, 1)                             \
+  V(V128Load32Splat, Memory, i32, i64, v128, 2)                             \
+  V(V128Load64Splat, Memory, i32, i64, v128, 3)                             \
+  V(V128Load8X8S, Memory, i32, i64, v128, 3)                                \
+  V(V128Load8X8U, Memory, i32, i64, v128, 3)                                \
+  V(V128Load16X4S, Memory, i32, i64, v128, 3)                               \
+  V(V128Load16X4U, Memory, i32, i64, v128, 3)                               \
+  V(V128Load32X2S, Memory, i32, i64, v128, 3)                               \
+  V(V128Load32X2U, Memory, i32, i64, v128, 3)                               \
+  V(V128Load32Zero, Memory, i32, i64, v128, 2)                              \
+  V(V128Load64Zero, Memory, i32, i64, v128, 3)                              \
+  V(I32Store, Memory, i32_i32, i64_i32, none, 2)                            \
+  V(I64Store, Memory, i32_i64, i64_i64, none, 3)                            \
+  V(F32Store, Memory, i32_f32, i64_f32, none, 2)                            \
+  V(F64Store, Memory, i32_f64, i64_f64, none, 3)                            \
+  V(I32Store8, Memory, i32_i32, i64_i32, none, 0)                           \
+  V(I32Store16, Memory, i32_i32, i64_i32, none, 1)                          \
+  V(I64Store8, Memory, i32_i64, i64_i64, none, 0)                           \
+  V(I64Store16, Memory, i32_i64, i64_i64, none, 1)                          \
+  V(I64Store32, Memory, i32_i64, i64_i64, none, 2)                          \
+  V(V128Store, Memory, i32_v128, i64_v128, none, 4)                         \
+  V(MemoryAtomicNotify, AtomicMemory, i32_i32, i64_i32, i32, 2)             \
+  V(MemoryAtomicWait32, AtomicMemory, i32_i32_i64, i64_i32_i64, i32, 2)     \
+  V(MemoryAtomicWait64, AtomicMemory, i32_i64_i64, i64_i64_i64, i32, 3)     \
+  V(I32AtomicLoad, AtomicMemory, i32, i64, i32, 2)                          \
+  V(I64AtomicLoad, AtomicMemory, i32, i64, i64, 3)                          \
+  V(I32AtomicLoad8U, AtomicMemory, i32, i64, i32, 0)                        \
+  V(I32AtomicLoad16U, AtomicMemory, i32, i64, i32, 1)                       \
+  V(I64AtomicLoad8U, AtomicMemory, i32, i64, i64, 0)                        \
+  V(I64AtomicLoad16U, AtomicMemory, i32, i64, i64, 1)                       \
+  V(I64AtomicLoad32U, AtomicMemory, i32, i64, i64, 2)                       \
+  V(I32AtomicStore, AtomicMemory, i32_i32, i64_i32, none, 2)                \
+  V(I64AtomicStore, AtomicMemory, i32_i64, i64_i64, none, 3)                \
+  V(I32AtomicStore8, AtomicMemory, i32_i32, i64_i32, none, 0)               \
+  V(I32AtomicStore16, AtomicMemory, i32_i32, i64_i32, none, 1)              \
+  V(I64AtomicStore8, AtomicMemory, i32_i64, i64_i64, none, 0)               \
+  V(I64AtomicStore16, AtomicMemory, i32_i64, i64_i64, none, 1)              \
+  V(I64AtomicStore32, AtomicMemory, i32_i64, i64_i64, none, 2)              \
+  V(I32AtomicRmwAdd, AtomicMemory, i32_i32, i64_i32, i32, 2)                \
+  V(I32AtomicRmwSub, AtomicMemory, i32_i32, i64_i32, i32, 2)                \
+  V(I32AtomicRmwAnd, AtomicMemory, i32_i32, i64_i32, i32, 2)                \
+  V(I32AtomicRmwOr, AtomicMemory, i32_i32, i64_i32, i32, 2)                 \
+  V(I32AtomicRmwXor, AtomicMemory, i32_i32, i64_i32, i32, 2)                \
+  V(I32AtomicRmwXchg, AtomicMemory, i32_i32, i64_i32, i32, 2)               \
+  V(I32AtomicRmw16AddU, AtomicMemory, i32_i32, i64_i32, i32, 1)             \
+  V(I32AtomicRmw16SubU, AtomicMemory, i32_i32, i64_i32, i32, 1)             \
+  V(I32AtomicRmw16AndU, AtomicMemory, i32_i32, i64_i32, i32, 1)             \
+  V(I32AtomicRmw16OrU, AtomicMemory, i32_i32, i64_i32, i32, 1)              \
+  V(I32AtomicRmw16XorU, AtomicMemory, i32_i32, i64_i32, i32, 1)             \
+  V(I32AtomicRmw16XchgU, AtomicMemory, i32_i32, i64_i32, i32, 1)            \
+  V(I32AtomicRmw8AddU, AtomicMemory, i32_i32, i64_i32, i32, 0)              \
+  V(I32AtomicRmw8SubU, AtomicMemory, i32_i32, i64_i32, i32, 0)              \
+  V(I32AtomicRmw8AndU, AtomicMemory, i32_i32, i64_i32, i32, 0)              \
+  V(I32AtomicRmw8OrU, AtomicMemory, i32_i32, i64_i32, i32, 0)               \
+  V(I32AtomicRmw8XorU, AtomicMemory, i32_i32, i64_i32, i32, 0)              \
+  V(I32AtomicRmw8XchgU, AtomicMemory, i32_i32, i64_i32, i32, 0)             \
+  V(I64AtomicRmwAdd, AtomicMemory, i32_i64, i64_i64, i64, 3)                \
+  V(I64AtomicRmwSub, AtomicMemory, i32_i64, i64_i64, i64, 3)                \
+  V(I64AtomicRmwAnd, AtomicMemory, i32_i64, i64_i64, i64, 3)                \
+  V(I64AtomicRmwOr, AtomicMemory, i32_i64, i64_i64, i64, 3)                 \
+  V(I64AtomicRmwXor, AtomicMemory, i32_i64, i64_i64, i64, 3)                \
+  V(I64AtomicRmwXchg, AtomicMemory, i32_i64, i64_i64, i64, 3)               \
+  V(I64AtomicRmw8AddU, AtomicMemory, i32_i64, i64_i64, i64, 0)              \
+  V(I64AtomicRmw8SubU, AtomicMemory, i32_i64, i64_i64, i64, 0)              \
+  V(I64AtomicRmw8AndU, AtomicMemory, i32_i64, i64_i64, i64, 0)              \
+  V(I64AtomicRmw8OrU, AtomicMemory, i32_i64, i64_i64, i64, 0)               \
+  V(I64AtomicRmw8XorU, AtomicMemory, i32_i64, i64_i64, i64, 0)              \
+  V(I64AtomicRmw8XchgU, AtomicMemory, i32_i64, i64_i64, i64, 0)             \
+  V(I64AtomicRmw16AddU, AtomicMemory, i32_i64, i64_i64, i64, 1)             \
+  V(I64AtomicRmw16SubU, AtomicMemory, i32_i64, i64_i64, i64, 1)             \
+  V(I64AtomicRmw16AndU, AtomicMemory, i32_i64, i64_i64, i64, 1)             \
+  V(I64AtomicRmw16OrU, AtomicMemory, i32_i64, i64_i64, i64, 1)              \
+  V(I64AtomicRmw16XorU, AtomicMemory, i32_i64, i64_i64, i64, 1)             \
+  V(I64AtomicRmw16XchgU, AtomicMemory, i32_i64, i64_i64, i64, 1)            \
+  V(I64AtomicRmw32AddU, AtomicMemory, i32_i64, i64_i64, i64, 2)             \
+  V(I64AtomicRmw32SubU, AtomicMemory, i32_i64, i64_i64, i64, 2)             \
+  V(I64AtomicRmw32AndU, AtomicMemory, i32_i64, i64_i64, i64, 2)             \
+  V(I64AtomicRmw32OrU, AtomicMemory, i32_i64, i64_i64, i64, 2)              \
+  V(I64AtomicRmw32XorU, AtomicMemory, i32_i64, i64_i64, i64, 2)             \
+  V(I64AtomicRmw32XchgU, AtomicMemory, i32_i64, i64_i64, i64, 2)            \
+  V(I32AtomicRmwCmpxchg, AtomicMemory, i32_i32_i32, i64_i32_i32, i32, 2)    \
+  V(I32AtomicRmw8CmpxchgU, AtomicMemory, i32_i32_i32, i64_i32_i32, i32, 0)  \
+  V(I32AtomicRmw16CmpxchgU, AtomicMemory, i32_i32_i32, i64_i32_i32, i32, 1) \
+  V(I64AtomicRmwCmpxchg, AtomicMemory, i32_i64_i64, i64_i64_i64, i64, 3)    \
+  V(I64AtomicRmw8CmpxchgU, AtomicMemory, i32_i64_i64, i64_i64_i64, i64, 0)  \
+  V(I64AtomicRmw16CmpxchgU, AtomicMemory, i32_i64_i64, i64_i64_i64, i64, 1) \
+  V(I64AtomicRmw32CmpxchgU, AtomicMemory, i32_i64_i64, i64_i64_i64, i64, 2)
+
+// Instructions with immediates or a stack effect that depends on the module,
+// validated by the switch in Validate(). Together with NUMERIC_OPCODES and
+// MEMORY_OPCODES, every opcode in opcode.inc must be listed exactly once;
+// this is checked by a static_assert below.
+//
+//   V(opcode)
+#define OTHER_OPCODES(V)     \
+  V(Unreachable)             \
+  V(Nop)                     \
+  V(Block)                   \
+  V(Loop)                    \
+  V(If)                      \
+  V(Else)                    \
+  V(End)                     \
+  V(Br)                      \
+  V(BrIf)                    \
+  V(BrTable)                 \
+  V(Return)                  \
+  V(Call)                    \
+  V(CallIndirect)            \
+  V(Drop)                    \
+  V(Select)                  \
+  V(LocalGet)                \
+  V(LocalSet)                \
+  V(LocalTee)                \
+  V(GlobalGet)               \
+  V(GlobalSet)               \
+  V(MemorySize)              \
+  V(MemoryGrow)              \
+  V(Try)                     \
+  V(Catch)                   \
+  V(Throw)                   \
+  V(Rethrow)                 \
+  V(Delegate)                \
+  V(CatchAll)                \
+  V(ReturnCall)              \
+  V(ReturnCallIndirect)      \
+  V(CallRef)                 \
+  V(ReturnCallRef)           \
+  V(FuncBind)                \
+  V(Let)                     \
+  V(RefAsNonNull)            \
+  V(BrOnNull)                \
+  V(SelectT)                 \
+  V(TableGet)                \
+  V(TableSet)                \
+  V(TableGrow)               \
+  V(TableSize)               \
+  V(TableFill)               \
+  V(RefNull)                 \
+  V(RefIsNull)               \
+  V(RefFunc)                 \
+  V(StructNewWithRtt)        \
+  V(StructNewDefaultWithRtt) \
+  V(StructGet)               \
+  V(StructGetS)              \
+  V(StructGetU)              \
+  V(StructSet)               \
+  V(ArrayNewWithRtt)         \
+  V(ArrayNewDefaultWithRtt)  \
+  V(ArrayGet)                \
+  V(ArrayGetS)               \
+  V(ArrayGetU)               \
+  V(ArraySet)                \
+  V(ArrayLen)                \
+  V(RttCanon)                \
+  V(RttSub)                  \
+  V(RefTest)                 \
+  V(RefCast)                 \
+  V(BrOnCast)                \
+  V(MemoryInit)              \
+  V(DataDrop)                \
+  V(MemoryCopy)              \
+  V(MemoryFill)              \
+  V(TableInit)               \
+  V(ElemDrop)                \
+  V(TableCopy)               \
+  V(I8X16Shuffle)            \
+  V(I8X16ExtractLaneS)       \
+  V(I8X16ExtractLaneU)       \
+  V(I8X16ReplaceLane)        \
+  V(I16X8ExtractLaneS)       \
+  V(I16X8ExtractLaneU)       \
+  V(I16X8ReplaceLane)        \
+  V(I32X4ExtractLane)        \
+  V(I32X4ReplaceLane)        \
+  V(I64X2ExtractLane)        \
+  V(I64X2ReplaceLane)        \
+  V(F32X4ExtractLane)        \
+  V(F32X4ReplaceLane)        \
+  V(F64X2ExtractLane)        \
+  V(F64X2ReplaceLane)        \
+  V(V128Load8Lane)           \
+  V(V128Load16Lane)          \
+  V(V128Load32Lane)          \
+  V(V128Load64Lane)          \
+  V(V128Store8Lane)          \
+  V(V128Store16Lane)         \
+  V(V128Store32Lane)         \
+  V(V128Store64Lane)
+
+enum class OpcodeKind : u8 {
+  Unlisted,  // Not in any of the lists above.
+  Other,     // Validated by the switch in Validate().
+  Numeric,
+  Memory,
+  AtomicMemory,
+};
+
+struct OpcodeInfo {
+  OpcodeKind kind;
+  SpanId params;
+  SpanId params64;
+  SpanId results;
+  u8 align;
+};
+
+constexpr size_t kOpcodeCount = 0
+#define WASP_V(...) +1
+#define WASP_FEATURE_V(...) WASP_V(__VA_ARGS__)
+#define WASP_PREFIX_V(...) WASP_V(__VA_ARGS__)
+#include "wasp/base/inc/opcode.inc"
+#undef WASP_V
+#undef WASP_FEATURE_V
+#undef WASP_PREFIX_V
+    ;
+
+using OpcodeInfoTable = std::array<OpcodeInfo, kOpcodeCount>;
+
+constexpr OpcodeInfoTable MakeOpcodeInfoTable() {
+  OpcodeInfoTable table{};
+#define WASP_V(name, params, results)                                      \
+  table[static_cast<size_t>(Opcode::name)] = {                             \
+      OpcodeKind::Numeric, SpanId::params, SpanId::params, SpanId::results, \
+      0};
+  NUMERIC_OPCODES(WASP_V)
+#undef WASP_V
+#define WASP_V(name, kind, params, params64, results, align)                \
+  table[static_cast<size_t>(Opcode::name)] = {                              \
+      OpcodeKind::kind, SpanId::params, SpanId::params64, SpanId::results, \
+      align};
+  MEMORY_OPCODES(WASP_V)
+#undef WASP_V
+#define WASP_V(name)                          \
+  table[static_cast<size_t>(Opcode::name)] = { \
+      OpcodeKind::Other, SpanId::none, SpanId::none, SpanId::none, 0};
+  OTHER_OPCODES(WASP_V)
+#undef WASP_V
+  return table;
+}
+
+constexpr size_t kListedOpcodeCount = 0
+#define WASP_V(...) +1
+    NUMERIC_OPCODES(WASP_V) MEMORY_OPCODES(WASP_V) OTHER_OPCODES(WASP_V)
+#undef WASP_V
+    ;
+
+#undef NUMERIC_OPCODES
+#undef MEMORY_OPCODES
+#undef OTHER_OPCODES
+
+constexpr OpcodeInfoTable kOpcodeInfo = MakeOpcodeInfoTable();
+
+constexpr bool AllOpcodesListed(const OpcodeInfoTable& table) {
+  for (const auto& info : table) {
+    if (info.kind == OpcodeKind::Unlisted) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// A new opcode in opcode.inc must be added to one of the lists above, and no
+// opcode may be listed twice.
+static_assert(AllOpcodesListed(kOpcodeInfo),
+              "An opcode is missing from NUMERIC_OPCODES, MEMORY_OPCODES or "
+              "OTHER_OPCODES");
+static_assert(kListedOpcodeCount == kOpcodeCount,
+              "Each opcode must be listed exactly once");
+
 bool AllTrue() { return true; }
 template <typename T, typename... Args>
 bool AllTrue(T first, Args... rest) {
   return !!first & AllTrue(rest...);
 }
 
-optional<FunctionType> GetFunctionType(ValidCtx& ctx, At<Index> index) {
+// Like GetFunctionType, but returns a pointer, to avoid copying the type.
+const FunctionType* GetFunctionTypePtr(ValidCtx& ctx, At<Index> index) {
   if (!ValidateIndex(ctx, index, static_cast<Index>(ctx.types.size()),
                      "type index")) {
-    return nullopt;
+    return nullptr;
   }
   if (!ctx.types[index].is_function_type()) {
     ctx.errors->OnError(index.loc(), "Expected a function type");
+    return nullptr;
+  }
+  return &*ctx.types[index].function_type();
+}
+
+optional<FunctionType> GetFunctionType(ValidCtx& ctx, At<Index> index) {
+  const auto* function_type = GetFunctionTypePtr(ctx, index);
+  if (!function_type) {
     return nullopt;
   }
-  return ctx.types[index].function_type();
+  return *function_type;
 }
 
 optional<StructType> GetStructType(ValidCtx& ctx, At<Index> index) {
@@ -161,22 +841,6 @@ optional<PackedType> GetStructFieldPackedType(ValidCtx& ctx,
   return GetFieldPackedType(ctx, loc, *field_type);
 }
 
-optional<FunctionType> GetBlockTypeSignature(ValidCtx& ctx,
-                                             BlockType block_type) {
-  if (block_type.is_void()) {
-    return FunctionType{};
-  } else if (block_type.is_value_type()) {
-    const auto& value_type = block_type.value_type();
-    if (!Validate(ctx, value_type)) {
-      return nullopt;
-    }
-    return FunctionType{{}, {value_type}};
-  } else {
-    assert(block_type.is_index());
-    return GetFunctionType(ctx, block_type.index());
-  }
-}
-
 Label& TopLabel(ValidCtx& ctx) {
   assert(!ctx.label_stack.empty());
   return ctx.label_stack.back();
@@ -282,7 +946,7 @@ ReferenceType MaybeDefault(optional<ReferenceType> value) {
 }
 
 Label MaybeDefault(const Label* value) {
-  return value ? *value : Label{LabelType::Block, {}, {}, 0};
+  return value ? *value : Label{LabelType::Block, 0, 0, 0, 0};
 }
 
 optional<StackType> PeekType(ValidCtx& ctx, Location loc) {
@@ -339,7 +1003,7 @@ bool CheckResultTypes(ValidCtx& ctx,
   auto* label = GetFunctionLabel(ctx);
   assert(label != nullptr);
   auto caller = ToStackTypeList(function_type.result_types);
-  auto callee = label->br_types();
+  auto callee = ctx.GetBrTypes(*label);
 
   if (!IsMatch(ctx, callee, caller)) {
     ctx.errors->OnError(loc,
@@ -518,29 +1182,40 @@ Label* GetFunctionLabel(ValidCtx& ctx) {
   return GetLabel(ctx, static_cast<Index>(ctx.label_stack.size() - 1));
 }
 
-bool PushLabel(ValidCtx& ctx,
-               Location loc,
-               LabelType label_type,
-               const FunctionType& type) {
-  auto stack_param_types = ToStackTypeList(type.param_types);
-  auto stack_result_types = ToStackTypeList(type.result_types);
-  bool valid = PopTypes(ctx, loc, stack_param_types);
-  ctx.label_stack.emplace_back(label_type, stack_param_types,
-                               stack_result_types,
-                               static_cast<Index>(ctx.type_stack.size()));
-  PushTypes(ctx, stack_param_types);
-  return valid;
-}
-
 bool PushLabel(ValidCtx& ctx,
                Location loc,
                LabelType label_type,
                BlockType block_type) {
-  auto sig = GetBlockTypeSignature(ctx, block_type);
-  if (!sig) {
-    return false;
+  // The label's types are pushed first, so its params can be checked without
+  // copying them elsewhere.
+  if (block_type.is_void()) {
+    ctx.PushLabel(label_type, {}, {}, 0);
+  } else if (block_type.is_value_type()) {
+    const auto& value_type = block_type.value_type();
+    if (!Validate(ctx, value_type)) {
+      return false;
+    }
+    StackType result_type{value_type};
+    ctx.PushLabel(label_type, {}, StackTypeSpan{&result_type, 1}, 0);
+  } else {
+    assert(block_type.is_index());
+    const auto* function_type = GetFunctionTypePtr(ctx, block_type.index());
+    if (!function_type) {
+      return false;
+    }
+    ctx.PushLabel(label_type, *function_type, 0);
   }
-  return PushLabel(ctx, loc, label_type, *sig);
+
+  // Validate the params against the enclosing label, then push them again
+  // inside the new label.
+  Label new_label = ctx.label_stack.back();
+  ctx.label_stack.pop_back();
+  auto param_types = ctx.GetParamTypes(new_label);
+  bool valid = PopTypes(ctx, loc, param_types);
+  new_label.type_stack_limit = static_cast<Index>(ctx.type_stack.size());
+  ctx.label_stack.push_back(new_label);
+  PushTypes(ctx, param_types);
+  return valid;
 }
 
 bool CheckTypeStackEmpty(ValidCtx& ctx, Location loc) {
@@ -563,7 +1238,7 @@ bool Catch(ValidCtx& ctx, Location loc, At<Index> index) {
     ctx.errors->OnError(loc, "Got catch instruction without try");
     return false;
   }
-  valid &= PopTypes(ctx, loc, top_label.result_types);
+  valid &= PopTypes(ctx, loc, ctx.GetResultTypes(top_label));
   valid &= CheckTypeStackEmpty(ctx, loc);
   ResetTypeStackToLimit(ctx);
   PushTypes(ctx, ToStackTypeList(MaybeDefault(function_type).param_types));
@@ -580,7 +1255,7 @@ bool CatchAll(ValidCtx& ctx, Location loc) {
     ctx.errors->OnError(loc, "Got catch_all instruction without try or catch");
     return false;
   }
-  valid &= PopTypes(ctx, loc, top_label.result_types);
+  valid &= PopTypes(ctx, loc, ctx.GetResultTypes(top_label));
   valid &= CheckTypeStackEmpty(ctx, loc);
   ResetTypeStackToLimit(ctx);
   top_label.label_type = LabelType::CatchAll;
@@ -596,11 +1271,11 @@ bool Delegate(ValidCtx& ctx, Location loc, At<Index> depth) {
     return false;
   }
   const auto* label = GetLabel(ctx, depth, +1);  // + 1 to skip innermost try.
-  valid &= PopTypes(ctx, loc, top_label.result_types);
+  valid &= PopTypes(ctx, loc, ctx.GetResultTypes(top_label));
   valid &= CheckTypeStackEmpty(ctx, loc);
   ResetTypeStackToLimit(ctx);
-  PushTypes(ctx, top_label.result_types);
-  ctx.label_stack.pop_back();
+  PushTypes(ctx, ctx.GetResultTypes(top_label));
+  ctx.PopLabel();
   return AllTrue(label, valid);
 }
 
@@ -610,10 +1285,10 @@ bool Else(ValidCtx& ctx, Location loc) {
     ctx.errors->OnError(loc, "Got else instruction without if");
     return false;
   }
-  bool valid = PopTypes(ctx, loc, top_label.result_types);
+  bool valid = PopTypes(ctx, loc, ctx.GetResultTypes(top_label));
   valid &= CheckTypeStackEmpty(ctx, loc);
   ResetTypeStackToLimit(ctx);
-  PushTypes(ctx, top_label.param_types);
+  PushTypes(ctx, ctx.GetParamTypes(top_label));
   top_label.label_type = LabelType::Else;
   top_label.unreachable = false;
   return valid;
@@ -627,17 +1302,17 @@ bool End(ValidCtx& ctx, Location loc) {
   } else if (top_label.label_type == LabelType::Let) {
     ctx.locals.Pop();
   }
-  valid &= PopTypes(ctx, loc, top_label.result_types);
+  valid &= PopTypes(ctx, loc, ctx.GetResultTypes(top_label));
   valid &= CheckTypeStackEmpty(ctx, loc);
   ResetTypeStackToLimit(ctx);
-  PushTypes(ctx, top_label.result_types);
-  ctx.label_stack.pop_back();
+  PushTypes(ctx, ctx.GetResultTypes(top_label));
+  ctx.PopLabel();
   return valid;
 }
 
 bool Br(ValidCtx& ctx, Location loc, At<Index> depth) {
   const auto* label = GetLabel(ctx, depth);
-  bool valid = PopTypes(ctx, loc, MaybeDefault(label).br_types());
+  bool valid = PopTypes(ctx, loc, ctx.GetBrTypes(MaybeDefault(label)));
   SetUnreachable(ctx);
   return AllTrue(label, valid);
 }
@@ -645,10 +1320,8 @@ bool Br(ValidCtx& ctx, Location loc, At<Index> depth) {
 bool BrIf(ValidCtx& ctx, Location loc, At<Index> depth) {
   bool valid = PopType(ctx, loc, StackType::I32());
   const auto* label = GetLabel(ctx, depth);
-  auto label_ = MaybeDefault(label);
-  return AllTrue(
-      valid, label,
-      PopAndPushTypes(ctx, loc, label_.br_types(), label_.br_types()));
+  auto br_types = ctx.GetBrTypes(MaybeDefault(label));
+  return AllTrue(valid, label, PopAndPushTypes(ctx, loc, br_types, br_types));
 }
 
 bool BrTable(ValidCtx& ctx,
@@ -660,19 +1333,19 @@ bool BrTable(ValidCtx& ctx,
     return false;
   }
 
-  StackTypeSpan br_types = default_label->br_types();
+  StackTypeSpan br_types = ctx.GetBrTypes(*default_label);
   valid &= CheckTypes(ctx, immediate->default_target.loc(), br_types);
 
   for (auto target : immediate->targets) {
     const auto* label = GetLabel(ctx, target);
     if (label) {
-      if (br_types.size() != label->br_types().size()) {
+      if (br_types.size() != ctx.GetBrTypes(*label).size()) {
         ctx.errors->OnError(
             target.loc(),
             concat("br_table labels must have the same arity; expected ",
-                   br_types.size(), ", got ", label->br_types().size()));
+                   br_types.size(), ", got ", ctx.GetBrTypes(*label).size()));
         valid = false;
-      } else if (!CheckTypes(ctx, target.loc(), label->br_types())) {
+      } else if (!CheckTypes(ctx, target.loc(), ctx.GetBrTypes(*label))) {
         valid = false;
       }
     } else {
@@ -838,72 +1511,6 @@ StackTypeSpan GetLoadStoreLaneIndexTypeSpan(
   return span_i32_v128;
 }
 
-bool Load(ValidCtx& ctx, Location loc, const At<Instruction>& instruction) {
-  auto memory_type = GetMemoryType(ctx, 0);
-  auto index_span = GetIndexTypeSpan(memory_type);
-  StackTypeSpan span;
-  u32 max_align;
-  switch (instruction->opcode) {
-    case Opcode::I32Load:    span = span_i32; max_align = 2; break;
-    case Opcode::I64Load:    span = span_i64; max_align = 3; break;
-    case Opcode::F32Load:    span = span_f32; max_align = 2; break;
-    case Opcode::F64Load:    span = span_f64; max_align = 3; break;
-    case Opcode::I32Load8S:  span = span_i32; max_align = 0; break;
-    case Opcode::I32Load8U:  span = span_i32; max_align = 0; break;
-    case Opcode::I32Load16S: span = span_i32; max_align = 1; break;
-    case Opcode::I32Load16U: span = span_i32; max_align = 1; break;
-    case Opcode::I64Load8S:  span = span_i64; max_align = 0; break;
-    case Opcode::I64Load8U:  span = span_i64; max_align = 0; break;
-    case Opcode::I64Load16S: span = span_i64; max_align = 1; break;
-    case Opcode::I64Load16U: span = span_i64; max_align = 1; break;
-    case Opcode::I64Load32S: span = span_i64; max_align = 2; break;
-    case Opcode::I64Load32U: span = span_i64; max_align = 2; break;
-    case Opcode::V128Load:   span = span_v128; max_align = 4; break;
-    case Opcode::V128Load8Splat:  span = span_v128; max_align = 0; break;
-    case Opcode::V128Load16Splat: span = span_v128; max_align = 1; break;
-    case Opcode::V128Load32Splat: span = span_v128; max_align = 2; break;
-    case Opcode::V128Load64Splat: span = span_v128; max_align = 3; break;
-    case Opcode::V128Load8X8S:    span = span_v128; max_align = 3; break;
-    case Opcode::V128Load8X8U:    span = span_v128; max_align = 3; break;
-    case Opcode::V128Load16X4S:   span = span_v128; max_align = 3; break;
-    case Opcode::V128Load16X4U:   span = span_v128; max_align = 3; break;
-    case Opcode::V128Load32X2S:   span = span_v128; max_align = 3; break;
-    case Opcode::V128Load32X2U:   span = span_v128; max_align = 3; break;
-    case Opcode::V128Load32Zero:  span = span_v128; max_align = 2; break;
-    case Opcode::V128Load64Zero:  span = span_v128; max_align = 3; break;
-    default:
-      WASP_UNREACHABLE();
-  }
-
-  bool valid = CheckAlignment(ctx, instruction, max_align);
-  return AllTrue(memory_type, valid,
-                 PopAndPushTypes(ctx, loc, index_span, span));
-}
-
-bool Store(ValidCtx& ctx, Location loc, const At<Instruction>& instruction) {
-  auto memory_type = GetMemoryType(ctx, 0);
-  StackType type;
-  u32 max_align;
-  switch (instruction->opcode) {
-    case Opcode::I32Store:   type = StackType::I32(); max_align = 2; break;
-    case Opcode::I64Store:   type = StackType::I64(); max_align = 3; break;
-    case Opcode::F32Store:   type = StackType::F32(); max_align = 2; break;
-    case Opcode::F64Store:   type = StackType::F64(); max_align = 3; break;
-    case Opcode::I32Store8:  type = StackType::I32(); max_align = 0; break;
-    case Opcode::I32Store16: type = StackType::I32(); max_align = 1; break;
-    case Opcode::I64Store8:  type = StackType::I64(); max_align = 0; break;
-    case Opcode::I64Store16: type = StackType::I64(); max_align = 1; break;
-    case Opcode::I64Store32: type = StackType::I64(); max_align = 2; break;
-    case Opcode::V128Store:  type = StackType::V128(); max_align = 4; break;
-    default:
-      WASP_UNREACHABLE();
-  }
-
-  StackTypeList params{GetIndexType(memory_type), type};
-  bool valid = CheckAlignment(ctx, instruction, max_align);
-  return AllTrue(memory_type, valid, PopTypes(ctx, loc, params));
-}
-
 bool CheckMaxLanes(ValidCtx& ctx,
                    const At<Instruction>& instruction,
                    u8 lane,
@@ -1057,172 +1664,20 @@ bool CheckAtomicAlignment(ValidCtx& ctx,
   return true;
 }
 
-bool MemoryAtomicNotify(ValidCtx& ctx,
-                        Location loc,
-                        const At<Instruction>& instruction) {
-  const u32 align = 2;
-  auto memory_type = GetMemoryType(ctx, 0);
-  StackTypeList params{GetIndexType(memory_type), StackType::I32()};
-  bool valid = CheckAtomicAlignment(ctx, instruction, align);
-  return AllTrue(memory_type, valid,
-                 PopAndPushTypes(ctx, loc, params, span_i32));
-}
-
-bool MemoryAtomicWait(ValidCtx& ctx,
-                      Location loc,
-                      const At<Instruction>& instruction) {
-  auto memory_type = GetMemoryType(ctx, 0);
-  StackType type;
-  u32 align;
-  switch (instruction->opcode) {
-    case Opcode::MemoryAtomicWait32: type = StackType::I32(); align = 2; break;
-    case Opcode::MemoryAtomicWait64: type = StackType::I64(); align = 3; break;
-    default:
-      WASP_UNREACHABLE();
-  }
-
-  StackTypeList params{GetIndexType(memory_type), type, StackType::I64()};
-  bool valid = CheckAtomicAlignment(ctx, instruction, align);
-  return AllTrue(memory_type, valid,
-                 PopAndPushTypes(ctx, loc, params, span_i32));
-}
-
-bool AtomicLoad(ValidCtx& ctx,
-                Location loc,
-                const At<Instruction>& instruction) {
-  auto memory_type = GetMemoryType(ctx, 0);
-  auto index_span = GetIndexTypeSpan(memory_type);
-  StackTypeSpan span;
-  u32 align;
-  switch (instruction->opcode) {
-    case Opcode::I32AtomicLoad:    span = span_i32; align = 2; break;
-    case Opcode::I64AtomicLoad:    span = span_i64; align = 3; break;
-    case Opcode::I32AtomicLoad8U:  span = span_i32; align = 0; break;
-    case Opcode::I32AtomicLoad16U: span = span_i32; align = 1; break;
-    case Opcode::I64AtomicLoad8U:  span = span_i64; align = 0; break;
-    case Opcode::I64AtomicLoad16U: span = span_i64; align = 1; break;
-    case Opcode::I64AtomicLoad32U: span = span_i64; align = 2; break;
-    default:
-      WASP_UNREACHABLE();
-  }
-
-  bool valid = CheckAtomicAlignment(ctx, instruction, align);
-  return AllTrue(memory_type, valid,
-                 PopAndPushTypes(ctx, loc, index_span, span));
-}
-
-bool AtomicStore(ValidCtx& ctx,
-                 Location loc,
-                 const At<Instruction>& instruction) {
-  auto memory_type = GetMemoryType(ctx, 0);
-  StackType type;
-  u32 align;
-  switch (instruction->opcode) {
-    case Opcode::I32AtomicStore:   type = StackType::I32(); align = 2; break;
-    case Opcode::I64AtomicStore:   type = StackType::I64(); align = 3; break;
-    case Opcode::I32AtomicStore8:  type = StackType::I32(); align = 0; break;
-    case Opcode::I32AtomicStore16: type = StackType::I32(); align = 1; break;
-    case Opcode::I64AtomicStore8:  type = StackType::I64(); align = 0; break;
-    case Opcode::I64AtomicStore16: type = StackType::I64(); align = 1; break;
-    case Opcode::I64AtomicStore32: type = StackType::I64(); align = 2; break;
-    default:
-      WASP_UNREACHABLE();
-  }
-
-  StackTypeList types{GetIndexType(memory_type), type};
-  bool valid = CheckAtomicAlignment(ctx, instruction, align);
-  return AllTrue(memory_type, valid, PopTypes(ctx, loc, types));
-}
-
-bool AtomicRmw(ValidCtx& ctx,
-               Location loc,
-               const At<Instruction>& instruction) {
+bool MemoryAccess(ValidCtx& ctx,
+                  Location loc,
+                  const At<Instruction>& instruction,
+                  const OpcodeInfo& info) {
   auto memory_type = GetMemoryType(ctx, 0);
-  StackType index_type = GetIndexType(memory_type);
-  StackTypeList params;
-  StackTypeSpan results;
-  u32 align;
-  switch (instruction->opcode) {
-    case Opcode::I32AtomicRmwAdd:
-    case Opcode::I32AtomicRmwSub:
-    case Opcode::I32AtomicRmwAnd:
-    case Opcode::I32AtomicRmwOr:
-    case Opcode::I32AtomicRmwXor:
-    case Opcode::I32AtomicRmwXchg:    align = 2; goto rmw32;
-    case Opcode::I32AtomicRmw16AddU:
-    case Opcode::I32AtomicRmw16SubU:
-    case Opcode::I32AtomicRmw16AndU:
-    case Opcode::I32AtomicRmw16OrU:
-    case Opcode::I32AtomicRmw16XorU:
-    case Opcode::I32AtomicRmw16XchgU: align = 1; goto rmw32;
-    case Opcode::I32AtomicRmw8AddU:
-    case Opcode::I32AtomicRmw8SubU:
-    case Opcode::I32AtomicRmw8AndU:
-    case Opcode::I32AtomicRmw8OrU:
-    case Opcode::I32AtomicRmw8XorU:
-    case Opcode::I32AtomicRmw8XchgU:  align = 0; goto rmw32;
-
-    rmw32:
-      params = {index_type, StackType::I32()};
-      results = span_i32;
-      break;
-
-    case Opcode::I64AtomicRmwAdd:
-    case Opcode::I64AtomicRmwSub:
-    case Opcode::I64AtomicRmwAnd:
-    case Opcode::I64AtomicRmwOr:
-    case Opcode::I64AtomicRmwXor:
-    case Opcode::I64AtomicRmwXchg:    align = 3; goto rmw64;
-    case Opcode::I64AtomicRmw8AddU:
-    case Opcode::I64AtomicRmw8SubU:
-    case Opcode::I64AtomicRmw8AndU:
-    case Opcode::I64AtomicRmw8OrU:
-    case Opcode::I64AtomicRmw8XorU:
-    case Opcode::I64AtomicRmw8XchgU:  align = 0; goto rmw64;
-    case Opcode::I64AtomicRmw16AddU:
-    case Opcode::I64AtomicRmw16SubU:
-    case Opcode::I64AtomicRmw16AndU:
-    case Opcode::I64AtomicRmw16OrU:
-    case Opcode::I64AtomicRmw16XorU:
-    case Opcode::I64AtomicRmw16XchgU: align = 1; goto rmw64;
-    case Opcode::I64AtomicRmw32AddU:
-    case Opcode::I64AtomicRmw32SubU:
-    case Opcode::I64AtomicRmw32AndU:
-    case Opcode::I64AtomicRmw32OrU:
-    case Opcode::I64AtomicRmw32XorU:
-    case Opcode::I64AtomicRmw32XchgU: align = 2; goto rmw64;
-
-    rmw64:
-      params = {index_type, StackType::I64()};
-      results = span_i64;
-      break;
-
-    case Opcode::I32AtomicRmwCmpxchg:    align = 2; goto cmpxchg32;
-    case Opcode::I32AtomicRmw8CmpxchgU:  align = 0; goto cmpxchg32;
-    case Opcode::I32AtomicRmw16CmpxchgU: align = 1; goto cmpxchg32;
-
-    cmpxchg32:
-      params = {index_type, StackType::I32(), StackType::I32()};
-      results = span_i32;
-      break;
-
-    case Opcode::I64AtomicRmwCmpxchg:    align = 3; goto cmpxchg64;
-    case Opcode::I64AtomicRmw8CmpxchgU:  align = 0; goto cmpxchg64;
-    case Opcode::I64AtomicRmw16CmpxchgU: align = 1; goto cmpxchg64;
-    case Opcode::I64AtomicRmw32CmpxchgU: align = 2; goto cmpxchg64;
-
-    cmpxchg64:
-      params = {index_type, StackType::I64(), StackType::I64()};
-      results = span_i64;
-      break;
-
-    default:
-      WASP_UNREACHABLE();
-  }
-
-  bool valid = CheckAtomicAlignment(ctx, instruction, align);
+  bool is_64 =
+      memory_type && *memory_type->limits->index_type == IndexType::I64;
+  bool valid = info.kind == OpcodeKind::AtomicMemory
+                   ? CheckAtomicAlignment(ctx, instruction, info.align)
+                   : CheckAlignment(ctx, instruction, info.align);
   return AllTrue(memory_type, valid,
-                 PopAndPushTypes(ctx, loc, params, results));
+                 PopAndPushTypes(ctx, loc,
+                                 GetSpan(is_64 ? info.params64 : info.params),
+                                 GetSpan(info.results)));
 }
 
 bool ReturnCall(ValidCtx& ctx, Location loc, At<Index> function_index) {
@@ -1275,8 +1730,8 @@ bool BrOnNull(ValidCtx& ctx, Location loc, const At<Index>& depth) {
   auto type = MaybeDefault(type_opt);
 
   const auto* label = GetLabel(ctx, depth);
-  auto label_ = MaybeDefault(label);
-  valid &= PopAndPushTypes(ctx, loc, label_.br_types(), label_.br_types());
+  auto br_types = ctx.GetBrTypes(MaybeDefault(label));
+  valid &= PopAndPushTypes(ctx, loc, br_types, br_types);
 
   if (IsNullableType(type)) {
     PushType(ctx, AsNonNullableType(type));
@@ -1570,7 +2025,7 @@ bool BrOnCast(ValidCtx& ctx, Location loc, const At<Index>& immediate) {
       StackType{ValueType{ReferenceType{RefType{rtt_opt->type, Null::Yes}}}}};
 
   auto* label = GetLabel(ctx, immediate);
-  auto label_types = MaybeDefault(label).br_types();
+  auto label_types = ctx.GetBrTypes(MaybeDefault(label));
   if (!IsMatch(ctx, sub_type, label_types)) {
     ctx.errors->OnError(
         loc, concat("Label type is ", label_types, ", got ", sub_type));
@@ -1860,7 +2315,21 @@ bool Validate(ValidCtx& ctx, const At<Instruction>& value) {
 
   Location loc = value.loc();
 
-  StackTypeSpan params, results;
+  const OpcodeInfo& info = kOpcodeInfo[static_cast<size_t>(*value->opcode)];
+  switch (info.kind) {
+    case OpcodeKind::Numeric:
+      return PopAndPushTypes(ctx, loc, GetSpan(info.params),
+                             GetSpan(info.results));
+
+    case OpcodeKind::Memory:
+    case OpcodeKind::AtomicMemory:
+      return MemoryAccess(ctx, loc, value, info);
+
+    case OpcodeKind::Unlisted:
+    case OpcodeKind::Other:
+      break;
+  }
+
   switch (value->opcode) {
     case Opcode::Unreachable:
       SetUnreachable(ctx);
@@ -1987,47 +2456,6 @@ bool Validate(ValidCtx& ctx, const At<Instruction>& value) {
     case Opcode::Let:
       return Let(ctx, loc, value->let_immediate());
 
-    case Opcode::I32Load:
-    case Opcode::I64Load:
-    case Opcode::F32Load:
-    case Opcode::F64Load:
-    case Opcode::I32Load8S:
-    case Opcode::I32Load8U:
-    case Opcode::I32Load16S:
-    case Opcode::I32Load16U:
-    case Opcode::I64Load8S:
-    case Opcode::I64Load8U:
-    case Opcode::I64Load16S:
-    case Opcode::I64Load16U:
-    case Opcode::I64Load32S:
-    case Opcode::I64Load32U:
-    case Opcode::V128Load:
-    case Opcode::V128Load8Splat:
-    case Opcode::V128Load16Splat:
-    case Opcode::V128Load32Splat:
-    case Opcode::V128Load64Splat:
-    case Opcode::V128Load8X8S:
-    case Opcode::V128Load8X8U:
-    case Opcode::V128Load16X4S:
-    case Opcode::V128Load16X4U:
-    case Opcode::V128Load32X2S:
-    case Opcode::V128Load32X2U:
-    case Opcode::V128Load32Zero:
-    case Opcode::V128Load64Zero:
-      return Load(ctx, loc, value);
-
-    case Opcode::I32Store:
-    case Opcode::I64Store:
-    case Opcode::F32Store:
-    case Opcode::F64Store:
-    case Opcode::I32Store8:
-    case Opcode::I32Store16:
-    case Opcode::I64Store8:
-    case Opcode::I64Store16:
-    case Opcode::I64Store32:
-    case Opcode::V128Store:
-      return Store(ctx, loc, value);
-
     case Opcode::V128Load8Lane:
     case Opcode::V128Load16Lane:
     case Opcode::V128Load32Lane:
@@ -2044,227 +2472,6 @@ bool Validate(ValidCtx& ctx, const At<Instruction>& value) {
     case Opcode::MemoryGrow:
       return MemoryGrow(ctx, loc);
 
-    case Opcode::I32Const:
-      PushType(ctx, StackType::I32());
-      return true;
-
-    case Opcode::I64Const:
-      PushType(ctx, StackType::I64());
-      return true;
-
-    case Opcode::F32Const:
-      PushType(ctx, StackType::F32());
-      return true;
-
-    case Opcode::F64Const:
-      PushType(ctx, StackType::F64());
-      return true;
-
-    case Opcode::I32Eqz:
-    case Opcode::I32Clz:
-    case Opcode::I32Ctz:
-    case Opcode::I32Popcnt:
-    case Opcode::I32Extend8S:
-    case Opcode::I32Extend16S:
-      params = span_i32, results = span_i32;
-      break;
-
-    case Opcode::I64Eqz:
-    case Opcode::I32WrapI64:
-      params = span_i64, results = span_i32;
-      break;
-
-    case Opcode::I64Clz:
-    case Opcode::I64Ctz:
-    case Opcode::I64Popcnt:
-    case Opcode::I64Extend8S:
-    case Opcode::I64Extend16S:
-    case Opcode::I64Extend32S:
-      params = span_i64, results = span_i64;
-      break;
-
-    case Opcode::I32Eq:
-    case Opcode::I32Ne:
-    case Opcode::I32LtS:
-    case Opcode::I32LtU:
-    case Opcode::I32GtS:
-    case Opcode::I32GtU:
-    case Opcode::I32LeS:
-    case Opcode::I32LeU:
-    case Opcode::I32GeS:
-    case Opcode::I32GeU:
-    case Opcode::I32Add:
-    case Opcode::I32Sub:
-    case Opcode::I32Mul:
-    case Opcode::I32DivS:
-    case Opcode::I32DivU:
-    case Opcode::I32RemS:
-    case Opcode::I32RemU:
-    case Opcode::I32And:
-    case Opcode::I32Or:
-    case Opcode::I32Xor:
-    case Opcode::I32Shl:
-    case Opcode::I32ShrS:
-    case Opcode::I32ShrU:
-    case Opcode::I32Rotl:
-    case Opcode::I32Rotr:
-      params = span_i32_i32, results = span_i32;
-      break;
-
-    case Opcode::I64Eq:
-    case Opcode::I64Ne:
-    case Opcode::I64LtS:
-    case Opcode::I64LtU:
-    case Opcode::I64GtS:
-    case Opcode::I64GtU:
-    case Opcode::I64LeS:
-    case Opcode::I64LeU:
-    case Opcode::I64GeS:
-    case Opcode::I64GeU:
-      params = span_i64_i64, results = span_i32;
-      break;
-
-    case Opcode::F32Eq:
-    case Opcode::F32Ne:
-    case Opcode::F32Lt:
-    case Opcode::F32Gt:
-    case Opcode::F32Le:
-    case Opcode::F32Ge:
-      params = span_f32_f32, results = span_i32;
-      break;
-
-    case Opcode::F64Eq:
-    case Opcode::F64Ne:
-    case Opcode::F64Lt:
-    case Opcode::F64Gt:
-    case Opcode::F64Le:
-    case Opcode::F64Ge:
-      params = span_f64_f64, results = span_i32;
-      break;
-
-    case Opcode::I64Add:
-    case Opcode::I64Sub:
-    case Opcode::I64Mul:
-    case Opcode::I64DivS:
-    case Opcode::I64DivU:
-    case Opcode::I64RemS:
-    case Opcode::I64RemU:
-    case Opcode::I64And:
-    case Opcode::I64Or:
-    case Opcode::I64Xor:
-    case Opcode::I64Shl:
-    case Opcode::I64ShrS:
-    case Opcode::I64ShrU:
-    case Opcode::I64Rotl:
-    case Opcode::I64Rotr:
-      params = span_i64_i64, results = span_i64;
-      break;
-
-    case Opcode::F32Abs:
-    case Opcode::F32Neg:
-    case Opcode::F32Ceil:
-    case Opcode::F32Floor:
-    case Opcode::F32Trunc:
-    case Opcode::F32Nearest:
-    case Opcode::F32Sqrt:
-      params = span_f32, results = span_f32;
-      break;
-
-    case Opcode::F32Add:
-    case Opcode::F32Sub:
-    case Opcode::F32Mul:
-    case Opcode::F32Div:
-    case Opcode::F32Min:
-    case Opcode::F32Max:
-    case Opcode::F32Copysign:
-      params = span_f32_f32, results = span_f32;
-      break;
-
-    case Opcode::F64Abs:
-    case Opcode::F64Neg:
-    case Opcode::F64Ceil:
-    case Opcode::F64Floor:
-    case Opcode::F64Trunc:
-    case Opcode::F64Nearest:
-    case Opcode::F64Sqrt:
-      params = span_f64, results = span_f64;
-      break;
-
-    case Opcode::F64Add:
-    case Opcode::F64Sub:
-    case Opcode::F64Mul:
-    case Opcode::F64Div:
-    case Opcode::F64Min:
-    case Opcode::F64Max:
-    case Opcode::F64Copysign:
-      params = span_f64_f64, results = span_f64;
-      break;
-
-    case Opcode::I32TruncF32S:
-    case Opcode::I32TruncF32U:
-    case Opcode::I32ReinterpretF32:
-    case Opcode::I32TruncSatF32S:
-    case Opcode::I32TruncSatF32U:
-      params = span_f32, results = span_i32;
-      break;
-
-    case Opcode::I32TruncF64S:
-    case Opcode::I32TruncF64U:
-    case Opcode::I32TruncSatF64S:
-    case Opcode::I32TruncSatF64U:
-      params = span_f64, results = span_i32;
-      break;
-
-    case Opcode::I64ExtendI32S:
-    case Opcode::I64ExtendI32U:
-      params = span_i32, results = span_i64;
-      break;
-
-    case Opcode::I64TruncF32S:
-    case Opcode::I64TruncF32U:
-    case Opcode::I64TruncSatF32S:
-    case Opcode::I64TruncSatF32U:
-      params = span_f32, results = span_i64;
-      break;
-
-    case Opcode::I64TruncF64S:
-    case Opcode::I64TruncF64U:
-    case Opcode::I64ReinterpretF64:
-    case Opcode::I64TruncSatF64S:
-    case Opcode::I64TruncSatF64U:
-      params = span_f64, results = span_i64;
-      break;
-
-    case Opcode::F32ConvertI32S:
-    case Opcode::F32ConvertI32U:
-    case Opcode::F32ReinterpretI32:
-      params = span_i32, results = span_f32;
-      break;
-
-    case Opcode::F32ConvertI64S:
-    case Opcode::F32ConvertI64U:
-      params = span_i64, results = span_f32;
-      break;
-
-    case Opcode::F32DemoteF64:
-      params = span_f64, results = span_f32;
-      break;
-
-    case Opcode::F64ConvertI32S:
-    case Opcode::F64ConvertI32U:
-      params = span_i32, results = span_f64;
-      break;
-
-    case Opcode::F64ConvertI64S:
-    case Opcode::F64ConvertI64U:
-    case Opcode::F64ReinterpretI64:
-      params = span_i64, results = span_f64;
-      break;
-
-    case Opcode::F64PromoteF32:
-      params = span_f32, results = span_f64;
-      break;
-
     case Opcode::ReturnCall:
       return ReturnCall(ctx, loc, value->index_immediate());
 
@@ -2301,211 +2508,9 @@ bool Validate(ValidCtx& ctx, const At<Instruction>& value) {
     case Opcode::TableFill:
       return TableFill(ctx, loc, value->index_immediate());
 
-    case Opcode::V128Const:
-      PushType(ctx, StackType::V128());
-      return true;
-
-    case Opcode::V128Not:
-    case Opcode::F32X4DemoteF64X2Zero:
-    case Opcode::F64X2PromoteLowF32X4:
-    case Opcode::I8X16Abs:
-    case Opcode::I8X16Neg:
-    case Opcode::I8X16Popcnt:
-    case Opcode::F32X4Ceil:
-    case Opcode::F32X4Floor:
-    case Opcode::F32X4Trunc:
-    case Opcode::F32X4Nearest:
-    case Opcode::F64X2Ceil:
-    case Opcode::F64X2Floor:
-    case Opcode::F64X2Trunc:
-    case Opcode::I16X8ExtaddPairwiseI8X16S:
-    case Opcode::I16X8ExtaddPairwiseI8X16U:
-    case Opcode::I32X4ExtaddPairwiseI16X8S:
-    case Opcode::I32X4ExtaddPairwiseI16X8U:
-    case Opcode::I16X8Abs:
-    case Opcode::I16X8Neg:
-    case Opcode::I16X8ExtendLowI8X16S:
-    case Opcode::I16X8ExtendHighI8X16S:
-    case Opcode::I16X8ExtendLowI8X16U:
-    case Opcode::I16X8ExtendHighI8X16U:
-    case Opcode::F64X2Nearest:
-    case Opcode::I32X4Abs:
-    case Opcode::I32X4Neg:
-    case Opcode::I32X4ExtendLowI16X8S:
-    case Opcode::I32X4ExtendHighI16X8S:
-    case Opcode::I32X4ExtendLowI16X8U:
-    case Opcode::I32X4ExtendHighI16X8U:
-    case Opcode::I64X2Abs:
-    case Opcode::I64X2Neg:
-    case Opcode::I64X2ExtendLowI32X4S:
-    case Opcode::I64X2ExtendHighI32X4S:
-    case Opcode::I64X2ExtendLowI32X4U:
-    case Opcode::I64X2ExtendHighI32X4U:
-    case Opcode::F32X4Abs:
-    case Opcode::F32X4Neg:
-    case Opcode::F32X4Sqrt:
-    case Opcode::F64X2Abs:
-    case Opcode::F64X2Neg:
-    case Opcode::F64X2Sqrt:
-    case Opcode::I32X4TruncSatF32X4S:
-    case Opcode::I32X4TruncSatF32X4U:
-    case Opcode::F32X4ConvertI32X4S:
-    case Opcode::F32X4ConvertI32X4U:
-    case Opcode::I32X4TruncSatF64X2SZero:
-    case Opcode::I32X4TruncSatF64X2UZero:
-    case Opcode::F64X2ConvertLowI32X4S:
-    case Opcode::F64X2ConvertLowI32X4U:
-      params = span_v128, results = span_v128;
-      break;
-
-    case Opcode::V128BitSelect:
-      params = span_v128_v128_v128, results = span_v128;
-      break;
-
-    case Opcode::I8X16Swizzle:
-    case Opcode::I8X16Eq:
-    case Opcode::I8X16Ne:
-    case Opcode::I8X16LtS:
-    case Opcode::I8X16LtU:
-    case Opcode::I8X16GtS:
-    case Opcode::I8X16GtU:
-    case Opcode::I8X16LeS:
-    case Opcode::I8X16LeU:
-    case Opcode::I8X16GeS:
-    case Opcode::I8X16GeU:
-    case Opcode::I16X8Eq:
-    case Opcode::I16X8Ne:
-    case Opcode::I16X8LtS:
-    case Opcode::I16X8LtU:
-    case Opcode::I16X8GtS:
-    case Opcode::I16X8GtU:
-    case Opcode::I16X8LeS:
-    case Opcode::I16X8LeU:
-    case Opcode::I16X8GeS:
-    case Opcode::I16X8GeU:
-    case Opcode::I32X4Eq:
-    case Opcode::I32X4Ne:
-    case Opcode::I32X4LtS:
-    case Opcode::I32X4LtU:
-    case Opcode::I32X4GtS:
-    case Opcode::I32X4GtU:
-    case Opcode::I32X4LeS:
-    case Opcode::I32X4LeU:
-    case Opcode::I32X4GeS:
-    case Opcode::I32X4GeU:
-    case Opcode::F32X4Eq:
-    case Opcode::F32X4Ne:
-    case Opcode::F32X4Lt:
-    case Opcode::F32X4Gt:
-    case Opcode::F32X4Le:
-    case Opcode::F32X4Ge:
-    case Opcode::F64X2Eq:
-    case Opcode::F64X2Ne:
-    case Opcode::F64X2Lt:
-    case Opcode::F64X2Gt:
-    case Opcode::F64X2Le:
-    case Opcode::F64X2Ge:
-    case Opcode::V128And:
-    case Opcode::V128Andnot:
-    case Opcode::V128Or:
-    case Opcode::V128Xor:
-    case Opcode::I8X16NarrowI16X8S:
-    case Opcode::I8X16NarrowI16X8U:
-    case Opcode::I8X16Add:
-    case Opcode::I8X16AddSatS:
-    case Opcode::I8X16AddSatU:
-    case Opcode::I8X16Sub:
-    case Opcode::I8X16SubSatS:
-    case Opcode::I8X16SubSatU:
-    case Opcode::I8X16MinS:
-    case Opcode::I8X16MinU:
-    case Opcode::I8X16MaxS:
-    case Opcode::I8X16MaxU:
-    case Opcode::I8X16AvgrU:
-    case Opcode::I16X8Q15mulrSatS:
-    case Opcode::I16X8NarrowI32X4S:
-    case Opcode::I16X8NarrowI32X4U:
-    case Opcode::I16X8Add:
-    case Opcode::I16X8AddSatS:
-    case Opcode::I16X8AddSatU:
-    case Opcode::I16X8Sub:
-    case Opcode::I16X8SubSatS:
-    case Opcode::I16X8SubSatU:
-    case Opcode::I16X8Mul:
-    case Opcode::I16X8MinS:
-    case Opcode::I16X8MinU:
-    case Opcode::I16X8MaxS:
-    case Opcode::I16X8MaxU:
-    case Opcode::I16X8AvgrU:
-    case Opcode::I16X8ExtmulLowI8X16S:
-    case Opcode::I16X8ExtmulHighI8X16S:
-    case Opcode::I16X8ExtmulLowI8X16U:
-    case Opcode::I16X8ExtmulHighI8X16U:
-    case Opcode::I32X4Add:
-    case Opcode::I32X4Sub:
-    case Opcode::I32X4Mul:
-    case Opcode::I32X4MinS:
-    case Opcode::I32X4MinU:
-    case Opcode::I32X4MaxS:
-    case Opcode::I32X4MaxU:
-    case Opcode::I32X4DotI16X8S:
-    case Opcode::I32X4ExtmulLowI16X8S:
-    case Opcode::I32X4ExtmulHighI16X8S:
-    case Opcode::I32X4ExtmulLowI16X8U:
-    case Opcode::I32X4ExtmulHighI16X8U:
-    case Opcode::I64X2Add:
-    case Opcode::I64X2Sub:
-    case Opcode::I64X2Mul:
-    case Opcode::I64X2Eq:
-    case Opcode::I64X2Ne:
-    case Opcode::I64X2LtS:
-    case Opcode::I64X2GtS:
-    case Opcode::I64X2LeS:
-    case Opcode::I64X2GeS:
-    case Opcode::I64X2ExtmulLowI32X4S:
-    case Opcode::I64X2ExtmulHighI32X4S:
-    case Opcode::I64X2ExtmulLowI32X4U:
-    case Opcode::I64X2ExtmulHighI32X4U:
-    case Opcode::F32X4Add:
-    case Opcode::F32X4Sub:
-    case Opcode::F32X4Mul:
-    case Opcode::F32X4Div:
-    case Opcode::F32X4Min:
-    case Opcode::F32X4Max:
-    case Opcode::F32X4Pmin:
-    case Opcode::F32X4Pmax:
-    case Opcode::F64X2Add:
-    case Opcode::F64X2Sub:
-    case Opcode::F64X2Mul:
-    case Opcode::F64X2Div:
-    case Opcode::F64X2Min:
-    case Opcode::F64X2Max:
-    case Opcode::F64X2Pmin:
-    case Opcode::F64X2Pmax:
-      params = span_v128_v128, results = span_v128;
-      break;
-
     case Opcode::I8X16Shuffle:
       return SimdShuffle(ctx, loc, value->shuffle_immediate());
 
-    case Opcode::I8X16Splat:
-    case Opcode::I16X8Splat:
-    case Opcode::I32X4Splat:
-      params = span_i32, results = span_v128;
-      break;
-
-    case Opcode::I64X2Splat:
-      params = span_i64, results = span_v128;
-      break;
-
-    case Opcode::F32X4Splat:
-      params = span_f32, results = span_v128;
-      break;
-
-    case Opcode::F64X2Splat:
-      params = span_f64, results = span_v128;
-      break;
-
     case Opcode::I8X16ExtractLaneS:
     case Opcode::I8X16ExtractLaneU:
     case Opcode::I16X8ExtractLaneS:
@@ -2522,122 +2527,6 @@ bool Validate(ValidCtx& ctx, const At<Instruction>& value) {
     case Opcode::F64X2ReplaceLane:
       return SimdLane(ctx, loc, value);
 
-    case Opcode::V128AnyTrue:
-    case Opcode::I8X16AllTrue:
-    case Opcode::I8X16Bitmask:
-    case Opcode::I16X8AllTrue:
-    case Opcode::I16X8Bitmask:
-    case Opcode::I32X4AllTrue:
-    case Opcode::I32X4Bitmask:
-    case Opcode::I64X2AllTrue:
-    case Opcode::I64X2Bitmask:
-      params = span_v128, results = span_i32;
-      break;
-
-    case Opcode::I8X16Shl:
-    case Opcode::I8X16ShrS:
-    case Opcode::I8X16ShrU:
-    case Opcode::I16X8Shl:
-    case Opcode::I16X8ShrS:
-    case Opcode::I16X8ShrU:
-    case Opcode::I32X4Shl:
-    case Opcode::I32X4ShrS:
-    case Opcode::I32X4ShrU:
-    case Opcode::I64X2Shl:
-    case Opcode::I64X2ShrS:
-    case Opcode::I64X2ShrU:
-      params = span_v128_i32, results = span_v128;
-      break;
-
-    case Opcode::MemoryAtomicNotify:
-      return MemoryAtomicNotify(ctx, loc, value);
-
-    case Opcode::MemoryAtomicWait32:
-    case Opcode::MemoryAtomicWait64:
-      return MemoryAtomicWait(ctx, loc, value);
-
-    case Opcode::I32AtomicLoad:
-    case Opcode::I64AtomicLoad:
-    case Opcode::I32AtomicLoad8U:
-    case Opcode::I32AtomicLoad16U:
-    case Opcode::I64AtomicLoad8U:
-    case Opcode::I64AtomicLoad16U:
-    case Opcode::I64AtomicLoad32U:
-      return AtomicLoad(ctx, loc, value);
-
-    case Opcode::I32AtomicStore:
-    case Opcode::I64AtomicStore:
-    case Opcode::I32AtomicStore8:
-    case Opcode::I32AtomicStore16:
-    case Opcode::I64AtomicStore8:
-    case Opcode::I64AtomicStore16:
-    case Opcode::I64AtomicStore32:
-      return AtomicStore(ctx, loc, value);
-
-    case Opcode::I32AtomicRmwAdd:
-    case Opcode::I32AtomicRmw8AddU:
-    case Opcode::I32AtomicRmw16AddU:
-    case Opcode::I32AtomicRmwSub:
-    case Opcode::I32AtomicRmw8SubU:
-    case Opcode::I32AtomicRmw16SubU:
-    case Opcode::I32AtomicRmwAnd:
-    case Opcode::I32AtomicRmw8AndU:
-    case Opcode::I32AtomicRmw16AndU:
-    case Opcode::I32AtomicRmwOr:
-    case Opcode::I32AtomicRmw8OrU:
-    case Opcode::I32AtomicRmw16OrU:
-    case Opcode::I32AtomicRmwXor:
-    case Opcode::I32AtomicRmw8XorU:
-    case Opcode::I32AtomicRmw16XorU:
-    case Opcode::I32AtomicRmwXchg:
-    case Opcode::I32AtomicRmw8XchgU:
-    case Opcode::I32AtomicRmw16XchgU:
-    case Opcode::I64AtomicRmwAdd:
-    case Opcode::I64AtomicRmw8AddU:
-    case Opcode::I64AtomicRmw16AddU:
-    case Opcode::I64AtomicRmw32AddU:
-    case Opcode::I64AtomicRmwSub:
-    case Opcode::I64AtomicRmw8SubU:
-    case Opcode::I64AtomicRmw16SubU:
-    case Opcode::I64AtomicRmw32SubU:
-    case Opcode::I64AtomicRmwAnd:
-    case Opcode::I64AtomicRmw8AndU:
-    case Opcode::I64AtomicRmw16AndU:
-    case Opcode::I64AtomicRmw32AndU:
-    case Opcode::I64AtomicRmwOr:
-    case Opcode::I64AtomicRmw8OrU:
-    case Opcode::I64AtomicRmw16OrU:
-    case Opcode::I64AtomicRmw32OrU:
-    case Opcode::I64AtomicRmwXor:
-    case Opcode::I64AtomicRmw8XorU:
-    case Opcode::I64AtomicRmw16XorU:
-    case Opcode::I64AtomicRmw32XorU:
-    case Opcode::I64AtomicRmwXchg:
-    case Opcode::I64AtomicRmw8XchgU:
-    case Opcode::I64AtomicRmw16XchgU:
-    case Opcode::I64AtomicRmw32XchgU:
-    case Opcode::I32AtomicRmwCmpxchg:
-    case Opcode::I64AtomicRmwCmpxchg:
-    case Opcode::I32AtomicRmw8CmpxchgU:
-    case Opcode::I32AtomicRmw16CmpxchgU:
-    case Opcode::I64AtomicRmw8CmpxchgU:
-    case Opcode::I64AtomicRmw16CmpxchgU:
-    case Opcode::I64AtomicRmw32CmpxchgU:
-      return AtomicRmw(ctx, loc, value);
-
-    case Opcode::RefEq:
-      params = span_eqref_eqref, results = span_i32;
-      break;
-
-    case Opcode::I31New:
-      params = span_i32, results = span_i31ref;
-      break;
-
-    case Opcode::I31GetS:
-    case Opcode::I31GetU:
-      params = span_i31ref, results = span_i32;
-      break;
-
     case Opcode::RttCanon:
       return RttCanon(ctx, loc, value->heap_type_immediate());
 
@@ -2687,9 +2576,10 @@ bool Validate(ValidCtx& ctx, const At<Instruction>& value) {
 
     case Opcode::ArrayLen:
       return ArrayLen(ctx, loc, value->index_immediate());
-  }
 
-  return PopAndPushTypes(ctx, loc, params, results);
+    default:
+      WASP_UNREACHABLE();
+  }
 }
 
 }  // namespace wasp::valid
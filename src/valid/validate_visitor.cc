@@ -16,13 +16,40 @@
 
 #include "wasp/valid/validate_visitor.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <limits>
+#include <thread>
+#include <vector>
+
+#include "wasp/base/errors_buffer.h"
+#include "wasp/binary/lazy_expression.h"
+#include "wasp/binary/read.h"
+#include "wasp/binary/read/read_ctx.h"
 
 namespace wasp::valid {
 
 ValidateVisitor::ValidateVisitor(Features features, Errors& errors)
     : ctx{features, errors}, features{features}, errors{errors} {}
 
+ValidateVisitor::ValidateVisitor(Features features,
+                                 Errors& errors,
+                                 u32 code_jobs)
+    : ctx{features, errors},
+      features{features},
+      errors{errors},
+      code_jobs{code_jobs} {}
+
+auto ValidateVisitor::OnSection(At<binary::Section> section) -> Result {
+  // BeginCodeSection isn't given the section's data, so remember it here.
+  if (code_jobs > 1 && section->is_known() &&
+      section->known()->id == binary::SectionId::Code) {
+    code_section_data = section->known()->data;
+  }
+  return Result::Ok;
+}
+
 auto ValidateVisitor::BeginTypeSection(binary::LazyTypeSection sec) -> Result {
   return FailUnless(valid::BeginTypeSection(ctx, sec.count.value_or(0)));
 }
@@ -79,6 +106,16 @@ auto ValidateVisitor::OnDataCount(const At<binary::DataCount>& data_count)
   return FailUnless(Validate(ctx, data_count));
 }
 
+auto ValidateVisitor::BeginCodeSection(binary::LazyCodeSection sec)
+    -> Result {
+  if (!code_section_data) {
+    return Result::Ok;
+  }
+  auto data = *code_section_data;
+  code_section_data.reset();
+  return ValidateCodeSectionParallel(data, sec.sequence.ctx());
+}
+
 auto ValidateVisitor::BeginCode(const At<binary::Code>& code) -> Result {
   return FailUnless(valid::BeginCode(ctx, code.loc()) &&
                     Validate(ctx, code->locals, RequireDefaultable::Yes));
@@ -97,4 +134,120 @@ auto ValidateVisitor::FailUnless(bool b) -> Result {
   return b ? Result::Ok : Result::Fail;
 }
 
+namespace {
+
+// A contiguous range of function bodies, validated by a single thread.
+struct CodeChunk {
+  size_t begin;
+  size_t end;
+  ErrorsBuffer errors;
+  bool failed = false;
+};
+
+}  // namespace
+
+auto ValidateVisitor::ValidateCodeSectionParallel(
+    SpanU8 data,
+    const binary::ReadCtx& module_read_ctx) -> Result {
+  // Read the locals and body span of each function first. This is cheap
+  // compared to decoding and validating the bodies. If it fails, fall back to
+  // the serial path, which will read the section again and report the errors.
+  std::vector<At<binary::Code>> codes;
+  {
+    ErrorsBuffer read_errors;
+    binary::ReadCtx read_ctx{module_read_ctx, read_errors};
+    for (const auto& code : binary::ReadCodeSection(data, read_ctx).sequence) {
+      codes.push_back(code);
+    }
+    if (read_errors.HasError()) {
+      return Result::Ok;
+    }
+  }
+
+  // Use more chunks than threads, so a few large functions don't leave the
+  // other threads idle.
+  const size_t jobs = std::min<size_t>(code_jobs, codes.size());
+  const size_t chunk_size = std::max<size_t>(1, codes.size() / (jobs * 16));
+  std::vector<CodeChunk> chunks;
+  for (size_t begin = 0; begin < codes.size(); begin += chunk_size) {
+    chunks.push_back(
+        CodeChunk{begin, std::min(begin + chunk_size, codes.size()), {}});
+  }
+
+  // Once a chunk has failed, the chunks after it don't need to be validated,
+  // since validation stops at the first failure.
+  std::atomic<size_t> next_chunk{0};
+  std::atomic<size_t> first_failed_chunk{std::numeric_limits<size_t>::max()};
+  const Index first_code_count = ctx.code_count;
+
+  auto worker = [&]() {
+    // The module-level state in `ctx` is not modified while the bodies are
+    // validated, so it is safe to copy it concurrently.
+    ValidCtx worker_ctx{ctx, *ctx.errors};
+    for (size_t i; (i = next_chunk++) < chunks.size();) {
+      if (i > first_failed_chunk) {
+        continue;
+      }
+      auto& chunk = chunks[i];
+      worker_ctx.errors = &chunk.errors;
+      // Each function body is read with the module state, e.g. the declared
+      // data count, that the serial path would use.
+      binary::ReadCtx read_ctx{module_read_ctx, chunk.errors};
+      for (size_t index = chunk.begin; index < chunk.end; ++index) {
+        const auto& code = codes[index];
+        worker_ctx.code_count = first_code_count + static_cast<Index>(index);
+        bool valid =
+            valid::BeginCode(worker_ctx, code.loc()) &&
+            Validate(worker_ctx, code->locals, RequireDefaultable::Yes);
+        if (valid) {
+          read_ctx.local_count = 0;
+          for (const auto& locals : code->locals) {
+            read_ctx.local_count += locals->count;
+          }
+          read_ctx.open_blocks.clear();
+          for (auto&& instr : binary::ReadExpression(*code->body, read_ctx)) {
+            if (!Validate(worker_ctx, instr)) {
+              valid = false;
+              break;
+            }
+          }
+          // A read error ends the expression early, without failing
+          // validation of the instructions read so far.
+          valid = valid && !chunk.errors.HasError() &&
+                  binary::EndCode(code->body->data.last(0), read_ctx);
+        }
+
+        if (!valid) {
+          chunk.failed = true;
+          size_t expected = first_failed_chunk;
+          while (i < expected &&
+                 !first_failed_chunk.compare_exchange_weak(expected, i)) {
+          }
+          break;
+        }
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < jobs; ++i) {
+    threads.emplace_back(worker);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // Report errors in function order, stopping at the first failure.
+  for (auto& chunk : chunks) {
+    chunk.errors.ReplayTo(errors);
+    if (chunk.failed) {
+      return Result::Fail;
+    }
+  }
+
+  ctx.code_count += static_cast<Index>(codes.size());
+  // Skip the section, since all function bodies have already been validated.
+  return Result::Skip;
+}
+
 }  // namespace wasp::valid
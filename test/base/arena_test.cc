@@ -0,0 +1,95 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/base/arena.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace ::wasp;
+
+TEST(ArenaTest, Add) {
+  Arena arena;
+  auto hello = arena.Add("hello"_sv);
+  auto bytes = arena.Add("\x01\x02\x03"_su8);
+  EXPECT_EQ("hello"_sv, hello);
+  EXPECT_EQ("\x01\x02\x03"_su8, bytes);
+  EXPECT_EQ(8u, arena.allocated_bytes());
+  EXPECT_EQ(1u, arena.block_count());
+}
+
+TEST(ArenaTest, Empty) {
+  Arena arena;
+  EXPECT_EQ(""_sv, arena.Add(""_sv));
+  EXPECT_TRUE(arena.Add(SpanU8{}).empty());
+  EXPECT_EQ(0u, arena.block_count());
+}
+
+TEST(ArenaTest, StableAcrossBlocks) {
+  Arena arena{16};
+  std::vector<std::string> strings;
+  std::vector<string_view> views;
+  for (int i = 0; i < 100; ++i) {
+    strings.push_back(std::to_string(i * 1000));
+    views.push_back(arena.Add(strings.back()));
+  }
+  for (size_t i = 0; i < strings.size(); ++i) {
+    EXPECT_EQ(strings[i], views[i]);
+  }
+  EXPECT_LT(1u, arena.block_count());
+}
+
+TEST(ArenaTest, LargeAllocation) {
+  Arena arena{16};
+  auto small1 = arena.Add("abc"_sv);
+  std::string large(100, 'x');
+  auto large_view = arena.Add(large);
+  // The large allocation has its own block, so the current block is still
+  // used for small allocations.
+  auto small2 = arena.Add("def"_sv);
+  EXPECT_EQ(2u, arena.block_count());
+  EXPECT_EQ(small1.data() + 3, small2.data());
+  EXPECT_EQ(large, large_view);
+  EXPECT_EQ("abc"_sv, small1);
+  EXPECT_EQ("def"_sv, small2);
+}
+
+TEST(ArenaTest, Move) {
+  Arena arena;
+  auto hello = arena.Add("hello"_sv);
+  Arena moved{std::move(arena)};
+  EXPECT_EQ("hello"_sv, hello);
+  EXPECT_EQ(1u, moved.block_count());
+  EXPECT_EQ(5u, moved.allocated_bytes());
+  EXPECT_EQ(0u, arena.block_count());
+  EXPECT_EQ(0u, arena.allocated_bytes());
+
+  // The moved-from Arena must not allocate from the moved block.
+  auto world = arena.Add("world"_sv);
+  auto bang = moved.Add("!"_sv);
+  EXPECT_EQ(1u, arena.block_count());
+  EXPECT_EQ(hello.data() + 5, bang.data());
+  EXPECT_EQ("hello"_sv, hello);
+  EXPECT_EQ("world"_sv, world);
+
+  Arena assigned;
+  assigned = std::move(moved);
+  EXPECT_EQ(0u, moved.block_count());
+  EXPECT_EQ(6u, assigned.allocated_bytes());
+  EXPECT_EQ(hello.data() + 6, assigned.Add("?"_sv).data());
+}
@@ -0,0 +1,96 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/base/errors.h"
+#include "wasp/base/errors_context_guard.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace ::wasp;
+
+namespace {
+
+class RecordingErrors : public Errors {
+ public:
+  bool HasError() const override { return false; }
+
+  std::vector<std::string> events;
+
+ protected:
+  void HandlePushContext(Location loc, string_view desc) override {
+    events.push_back("push " + std::string{desc});
+  }
+  void HandlePopContext() override { events.push_back("pop"); }
+  void HandleOnError(Location loc, string_view message) override {
+    events.push_back("error " + std::string{message});
+  }
+};
+
+using Events = std::vector<std::string>;
+
+}  // namespace
+
+TEST(ErrorsTest, ContextGuard_NoError) {
+  RecordingErrors errors;
+  {
+    ErrorsContextGuard outer{errors, {}, "outer"};
+    ErrorsContextGuard inner{errors, {}, "inner"};
+  }
+  EXPECT_EQ((Events{}), errors.events);
+}
+
+TEST(ErrorsTest, ContextGuard_Error) {
+  RecordingErrors errors;
+  {
+    ErrorsContextGuard outer{errors, {}, "outer"};
+    {
+      ErrorsContextGuard inner{errors, {}, "inner"};
+      errors.OnError({}, "1");
+      errors.OnError({}, "2");
+    }
+    errors.OnError({}, "3");
+  }
+  EXPECT_EQ((Events{"push outer", "push inner", "error 1", "error 2", "pop",
+                    "error 3", "pop"}),
+            errors.events);
+}
+
+TEST(ErrorsTest, ContextGuard_PopContext) {
+  RecordingErrors errors;
+  {
+    ErrorsContextGuard outer{errors, {}, "outer"};
+    ErrorsContextGuard first{errors, {}, "first"};
+    first.PopContext();
+    ErrorsContextGuard second{errors, {}, "second"};
+    errors.OnError({}, "1");
+  }
+  EXPECT_EQ((Events{"push outer", "push second", "error 1", "pop", "pop"}),
+            errors.events);
+}
+
+TEST(ErrorsTest, ContextGuard_PushContext) {
+  RecordingErrors errors;
+  {
+    ErrorsContextGuard guard{errors, {}, "guard"};
+    errors.PushContext({}, "explicit");
+    errors.PopContext();
+  }
+  EXPECT_EQ((Events{"push guard", "push explicit", "pop", "pop"}),
+            errors.events);
+}
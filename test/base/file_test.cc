@@ -0,0 +1,68 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/base/file.h"
+
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "wasp/base/output_sink.h"
+
+#if !defined(_WIN32)
+#include <sys/stat.h>
+#endif
+
+using namespace ::wasp;
+
+TEST(FileTest, MapFile_Regular) {
+  std::string filename = ::testing::TempDir() + "file_test.bin";
+  {
+    auto sink = OutputSink::OpenFile(filename);
+    ASSERT_TRUE(sink.has_value());
+    sink->Write("hello"_sv);
+  }
+  auto file = MapFile(filename);
+  ASSERT_TRUE(file.has_value());
+  EXPECT_EQ("hello"_su8, file->data());
+  std::remove(filename.c_str());
+}
+
+TEST(FileTest, MapFile_Missing) {
+  EXPECT_FALSE(MapFile("/nonexistent/dir/file").has_value());
+}
+
+#if !defined(_WIN32)
+TEST(FileTest, MapFile_Fifo) {
+  std::string filename = ::testing::TempDir() + "file_test.fifo";
+  std::remove(filename.c_str());
+  ASSERT_EQ(0, mkfifo(filename.c_str(), 0600));
+
+  // The writer is gone once the data is written, so reopening the FIFO to
+  // read it again would block forever.
+  std::thread writer{[&] {
+    auto sink = OutputSink::OpenFile(filename);
+    ASSERT_TRUE(sink.has_value());
+    sink->Write("fifo data"_sv);
+  }};
+  auto file = MapFile(filename);
+  writer.join();
+  ASSERT_TRUE(file.has_value());
+  EXPECT_EQ("fifo data"_su8, file->data());
+  std::remove(filename.c_str());
+}
+#endif
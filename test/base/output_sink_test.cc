@@ -0,0 +1,133 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "wasp/base/output_sink.h"
+
+#include <cstdio>
+#include <utility>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "wasp/base/file.h"
+
+using namespace ::wasp;
+
+namespace {
+
+Buffer MakeBytes(size_t size) {
+  Buffer buffer(size);
+  for (size_t i = 0; i < size; ++i) {
+    buffer[i] = static_cast<u8>(i * 7);
+  }
+  return buffer;
+}
+
+}  // namespace
+
+TEST(OutputSinkTest, Memory) {
+  OutputSink sink;
+  sink.Write(u8{1});
+  sink.Write("\x02\x03"_su8);
+  sink.Write("ab"_sv);
+  EXPECT_EQ(5u, sink.size());
+  EXPECT_EQ((Buffer{1, 2, 3, 'a', 'b'}), sink.ToBuffer());
+}
+
+TEST(OutputSinkTest, MemoryAcrossChunks) {
+  auto expected = MakeBytes(OutputSink::kChunkSize * 2 + 100);
+  OutputSink sink;
+  // Write a few single bytes, then the rest in bulk, so the bulk write is
+  // split unevenly between the chunks.
+  for (size_t i = 0; i < 3; ++i) {
+    sink.Write(expected[i]);
+  }
+  sink.Write(SpanU8{expected}.subspan(3));
+  EXPECT_EQ(expected.size(), sink.size());
+  EXPECT_EQ(expected, sink.ToBuffer());
+}
+
+TEST(OutputSinkTest, Iterator) {
+  auto expected = MakeBytes(OutputSink::kChunkSize + 1);
+  OutputSink sink;
+  auto out = sink.out();
+  for (auto byte : expected) {
+    *out++ = byte;
+  }
+  out = CopyBytes("xyz"_sv, out);
+  expected.insert(expected.end(), {'x', 'y', 'z'});
+  EXPECT_EQ(expected, sink.ToBuffer());
+}
+
+TEST(OutputSinkTest, WriteSink) {
+  auto expected = MakeBytes(OutputSink::kChunkSize + 10);
+  OutputSink part;
+  part.Write(expected);
+
+  OutputSink sink;
+  sink.Write("a"_sv);
+  sink.Write(part);
+  expected.insert(expected.begin(), 'a');
+  EXPECT_EQ(expected, sink.ToBuffer());
+}
+
+TEST(OutputSinkTest, Counting) {
+  auto sink = OutputSink::Counting();
+  for (int i = 0; i < 1000; ++i) {
+    sink.Write(u8{0});
+  }
+  sink.Write(MakeBytes(OutputSink::kChunkSize * 3));
+  EXPECT_EQ(1000u + OutputSink::kChunkSize * 3, sink.size());
+  EXPECT_TRUE(sink.Flush());
+
+  auto moved = std::move(sink);
+  moved.Write("abc"_sv);
+  moved.Write(u8{0});
+  EXPECT_EQ(1004u + OutputSink::kChunkSize * 3, moved.size());
+}
+
+TEST(OutputSinkTest, File) {
+  std::string filename = ::testing::TempDir() + "output_sink_test.bin";
+  auto expected = MakeBytes(OutputSink::kChunkSize * 3 + 5);
+  {
+    auto sink = OutputSink::OpenFile(filename);
+    ASSERT_TRUE(sink.has_value());
+    // Small writes go through the chunk, large ones are written directly.
+    sink->Write(SpanU8{expected}.subspan(0, 10));
+    sink->Write(SpanU8{expected}.subspan(10, OutputSink::kChunkSize * 2));
+    auto rest = SpanU8{expected}.subspan(10 + OutputSink::kChunkSize * 2);
+    for (auto byte : rest) {
+      sink->Write(byte);
+    }
+    EXPECT_EQ(expected.size(), sink->size());
+    EXPECT_TRUE(sink->Flush());
+  }
+  EXPECT_EQ(expected, ReadFile(filename));
+  std::remove(filename.c_str());
+}
+
+TEST(OutputSinkTest, FileFlushedOnDestruction) {
+  std::string filename = ::testing::TempDir() + "output_sink_test.bin";
+  {
+    auto sink = OutputSink::OpenFile(filename);
+    ASSERT_TRUE(sink.has_value());
+    sink->Write("hello"_sv);
+  }
+  EXPECT_EQ((Buffer{'h', 'e', 'l', 'l', 'o'}), ReadFile(filename));
+  std::remove(filename.c_str());
+}
+
+TEST(OutputSinkTest, OpenFileFails) {
+  EXPECT_FALSE(OutputSink::OpenFile("/nonexistent/dir/file").has_value());
+}
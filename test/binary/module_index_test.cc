@@ -0,0 +1,196 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/module_index.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "test/binary/constants.h"
+#include "test/test_utils.h"
+#include "wasp/binary/formatters.h"
+#include "wasp/binary/read/read_ctx.h"
+
+using namespace ::wasp;
+using namespace ::wasp::binary;
+using namespace ::wasp::binary::test;
+using namespace ::wasp::test;
+
+namespace {
+
+SpanU8 GetModuleData() {
+  return "\0asm\x01\0\0\0"
+         "\x01\x04\x01\x60\0\0"          // 1 type: params:[] results:[]
+         "\x02\x0b\x01\0\x06import\0\0"  // 1 import: func mod:"" name:"import"
+         "\x03\x03\x02\0\0"              // 2 funcs: type 0, type 0
+         "\x07\x0a\x01\x06"
+         "export\0\x01"  // 1 export: func 1 name:"export"
+         "\x0a\x09\x02"
+         "\x02\0\x0b"          // code 1: empty
+         "\x04\x01\x01\x7f\x0b"  // code 2: 1 i32 local
+         "\0\x10\x04name"      // "name" section
+         "\x01\x09\x01\x02\x06"
+         "custom"_su8;  // func 2, name "custom"
+}
+
+void ExpectIndex(const ModuleIndex& index) {
+  EXPECT_EQ(6u, index.sections.size());
+  EXPECT_EQ(SectionId::Custom, index.sections[5].id);
+  EXPECT_EQ(1u, index.GetImportCount(ExternalKind::Function));
+  EXPECT_EQ(0u, index.GetImportCount(ExternalKind::Global));
+  EXPECT_EQ(3u, index.GetFunctionCount());
+  EXPECT_EQ(0u, index.GetFunctionTypeIndex(2));
+  EXPECT_EQ(nullopt, index.GetFunctionTypeIndex(3));
+  EXPECT_EQ(2u, index.codes.size());
+
+  EXPECT_EQ(0u, index.FindFunction("import"));
+  EXPECT_EQ(1u, index.FindFunction("export"));
+  EXPECT_EQ(2u, index.FindFunction("custom"));
+  EXPECT_EQ(nullopt, index.FindFunction("missing"));
+
+  ASSERT_TRUE(index.GetSection(SectionId::Type).has_value());
+  EXPECT_EQ("\x01\x60\0\0"_su8, *index.GetSection(SectionId::Type));
+  EXPECT_FALSE(index.GetSection(SectionId::Start).has_value());
+}
+
+}  // namespace
+
+TEST(BinaryModuleIndexTest, Build) {
+  Features features;
+  TestErrors errors;
+  auto module = ReadLazyModule(GetModuleData(), features, errors);
+  auto index = BuildModuleIndex(module);
+  ExpectIndex(index);
+  ExpectNoErrors(errors);
+}
+
+TEST(BinaryModuleIndexTest, Build_DoesNotChangeModule) {
+  Features features;
+  TestErrors errors;
+  auto module = ReadLazyModule(GetModuleData(), features, errors);
+  BuildModuleIndex(module);
+  EXPECT_EQ(nullopt, module.ctx.last_section_id);
+  EXPECT_EQ(0u, module.ctx.defined_function_count);
+
+  // The module can still be read from the start.
+  size_t count = 0;
+  for (auto section : module.sections) {
+    (void)section;
+    ++count;
+  }
+  EXPECT_EQ(6u, count);
+  ExpectNoErrors(errors);
+}
+
+TEST(BinaryModuleIndexTest, GetCode) {
+  Features features;
+  TestErrors errors;
+  auto module = ReadLazyModule(GetModuleData(), features, errors);
+  auto index = BuildModuleIndex(module);
+  ReadCtx ctx{features, errors};
+
+  // Imported functions have no code.
+  EXPECT_FALSE(index.GetCode(0, ctx).has_value());
+
+  auto code = index.GetCode(1, ctx);
+  ASSERT_TRUE(code.has_value());
+  EXPECT_EQ(0u, code->value().locals.size());
+  EXPECT_EQ("\x0b"_su8, code->value().body->data);
+
+  code = index.GetCode(2, ctx);
+  ASSERT_TRUE(code.has_value());
+  EXPECT_EQ((LocalsList{At{
+                "\x01\x7f"_su8,
+                Locals{At{"\x01"_su8, Index{1}}, At{"\x7f"_su8, VT_I32}}}}),
+            code->value().locals);
+
+  EXPECT_FALSE(index.GetCode(3, ctx).has_value());
+  ExpectNoErrors(errors);
+}
+
+TEST(BinaryModuleIndexTest, WriteRead) {
+  Features features;
+  TestErrors errors;
+  auto module = ReadLazyModule(GetModuleData(), features, errors);
+  Buffer buffer;
+  WriteModuleIndex(BuildModuleIndex(module), buffer);
+
+  auto index = ReadModuleIndex(buffer, GetModuleData());
+  ASSERT_TRUE(index.has_value());
+  ExpectIndex(*index);
+  ExpectNoErrors(errors);
+}
+
+TEST(BinaryModuleIndexTest, Read_ModifiedModule) {
+  Features features;
+  TestErrors errors;
+  auto module = ReadLazyModule(GetModuleData(), features, errors);
+  Buffer buffer;
+  WriteModuleIndex(BuildModuleIndex(module), buffer);
+
+  std::vector<u8> modified(GetModuleData().begin(), GetModuleData().end());
+  modified.back() = 'X';
+  EXPECT_FALSE(ReadModuleIndex(buffer, modified).has_value());
+  EXPECT_FALSE(ReadModuleIndex(buffer, GetModuleData().first(20)).has_value());
+}
+
+TEST(BinaryModuleIndexTest, Read_LargeModule) {
+  // Add a large custom section, so most of the module is hashed a word at a
+  // time.
+  std::vector<u8> data(GetModuleData().begin(), GetModuleData().end());
+  const u32 size = 100000;
+  data.insert(data.end(), {0, 0xa0, 0x8d, 0x06, 1, 'x'});  // length 100000
+  data.insert(data.end(), size - 2, 0);
+
+  Features features;
+  TestErrors errors;
+  auto module = ReadLazyModule(data, features, errors);
+  Buffer buffer;
+  WriteModuleIndex(BuildModuleIndex(module), buffer);
+  ExpectNoErrors(errors);
+
+  auto index = ReadModuleIndex(buffer, data);
+  ASSERT_TRUE(index.has_value());
+  EXPECT_EQ(7u, index->sections.size());
+  EXPECT_EQ(size - 2, index->sections[6].data.size());
+
+  auto modified = data;
+  modified.back() = 1;
+  EXPECT_FALSE(ReadModuleIndex(buffer, modified).has_value());
+  modified = data;
+  modified[9] = 0x05;
+  EXPECT_FALSE(ReadModuleIndex(buffer, modified).has_value());
+
+  // Every byte is hashed, not just samples of the module.
+  for (size_t i = data.size() / 2; i < data.size() / 2 + 64; ++i) {
+    modified = data;
+    modified[i] = 1;
+    EXPECT_FALSE(ReadModuleIndex(buffer, modified).has_value()) << i;
+  }
+}
+
+TEST(BinaryModuleIndexTest, Read_Truncated) {
+  Features features;
+  TestErrors errors;
+  auto module = ReadLazyModule(GetModuleData(), features, errors);
+  Buffer buffer;
+  WriteModuleIndex(BuildModuleIndex(module), buffer);
+
+  for (size_t size = 0; size < buffer.size(); ++size) {
+    EXPECT_FALSE(ReadModuleIndex(SpanU8{buffer}.first(size), GetModuleData())
+                     .has_value());
+  }
+}
@@ -0,0 +1,157 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/packed_expression.h"
+
+#include "gtest/gtest.h"
+#include "test/binary/constants.h"
+#include "test/test_utils.h"
+#include "wasp/binary/formatters.h"
+#include "wasp/binary/lazy_expression.h"
+#include "wasp/binary/read/read_ctx.h"
+
+using namespace ::wasp;
+using namespace ::wasp::binary;
+using namespace ::wasp::binary::test;
+using namespace ::wasp::test;
+
+using I = Instruction;
+using O = Opcode;
+
+TEST(BinaryPackedExpressionTest, RoundTrip) {
+  InstructionList instructions = {
+      I{O::Nop},
+      I{O::I32Const, s32{-1}},
+      I{O::I64Const, s64{0x123456789abcdefll}},
+      I{O::F32Const, f32{1.5f}},
+      I{O::F64Const, f64{-2.25}},
+      I{O::V128Const, At{v128{u64{1}, u64{2}}}},
+      I{O::LocalGet, Index{7}},
+      I{O::Block, At{BlockType{At{VoidType{}}}}},
+      I{O::Loop, At{BlockType{At{ValueType::I32_NoLocation()}}}},
+      I{O::If, At{BlockType{At{ValueType::Funcref_NoLocation()}}}},
+      // These are stored unpacked, so keep their locations.
+      I{O::Block, At{BT_RefNullFunc}},
+      I{O::Block, At{BT_Ref0}},
+      I{O::Block, At{BlockType{At{Index{3}}}}},
+      I{O::BrTable, At{BrTableImmediate{{At{Index{1}}, At{Index{2}}},
+                                        At{Index{3}}}}},
+      I{O::BrTable, At{BrTableImmediate{{}, At{Index{4}}}}},
+      I{O::CallIndirect,
+        At{CallIndirectImmediate{At{Index{1}}, At{Index{2}}}}},
+      I{O::MemoryCopy, At{CopyImmediate{At{Index{3}}, At{Index{4}}}}},
+      I{O::MemoryInit, At{InitImmediate{At{Index{5}}, At{Index{6}}}}},
+      I{O::I32Load, At{MemArgImmediate{At{u32{2}}, At{u32{100}}}}},
+      I{O::RefNull, At{HeapType{At{HeapKind::Extern}}}},
+      I{O::RefNull, At{HeapType{At{Index{1}}}}},
+      I{O::SelectT, At{SelectImmediate{At{VT_I32}, At{VT_RefNullAny}}}},
+      I{O::I8X16Shuffle,
+        At{ShuffleImmediate{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+                            15}}},
+      I{O::I8X16ExtractLaneS, SimdLaneImmediate{5}},
+      I{O::V128Load8Lane,
+        At{SimdMemoryLaneImmediate{
+            MemArgImmediate{At{u32{0}}, At{u32{8}}}, At{u8{15}}}}},
+      I{O::FuncBind, At{FuncBindImmediate{At{Index{9}}}}},
+      I{O::StructGet, At{StructFieldImmediate{At{Index{1}}, At{Index{2}}}}},
+      I{O::Let, At{LetImmediate{At{BT_Void}, {}}}},
+      I{O::RefTest, At{HeapType2Immediate{At{HT_Any}, At{HT_Eq}}}},
+      I{O::End},
+  };
+
+  PackedExpression packed{instructions};
+  ASSERT_EQ(instructions.size(), packed.size());
+  for (size_t i = 0; i < instructions.size(); ++i) {
+    EXPECT_EQ(instructions[i], packed[i]);
+    EXPECT_EQ(*instructions[i]->opcode, packed.opcode(i));
+  }
+}
+
+TEST(BinaryPackedExpressionTest, ReadPackedExpression) {
+  TestErrors errors;
+  ReadCtx ctx{errors};
+  auto data = "\x20\x00\x41\x7f\x6a\x0b"_su8;
+  auto packed = ReadPackedExpression(data, ctx);
+  ExpectNoErrors(errors);
+
+  ASSERT_EQ(4u, packed.size());
+  EXPECT_EQ(data.subspan(0, 2), packed.loc(0));
+  EXPECT_EQ(data.subspan(2, 2), packed.loc(1));
+  EXPECT_EQ(data.subspan(4, 1), packed.loc(2));
+  EXPECT_EQ(data.subspan(5, 1), packed.loc(3));
+
+  EXPECT_EQ(O::LocalGet, *packed[0]->opcode);
+  EXPECT_EQ(Index{0}, packed[0]->index_immediate());
+  EXPECT_EQ(data.subspan(0, 2), packed[0].loc());
+  EXPECT_EQ(O::I32Const, *packed[1]->opcode);
+  EXPECT_EQ(s32{-1}, packed[1]->s32_immediate());
+  EXPECT_EQ(O::I32Add, *packed[2]->opcode);
+  EXPECT_EQ(O::End, *packed[3]->opcode);
+}
+
+TEST(BinaryPackedExpressionTest, ReadPackedExpression_MatchesReadExpression) {
+  TestErrors errors;
+  ReadCtx ctx{errors};
+  ctx.features.enable_bulk_memory();
+  ctx.declared_data_count = 1;
+  auto data =
+      "\x02\x7f"                  // block (result i32)
+      "\x41\x00"                  // i32.const 0
+      "\x0e\x02\x00\x00\x00"      // br_table 0 0 0
+      "\x0b"                      // end
+      "\x41\x00\x41\x00\x41\x00"  // i32.const 0 (x3)
+      "\xfc\x08\x00\x00"          // memory.init 0
+      "\xfc\x09\x00"              // data.drop 0
+      "\x1a"                      // drop
+      "\x0b"_su8;                 // end
+  auto packed = ReadPackedExpression(data, ctx);
+  ExpectNoErrors(errors);
+
+  // Pack the same instructions after decoding them as Instructions; the
+  // results should be identical, including locations.
+  PackedExpression expected{data};
+  for (auto&& instruction : ReadExpression(data, ctx)) {
+    expected.push_back(instruction);
+  }
+  ExpectNoErrors(errors);
+
+  ASSERT_EQ(expected.size(), packed.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(expected[i], packed[i]);
+    EXPECT_EQ(expected.loc(i), packed.loc(i));
+    EXPECT_NE(Location{}, packed.loc(i));
+  }
+}
+
+TEST(BinaryPackedExpressionTest, ReadPackedExpression_Error) {
+  TestErrors errors;
+  ReadCtx ctx{errors};
+  ctx.features.enable_bulk_memory();
+  // data.drop without a data count section.
+  auto data = "\x01\xfc\x09\x00\x0b"_su8;
+  auto packed = ReadPackedExpression(data, ctx);
+  ASSERT_EQ(1u, packed.size());
+  EXPECT_EQ(O::Nop, packed.opcode(0));
+  EXPECT_TRUE(errors.HasError());
+}
+
+TEST(BinaryPackedExpressionTest, NoLocationForDisjointInstructions) {
+  auto data = "\x01\x01"_su8;
+  PackedExpression packed{data};
+  packed.push_back(At{data.subspan(1, 1), I{At{O::Nop}}});
+  EXPECT_EQ(Location{}, packed.loc(0));
+  EXPECT_EQ(I{O::Nop}, *packed[0]);
+}
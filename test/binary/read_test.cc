@@ -3828,6 +3828,24 @@ TEST_F(BinaryReadTest, U32_PastEnd) {
        "\xf0\xf0\xf0\xf0"_su8);
 }
 
+TEST_F(BinaryReadTest, U32_FollowedByOtherData) {
+  // With at least 5 bytes remaining, the value is decoded without checking
+  // for the end of the data.
+  auto data = "\xc0\x03\x01\x02\x03\x04"_su8;
+  auto copy = data;
+  auto actual = Read<u32>(&copy, ctx);
+  ExpectNoErrors(errors);
+  ASSERT_TRUE(actual.has_value());
+  EXPECT_EQ(448u, **actual);
+  EXPECT_EQ(data.first(2), actual->loc());
+  EXPECT_EQ(data.subspan(2), copy);
+
+  Fail(Read<u32>,
+       {{0, "u32"},
+        {4, "Last byte of u32 must be zero extension: expected 0x2, got 0x12"}},
+       "\xf0\xf0\xf0\xf0\x12\x00"_su8);
+}
+
 TEST_F(BinaryReadTest, U8) {
   OK(Read<u8>, 32, "\x20"_su8);
   Fail(Read<u8>, {{0, "Unable to read u8"}}, ""_su8);
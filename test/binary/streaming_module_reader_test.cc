@@ -0,0 +1,250 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/streaming_module_reader.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "test/test_utils.h"
+#include "wasp/base/concat.h"
+#include "wasp/base/features.h"
+#include "wasp/binary/formatters.h"
+#include "wasp/binary/lazy_module.h"
+
+using namespace ::wasp;
+using namespace ::wasp::binary;
+using namespace ::wasp::test;
+
+using visit::Result;
+
+namespace {
+
+// The same module as in visitor_test.cc:
+//
+// (module
+//   (type (;0;) (func (param i32) (result i32)))
+//   (type (;1;) (func (param f32) (result f32)))
+//   (type (;2;) (func))
+//   (import "foo" "bar" (func (;0;) (type 0)))
+//   (func (;1;) (type 1) (param f32) (result f32)
+//     (f32.const 0x1.5p+5 (;=42;)))
+//   (func (;2;) (type 2))
+//   (table (;0;) 1 2 funcref)
+//   (memory (;0;) 1)
+//   (global (;0;) i32 (i32.const 1))
+//   (export "quux" (func 1))
+//   (start 2)
+//   (elem (;0;) (i32.const 0) 0 1)
+//   (data (;0;) (i32.const 2) "hello"))
+const u8 kTestModule[] = {
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x0e, 0x03, 0x60,
+    0x01, 0x7f, 0x01, 0x7f, 0x60, 0x01, 0x7d, 0x01, 0x7d, 0x60, 0x00, 0x00,
+    0x02, 0x0b, 0x01, 0x03, 0x66, 0x6f, 0x6f, 0x03, 0x62, 0x61, 0x72, 0x00,
+    0x00, 0x03, 0x03, 0x02, 0x01, 0x02, 0x04, 0x05, 0x01, 0x70, 0x01, 0x01,
+    0x02, 0x05, 0x03, 0x01, 0x00, 0x01, 0x06, 0x06, 0x01, 0x7f, 0x00, 0x41,
+    0x01, 0x0b, 0x07, 0x08, 0x01, 0x04, 0x71, 0x75, 0x75, 0x78, 0x00, 0x01,
+    0x08, 0x01, 0x02, 0x09, 0x08, 0x01, 0x00, 0x41, 0x00, 0x0b, 0x02, 0x00,
+    0x01, 0x0a, 0x0c, 0x02, 0x07, 0x00, 0x43, 0x00, 0x00, 0x28, 0x42, 0x0b,
+    0x02, 0x00, 0x0b, 0x0b, 0x0b, 0x01, 0x00, 0x41, 0x02, 0x0b, 0x05, 0x68,
+    0x65, 0x6c, 0x6c, 0x6f,
+};
+
+// Offsets of the first function body (after its size), the end of that body,
+// and the end of the code section.
+const size_t kFirstBodyOffset = 89;
+const size_t kFirstBodyEnd = 96;
+const size_t kCodeSectionEnd = 99;
+
+// Records the visitor calls, so streaming can be compared with visit::Visit.
+struct RecordingVisitor : visit::Visitor {
+  Result OnSection(At<Section> section) {
+    Record(concat("section ", section->id()));
+    return Result::Ok;
+  }
+  Result OnType(const At<DefinedType>& x) { return Record(concat(x)); }
+  Result OnImport(const At<Import>& x) { return Record(concat(x)); }
+  Result OnFunction(const At<Function>& x) { return Record(concat(x)); }
+  Result OnTable(const At<Table>& x) { return Record(concat(x)); }
+  Result OnMemory(const At<Memory>& x) { return Record(concat(x)); }
+  Result OnGlobal(const At<Global>& x) { return Record(concat(x)); }
+  Result OnExport(const At<Export>& x) { return Record(concat(x)); }
+  Result OnStart(const At<Start>& x) { return Record(concat(x)); }
+  Result OnElement(const At<ElementSegment>& x) { return Record(concat(x)); }
+  Result BeginCodeSection(LazyCodeSection sec) {
+    return Record(concat("begin code section ", sec.count));
+  }
+  Result BeginCode(const At<Code>& x) { return Record(concat(x)); }
+  Result OnInstruction(const At<Instruction>& x) { return Record(concat(x)); }
+  Result EndCode(const At<Code>&) { return Record("end code"); }
+  Result EndCodeSection(LazyCodeSection) {
+    return Record("end code section");
+  }
+  Result OnData(const At<DataSegment>& x) { return Record(concat(x)); }
+
+  Result Record(std::string s) {
+    calls.push_back(std::move(s));
+    return Result::Ok;
+  }
+
+  std::vector<std::string> calls;
+};
+
+std::vector<std::string> VisitAll(SpanU8 data) {
+  Features features;
+  TestErrors errors;
+  RecordingVisitor visitor;
+  LazyModule module = ReadLazyModule(data, features, errors);
+  EXPECT_EQ(Result::Ok, visit::Visit(module, visitor));
+  ExpectNoErrors(errors);
+  return visitor.calls;
+}
+
+}  // namespace
+
+TEST(BinaryStreamingModuleReaderTest, MatchesVisit) {
+  SpanU8 data{kTestModule};
+  auto expected = VisitAll(data);
+
+  for (size_t chunk_size : {1, 2, 3, 5, 8, 13, 64, 1000}) {
+    Features features;
+    TestErrors errors;
+    RecordingVisitor visitor;
+    StreamingModuleReader<RecordingVisitor> reader{features, errors, visitor};
+    for (size_t i = 0; i < data.size(); i += chunk_size) {
+      EXPECT_EQ(Result::Ok, reader.Feed(data.subspan(i, chunk_size)));
+    }
+    EXPECT_EQ(Result::Ok, reader.Finish());
+    ExpectNoErrors(errors);
+    EXPECT_EQ(expected, visitor.calls) << "chunk size " << chunk_size;
+    EXPECT_EQ(data.size(), reader.size());
+  }
+}
+
+TEST(BinaryStreamingModuleReaderTest, VisitsBodiesAsTheyArrive) {
+  SpanU8 data{kTestModule};
+  Features features;
+  TestErrors errors;
+  RecordingVisitor visitor;
+  StreamingModuleReader<RecordingVisitor> reader{features, errors, visitor};
+
+  // Everything up to the end of the first function body.
+  EXPECT_EQ(Result::Ok, reader.Feed(data.first(kFirstBodyEnd)));
+  ASSERT_FALSE(visitor.calls.empty());
+  EXPECT_EQ("end code", visitor.calls.back());
+
+  EXPECT_EQ(Result::Ok, reader.Feed(data.subspan(kFirstBodyEnd)));
+  EXPECT_EQ(Result::Ok, reader.Finish());
+  ExpectNoErrors(errors);
+}
+
+TEST(BinaryStreamingModuleReaderTest, ReportsErrorEarly) {
+  std::vector<u8> bytes(std::begin(kTestModule), std::end(kTestModule));
+  // Replace the first body's `f32.const` with an invalid opcode.
+  bytes[kFirstBodyOffset + 1] = 0xff;
+  SpanU8 data{bytes};
+
+  Features features;
+  TestErrors errors;
+  RecordingVisitor visitor;
+  StreamingModuleReader<RecordingVisitor> reader{features, errors, visitor};
+  EXPECT_EQ(Result::Fail, reader.Feed(data.first(kCodeSectionEnd)));
+  ASSERT_FALSE(errors.errors.empty());
+  EXPECT_EQ(kFirstBodyOffset + 1,
+            reader.offset(errors.errors[0].back().loc.data()));
+
+  // Nothing more is read after the first error.
+  auto calls = visitor.calls.size();
+  EXPECT_EQ(Result::Fail, reader.Feed(data.subspan(kCodeSectionEnd)));
+  EXPECT_EQ(Result::Fail, reader.Finish());
+  EXPECT_EQ(calls, visitor.calls.size());
+}
+
+TEST(BinaryStreamingModuleReaderTest, Truncated) {
+  SpanU8 data{kTestModule};
+  for (size_t size : {size_t{0}, size_t{4}, size_t{9}, kFirstBodyOffset,
+                      kCodeSectionEnd - 1, data.size() - 1}) {
+    Features features;
+    TestErrors errors;
+    RecordingVisitor visitor;
+    StreamingModuleReader<RecordingVisitor> reader{features, errors, visitor};
+    EXPECT_EQ(Result::Ok, reader.Feed(data.first(size)));
+    EXPECT_EQ(Result::Fail, reader.Finish()) << "size " << size;
+    EXPECT_TRUE(errors.HasError()) << "size " << size;
+  }
+}
+
+TEST(BinaryStreamingModuleReaderTest, CodeCountMismatch) {
+  // (module (func)), with a function section declaring two functions.
+  auto data =
+      "\0asm\x01\0\0\0"
+      "\x01\x04\x01\x60\0\0"
+      "\x03\x03\x02\0\0"
+      "\x0a\x04\x01\x02\0\x0b"_su8;
+  Features features;
+  TestErrors errors;
+  RecordingVisitor visitor;
+  StreamingModuleReader<RecordingVisitor> reader{features, errors, visitor};
+  EXPECT_EQ(Result::Ok, reader.Feed(data));
+  EXPECT_EQ(Result::Fail, reader.Finish());
+  EXPECT_TRUE(errors.HasError());
+}
+
+TEST(BinaryStreamingModuleReaderTest, HugeSectionLength) {
+  // A custom section that claims to be almost 4GiB long, but is truncated.
+  auto data = "\0asm\x01\0\0\0\x00\xfe\xff\xff\xff\x0f\x01x"_su8;
+  Features features;
+  TestErrors errors;
+  RecordingVisitor visitor;
+  StreamingModuleReader<RecordingVisitor> reader{features, errors, visitor};
+  EXPECT_EQ(Result::Ok, reader.Feed(data));
+  EXPECT_EQ(Result::Fail, reader.Finish());
+  EXPECT_TRUE(errors.HasError());
+}
+
+namespace {
+
+struct CodeSectionVisitor : visit::Visitor {
+  Result OnSection(At<Section> section) {
+    if (section->is_known() && section->known()->id == SectionId::Code) {
+      code_section_contents = section->known()->data;
+    }
+    return Result::Ok;
+  }
+
+  SpanU8 code_section_contents;
+};
+
+}  // namespace
+
+TEST(BinaryStreamingModuleReaderTest, CodeSectionContainsOnlyCount) {
+  SpanU8 data{kTestModule};
+  Features features;
+  TestErrors errors;
+  CodeSectionVisitor visitor;
+  StreamingModuleReader<CodeSectionVisitor> reader{features, errors, visitor};
+
+  // Everything up to the start of the first function body.
+  EXPECT_EQ(Result::Ok, reader.Feed(data.first(kFirstBodyOffset)));
+  // The code section only contains its count; the bodies haven't arrived.
+  EXPECT_EQ(1u, visitor.code_section_contents.size());
+  EXPECT_EQ(2u, visitor.code_section_contents[0]);
+
+  EXPECT_EQ(Result::Ok, reader.Feed(data.subspan(kFirstBodyOffset)));
+  EXPECT_EQ(Result::Ok, reader.Finish());
+  ExpectNoErrors(errors);
+}
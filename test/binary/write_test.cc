@@ -24,6 +24,7 @@
 #include "test/binary/test_utils.h"
 #include "test/write_test_utils.h"
 #include "wasp/base/buffer.h"
+#include "wasp/base/output_sink.h"
 #include "wasp/binary/name_section/write.h"
 #include "wasp/binary/write.h"
 
@@ -2167,3 +2168,81 @@ TEST(BinaryWriteTest, WriteVector_u32) {
   EXPECT_EQ(iter.base(), output.end());
   EXPECT_EQ(expected, SpanU8{output});
 }
+
+namespace {
+
+// A module with a code section longer than 127 bytes, and a function body
+// longer than 127 bytes, so their lengths need more than one byte.
+Module MakeModuleWithLongCode() {
+  Module module;
+  module.types.push_back(DefinedType{FunctionType{}});
+  module.functions.push_back(Function{Index{0}});
+  module.functions.push_back(Function{Index{0}});
+  module.codes.push_back(UnpackedCode{{}, {}});
+  module.codes.push_back(UnpackedCode{{}, {}});
+  for (int i = 0; i < 100; ++i) {
+    module.codes[0]->body.instructions.push_back(Instruction{Opcode::Nop});
+    module.codes[1]->body.instructions.push_back(Instruction{Opcode::Nop});
+  }
+  for (auto& code : module.codes) {
+    code->body.instructions.push_back(Instruction{Opcode::End});
+  }
+  module.exports.push_back(Export{ExternalKind::Function, "f"_sv, Index{0}});
+  return module;
+}
+
+}  // namespace
+
+TEST(BinaryWriteTest, WriteModule_Minimal) {
+  for (const auto& module : {Module{}, MakeModuleWithLongCode()}) {
+    Buffer expected;
+    Write(module, std::back_inserter(expected));
+
+    Buffer actual;
+    WriteModule(module, actual, LengthEncoding::Minimal);
+    EXPECT_EQ(SpanU8{expected}, SpanU8{actual});
+  }
+}
+
+TEST(BinaryWriteTest, Write_OutputSink) {
+  auto module = MakeModuleWithLongCode();
+  module.codes[0]->locals.push_back(Locals{2, VT_I32});
+  module.codes[0]->locals.push_back(Locals{128, VT_I64});
+
+  Buffer expected;
+  Write(module, std::back_inserter(expected));
+
+  OutputSink sink;
+  Write(module, sink.out());
+  EXPECT_EQ(SpanU8{expected}, SpanU8{sink.ToBuffer()});
+}
+
+TEST(BinaryWriteTest, WriteModule_Fixed) {
+  Module module;
+  module.functions.push_back(Function{Index{3}});
+  Buffer actual;
+  WriteModule(module, actual, LengthEncoding::Fixed);
+  EXPECT_EQ(
+      "\x00\x61\x73\x6d\x01\x00\x00\x00"  // magic/version
+      "\x03"                              // function section
+      "\x82\x80\x80\x80\x00"              // section length
+      "\x01"                              // function count
+      "\x03"_su8,                         // type index
+      SpanU8{actual});
+}
+
+TEST(BinaryWriteTest, LengthPatcher_Nested) {
+  Buffer buffer{0xff};
+  LengthPatcher patcher{buffer, LengthEncoding::Minimal};
+  patcher.Begin();
+  buffer.push_back(1);
+  patcher.Begin();
+  buffer.insert(buffer.end(), 200, 2);
+  patcher.End();
+  patcher.End();
+  patcher.Finish();
+
+  Buffer expected{0xff, 0xcb, 0x01, 1, 0xc8, 0x01};
+  expected.insert(expected.end(), 200, 2);
+  EXPECT_EQ(SpanU8{expected}, SpanU8{buffer});
+}
@@ -17,6 +17,7 @@
 #include "wasp/text/read/lex.h"
 
 #include <algorithm>
+#include <string>
 #include <vector>
 
 #include "gtest/gtest.h"
@@ -65,6 +66,10 @@ struct ExpectedToken {
 
 using TT = TokenType;
 
+SpanU8 ToSpanU8(const std::string& s) {
+  return SpanU8{reinterpret_cast<const u8*>(s.data()), s.size()};
+}
+
 SpanU8 ExpectLex(ExpectedToken et, SpanU8 data) {
   Token expected{Location{data.begin(), et.size}, et.type, et.immediate};
   auto actual = Lex(&data);
@@ -1076,6 +1081,66 @@ TEST(LexTest, Text) {
   }
 }
 
+// The lexer scans long runs a vector at a time, so check runs that end at
+// every offset within and across vectors.
+TEST(LexTest, LongRuns) {
+  for (size_t size = 0; size < 100; ++size) {
+    std::string run(size, 'a');
+
+    std::string ws;
+    for (size_t i = 0; i < size + 1; ++i) {
+      ws += " \t\r\n"[i % 4];
+    }
+    ExpectLex({ws.size(), TT::Whitespace}, ToSpanU8(ws + "x"));
+
+    std::string line = ";;" + run + "\n";
+    ExpectLex({line.size(), TT::LineComment}, ToSpanU8(line + "x"));
+    ExpectLex({line.size() - 1, TT::InvalidLineComment},
+              ToSpanU8(";;" + run));
+
+    std::string block = "(;" + run + ";)";
+    ExpectLex({block.size(), TT::BlockComment}, ToSpanU8(block + "x"));
+
+    std::string text = "\"" + run + "\"";
+    ExpectLex({text.size(), TT::Text, Text{text, static_cast<u32>(size)}},
+              ToSpanU8(text + "x"));
+
+    std::string id = "$a" + run;
+    ExpectLex({id.size(), TT::Id}, ToSpanU8(id + ")"));
+  }
+}
+
+// Checks that every character ends (or continues) a long run the same way as
+// it does a short one.
+TEST(LexTest, LongRuns_AllChars) {
+  const std::string before(40, 'a');
+  const std::string after(30, 'b');
+  for (int i = 0; i < 256; ++i) {
+    char c = static_cast<char>(i);
+    bool is_whitespace = c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    bool is_reserved = i >= '!' && i <= '~' &&
+                       string_view{"\"(),;[]{}"}.find(c) == string_view::npos;
+
+    std::string ws = std::string(40, ' ') + c + after;
+    ExpectLex({is_whitespace ? 41u : 40u, TT::Whitespace}, ToSpanU8(ws));
+
+    std::string id = "$" + before + c + after;
+    ExpectLex({is_reserved ? id.size() : 41u, TT::Id}, ToSpanU8(id));
+
+    std::string line = ";;" + before + c + after + "\n";
+    ExpectLex({c == '\n' ? 43u : line.size(), TT::LineComment},
+              ToSpanU8(line));
+
+    std::string block = "(;" + before + c + after + ";)";
+    ExpectLex({block.size(), TT::BlockComment}, ToSpanU8(block));
+
+    if (c != '"' && c != '\\' && c != '\n') {
+      std::string text = "\"" + before + c + after + "\"";
+      ExpectLex({text.size(), TT::Text, Text{text, 71}}, ToSpanU8(text));
+    }
+  }
+}
+
 TEST(LexTest, NumericType) {
   struct {
     SpanU8 span;
@@ -16,6 +16,9 @@
 
 #include "wasp/text/read/name_map.h"
 
+#include <string>
+#include <vector>
+
 #include "gtest/gtest.h"
 
 using namespace ::wasp;
@@ -26,6 +29,15 @@ void ExpectGet(NameMap& map, string_view name, Index expected) {
   EXPECT_EQ(map.Get(name), expected);
 }
 
+// Returns `count` distinct names, enough to make a NameMap build its index.
+std::vector<std::string> MakeNames(size_t count) {
+  std::vector<std::string> names;
+  for (size_t i = 0; i < count; ++i) {
+    names.push_back("$n" + std::to_string(i));
+  }
+  return names;
+}
+
 TEST(TextNameMapTest, Basic) {
   NameMap map;
   map.NewUnbound();       // 0
@@ -128,3 +140,151 @@ TEST(TextNameMapTest, LetBindings) {
   ExpectGet(map, "$a"_sv, 0);
   ExpectGet(map, "$c"_sv, 2);
 }
+
+TEST(TextNameMapTest, PopRestoresShadowedName) {
+  NameMap map;
+  map.NewBound("$a"_sv);
+  map.NewBound("$b"_sv);
+  map.Push();
+  map.NewBound("$b"_sv);
+  EXPECT_TRUE(map.HasSinceLastPush("$b"_sv));
+  EXPECT_FALSE(map.HasSinceLastPush("$a"_sv));
+  ExpectGet(map, "$b"_sv, 0);
+
+  map.Pop();
+  EXPECT_TRUE(map.HasSinceLastPush("$b"_sv));
+  ExpectGet(map, "$a"_sv, 0);
+  ExpectGet(map, "$b"_sv, 1);
+}
+
+TEST(TextNameMapTest, PopUnbindsName) {
+  NameMap map;
+  map.Push();
+  map.NewBound("$a"_sv);
+  map.Pop();
+  EXPECT_FALSE(map.Has("$a"_sv));
+  EXPECT_EQ(nullopt, map.Get("$a"_sv));
+  EXPECT_TRUE(map.NewBound("$a"_sv));
+  ExpectGet(map, "$a"_sv, 0);
+}
+
+TEST(TextNameMapTest, EmptyScopes) {
+  NameMap map;
+  map.NewBound("$a"_sv);
+  map.Push();
+  map.Push();
+  map.NewBound("$b"_sv);
+  map.Push();
+  // 0  1
+  // $b $a
+  ExpectGet(map, "$a"_sv, 1);
+  ExpectGet(map, "$b"_sv, 0);
+}
+
+TEST(TextNameMapTest, Reset) {
+  NameMap map;
+  map.NewBound("$a"_sv);
+  map.Push();
+  map.NewBound("$b"_sv);
+  map.Reset();
+  EXPECT_FALSE(map.Has("$a"_sv));
+  EXPECT_FALSE(map.Has("$b"_sv));
+  EXPECT_EQ(0u, map.Size());
+  EXPECT_TRUE(map.NewBound("$b"_sv));
+  ExpectGet(map, "$b"_sv, 0);
+}
+
+TEST(TextNameMapTest, Indexed) {
+  auto names = MakeNames(40);
+  NameMap map;
+  for (auto&& name : names) {
+    EXPECT_TRUE(map.NewBound(name));
+  }
+  EXPECT_FALSE(map.NewBound(names[0]));
+  EXPECT_FALSE(map.NewBound(names[39]));
+  for (Index i = 0; i < 40; ++i) {
+    ExpectGet(map, names[i], i);
+  }
+  EXPECT_FALSE(map.Has("$missing"_sv));
+  EXPECT_EQ(40u, map.Size());
+}
+
+TEST(TextNameMapTest, BuildIndexWithShadowedName) {
+  // The index is built while $a is bound in two scopes, so it must record
+  // that the newer binding shadows the older one.
+  auto names = MakeNames(20);
+  NameMap map;
+  map.NewBound("$a"_sv);
+  map.Push();
+  map.NewBound("$a"_sv);
+  for (auto&& name : names) {
+    map.NewBound(name);
+  }
+  // 0  1    ...  20   21
+  // $a $n0  ...  $n19 $a
+  ExpectGet(map, "$a"_sv, 0);
+  ExpectGet(map, names[0], 1);
+  ExpectGet(map, names[19], 20);
+  EXPECT_FALSE(map.NewBound("$a"_sv));
+
+  map.Pop();
+  // 0
+  // $a
+  ExpectGet(map, "$a"_sv, 0);
+  EXPECT_FALSE(map.Has(names[0]));
+  EXPECT_EQ(1u, map.Size());
+}
+
+TEST(TextNameMapTest, IndexedShadowAcrossPushPop) {
+  auto names = MakeNames(20);
+  NameMap map;
+  for (auto&& name : names) {
+    map.NewBound(name);
+  }
+
+  map.Push();
+  EXPECT_FALSE(map.HasSinceLastPush(names[5]));
+  EXPECT_TRUE(map.NewBound(names[5]));
+  EXPECT_TRUE(map.NewBound("$new"_sv));
+  EXPECT_FALSE(map.NewBound(names[5]));
+  EXPECT_TRUE(map.HasSinceLastPush(names[5]));
+  // 0    1    2    ...  21
+  // $n5 $new  $n0  ...  $n19
+  ExpectGet(map, names[5], 0);
+  ExpectGet(map, "$new"_sv, 1);
+  ExpectGet(map, names[0], 2);
+  ExpectGet(map, names[6], 8);
+
+  map.Push();
+  EXPECT_TRUE(map.NewBound(names[5]));
+  ExpectGet(map, names[5], 0);
+  ExpectGet(map, "$new"_sv, 2);
+
+  map.Pop();
+  ExpectGet(map, names[5], 0);
+  ExpectGet(map, "$new"_sv, 1);
+
+  map.Pop();
+  // 0    ...  19
+  // $n0  ...  $n19
+  ExpectGet(map, names[5], 5);
+  ExpectGet(map, names[6], 6);
+  EXPECT_FALSE(map.Has("$new"_sv));
+  EXPECT_EQ(nullopt, map.Get("$new"_sv));
+  EXPECT_TRUE(map.HasSinceLastPush(names[5]));
+  EXPECT_FALSE(map.NewBound(names[5]));
+  EXPECT_TRUE(map.NewBound("$new"_sv));
+  ExpectGet(map, "$new"_sv, 20);
+}
+
+TEST(TextNameMapTest, ResetIndexed) {
+  auto names = MakeNames(20);
+  NameMap map;
+  for (auto&& name : names) {
+    map.NewBound(name);
+  }
+  map.Reset();
+  EXPECT_FALSE(map.Has(names[0]));
+  EXPECT_TRUE(map.NewBound(names[1]));
+  ExpectGet(map, names[1], 0);
+}
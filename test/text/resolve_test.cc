@@ -242,6 +242,26 @@ TEST_F(TextResolveTest, FunctionTypeUse_DeferType) {
       defined_types[0]);
 }
 
+TEST_F(TextResolveTest, FunctionTypeUse_ReuseDeferredType) {
+  FunctionTypeMap& ftm = ctx.function_type_map;
+
+  ftm.Define(BoundFunctionType{{BVT{nullopt, VT_I32}}, {}});
+
+  // The same type at different locations is only deferred once.
+  const SpanU8 loc2 = "B"_su8;
+  EXPECT_EQ(1u, ftm.Use(FunctionType{{At{loc1, VT_F32}}, {}}));
+  EXPECT_EQ(2u, ftm.Use(FunctionType{{}, {VT_F32}}));
+  EXPECT_EQ(1u, ftm.Use(FunctionType{{At{loc2, VT_F32}}, {}}));
+  EXPECT_EQ(0u, ftm.Use(FunctionType{{VT_I32}, {}}));
+
+  auto defined_types = ftm.EndModule();
+  ASSERT_EQ(2u, defined_types.size());
+  ASSERT_EQ(3u, ftm.Size());
+
+  // Deferred types can be used by index once they are defined.
+  EXPECT_EQ(2u, ftm.Use(FunctionType{{}, {VT_F32}}));
+}
+
 TEST_F(TextResolveTest, FunctionTypeUse_NoFunctionTypeInContext) {
   FunctionTypeUse type_use;
   Resolve(ctx, type_use);
@@ -37,8 +37,8 @@ TEST(TextTokenTest, TextToString_Escapes) {
     {Text{R"("a newline \n")", 11}, "a newline \n"_sv},
     {Text{R"("a CR \r")", 6}, "a CR \r"_sv},
     {Text{R"("a double quote \"")", 16}, "a double quote \""_sv},
-    {Text{R"("a quote \'")", 16}, "a quote '"_sv},
-    {Text{R"("a slash \\")", 16}, "a slash \\"_sv},
+    {Text{R"("a quote \'")", 9}, "a quote '"_sv},
+    {Text{R"("a slash \\")", 9}, "a slash \\"_sv},
   };
   for (auto test: tests) {
     EXPECT_EQ(test.expected, test.text.ToString());
@@ -87,3 +87,30 @@ TEST(TextTokenTest, TextToString_HexEscape) {
     EXPECT_EQ(test.expected, test.text.ToString());
   }
 }
+
+TEST(TextTokenTest, TextToString_Arena) {
+  Arena arena;
+  auto empty = Text{R"("")", 0}.ToString(arena);
+  auto hello = Text{R"("hello")", 5}.ToString(arena);
+  auto escapes = Text{R"("\t\"\00\ff\\")", 5}.ToString(arena);
+  EXPECT_EQ(""_sv, empty);
+  EXPECT_EQ("hello"_sv, hello);
+  EXPECT_EQ("\t\"\x00\xff\\"_sv, escapes);
+  EXPECT_EQ(10u, arena.allocated_bytes());
+}
+
+TEST(TextTokenTest, TextToString_WrongByteSize) {
+  // Text is an aggregate, so byte_size may not match the text. The result
+  // must still be the unescaped text, without writing past its storage.
+  for (u32 byte_size : {0u, 1u, 5u, 6u, 100u}) {
+    Text text{R"("a\tb\00c")", byte_size};
+    EXPECT_EQ("a\tb\0c"_sv, string_view{text.ToString()});
+
+    Buffer buffer{'x'};
+    text.AppendToBuffer(buffer);
+    EXPECT_EQ((Buffer{'x', 'a', '\t', 'b', 0, 'c'}), buffer);
+
+    Arena arena;
+    EXPECT_EQ("a\tb\0c"_sv, text.ToString(arena));
+  }
+}
@@ -45,8 +45,8 @@ TEST(TextTypesTest, FunctionToImport) {
 }
 
 TEST(TextTypesTest, FunctionToExports) {
-  auto name1 = At{"\"e1\""_su8, Text{"\"e1\"", 1}};
-  auto name2 = At{"\"e2\""_su8, Text{"\"e2\"", 1}};
+  auto name1 = At{"\"e1\""_su8, Text{"\"e1\"", 2}};
+  auto name2 = At{"\"e2\""_su8, Text{"\"e2\"", 2}};
   auto desc = FunctionDesc{nullopt, At{"(type 0)"_su8, Var{Index{0}}}, {}};
   Index this_index = 13;
 
@@ -82,8 +82,8 @@ TEST(TextTypesTest, TableToImport) {
 }
 
 TEST(TextTypesTest, TableToExports) {
-  auto name1 = At{"\"e1\""_su8, Text{"\"e1\"", 1}};
-  auto name2 = At{"\"e2\""_su8, Text{"\"e2\"", 1}};
+  auto name1 = At{"\"e1\""_su8, Text{"\"e1\"", 2}};
+  auto name2 = At{"\"e2\""_su8, Text{"\"e2\"", 2}};
   auto desc = TableDesc{
       nullopt,
       At{"1 funcref"_su8, TableType{At{"1"_su8, Limits{At{"1"_su8, u32{1}}}},
@@ -137,8 +137,8 @@ TEST(TextTypesTest, MemoryToImport) {
 }
 
 TEST(TextTypesTest, MemoryToExports) {
-  auto name1 = At{"\"e1\""_su8, Text{"\"e1\"", 1}};
-  auto name2 = At{"\"e2\""_su8, Text{"\"e2\"", 1}};
+  auto name1 = At{"\"e1\""_su8, Text{"\"e1\"", 2}};
+  auto name2 = At{"\"e2\""_su8, Text{"\"e2\"", 2}};
   auto desc = MemoryDesc{
       nullopt,
       At{"1"_su8, MemoryType{At{"1"_su8, Limits{At{"1"_su8, u32{1}}}}}}};
@@ -188,8 +188,8 @@ TEST(TextTypesTest, GlobalToImport) {
 }
 
 TEST(TextTypesTest, GlobalToExports) {
-  auto name1 = At{"\"e1\""_su8, Text{"\"e1\"", 1}};
-  auto name2 = At{"\"e2\""_su8, Text{"\"e2\"", 1}};
+  auto name1 = At{"\"e1\""_su8, Text{"\"e1\"", 2}};
+  auto name2 = At{"\"e2\""_su8, Text{"\"e2\"", 2}};
   auto desc = GlobalDesc{
       nullopt,
       At{"i32"_su8, GlobalType{At{"i32"_su8, VT_I32}, Mutability::Const}}};
@@ -229,8 +229,8 @@ TEST(TextTypesTest, TagToImport) {
 }
 
 TEST(TextTypesTest, TagToExports) {
-  auto name1 = At{"\"e1\""_su8, Text{"\"e1\"", 1}};
-  auto name2 = At{"\"e2\""_su8, Text{"\"e2\"", 1}};
+  auto name1 = At{"\"e1\""_su8, Text{"\"e1\"", 2}};
+  auto name2 = At{"\"e2\""_su8, Text{"\"e2\"", 2}};
   auto desc =
       TagDesc{nullopt,
               At{"(type 0)"_su8,
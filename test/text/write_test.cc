@@ -21,6 +21,7 @@
 #include "test/text/constants.h"
 #include "test/write_test_utils.h"
 #include "wasp/base/errors.h"
+#include "wasp/base/output_sink.h"
 #include "wasp/text/formatters.h"
 #include "wasp/text/write.h"
 
@@ -1545,3 +1546,14 @@ TEST(TextWriteTest, Script) {
                               Text{"\"msg\"", 3}}}},
       });
 }
+
+TEST(TextWriteTest, Script_OutputSink) {
+  Script script{
+      Command{ScriptModule{nullopt, ScriptModuleKind::Text, {}}},
+      Command{InvokeAction{nullopt, Text{"\"a\""_sv, 1}, {}}},
+  };
+  WriteCtx ctx;
+  OutputSink sink;
+  Write(ctx, script, sink.out());
+  EXPECT_EQ("(module)\n(invoke \"a\")"_su8, SpanU8{sink.ToBuffer()});
+}
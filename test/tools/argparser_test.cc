@@ -137,6 +137,18 @@ TEST(ArgParserTest, BareWithFlags) {
   EXPECT_EQ(3, count);
 }
 
+TEST(ArgParserTest, BareDash) {
+  std::vector<string_view> bare;
+
+  ArgParser parser{"prog"};
+  parser.Add("metavar", "help", [&](string_view arg) { bare.push_back(arg); });
+
+  std::vector<string_view> args{{"-"}};
+  parser.Parse(args);
+  ASSERT_EQ(1, bare.size());
+  EXPECT_EQ("-", bare[0]);
+}
+
 TEST(ArgParserTest, UnknownBare) {
   ArgParser parser{"prog"};
   std::vector<string_view> args{{"foo", "bar"}};
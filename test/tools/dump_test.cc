@@ -0,0 +1,71 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "src/tools/dump.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "wasp/base/span.h"
+#include "wasp/base/string_view.h"
+
+using namespace ::wasp;
+using namespace ::wasp::tools;
+
+namespace {
+
+// Writes `data` to a temporary file, and returns its name.
+std::string WriteTempFile(string_view name, SpanU8 data) {
+  std::string filename = testing::TempDir() + std::string{name};
+  std::ofstream stream{filename, std::ios::binary};
+  stream.write(reinterpret_cast<const char*>(data.data()), data.size());
+  return filename;
+}
+
+std::string Dump(std::vector<string_view> args) {
+  testing::internal::CaptureStdout();
+  dump::Main(args);
+  return testing::internal::GetCapturedStdout();
+}
+
+// A module with a function that uses a passive data segment, which requires
+// the data count section.
+SpanU8 GetBulkMemoryModule() {
+  return "\0asm\x01\0\0\0"
+         "\x01\x04\x01\x60\0\0"  // 1 type: params:[] results:[]
+         "\x03\x02\x01\0"        // 1 func: type 0
+         "\x05\x03\x01\0\x01"    // 1 memory: min 1
+         "\x0c\x01\x01"          // datacount 1
+         "\x0a\x11\x01\x0f\0"    // 1 code, no locals
+         "\x41\0\x41\0\x41\0"    // i32.const 0 (x3)
+         "\xfc\x08\0\0"          // memory.init 0 0
+         "\xfc\x09\0"            // data.drop 0
+         "\x0b"                  // end
+         "\x0b\x03\x01\x01\0"_su8;  // 1 data: passive ""
+}
+
+}  // namespace
+
+TEST(DumpTest, Disassemble_DataCount) {
+  auto filename = WriteTempFile("dump_test_bulk.wasm", GetBulkMemoryModule());
+  for (string_view jobs : {"1", "2"}) {
+    auto out = Dump({"-d", "--jobs", jobs, filename});
+    EXPECT_NE(std::string::npos, out.find("memory.init 0 0")) << out;
+    EXPECT_NE(std::string::npos, out.find("data.drop 0")) << out;
+  }
+}
@@ -0,0 +1,99 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "src/tools/generator.h"
+
+#include "gtest/gtest.h"
+#include "test/test_utils.h"
+#include "wasp/base/buffer.h"
+#include "wasp/binary/lazy_module.h"
+#include "wasp/binary/visitor.h"
+#include "wasp/valid/validate_visitor.h"
+
+using namespace ::wasp;
+using namespace ::wasp::binary;
+using namespace ::wasp::test;
+using namespace ::wasp::tools;
+
+namespace {
+
+void ExpectValid(const GeneratorOptions& options) {
+  SCOPED_TRACE(testing::Message() << "seed " << options.seed);
+  Buffer buffer = GenerateModule(options);
+  Features features = GeneratorFeatures(options);
+  TestErrors errors;
+  auto module = ReadLazyModule(buffer, features, errors);
+  valid::ValidateVisitor visitor{features, errors};
+  EXPECT_EQ(visit::Result::Ok, visit::Visit(module, visitor));
+  ExpectNoErrors(errors);
+}
+
+GeneratorOptions SmallOptions() {
+  GeneratorOptions options;
+  options.functions = 20;
+  options.instructions = 50;
+  return options;
+}
+
+}  // namespace
+
+TEST(GeneratorTest, Default) {
+  for (u32 seed = 0; seed < 8; ++seed) {
+    GeneratorOptions options = SmallOptions();
+    options.seed = seed;
+    ExpectValid(options);
+  }
+}
+
+TEST(GeneratorTest, NoFunctionTypes) {
+  GeneratorOptions options = SmallOptions();
+  options.function_types = 0;
+  options.functions = 0;
+  options.globals = 0;
+  ExpectValid(options);
+}
+
+TEST(GeneratorTest, DeepNesting) {
+  for (u32 seed = 0; seed < 4; ++seed) {
+    GeneratorOptions options = SmallOptions();
+    options.seed = seed;
+    options.max_depth = 16;
+    options.br_table_size = 1;
+    options.locals = 0;
+    ExpectValid(options);
+  }
+}
+
+TEST(GeneratorTest, StructAndArrayTypes) {
+  for (u32 seed = 0; seed < 8; ++seed) {
+    GeneratorOptions options = SmallOptions();
+    options.seed = seed;
+    options.struct_types = 12;
+    options.array_types = 3;
+    ExpectValid(options);
+  }
+}
+
+TEST(GeneratorTest, SameOptionsSameModule) {
+  GeneratorOptions options = SmallOptions();
+  options.seed = 1234;
+  options.struct_types = 8;
+  EXPECT_EQ(GenerateModule(options), GenerateModule(options));
+
+  GeneratorOptions other = options;
+  other.seed = 1235;
+  EXPECT_NE(GenerateModule(options), GenerateModule(other));
+}
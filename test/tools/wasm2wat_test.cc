@@ -0,0 +1,73 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "src/tools/wasm2wat.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "src/tools/generator.h"
+#include "wasp/base/buffer.h"
+#include "wasp/base/span.h"
+#include "wasp/base/string_view.h"
+
+using namespace ::wasp;
+using namespace ::wasp::tools;
+
+namespace {
+
+// Generates a module with `functions` functions, writes it to a temporary
+// file, and returns its name.
+std::string WriteGeneratedModule(string_view name, Index functions) {
+  GeneratorOptions options;
+  options.functions = functions;
+  Buffer buffer = GenerateModule(options);
+  std::string filename = testing::TempDir() + std::string{name};
+  std::ofstream stream{filename, std::ios::binary};
+  stream.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+  return filename;
+}
+
+std::string Wasm2Wat(std::vector<string_view> args) {
+  testing::internal::CaptureStdout();
+  int result = wasm2wat::Main(args);
+  std::string out = testing::internal::GetCapturedStdout();
+  EXPECT_EQ(0, result);
+  return out;
+}
+
+}  // namespace
+
+// The functions are read and written a window at a time when streaming, so
+// use enough of them to need several windows.
+TEST(Wasm2WatTest, Stream) {
+  auto filename = WriteGeneratedModule("wasm2wat_test_stream.wasm", 100);
+  auto expected = Wasm2Wat({filename});
+  ASSERT_NE(std::string::npos, expected.find("(func")) << expected;
+  EXPECT_EQ(expected, Wasm2Wat({"--stream", filename}));
+}
+
+// Each job converts chunks of about `functions / (jobs * 16)` functions, so
+// use more than `jobs * 16` functions to get chunks with several functions.
+TEST(Wasm2WatTest, Jobs) {
+  auto filename = WriteGeneratedModule("wasm2wat_test_jobs.wasm", 200);
+  auto expected = Wasm2Wat({"-j", "1", filename});
+  ASSERT_NE(std::string::npos, expected.find("(func")) << expected;
+  EXPECT_EQ(expected, Wasm2Wat({"-j", "4", filename}));
+  EXPECT_EQ(expected, Wasm2Wat({"--stream", "-j", "4", filename}));
+}
@@ -0,0 +1,68 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/valid/types.h"
+
+#include "gtest/gtest.h"
+
+#include "test/binary/constants.h"
+#include "wasp/base/concat.h"
+#include "wasp/binary/formatters.h"
+#include "wasp/valid/formatters.h"
+
+using namespace ::wasp;
+using namespace ::wasp::valid;
+using namespace ::wasp::binary;
+using namespace ::wasp::binary::test;
+
+TEST(ValidTypesTest, StackType_ValueType) {
+  const ValueType types[] = {
+      VT_I32,           VT_I64,           VT_F32,         VT_F64,
+      VT_V128,          VT_Funcref,       VT_Externref,   VT_Anyref,
+      VT_Eqref,         VT_I31ref,        VT_RefFunc,     VT_RefNullFunc,
+      VT_RefI31,        VT_RefNullI31,    VT_Ref0,        VT_RefNull0,
+      VT_Ref2,          VT_RefNull2,      VT_RTT_0_Func,  VT_RTT_1_Any,
+      VT_RTT_0_0,       VT_RTT_1_0,
+  };
+
+  for (const auto& type : types) {
+    StackType stack_type{type};
+    EXPECT_TRUE(stack_type.is_value_type());
+    // The constants have locations, but the unpacked value type doesn't.
+    EXPECT_EQ(concat(type), concat(stack_type.value_type()));
+    EXPECT_EQ(stack_type, StackType{stack_type.value_type()});
+  }
+}
+
+TEST(ValidTypesTest, StackType_Equality) {
+  EXPECT_EQ(StackType::I32(), StackType{VT_I32});
+  EXPECT_EQ(StackType{}, StackType{Any{}});
+  EXPECT_NE(StackType::I32(), StackType::I64());
+  EXPECT_NE(StackType::I32(), StackType{});
+  EXPECT_NE(StackType{VT_Ref0}, StackType{VT_RefNull0});
+  EXPECT_NE(StackType{VT_Ref0}, StackType{VT_Ref1});
+  EXPECT_NE(StackType{VT_RTT_0_0}, StackType{VT_RTT_1_0});
+
+  // "funcref" and "ref null func" are the same type, but are stored
+  // differently, so they can be printed as they were written.
+  EXPECT_NE(StackType{VT_Funcref}, StackType{VT_RefNullFunc});
+}
+
+TEST(ValidTypesTest, StackType_IgnoresLocations) {
+  StackType type1{ValueType{At{"\x7f"_su8, NumericType::I32}}};
+  StackType type2{ValueType{At{"\x7f\x7f"_su8, NumericType::I32}}};
+  EXPECT_EQ(type1, type2);
+}
@@ -588,6 +588,24 @@ TEST_F(ValidateInstructionTest, End) {
   ExpectNoErrors(errors);
 }
 
+TEST_F(ValidateInstructionTest, End_PopsLabelTypes) {
+  auto index = AddFunctionType(FunctionType{{VT_I64}, {VT_I32, VT_F32}});
+  auto label_types_size = ctx.label_types.size();
+  Ok(I{O::I64Const, s64{}});
+  Ok(I{O::Block, BlockType(index)});
+  EXPECT_EQ(label_types_size + 3, ctx.label_types.size());
+  EXPECT_EQ(StackTypeSpan{ToStackTypeList({VT_I64})},
+            ctx.GetParamTypes(TopLabel(ctx)));
+  EXPECT_EQ(StackTypeSpan{ToStackTypeList({VT_I32, VT_F32})},
+            ctx.GetResultTypes(TopLabel(ctx)));
+  Ok(I{O::Drop});
+  Ok(I{O::I32Const, s32{}});
+  Ok(I{O::F32Const, f32{}});
+  Ok(I{O::End});
+  EXPECT_EQ(label_types_size, ctx.label_types.size());
+  ExpectNoErrors(errors);
+}
+
 TEST_F(ValidateInstructionTest, End_Unreachable) {
   Ok(I{O::Block, BT_Void});
   Ok(I{O::Unreachable});
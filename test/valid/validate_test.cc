@@ -222,6 +222,22 @@ TEST_F(ValidateTest, ConstantExpression_Funcref) {
   EXPECT_EQ(1u, ctx.declared_functions.size());
 }
 
+TEST_F(ValidateTest, ConstantExpression_KeepsExpressionState) {
+  ctx.type_stack.push_back(StackType::I64());
+  ctx.PushLabel(LabelType::Block, {}, {}, 0);
+  ctx.locals.Append(1, VT_F32);
+
+  EXPECT_TRUE(Validate(
+      ctx, ConstantExpression{Instruction{Opcode::I32Const, s32{0}}}, VT_I32,
+      0));
+
+  // The constant expression is validated with its own expression state, and
+  // the previous state is restored afterward.
+  EXPECT_EQ(StackTypeList{StackType::I64()}, ctx.type_stack);
+  EXPECT_EQ(1u, ctx.label_stack.size());
+  EXPECT_EQ(1u, ctx.locals.GetCount());
+}
+
 TEST_F(ValidateTest, DataCount) {
   EXPECT_TRUE(Validate(ctx, DataCount{1}));
   ASSERT_TRUE(ctx.declared_data_count);
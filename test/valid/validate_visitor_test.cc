@@ -0,0 +1,178 @@
+//
+// Copyright 2021 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/valid/validate_visitor.h"
+
+#include <set>
+
+#include "gtest/gtest.h"
+#include "test/test_utils.h"
+#include "wasp/base/buffer.h"
+#include "wasp/base/features.h"
+#include "wasp/binary/lazy_module.h"
+#include "wasp/binary/visitor.h"
+
+using namespace ::wasp;
+using namespace ::wasp::binary;
+using namespace ::wasp::valid;
+using namespace ::wasp::test;
+
+namespace {
+
+void AppendU32(Buffer& buffer, u32 value) {
+  do {
+    u8 byte = value & 0x7f;
+    value >>= 7;
+    buffer.push_back(value ? byte | 0x80 : byte);
+  } while (value);
+}
+
+void AppendSection(Buffer& buffer, u8 id, const Buffer& contents) {
+  buffer.push_back(id);
+  AppendU32(buffer, static_cast<u32>(contents.size()));
+  buffer.insert(buffer.end(), contents.begin(), contents.end());
+}
+
+// Creates a module with `count` functions of type `(func)`. The functions
+// whose indexes are in `invalid` have the body `i32.const 0`, which is
+// invalid; the rest are empty.
+Buffer MakeModule(u32 count, const std::set<u32>& invalid = {}) {
+  Buffer module = {0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00};
+  AppendSection(module, 1, {0x01, 0x60, 0x00, 0x00});
+
+  Buffer functions;
+  AppendU32(functions, count);
+  functions.insert(functions.end(), count, 0x00);
+  AppendSection(module, 3, functions);
+
+  Buffer codes;
+  AppendU32(codes, count);
+  for (u32 i = 0; i < count; ++i) {
+    if (invalid.count(i)) {
+      codes.insert(codes.end(), {0x04, 0x00, 0x41, 0x00, 0x0b});
+    } else {
+      codes.insert(codes.end(), {0x02, 0x00, 0x0b});
+    }
+  }
+  AppendSection(module, 10, codes);
+  return module;
+}
+
+// Creates a module with `count` functions that use a passive data segment,
+// which requires the data count section.
+Buffer MakeBulkMemoryModule(u32 count) {
+  Buffer module = {0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00};
+  AppendSection(module, 1, {0x01, 0x60, 0x00, 0x00});
+
+  Buffer functions;
+  AppendU32(functions, count);
+  functions.insert(functions.end(), count, 0x00);
+  AppendSection(module, 3, functions);
+  AppendSection(module, 5, {0x01, 0x00, 0x01});  // (memory 1)
+  AppendSection(module, 12, {0x01});             // datacount 1
+
+  Buffer codes;
+  AppendU32(codes, count);
+  for (u32 i = 0; i < count; ++i) {
+    codes.insert(codes.end(), {
+                                  0x0f, 0x00,              // size, locals
+                                  0x41, 0x00,              // i32.const 0
+                                  0x41, 0x00,              // i32.const 0
+                                  0x41, 0x00,              // i32.const 0
+                                  0xfc, 0x08, 0x00, 0x00,  // memory.init 0 0
+                                  0xfc, 0x09, 0x00,        // data.drop 0
+                                  0x0b,                    // end
+                              });
+  }
+  AppendSection(module, 10, codes);
+  AppendSection(module, 11, {0x01, 0x01, 0x00});  // (data passive "")
+  return module;
+}
+
+auto ValidateModule(SpanU8 data, u32 code_jobs, TestErrors& errors)
+    -> visit::Result {
+  Features features;
+  auto module = ReadLazyModule(data, features, errors);
+  ValidateVisitor visitor{features, errors, code_jobs};
+  return visit::Visit(module, visitor);
+}
+
+}  // namespace
+
+TEST(ValidateVisitorTest, ParallelCode) {
+  auto module = MakeModule(1000);
+  TestErrors errors;
+  EXPECT_EQ(visit::Result::Ok, ValidateModule(module, 4, errors));
+  ExpectNoErrors(errors);
+}
+
+TEST(ValidateVisitorTest, ParallelCode_MoreJobsThanFunctions) {
+  auto module = MakeModule(3);
+  TestErrors errors;
+  EXPECT_EQ(visit::Result::Ok, ValidateModule(module, 16, errors));
+  ExpectNoErrors(errors);
+}
+
+TEST(ValidateVisitorTest, ParallelCode_DataCount) {
+  auto module = MakeBulkMemoryModule(100);
+  for (u32 code_jobs : {1, 4}) {
+    TestErrors errors;
+    EXPECT_EQ(visit::Result::Ok, ValidateModule(module, code_jobs, errors));
+    ExpectNoErrors(errors);
+  }
+}
+
+TEST(ValidateVisitorTest, ParallelCode_SameErrorsAsSerial) {
+  for (const auto& invalid : std::vector<std::set<u32>>{
+           {0}, {999}, {500, 700}, {1, 998}}) {
+    auto module = MakeModule(1000, invalid);
+
+    TestErrors serial_errors;
+    EXPECT_EQ(visit::Result::Fail, ValidateModule(module, 1, serial_errors));
+
+    TestErrors parallel_errors;
+    EXPECT_EQ(visit::Result::Fail, ValidateModule(module, 4, parallel_errors));
+
+    ASSERT_FALSE(serial_errors.errors.empty());
+    ExpectErrors(serial_errors.errors, parallel_errors);
+  }
+}
+
+TEST(ValidateVisitorTest, ParallelCode_MalformedFallsBackToSerial) {
+  auto module = MakeModule(100);
+  // Change the last function's locals count from 0 to 1, so its locals can't
+  // be read.
+  module[module.size() - 2] = 0x01;
+
+  TestErrors serial_errors;
+  ValidateModule(module, 1, serial_errors);
+
+  TestErrors parallel_errors;
+  ValidateModule(module, 4, parallel_errors);
+
+  ASSERT_FALSE(serial_errors.errors.empty());
+  ExpectErrors(serial_errors.errors, parallel_errors);
+}
+
+TEST(ValidateVisitorTest, ParallelCode_ReadErrorFails) {
+  auto module = MakeModule(100);
+  // Replace the last function's end instruction with an unknown opcode.
+  module.back() = 0xff;
+
+  TestErrors errors;
+  EXPECT_EQ(visit::Result::Fail, ValidateModule(module, 4, errors));
+  EXPECT_FALSE(errors.errors.empty());
+}